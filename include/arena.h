@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include "memory.h"
+
+#define ARENA_BLOCO_PADRAO (64u << 10)   // tamanho por omissão do primeiro bloco (64 KB)
+#define ARENA_BLOCO_MAXIMO (64u << 20)   // limite do crescimento geométrico dos blocos (64 MB)
+#define ARENA_ALINHAMENTO  8             // suficiente para todos os nós (int, float, long long, ponteiros)
+
+/**
+ * @brief Bloco de memória de uma arena. Os blocos nunca mudam de sítio,
+ * pelo que os ponteiros devolvidos por arena_alloc() se mantêm válidos
+ * até à libertação da arena inteira.
+ *
+ */
+typedef struct BlocoArena {
+    struct BlocoArena* next;
+    size_t             tamanho;   // bytes úteis em dados[]
+    size_t             usado;
+    unsigned char      dados[];
+} BlocoArena;
+
+/**
+ * @brief Arena (alocador por blocos): as alocações são feitas em sequência
+ * dentro do bloco atual e toda a memória é libertada de uma só vez.
+ * Cada arena guarda estatísticas próprias para os relatórios de memória, e os
+ * seus blocos (e a parte ainda livre deles) são contabilizados no subsistema dela.
+ * Uma arena não é thread-safe: cada thread deve usar a sua.
+ *
+ */
+typedef struct {
+    const char* nome;
+    BlocoArena* blocos;           // o bloco atual está à cabeça
+    size_t      tamanhoBloco;     // tamanho do primeiro bloco (os seguintes duplicam)
+    size_t      numBlocos;
+    size_t      numAlocacoes;
+    size_t      bytesUsados;      // soma dos pedidos (com alinhamento)
+    size_t      bytesReservados;  // soma do tamanho dos blocos
+    SubsistemaMemoria subsistema;
+} Arena;
+
+#define ARENA_INIT(nome, tamanhoBloco, subsistema) { (nome), NULL, (tamanhoBloco), 0, 0, 0, 0, (subsistema) }
+
+void  arena_init(Arena* arena, const char* nome, size_t tamanhoBloco, SubsistemaMemoria subsistema);
+void* arena_alloc(Arena* arena, size_t bytes);
+void  arena_juntar(Arena* destino, Arena* origem);
+void  arena_libertar(Arena* arena);
+void  arena_imprimirEstatisticas(const Arena* arena);
+
+#endif // ARENA_H
@@ -0,0 +1,85 @@
+#ifndef ATTRIBUTE_INDEX_H
+#define ATTRIBUTE_INDEX_H
+
+#include "data.h"
+#include "bitmap.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ANOS_POR_FAIXA  5      // faixas de anos de fabrico: 2000-2004, 2005-2009, ...
+#define ANO_MINIMO      1800   // anos fora de [ANO_MINIMO, ANO_MAXIMO] não são indexados
+#define ANO_MAXIMO      2200
+#define NUM_DISTRITOS   100    // distrito = prefixo do código postal / 1000 ("4000-123" -> 4)
+
+#define FILTRO_QUALQUER  -1
+#define FILTRO_NENHUM    INT_MAX   // valor que nenhum carro tem (ex.: marca desconhecida)
+
+/**
+ * @brief Filtro de carros por atributos. Os campos a FILTRO_QUALQUER (ou o
+ * intervalo de anos todo) não restringem nada.
+ *
+ */
+typedef struct {
+    int marca;      // código no dicionarioMarcas
+    int modelo;     // código no dicionarioModelos
+    int anoMin;
+    int anoMax;
+    int distrito;   // do código postal do dono
+} FiltroCarros;
+
+#define FILTRO_CARROS_INIT { FILTRO_QUALQUER, FILTRO_QUALQUER, INT_MIN, INT_MAX, FILTRO_QUALQUER }
+
+/**
+ * @brief Bitmaps comprimidos (ver bitmap.h) de idVeiculo por marca, modelo,
+ * ano de fabrico (cada ano e cada faixa de ANOS_POR_FAIXA) e distrito do
+ * código postal do dono. Um filtro resolve-se por interseção dos bitmaps dos
+ * atributos pedidos; um intervalo de anos é a união das faixas que cobre por
+ * inteiro e dos anos soltos das pontas.
+ *
+ * Reflete um par de listas (donos, carros): é construído no carregamento e
+ * mantido de forma incremental ao registar carros (e donos, que ainda não
+ * têm carros). Não é thread-safe.
+ *
+ */
+typedef struct {
+    Bitmap*          marcas;         // por código de marca
+    int              numMarcas;
+    Bitmap*          modelos;        // por código de modelo
+    int              numModelos;
+    Bitmap*          anos;           // ano - anoBase
+    Bitmap*          faixas;         // (ano - anoBase) / ANOS_POR_FAIXA
+    int              anoBase;        // múltiplo de ANOS_POR_FAIXA
+    int              numAnos;
+    Bitmap           distritos[NUM_DISTRITOS];
+    size_t           numCarros;
+    const NodeDono*  cabecaDonos;    // listas refletidas (NULL = índice vazio)
+    const NodeCarro* cabecaCarros;
+} IndiceAtributos;
+
+/**
+ * @brief Índice de atributos das listas principais (definido em attribute_index.c).
+ *
+ */
+extern IndiceAtributos indiceAtributos;
+
+bool indiceAtributos_sincronizar(IndiceAtributos* idx, const NodeDono* listaDonos, const NodeCarro* listaCarros);
+bool indiceAtributos_inserirCarro(IndiceAtributos* idx, const NodeCarro* no, const NodeDono* listaDonos);
+void indiceAtributos_inserirDono(IndiceAtributos* idx, const NodeDono* no);
+bool indiceAtributos_resolver(const IndiceAtributos* idx, const FiltroCarros* filtro, Bitmap* resultado);
+void indiceAtributos_libertar(IndiceAtributos* idx);
+void indiceAtributos_imprimirEstatisticas(const IndiceAtributos* idx);
+bool filtroCarros_ativo(const FiltroCarros* filtro);
+
+/**
+ * @brief Diz se o índice reflete a lista de carros indicada.
+ *
+ * @param idx
+ * @param listaCarros
+ * @return bool
+ */
+static inline bool indiceAtributos_valido(const IndiceAtributos* idx, const NodeCarro* listaCarros) {
+    return listaCarros != NULL && idx->cabecaCarros == listaCarros;
+}
+
+#endif // ATTRIBUTE_INDEX_H
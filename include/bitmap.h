@@ -0,0 +1,51 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include "memory.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BITMAP_LIMITE_ARRAY 4096   // acima disto um contentor passa a mapa de bits
+#define BITMAP_PALAVRAS     1024   // 65536 bits por mapa
+
+/**
+ * @brief Valores com os mesmos 16 bits altos. Até BITMAP_LIMITE_ARRAY valores
+ * é um array ordenado dos 16 bits baixos (2 bytes por valor); acima disso é um
+ * mapa de 65536 bits (8 KiB), que passa a ocupar menos.
+ *
+ */
+typedef struct {
+    uint16_t  chave;          // 16 bits altos
+    bool      mapa;           // true = palavras, false = valores
+    uint32_t  cardinalidade;
+    uint32_t  capacidade;     // valores reservados (só no array)
+    uint16_t* valores;
+    uint64_t* palavras;
+} Contentor;
+
+/**
+ * @brief Conjunto comprimido de inteiros de 32 bits sem sinal, à maneira dos
+ * roaring bitmaps: contentores ordenados pelos 16 bits altos, cada um array ou
+ * mapa de bits conforme a densidade. A interseção e a união trabalham contentor
+ * a contentor, sem descomprimir. Não é thread-safe.
+ *
+ */
+typedef struct {
+    Contentor*        contentores;  // ordenados pela chave
+    uint32_t          num;
+    uint32_t          capacidade;
+    SubsistemaMemoria subsistema;
+} Bitmap;
+
+#define BITMAP_INIT(subsistema) { NULL, 0, 0, (subsistema) }
+
+bool     bitmap_adicionar(Bitmap* b, uint32_t valor);
+bool     bitmap_contem(const Bitmap* b, uint32_t valor);
+uint64_t bitmap_cardinalidade(const Bitmap* b);
+bool     bitmap_intersetar(const Bitmap* a, const Bitmap* b, Bitmap* resultado);
+bool     bitmap_unir(const Bitmap* a, const Bitmap* b, Bitmap* resultado);
+size_t   bitmap_bytes(const Bitmap* b);
+void     bitmap_libertar(Bitmap* b);
+
+#endif // BITMAP_H
@@ -0,0 +1,96 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define COLUNAS_CAPACIDADE_INICIAL 4096
+
+/**
+ * @brief Cache colunar (struct-of-arrays) derivada da lista de passagens, para
+ * as consultas que percorrem todas as passagens: um filtro por período lê só
+ * ts[] (8 bytes por passagem) em vez de um NodePassagem inteiro.
+ *
+ * A lista ligada continua a ser a fonte dos dados e os nós não mudam (ficam
+ * com a dataHora e o next); as colunas são sincronizadas com ela antes de cada
+ * consulta (ver colunas_sincronizar) e podem ser libertadas a qualquer altura.
+ * São memória a mais, não a menos: cerca de 22 bytes e 2 bits por passagem
+ * além do nó (ver colunas_imprimirEstatisticas). A dataHora não é copiada:
+ * quando é precisa para mostrar ou exportar, vem do nó original (origem[i]).
+ *
+ * As linhas estão por ordem de chegada: as da lista no carregamento, depois
+ * as postas à cabeça (registarPassagem) e as acrescentadas no fim (modo de
+ * seguimento) à medida que aparecem, sem recopiar as outras. As linhas postas
+ * à cabeça ficam marcadas em aCabeca, para se saber a sua ordem na lista (ver
+ * colunas_antes). Só uma lista diferente (arquivo, recarregamento) obriga a
+ * reconstruir, o que muda a geracao.
+ *
+ */
+typedef struct {
+    long long*           ts;           // milissegundos desde 1970-01-01
+    int32_t*             idVeiculo;
+    int16_t*             idSensor;
+    uint64_t*            tipoRegisto;  // 1 bit por passagem (0=entrada, 1=saída)
+    uint64_t*            aCabeca;      // 1 bit por passagem: posta à cabeça da lista
+    const NodePassagem** origem;       // nó da lista de onde veio cada linha
+    size_t               total;
+    size_t               capacidade;
+    const NodePassagem*  cabeca;       // cabeça da lista na última sincronização
+    const NodePassagem*  cauda;        // último nó já copiado
+    unsigned             geracao;      // muda sempre que as colunas são reconstruídas
+} ColunasPassagens;
+
+/**
+ * @brief Colunas da lista principal de passagens (definidas em columns.c).
+ *
+ */
+extern ColunasPassagens colunasPassagens;
+
+bool colunas_sincronizar(ColunasPassagens* col, const NodePassagem* lista);
+void colunas_libertar(ColunasPassagens* col);
+size_t colunas_bytes(const ColunasPassagens* col);
+void colunas_imprimirEstatisticas(const ColunasPassagens* col);
+
+/**
+ * @brief Tipo de registo (0=entrada, 1=saída) da linha i.
+ *
+ * @param col
+ * @param i
+ * @return int
+ */
+static inline int colunas_tipoRegisto(const ColunasPassagens* col, size_t i) {
+    return (int)((col->tipoRegisto[i / 64] >> (i % 64)) & 1);
+}
+
+/**
+ * @brief Ordem das linhas na lista: as postas à cabeça vêm primeiro (a mais
+ * recente à frente), depois as restantes pela ordem das linhas.
+ *
+ * @param col
+ * @param a
+ * @param b
+ * @return bool true se a linha a vem antes da b na lista
+ */
+static inline bool colunas_antesNaLista(const ColunasPassagens* col, size_t a, size_t b) {
+    bool ca = (col->aCabeca[a / 64] >> (a % 64)) & 1;
+    bool cb = (col->aCabeca[b / 64] >> (b % 64)) & 1;
+    if (ca != cb) return ca;
+    return ca ? a > b : a < b;
+}
+
+/**
+ * @brief Ordem por (ts, posição na lista).
+ *
+ * @param col
+ * @param a
+ * @param b
+ * @return bool true se a linha a vem antes da b
+ */
+static inline bool colunas_antes(const ColunasPassagens* col, size_t a, size_t b) {
+    if (col->ts[a] != col->ts[b]) return col->ts[a] < col->ts[b];
+    return colunas_antesNaLista(col, a, b);
+}
+
+#endif // COLUMNS_H
@@ -8,26 +8,35 @@
 #define SENSOR_MAX_DESIGNACAO 50
 #define SENSOR_MAX_LATITUDE 90
 #define SENSOR_MAX_LONGITUDE 180
+#ifndef SENSOR_GUARDAR_TEXTO
+#define SENSOR_GUARDAR_TEXTO 1 // guarda o texto original das coordenadas (0 = só os valores numéricos)
+#endif
 #define PASSAGEM_MAX_DATAHORA 30
+#define PASSAGEM_MIN_LINHA 30 // "1\t1\t12-09-2010_21:35:45.135\t0\n", usado para estimar o nº de linhas
 #define MAX_DONOS 100000 // s.a.a.
 #define MAX_CARROS 100000 // s.a.a.
 #define MAX_SENSORES 10000
+#define PASSAGENS_MAX_THREADS 64                  // limite de threads de parsing de passagem.txt
+#define PASSAGENS_MIN_BYTES_THREAD (4u << 20)     // fatias mais pequenas não compensam uma thread
 
 #define _GNU_SOURCE
 #include <time.h>
+#include <stdint.h>
+#include "arena.h"
+#include "string_heap.h"
 
 /**
  * @brief  * Representa um Dono (conforme o enunciado: numContribuinte, nome, codPostal).
  * Aqui usamos:
  *  - numeroContribuinte (int)
- *  - nome (string)
- *  - codigoPostal (string)
+ *  - nome (referência para o heapNomesDonos, ver nomeDono())
+ *  - codigoPostal (inteiro empacotado, ver postal.h)
  * 
  */
 typedef struct {
-    int  numeroContribuinte;
-    char nome[DONO_MAX_NOME];
-    char codigoPostal[DONO_MAX_CODIGOPOSTAL];
+    int       numeroContribuinte;
+    RefString nome;
+    uint32_t  codigoPostal;
 } Dono;
 
 /**
@@ -42,8 +51,8 @@ typedef struct nodeDono {
 /**
  * @brief Representa um Carro (equivalente à entidade "Carro" do enunciado).
  *  - matrícula => matricula
- *  - marca => marca
- *  - modelo => modelo
+ *  - marca => codigoMarca (código no dicionarioMarcas, ver dictionary.h)
+ *  - modelo => codigoModelo (código no dicionarioModelos)
  *  - ano => ano
  *  - numContribuinte do Dono => donoContribuinte
  *  - codVeiculo => idVeiculo
@@ -52,8 +61,8 @@ typedef struct nodeDono {
  */
 typedef struct {
     char matricula[CARRO_MAX_MATRICULA];
-    char marca[CARRO_MAX_MARCA];
-    char modelo[CARRO_MAX_MODELO];
+    int  codigoMarca;
+    int  codigoModelo;
     int  ano;
     int  donoContribuinte; // faz a ligação a Dono.numeroContribuinte
     int  idVeiculo;
@@ -70,13 +79,17 @@ typedef struct nodeCarro {
 
 /**
  * @brief Representa um Sensor (equivalente a "codSensor", "designacao", "latitude", "longitude").
+ * As coordenadas são convertidas para graus decimais ao ler (ver geo.h); o texto
+ * original só é mantido com SENSOR_GUARDAR_TEXTO ou se não for reconhecido.
  * 
  */
 typedef struct {
-    int  idSensor;
-    char designacao[SENSOR_MAX_DESIGNACAO];
-    char latitude[SENSOR_MAX_LATITUDE];
-    char longitude[SENSOR_MAX_LONGITUDE];
+    int    idSensor;
+    char   designacao[SENSOR_MAX_DESIGNACAO];
+    double latitude;              // graus decimais, Norte positivo (NAN se o texto não foi reconhecido)
+    double longitude;             // graus decimais, Este positivo
+    const char* latitudeTexto;    // texto original (na arenaSensores), ou NULL
+    const char* longitudeTexto;
 } Sensor;
 
 /**
@@ -123,7 +136,7 @@ typedef struct {
     int  idVeiculo;
     char dataHora[PASSAGEM_MAX_DATAHORA];  // ex.: "12-09-2010_21:35:45.135"
     int  tipoRegisto;   // 0=entrada, 1=saída
-    time_t ts;
+    long long ts;       // milissegundos desde 1970-01-01 (ver parseTimestampMs)
 } Passagem;
 
 /**
@@ -135,6 +148,29 @@ typedef struct nodePassagem {
     struct nodePassagem* next;
 } NodePassagem;
 
+/**
+ * @brief Próximo nó da lista de passagens. Com o modo de seguimento ativo a
+ * thread de seguimento publica nós no fim da lista com um store release em
+ * next (ver follow.c); a leitura com acquire garante que o nó já está completo.
+ * 
+ * @param p 
+ * @return NodePassagem* 
+ */
+static inline NodePassagem* passagem_seguinte(const NodePassagem* p) {
+    return __atomic_load_n(&p->next, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Cabeça da lista de passagens, que a thread de seguimento também
+ * publica (com release) se a lista estiver vazia.
+ * 
+ * @param lista 
+ * @return NodePassagem* 
+ */
+static inline NodePassagem* passagem_cabeca(NodePassagem* const* lista) {
+    return __atomic_load_n(lista, __ATOMIC_ACQUIRE);
+}
+
 typedef struct kmVeiculo {
     int  idVeiculo;
     float km;
@@ -145,7 +181,7 @@ typedef struct kmVeiculo {
  * 
  */
 typedef struct kmMarca {
-    char marca[CARRO_MAX_MARCA];
+    int    codigoMarca;
     double km;
 } KmMarca;
 
@@ -161,26 +197,6 @@ typedef struct TreeNodeInfracao {
     struct TreeNodeInfracao *right;         // Ponteiro para subárvore direita
 } TreeNodeInfracao;
 
-/**
- * @brief Estrutura para agrupar passagens por veículo numa tabela hash
- * 
- */
-typedef struct PassagemGroup {
-    int idVeiculo;                  // Identificador do veículo
-    NodePassagem* passagens;        // Lista ligada de passagens deste veículo
-    struct PassagemGroup* next;     // Próximo grupo em caso de colisão no hash
-} PassagemGroup;
-
-
-/**
- * @brief -- Estruturas para a funçao listarInfracoes
- * 
- */
-typedef struct hashTablePassagens {
-    size_t numBuckets;              // Número de buckets na tabela hash
-    PassagemGroup** buckets;        // Array com os buckets (cada bucket é uma lista de PassagemGroup)
-} HashTablePassagens;
-
 typedef struct rankingInfra {
     int idVeiculo;
     char matricula[CARRO_MAX_MATRICULA];
@@ -193,14 +209,14 @@ typedef struct {
 } VelocidadeMedia;
 
 typedef struct {
-    char   marca[CARRO_MAX_MARCA];
+    int    codigoMarca;
     double somaVelocidades; // Soma das velocidades médias dos veículos desta marca
     int    numVeiculos;     // Nº de veículos da marca que circularam
 } MarcaVelocidade;
 
 typedef struct {
-    int    nifDono;
-    char   nomeDono[DONO_MAX_NOME];
+    int       nifDono;
+    RefString nomeDono;
     double somaVelocidades; // Soma das velocidades médias dos veículos deste dono
     int    numVeiculos;     // Nº de veículos do dono que circularam
 } DonoVelocidade;
@@ -210,9 +226,30 @@ typedef struct {
  * 
  */
 typedef struct {
-    char marca[CARRO_MAX_MARCA];
+    int codigoMarca;
     int contagem;
 } MarcaContagem;
 
+/**
+ * @brief Arenas globais onde vivem os nós das listas principais (definidas em data.c).
+ * Os carregadores e as funções registarX alocam aqui; libertarListaX liberta a arena inteira.
+ * 
+ */
+extern Arena arenaDonos;
+extern Arena arenaCarros;
+extern Arena arenaSensores;
+extern Arena arenaDistancias;
+extern Arena arenaPassagens;
+
+/**
+ * @brief Nome de um dono (válido até ao próximo dono inserido no heapNomesDonos).
+ * 
+ * @param d 
+ * @return const char* 
+ */
+static inline const char* nomeDono(const Dono* d) {
+    return strings_texto(&heapNomesDonos, d->nome);
+}
+
 #endif /* DATA_STRUCTURES_H */
 
@@ -0,0 +1,27 @@
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ANEL_NUM_BLOCOS    4             // blocos no anel entre o descompressor e o parser
+#define ANEL_TAMANHO_BLOCO (4u << 20)    // tamanho inicial de cada bloco (cresce se uma linha não couber)
+
+/**
+ * @brief Leitura de ficheiros comprimidos (.gz / .zst) em pipeline: o descompressor
+ * (gzip -dc / zstd -dc) corre num processo próprio e uma thread produtora passa a
+ * sua saída para um anel de ANEL_NUM_BLOCOS blocos. Cada bloco termina numa
+ * fronteira de linha, pelo que o parser pode interpretar um bloco enquanto o
+ * seguinte está a ser descomprimido.
+ *
+ */
+typedef struct LeitorComprimido LeitorComprimido;
+
+bool ficheiroComprimido(const char* nomeFicheiro);
+bool procurarVersaoComprimida(const char* nomeFicheiro, char* destino, size_t tamanho);
+
+LeitorComprimido* abrirComprimido(const char* nomeFicheiro);
+bool proximoBlocoComprimido(LeitorComprimido* leitor, const char** ini, const char** fim);
+bool fecharComprimido(LeitorComprimido* leitor);
+
+#endif // DECOMPRESS_H
@@ -0,0 +1,47 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DICIONARIO_POSICOES_INICIAIS 256   // tamanho inicial da tabela (potência de 2)
+
+/**
+ * @brief Dicionário de strings (interning): cada texto distinto recebe um
+ * código inteiro pequeno e denso (0, 1, 2, ... pela ordem de chegada), pelo
+ * que as agregações por marca/modelo podem usar arrays indexados pelo código
+ * em vez de comparar strings.
+ *
+ * Os textos vivem numa arena própria; a tabela de dispersão usa endereçamento
+ * aberto e guarda código + 1 (0 = posição livre). Não é thread-safe.
+ *
+ */
+typedef struct {
+    const char*  nome;
+    const char** textos;       // código -> texto terminado em '\0'
+    int          total;
+    int          capacidade;
+    int*         tabela;
+    size_t       numPosicoes;  // potência de 2
+    Arena        arena;
+} Dicionario;
+
+#define DICIONARIO_INIT(nome) { (nome), NULL, 0, 0, NULL, 0, ARENA_INIT((nome), ARENA_BLOCO_PADRAO / 16, MEMORIA_INDICES) }
+
+/**
+ * @brief Dicionários das marcas e dos modelos dos carros (definidos em dictionary.c).
+ *
+ */
+extern Dicionario dicionarioMarcas;
+extern Dicionario dicionarioModelos;
+
+int         dicionario_codigo(Dicionario* d, const char* texto, size_t comprimento);
+int         dicionario_procurar(const Dicionario* d, const char* texto, size_t comprimento);
+const char* dicionario_texto(const Dicionario* d, int codigo);
+void        dicionario_libertar(Dicionario* d);
+
+static inline const char* marcaCarro(const Carro* c)  { return dicionario_texto(&dicionarioMarcas, c->codigoMarca); }
+static inline const char* modeloCarro(const Carro* c) { return dicionario_texto(&dicionarioModelos, c->codigoModelo); }
+
+#endif // DICTIONARY_H
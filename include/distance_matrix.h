@@ -0,0 +1,96 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MATRIZ_MAX_IDS           65536   // maior intervalo de ids de sensores com remapeamento direto
+#define MATRIZ_MAX_SENSORES      2048    // maior matriz densa (2048 x 2048 floats = 16 MB)
+#define MATRIZ_FOLGA_SENSORES    16      // linhas reservadas para sensores registados depois
+#define MATRIZ_POSICOES_INICIAIS 256     // tamanho inicial da tabela esparsa (potência de 2)
+
+/**
+ * @brief Entrada da tabela esparsa: o par (menor id, maior id) numa só chave.
+ *
+ */
+typedef struct {
+    uint64_t chave;
+    float    distancia;
+    int      ocupada;
+} EntradaDistancia;
+
+/**
+ * @brief Distâncias entre sensores com acesso direto, construídas a partir da
+ * lista de distâncias.
+ *
+ * Forma densa: os ids dos sensores que aparecem na lista são remapeados para
+ * linhas 0..numSensores-1 (array indexado por id - idMin) e as distâncias ficam
+ * numa matriz simétrica dimensao x dimensao de floats (-1 = sem distância).
+ * Quando os ids estão demasiado espalhados ou há sensores demais, usa-se a
+ * forma esparsa: uma tabela de dispersão com endereçamento aberto indexada pelo
+ * par de ids.
+ *
+ * Tal como o indiceCarros, a matriz guarda a cabeça da lista que reflete e só
+ * é usada por obterDistancia() enquanto essa lista for a mesma. Com pares
+ * repetidos fica a primeira distância da lista. Não é thread-safe.
+ *
+ */
+typedef struct {
+    const void*       cabeca;        // lista que a matriz reflete (NULL = vazia)
+    int               idMin;
+    int               numIds;        // tamanho do intervalo de ids remapeado
+    int*              linha;         // id - idMin -> linha da matriz (-1 = sensor sem distâncias)
+    int               numSensores;   // linhas em uso
+    int               dimensao;      // linhas reservadas
+    float*            valores;       // dimensao x dimensao (NULL na forma esparsa)
+    EntradaDistancia* tabela;        // forma esparsa
+    size_t            numPosicoes;   // potência de 2
+    size_t            total;
+} MatrizDistancias;
+
+#define MATRIZ_DISTANCIAS_INIT { NULL, 0, 0, NULL, 0, 0, NULL, NULL, 0, 0 }
+
+/**
+ * @brief Matriz da lista principal de distâncias (definida em distance_matrix.c).
+ *
+ */
+extern MatrizDistancias matrizDistancias;
+
+bool   matrizDistancias_construir(MatrizDistancias* m, NodeDistancia* lista);
+bool   matrizDistancias_inserirCabeca(MatrizDistancias* m, NodeDistancia* no);
+double matrizDistancias_procurarEsparsa(const MatrizDistancias* m, int id1, int id2);
+void   matrizDistancias_libertar(MatrizDistancias* m);
+void   matrizDistancias_imprimirEstatisticas(const MatrizDistancias* m);
+
+/**
+ * @brief Indica se a matriz reflete a lista cuja cabeça é 'cabeca'.
+ *
+ * @param m
+ * @param cabeca
+ * @return bool
+ */
+static inline bool matrizDistancias_valida(const MatrizDistancias* m, const void* cabeca) {
+    return cabeca != NULL && m->cabeca == cabeca;
+}
+
+/**
+ * @brief Distância entre dois sensores (em qualquer ordem).
+ *
+ * @param m Válida (ver matrizDistancias_valida())
+ * @param id1
+ * @param id2
+ * @return double -1.0 se não houver distância entre eles
+ */
+static inline double matrizDistancias_procurar(const MatrizDistancias* m, int id1, int id2) {
+    if (!m->valores) return matrizDistancias_procurarEsparsa(m, id1, id2);
+    long long a = (long long)id1 - m->idMin;
+    long long b = (long long)id2 - m->idMin;
+    if (a < 0 || b < 0 || a >= m->numIds || b >= m->numIds) return -1.0;
+    int i = m->linha[a], j = m->linha[b];
+    if (i < 0 || j < 0) return -1.0;
+    return m->valores[(size_t)i * (size_t)m->dimensao + (size_t)j];
+}
+
+#endif // DISTANCE_MATRIX_H
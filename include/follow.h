@@ -0,0 +1,26 @@
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SEGUIMENTO_INTERVALO_MS 1000     // período de verificação quando não há inotify
+#define SEGUIMENTO_BLOCO_LEITURA (1u << 20) // bytes lidos de cada vez do fim do ficheiro
+
+/**
+ * @brief Modo de seguimento de passagem.txt: uma thread em segundo plano espera
+ * (com inotify, em Linux) que o ficheiro cresça, interpreta as linhas novas e
+ * acrescenta-as ao fim da lista de passagens sem bloquear o menu.
+ *
+ * Cada nó é preenchido por completo antes de ser publicado com uma escrita
+ * "release" no campo next da cauda, pelo que quem percorre a lista vê sempre
+ * nós completos. A thread só escreve na cabeça da lista se ela estiver vazia;
+ * por isso não se registam passagens (opção 5) enquanto o seguimento está ativo.
+ */
+bool iniciarSeguimentoPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens, size_t offsetInicial);
+size_t pararSeguimentoPassagens(void);
+bool seguimentoPassagensAtivo(void);
+size_t passagensRecebidasSeguimento(void);
+
+#endif // FOLLOW_H
@@ -0,0 +1,39 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define GEO_MAX_TEXTO 40   // tamanho suficiente para uma coordenada formatada
+
+/**
+ * @brief Coordenadas dos sensores. Aceita as formas de sensores.txt:
+ *  - graus, minutos e segundos: "32º N, 22’, 56’’", "4ºW, 02’, 24’’"
+ *  - graus decimais: "41.1579", "-8.6291", "41.1579 N"
+ * O hemisfério S, W ou O (Oeste), ou um '-' inicial, tornam o valor negativo.
+ *
+ */
+bool parsearCoordenada(const char* ini, const char* fim, bool latitude, double* graus);
+void formatarCoordenada(double graus, bool latitude, char* destino, size_t tamanho);
+bool definirCoordenadasSensor(Sensor* sensor, Arena* arena, const char* latitude, size_t nLatitude,
+                              const char* longitude, size_t nLongitude);
+
+/**
+ * @brief Texto a mostrar/exportar de uma coordenada: o original, se foi guardado,
+ * senão a coordenada formatada em buffer.
+ *
+ * @param original
+ * @param graus
+ * @param latitude
+ * @param buffer
+ * @param tamanho
+ * @return const char*
+ */
+static inline const char* textoCoordenada(const char* original, double graus, bool latitude, char* buffer, size_t tamanho) {
+    if (original) return original;
+    formatarCoordenada(graus, latitude, buffer, tamanho);
+    return buffer;
+}
+
+#endif // GEO_H
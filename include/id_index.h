@@ -0,0 +1,77 @@
+#ifndef ID_INDEX_H
+#define ID_INDEX_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define INDICE_IDS_POSICOES_INICIAIS 1024   // tamanho inicial da tabela (potência de 2)
+
+/**
+ * @brief Entrada da tabela: valor == NULL marca uma posição livre.
+ *
+ */
+typedef struct {
+    int   chave;
+    int   ordem;    // posição do nó na lista = ordem - IndiceIds.primeiraOrdem
+    void* valor;
+} EntradaIndiceIds;
+
+/**
+ * @brief Índice de dispersão de uma chave inteira (idVeiculo, NIF, ...) para o
+ * nó de uma lista principal. Endereçamento aberto com sondagem linear e fator
+ * de carga máximo de 1/2; a tabela cresce por duplicação.
+ *
+ * O índice guarda a cabeça da lista a partir da qual foi construído: quem o
+ * consulta só o deve usar se continuar a ter essa lista (ver indiceIds_valido()),
+ * caso contrário faz a pesquisa linear. Com chaves repetidas fica o primeiro nó
+ * da lista, tal como na pesquisa linear. Cada entrada guarda também a posição
+ * do nó na lista, relativa a primeiraOrdem, que desce sempre que um nó é posto
+ * à cabeça; assim as inserções não obrigam a renumerar. Não é thread-safe.
+ *
+ */
+typedef struct {
+    const char*       nome;
+    const void*       cabeca;       // lista que o índice reflete (NULL = índice vazio)
+    EntradaIndiceIds* tabela;
+    size_t            numPosicoes;  // potência de 2
+    unsigned          deslocamento; // 64 - log2(numPosicoes): bits altos da dispersão usados
+    size_t            total;
+    int               primeiraOrdem;
+} IndiceIds;
+
+#define INDICE_IDS_INIT(nome) { (nome), NULL, NULL, 0, 64, 0, 0 }
+
+/**
+ * @brief Índice idVeiculo -> NodeCarro* da lista principal de carros (definido em id_index.c).
+ *
+ */
+extern IndiceIds indiceCarros;
+
+/**
+ * @brief Índice NIF -> NodeDono* da lista principal de donos (definido em id_index.c).
+ *
+ */
+extern IndiceIds indiceDonos;
+
+bool  indiceIds_inserirCabeca(IndiceIds* idx, int chave, void* no, const void* anterior);
+void* indiceIds_procurar(const IndiceIds* idx, int chave);
+int   indiceIds_posicao(const IndiceIds* idx, int chave);
+void  indiceIds_libertar(IndiceIds* idx);
+void  indiceIds_imprimirEstatisticas(const IndiceIds* idx);
+
+bool  indiceCarros_construir(IndiceIds* idx, NodeCarro* lista);
+bool  indiceDonos_construir(IndiceIds* idx, NodeDono* lista);
+
+/**
+ * @brief Indica se o índice reflete a lista cuja cabeça é 'cabeca'.
+ *
+ * @param idx
+ * @param cabeca
+ * @return bool
+ */
+static inline bool indiceIds_valido(const IndiceIds* idx, const void* cabeca) {
+    return cabeca != NULL && idx->cabeca == cabeca;
+}
+
+#endif // ID_INDEX_H
@@ -0,0 +1,49 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Subsistema a que pertence cada alocação, para os relatórios de memória.
+ *
+ */
+typedef enum {
+    MEMORIA_DADOS,        // nós e textos das listas carregadas
+    MEMORIA_INDICES,      // colunas, dicionários e outros índices persistentes
+    MEMORIA_LEITURA,      // buffers dos leitores (ficheiros, descompressão, seguimento)
+    MEMORIA_CONSULTAS,    // memória temporária de cada consulta
+    MEMORIA_EXPORTACAO,   // exportações CSV/XML e snapshots
+    MEMORIA_NUM_SUBSISTEMAS
+} SubsistemaMemoria;
+
+/**
+ * @brief Contadores de um subsistema. Os bytes são os do alocador (o que o
+ * malloc reservou de facto, com o cabeçalho de cada bloco), não os pedidos.
+ *
+ */
+typedef struct {
+    size_t atual;
+    size_t pico;
+    size_t folga;         // reservado mas ainda por usar (arenas, arrays com capacidade extra)
+    size_t alocacoes;     // alocações vivas
+} EstatisticasMemoria;
+
+#define MEMORIA_FICHEIRO "memoria.csv"
+
+void* memoria_alocar(SubsistemaMemoria subsistema, size_t bytes);
+void* memoria_alocarZeros(SubsistemaMemoria subsistema, size_t quantidade, size_t tamanho);
+void* memoria_realocar(SubsistemaMemoria subsistema, void* p, size_t bytes);
+void  memoria_libertar(void* p);
+void  memoria_transferir(void* p, SubsistemaMemoria subsistema);
+void  memoria_ajustarFolga(SubsistemaMemoria subsistema, long long delta);
+
+void        memoria_estatisticas(SubsistemaMemoria subsistema, EstatisticasMemoria* estatisticas);
+size_t      memoria_totalAtual(void);
+size_t      memoria_totalPico(void);
+size_t      memoria_rss(void);
+const char* memoria_nomeSubsistema(SubsistemaMemoria subsistema);
+void        memoria_imprimirRelatorio(void);
+bool        memoria_exportar(const char* nomeFicheiro);
+
+#endif // MEMORY_H
@@ -0,0 +1,84 @@
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define INDICE_NOMES_CAPACIDADE_MIN 4096
+
+/**
+ * @brief Entrada do índice: uma palavra do nome normalizado de um dono,
+ * até ao fim do nome ("nascimento barros bacelar").
+ *
+ */
+typedef struct {
+    uint32_t  texto;    // deslocamento em IndiceNomes.textos
+    int       ordem;    // posição do nó na lista = ordem - IndiceNomes.primeiraOrdem
+    NodeDono* dono;
+} EntradaNome;
+
+/**
+ * @brief Índice dos nomes da lista principal de donos, sem acentos nem
+ * maiúsculas (ver nome_normalizar()). Cada palavra de cada nome é uma entrada
+ * e as entradas estão ordenadas pelo texto a partir dessa palavra, pelo que os
+ * donos com um nome ou uma palavra começados por uma consulta ("Clotilde Nasc",
+ * "nasc") correspondem a uma fatia contígua, encontrada por pesquisa binária.
+ *
+ * Tal como o IndiceMatriculas, guarda a cabeça da lista que reflete e as
+ * posições relativas a primeiraOrdem, para que um dono registado à cabeça seja
+ * inserido sem renumerar. Não é thread-safe.
+ *
+ */
+typedef struct {
+    EntradaNome*    entradas;
+    size_t          total;
+    size_t          capacidade;
+    char*           textos;         // nomes normalizados, terminados em '\0'
+    size_t          tamanhoTextos;
+    size_t          capacidadeTextos;
+    size_t          numDonos;
+    int             primeiraOrdem;
+    const NodeDono* cabeca;         // lista que o índice reflete (NULL = índice vazio)
+} IndiceNomes;
+
+#define INDICE_NOMES_INIT { NULL, 0, 0, NULL, 0, 0, 0, 0, NULL }
+
+/**
+ * @brief Índice de nomes da lista principal de donos (definido em name_index.c).
+ *
+ */
+extern IndiceNomes indiceNomes;
+
+bool   indiceNomes_construir(IndiceNomes* idx, NodeDono* lista);
+bool   indiceNomes_inserirCabeca(IndiceNomes* idx, NodeDono* no);
+size_t indiceNomes_pesquisar(const IndiceNomes* idx, const char* consulta, const EntradaNome*** resultados);
+void   indiceNomes_libertar(IndiceNomes* idx);
+void   indiceNomes_imprimirEstatisticas(const IndiceNomes* idx);
+size_t nome_normalizar(const char* texto, char* destino, size_t tamanho);
+bool   nome_corresponde(const char* nome, const char* consulta);
+
+/**
+ * @brief Diz se o índice reflete a lista indicada.
+ *
+ * @param idx
+ * @param lista
+ * @return bool
+ */
+static inline bool indiceNomes_valido(const IndiceNomes* idx, const NodeDono* lista) {
+    return lista != NULL && idx->cabeca == lista;
+}
+
+/**
+ * @brief Posição na lista do dono de uma entrada.
+ *
+ * @param idx
+ * @param e
+ * @return int
+ */
+static inline int indiceNomes_posicao(const IndiceNomes* idx, const EntradaNome* e) {
+    return e->ordem - idx->primeiraOrdem;
+}
+
+#endif // NAME_INDEX_H
@@ -2,6 +2,7 @@
 #define OPERATIONS_H
 
 #include "data.h"
+#include "attribute_index.h"
 #include <time.h>
 #include <stdbool.h>
 
@@ -9,12 +10,14 @@
 void limparBufferInput();
 void esperarEnter();
 void obterPeriodoTempo(time_t* inicio, time_t* fim);
+void lerFiltroCarros(FiltroCarros* filtro);
 
 
 // --- Funções Auxiliares de Input e Pesquisa ---
 void lerString(const char* prompt, char* buffer, int tamanho);
 NodeDono* pesquisarDonoPorNIF(NodeDono* listaDonos, int nif);
 NodeCarro* pesquisarCarroPorId(NodeCarro* listaCarros, int idVeiculo);
+NodeCarro* pesquisarCarroPorMatricula(NodeCarro* listaCarros, const char* matricula);
 NodeSensor* pesquisarSensorPorId(NodeSensor* listaSensores, int idSensor);
 
 
@@ -48,19 +51,20 @@ bool validarCodigoPostal(const char *cp);
 
 
 // --- Funções Principais do Projeto ---
-size_t calcularMemoriaTotal(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor* listaSensores, NodeDistancia* listaDistancias, NodePassagem* listaPassagens);
+size_t calcularMemoriaTotal(void);
 time_t parseTimestamp(const char *dataHora);
+long long parseTimestampMs(const char *dataHora);
 double obterDistancia(NodeDistancia* lista, int id1, int id2);
 void rankingVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim);
-void rankingPorMarca(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim);
+void rankingPorMarca(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim, const FiltroCarros* filtro);
 void listarVeiculosPorPeriodo(NodePassagem* listaPassagens, NodeCarro* listaCarros, time_t inicio, time_t fim);
 void imprimirListaDonosOrdemAlfabetica(NodeDono* listaDonos);
 void listarInfracoes(NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim);
 void rankingInfraVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim);
 void velocidadesMedias(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim);
 double velocidadeMediaPorCodigoPostal(const char* codPostal, NodeDono* listaDonos, NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias);
-void rankingMarcasVelocidade(NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim);
-void rankingDonosVelocidade(NodeDono* listaDonos, NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim);
+void rankingMarcasVelocidade(NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim, const FiltroCarros* filtro);
+void rankingDonosVelocidade(NodeDono* listaDonos, NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim, const FiltroCarros* filtro);
 void determinarMarcaMaisComum(NodeCarro* listaCarros);
 void exportarDadosCSV(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor* listaSensores, NodeDistancia* listaDistancias, NodePassagem* listaPassagens);
 void exportarDadosXML(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor* listaSensores, NodeDistancia* listaDistancias, NodePassagem* listaPassagens);
@@ -0,0 +1,114 @@
+#ifndef PLATE_INDEX_H
+#define PLATE_INDEX_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define INDICE_MATRICULAS_CAPACIDADE_MIN 1024
+#define INDICE_MATRICULAS_PENDENTES_MIN  64     // menor limite de carros pendentes
+
+/**
+ * @brief Entrada do índice: os primeiros 8 caracteres da matrícula em big-endian
+ * (a ordem dos inteiros é a ordem alfabética), para comparar sem ir ao nó.
+ *
+ */
+typedef struct {
+    uint64_t   chave;
+    NodeCarro* carro;
+    int        ordem;   // posição do nó na lista = ordem - IndiceMatriculas.primeiraOrdem
+} EntradaMatricula;
+
+/**
+ * @brief Índice ordenado das matrículas da lista principal de carros: uma
+ * matrícula exata ou um prefixo ("06-FK-*") é uma fatia contígua, encontrada
+ * por pesquisa binária. Matrículas repetidas ficam pela ordem da lista.
+ *
+ * Tal como o IndiceIds, guarda a cabeça da lista que reflete (ver
+ * indiceMatriculas_valido()) e as posições relativas a primeiraOrdem, para que
+ * um carro registado à cabeça seja inserido sem renumerar. Os carros registados
+ * ficam num pequeno array de pendentes, também ordenado, que as pesquisas
+ * percorrem junto com as entradas (ver indiceMatriculas_seguinte()) e que só é
+ * fundido nelas quando passa de ~√total carros: cada registo custa O(√total)
+ * em vez de deslocar todas as entradas. Não é thread-safe.
+ *
+ */
+typedef struct {
+    EntradaMatricula* entradas;
+    size_t            total;
+    size_t            capacidade;
+    EntradaMatricula* pendentes;    // registados depois da última fusão, pela mesma ordem
+    size_t            numPendentes;
+    size_t            capacidadePendentes;
+    int               primeiraOrdem;
+    const NodeCarro*  cabeca;       // lista que o índice reflete (NULL = índice vazio)
+} IndiceMatriculas;
+
+#define INDICE_MATRICULAS_INIT { NULL, 0, 0, NULL, 0, 0, 0, NULL }
+
+/**
+ * @brief Entradas de uma pesquisa: uma fatia das entradas e outra dos
+ * pendentes, percorridas por ordem com indiceMatriculas_seguinte().
+ *
+ */
+typedef struct {
+    const EntradaMatricula* entradas;
+    size_t                  numEntradas;
+    const EntradaMatricula* pendentes;
+    size_t                  numPendentes;
+} IntervaloMatriculas;
+
+/**
+ * @brief Índice de matrículas da lista principal de carros (definido em plate_index.c).
+ *
+ */
+extern IndiceMatriculas indiceMatriculas;
+
+bool   indiceMatriculas_construir(IndiceMatriculas* idx, NodeCarro* lista);
+bool   indiceMatriculas_inserirCabeca(IndiceMatriculas* idx, NodeCarro* no);
+size_t indiceMatriculas_intervalo(const IndiceMatriculas* idx, const char* texto, size_t comprimento,
+                                  IntervaloMatriculas* intervalo);
+const EntradaMatricula* indiceMatriculas_seguinte(IntervaloMatriculas* intervalo);
+void   indiceMatriculas_libertar(IndiceMatriculas* idx);
+void   indiceMatriculas_imprimirEstatisticas(const IndiceMatriculas* idx);
+size_t matricula_padrao(const char* padrao, bool* exata);
+
+/**
+ * @brief Diz se o índice reflete a lista indicada.
+ *
+ * @param idx
+ * @param lista
+ * @return bool
+ */
+static inline bool indiceMatriculas_valido(const IndiceMatriculas* idx, const NodeCarro* lista) {
+    return lista != NULL && idx->cabeca == lista;
+}
+
+/**
+ * @brief Posição na lista do carro de uma entrada.
+ *
+ * @param idx
+ * @param e
+ * @return int
+ */
+static inline int indiceMatriculas_posicao(const IndiceMatriculas* idx, const EntradaMatricula* e) {
+    return e->ordem - idx->primeiraOrdem;
+}
+
+/**
+ * @brief Primeiro carro com a matrícula exata.
+ *
+ * @param idx Válido
+ * @param matricula
+ * @return NodeCarro* NULL se não existir
+ */
+static inline NodeCarro* indiceMatriculas_procurar(const IndiceMatriculas* idx, const char* matricula) {
+    IntervaloMatriculas intervalo;
+    indiceMatriculas_intervalo(idx, matricula, strlen(matricula) + 1, &intervalo);
+    const EntradaMatricula* e = indiceMatriculas_seguinte(&intervalo);
+    return e ? e->carro : NULL;
+}
+
+#endif // PLATE_INDEX_H
@@ -0,0 +1,35 @@
+#ifndef POSTAL_H
+#define POSTAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Código postal empacotado num inteiro de 32 bits. Guarda também o número
+ * de dígitos de cada parte, para que "4000-012" e "4000-12" se mantenham distintos
+ * e o texto original seja reconstruído tal e qual:
+ *  - bits  0..9  : sufixo (0..999)
+ *  - bits 10..11 : dígitos do sufixo (0 = sem "-sufixo")
+ *  - bits 12..28 : prefixo (0..99999)
+ *  - bits 29..31 : dígitos do prefixo (1..5)
+ * O valor 0 representa um código vazio ou que não tem este formato.
+ *
+ */
+#define CODIGO_POSTAL_MAX_PREFIXO 5
+#define CODIGO_POSTAL_MAX_SUFIXO  3
+#define CODIGO_POSTAL_INVALIDO    0u
+
+uint32_t empacotarCodigoPostal(const char* texto, size_t comprimento);
+void     formatarCodigoPostal(uint32_t codigo, char* destino, size_t tamanho);
+
+/**
+ * @brief Distrito postal: o prefixo sem os três últimos dígitos ("4000-123" -> 4).
+ *
+ * @param codigo
+ * @return int -1 se o código for inválido
+ */
+static inline int distritoCodigoPostal(uint32_t codigo) {
+    return codigo == CODIGO_POSTAL_INVALIDO ? -1 : (int)(((codigo >> 12) & 0x1FFFF) / 1000);
+}
+
+#endif // POSTAL_H
@@ -0,0 +1,70 @@
+#ifndef POSTAL_INDEX_H
+#define POSTAL_INDEX_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Dono no índice postal: os veículos dele são
+ * veiculos[primeiroVeiculo .. primeiroVeiculo da entrada seguinte).
+ *
+ */
+typedef struct {
+    char     codigo[DONO_MAX_CODIGOPOSTAL];   // texto do código (chave de ordenação)
+    int      nif;
+    uint32_t primeiroVeiculo;
+} EntradaPostal;
+
+/**
+ * @brief Junção código postal -> donos -> veículos. Os donos com código
+ * válido estão ordenados pelo texto do código (e, em empate, pela ordem da
+ * lista), pelo que tanto um código exato como um prefixo ("4000-*", "4*")
+ * correspondem a uma fatia contígua, encontrada por pesquisa binária. Os
+ * idVeiculo de cada dono ficam seguidos em 'veiculos', pela ordem da lista de
+ * carros, e os de uma fatia de donos também são contíguos.
+ *
+ * Reflete um par de listas (donos, carros) e é reconstruído quando alguma
+ * delas muda de cabeça (registo de dono ou carro). Não é thread-safe.
+ *
+ */
+typedef struct {
+    EntradaPostal*   donos;         // numDonos + 1 (a última só fecha os veículos)
+    size_t           numDonos;
+    int*             veiculos;
+    size_t           numVeiculos;
+    const NodeDono*  cabecaDonos;   // listas refletidas (NULL = índice vazio)
+    const NodeCarro* cabecaCarros;
+} IndicePostal;
+
+#define INDICE_POSTAL_INIT { NULL, 0, NULL, 0, NULL, NULL }
+
+/**
+ * @brief Índice postal das listas principais (definido em postal_index.c).
+ *
+ */
+extern IndicePostal indicePostal;
+
+bool indicePostal_sincronizar(IndicePostal* idx, const NodeDono* listaDonos, const NodeCarro* listaCarros);
+bool indicePostal_intervalo(const IndicePostal* idx, const char* padrao, size_t* primeiro, size_t* ultimo);
+void indicePostal_libertar(IndicePostal* idx);
+void indicePostal_imprimirEstatisticas(const IndicePostal* idx);
+
+/**
+ * @brief Veículos dos donos [primeiro, ultimo) do índice.
+ *
+ * @param idx
+ * @param primeiro
+ * @param ultimo
+ * @param veiculos
+ * @return size_t Número de veículos
+ */
+static inline size_t indicePostal_veiculos(const IndicePostal* idx, size_t primeiro, size_t ultimo,
+                                           const int** veiculos) {
+    if (primeiro >= ultimo) return 0;
+    *veiculos = idx->veiculos + idx->donos[primeiro].primeiroVeiculo;
+    return idx->donos[ultimo].primeiroVeiculo - idx->donos[primeiro].primeiroVeiculo;
+}
+
+#endif // POSTAL_INDEX_H
@@ -2,16 +2,40 @@
 #define READ_FILES_H
 
 #include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Ficheiros de dados carregados no arranque (índices do array de caminhos).
+ * 
+ */
+typedef enum {
+    FONTE_DONOS,
+    FONTE_CARROS,
+    FONTE_SENSORES,
+    FONTE_DISTANCIAS,
+    FONTE_PASSAGENS,
+    NUM_FONTES
+} FonteDados;
 
 void lerDonos(const char* nomeFicheiro, NodeDono** listaDonos);
 void lerCarros(const char* nomeFicheiro, NodeCarro** listaCarros);
 void lerSensores(const char* nomeFicheiro, NodeSensor** listaSensores);
 void lerDistancias(const char* nomeFicheiro, NodeDistancia** listaDistancias);
-void lerPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens);
+size_t lerPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens);
+size_t lerPassagensDesde(const char* nomeFicheiro, NodePassagem** listaPassagens, size_t offset);
+bool parsearLinhaPassagem(const char* ini, const char* fim, Passagem* out);
+size_t carregarBaseDados(const char* const fontes[NUM_FONTES], NodeDono** listaDonos, NodeCarro** listaCarros,
+                         NodeSensor** listaSensores, NodeDistancia** listaDistancias, NodePassagem** listaPassagens);
+
+// --- Utilitários partilhados pelos carregadores ---
+const char* mapearFicheiro(const char* nomeFicheiro, size_t* tamanho);
+void desmapearFicheiro(const char* dados, size_t tamanho);
+double segundosAgora(void);
 
 
 void ordenar_donos(const char *ficheiro);
-void ordenar_por_nome(Dono *donos, int total);
+void ordenar_por_nome(Dono *donos, int total, const HeapStrings *nomes);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SEGMENTO_FICHEIRO     "passagens.seg"
+#define SEGMENTO_MAGIA        "PORTSEGM"
+#define SEGMENTO_VERSAO       1
+#define SEGMENTO_LINHAS_BLOCO 4096
+
+/**
+ * @brief Segmento de passagens arquivadas: ficheiro mapeado em memória, com as
+ * passagens antigas ordenadas por ts e guardadas em blocos comprimidos de até
+ * SEGMENTO_LINHAS_BLOCO linhas (inteiros em little-endian):
+ *
+ *  [SegmentoCabecalho][blocos alinhados a 8 bytes][SegmentoBloco x numBlocos]
+ *
+ * Cada arquivo acrescenta os seus blocos e um diretório novo no fim do ficheiro
+ * e só depois reescreve o cabeçalho; os diretórios antigos ficam sem uso até o
+ * segmento ser regravado (compactado) por arquivarPassagens().
+ *
+ * Cada bloco tem:
+ *  - os ts em varint (LEB128), como diferença para a linha anterior
+ *    (a primeira linha é a diferença para tsMin, ou seja 0);
+ *  - alinhado a 8 bytes, um array de palavras de 64 bits com, seguidos,
+ *    idVeiculo - minVeiculo (bitsVeiculo bits por linha), idSensor - minSensor
+ *    (bitsSensor bits) e o tipoRegisto (1 bit).
+ * O diretório guarda tsMin/tsMax de cada bloco, pelo que uma consulta por
+ * período só descomprime os blocos que intersetam [inicio, fim].
+ * A dataHora não é guardada: é reconstruída a partir do ts.
+ */
+typedef struct {
+    char      magia[8];         // SEGMENTO_MAGIA, sem '\0'
+    uint32_t  versao;           // SEGMENTO_VERSAO
+    uint32_t  linhasPorBloco;
+    uint64_t  numLinhas;
+    uint64_t  numBlocos;
+    uint64_t  offsetDiretorio;
+    int64_t   corte;            // todas as passagens com ts <= corte estão no segmento
+    uint64_t  tamanhoTotal;     // para detetar ficheiros truncados (pode haver bytes sem uso depois)
+} SegmentoCabecalho;
+
+typedef struct {
+    int64_t   tsMin;
+    int64_t   tsMax;
+    uint64_t  offset;           // desde o início do ficheiro
+    uint32_t  bytesTs;          // bytes dos varints (antes do alinhamento)
+    uint32_t  numLinhas;
+    int32_t   minVeiculo;
+    int32_t   minSensor;
+    uint8_t   bitsVeiculo;
+    uint8_t   bitsSensor;
+    uint8_t   reservado[6];
+} SegmentoBloco;
+
+/**
+ * @brief Segmento aberto (vazio se dados == NULL).
+ *
+ */
+typedef struct {
+    const unsigned char*     dados;
+    size_t                   tamanho;
+    const SegmentoCabecalho* cabecalho;   // cópia: o do ficheiro é reescrito ao arquivar
+    const SegmentoBloco*     blocos;
+} SegmentoPassagens;
+
+/**
+ * @brief Que linhas devolve segmento_filtrar().
+ *
+ */
+typedef enum {
+    SEGMENTO_SO_PERIODO,      // só as passagens de [inicio, fim]
+    SEGMENTO_COM_SEGUINTES    // todas as linhas dos blocos do período e dos blocos seguintes
+                              // até cada veículo do período ter uma passagem posterior
+} ModoFiltroSegmento;
+
+/**
+ * @brief Segmento das passagens arquivadas (definido em segment.c).
+ *
+ */
+extern SegmentoPassagens segmentoPassagens;
+
+bool   segmento_abrir(SegmentoPassagens* seg, const char* nomeFicheiro);
+void   segmento_fechar(SegmentoPassagens* seg);
+bool   segmento_filtrar(const SegmentoPassagens* seg, long long inicioMs, long long fimMs, ModoFiltroSegmento modo,
+                        Arena* arena, NodePassagem** cabeca, NodePassagem** cauda);
+size_t arquivarPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens, long long corteMs);
+void   segmento_imprimirEstatisticas(const SegmentoPassagens* seg);
+
+/**
+ * @brief Indica se uma passagem lida dos ficheiros de texto já está no segmento
+ * (e portanto não deve voltar a entrar na lista).
+ *
+ * @param seg
+ * @param ts
+ * @return bool
+ */
+static inline bool segmento_arquivada(const SegmentoPassagens* seg, long long ts) {
+    return seg->cabecalho && ts >= 0 && ts <= seg->cabecalho->corte;
+}
+
+#endif // SEGMENT_H
@@ -0,0 +1,90 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "data.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SNAPSHOT_FICHEIRO "portagens.snap"
+#define SNAPSHOT_MAGIA    "PORTSNAP"
+#define SNAPSHOT_VERSAO   2
+
+/**
+ * @brief Formato binário do snapshot (inteiros em little-endian, tal como em memória):
+ *
+ *  [SnapshotCabecalho][SnapshotSeccao x numSeccoes][secções alinhadas a 8 bytes]
+ *
+ * Cada secção de entidades é um array de registos de tamanho fixo; os textos
+ * ficam na secção SNAP_STRINGS (heap de strings terminadas em '\0') e os registos
+ * guardam apenas o offset dentro desse heap.
+ */
+typedef struct {
+    char     magia[8];       // SNAPSHOT_MAGIA, sem '\0'
+    uint32_t versao;         // SNAPSHOT_VERSAO
+    uint32_t numSeccoes;
+    uint64_t tamanhoTotal;   // tamanho do ficheiro, para detetar snapshots truncados
+    uint64_t offsetPassagens;  // bytes de passagem.txt refletidos nas passagens gravadas
+    uint64_t tamanhoPassagens; // tamanho e mtime de passagem.txt na altura da gravação
+    int64_t  mtimePassagens;
+} SnapshotCabecalho;
+
+typedef enum {
+    SNAP_DONOS = 1,
+    SNAP_CARROS,
+    SNAP_SENSORES,
+    SNAP_DISTANCIAS,
+    SNAP_PASSAGENS,
+    SNAP_STRINGS
+} SnapshotTipoSeccao;
+
+typedef struct {
+    uint32_t tipo;            // SnapshotTipoSeccao
+    uint32_t tamanhoRegisto;  // bytes por registo (1 para o heap de strings)
+    uint64_t numRegistos;
+    uint64_t offset;          // desde o início do ficheiro
+    uint64_t bytes;
+} SnapshotSeccao;
+
+typedef struct {
+    int32_t  numeroContribuinte;
+    uint32_t nome;            // offset no heap de strings
+    uint32_t codigoPostal;
+} SnapDono;
+
+typedef struct {
+    uint32_t matricula;
+    uint32_t marca;
+    uint32_t modelo;
+    int32_t  ano;
+    int32_t  donoContribuinte;
+    int32_t  idVeiculo;
+} SnapCarro;
+
+typedef struct {
+    int32_t  idSensor;
+    uint32_t designacao;
+    uint32_t latitude;
+    uint32_t longitude;
+} SnapSensor;
+
+typedef struct {
+    int32_t idSensor1;
+    int32_t idSensor2;
+    float   distancia;
+} SnapDistancia;
+
+typedef struct {
+    int64_t  ts;
+    int32_t  idSensor;
+    int32_t  idVeiculo;
+    int32_t  tipoRegisto;
+    uint32_t dataHora;
+} SnapPassagem;
+
+bool gravarSnapshot(const char* nomeFicheiro, NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor* listaSensores, NodeDistancia* listaDistancias, NodePassagem* listaPassagens,
+                    const char* fontePassagens, size_t offsetPassagens);
+bool carregarSnapshot(const char* nomeFicheiro, NodeDono** listaDonos, NodeCarro** listaCarros, NodeSensor** listaSensores, NodeDistancia** listaDistancias, NodePassagem** listaPassagens);
+bool snapshotAtualizado(const char* nomeFicheiro, const char* const fontes[], int numFontes, size_t* offsetPassagens);
+
+#endif // SNAPSHOT_H
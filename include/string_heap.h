@@ -0,0 +1,60 @@
+#ifndef STRING_HEAP_H
+#define STRING_HEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memory.h"
+
+#define HEAP_STRINGS_CAPACIDADE_INICIAL (64u << 10)
+
+/**
+ * @brief Referência para um texto dentro de um HeapStrings (offset + comprimento).
+ * Ao contrário de um ponteiro, continua válida quando o heap cresce.
+ *
+ */
+typedef struct {
+    uint32_t offset;
+    uint32_t comprimento;   // sem o '\0' final
+} RefString;
+
+/**
+ * @brief Heap de strings: um único buffer contíguo onde os textos são
+ * acrescentados uns a seguir aos outros (terminados em '\0'), sem nunca
+ * serem removidos. Cada texto ocupa só o seu comprimento + 1, em vez de um
+ * char[] de tamanho máximo, e percorrer os textos lê memória seguida.
+ * Não é thread-safe; os ponteiros devolvidos por strings_texto() só são
+ * válidos até à próxima inserção.
+ *
+ */
+typedef struct {
+    const char* nome;
+    char*       dados;
+    size_t      tamanho;
+    size_t      capacidade;
+    SubsistemaMemoria subsistema;
+} HeapStrings;
+
+#define HEAP_STRINGS_INIT(nome, subsistema) { (nome), NULL, 0, 0, (subsistema) }
+
+/**
+ * @brief Heap dos nomes dos donos (definido em string_heap.c).
+ *
+ */
+extern HeapStrings heapNomesDonos;
+
+bool strings_adicionar(HeapStrings* heap, const char* texto, size_t comprimento, RefString* ref);
+void strings_libertar(HeapStrings* heap);
+
+/**
+ * @brief Texto (terminado em '\0') de uma referência.
+ *
+ * @param heap
+ * @param ref
+ * @return const char*
+ */
+static inline const char* strings_texto(const HeapStrings* heap, RefString ref) {
+    return heap->dados ? heap->dados + ref.offset : "";
+}
+
+#endif // STRING_HEAP_H
@@ -0,0 +1,121 @@
+#ifndef TIME_INDEX_H
+#define TIME_INDEX_H
+
+#include "data.h"
+#include "columns.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Índice temporal das passagens: as linhas de colunasPassagens
+ * ordenadas por (ts, posição na lista). Um período é uma fatia contígua do
+ * índice, encontrada por pesquisa binária, pelo que uma consulta de uma hora
+ * custa o proporcional às passagens dessa hora e não ao histórico inteiro.
+ *
+ * Tal como as colunas, é sincronizado antes de cada consulta. Poucas linhas
+ * novas (registarPassagem, modo de seguimento) vão para um pequeno array de
+ * pendentes, também ordenado, que as consultas leem ao lado da fatia e que é
+ * fundido no índice quando passa de ~√total linhas; muitas linhas novas são
+ * ordenadas e fundidas logo. Se as colunas foram reconstruídas (outra
+ * geração), o índice também é.
+ *
+ */
+typedef struct {
+    uint32_t*                linhas;
+    size_t                   total;
+    size_t                   capacidade;
+    uint32_t*                pendentes;    // linhas ainda fora de 'linhas', ordenadas
+    size_t                   numPendentes;
+    size_t                   capacidadePendentes;
+    const ColunasPassagens*  colunas;      // colunas refletidas (NULL = índice vazio)
+    unsigned                 geracao;      // geração dessas colunas
+} IndiceTemporal;
+
+/**
+ * @brief Índice temporal de colunasPassagens (definido em time_index.c).
+ *
+ */
+extern IndiceTemporal indiceTemporal;
+
+bool indiceTemporal_sincronizar(IndiceTemporal* idx, const ColunasPassagens* col);
+void indiceTemporal_intervalo(const IndiceTemporal* idx, const ColunasPassagens* col,
+                              long long inicioMs, long long fimMs, size_t* primeira, size_t* ultima);
+size_t indiceTemporal_pendentes(const IndiceTemporal* idx, const ColunasPassagens* col,
+                                long long inicioMs, long long fimMs, const uint32_t** linhas);
+void indiceTemporal_libertar(IndiceTemporal* idx);
+
+/**
+ * @brief Passagens de um período sem cópias: as arquivadas no segmento (que
+ * têm de ser descomprimidas para uma arena) seguidas de uma fatia do índice
+ * temporal, fundida com a fatia dos seus pendentes. Sem índice (falta de
+ * memória) percorre a lista e filtra à passagem. As passagens são devolvidas
+ * por ordem de ts.
+ *
+ */
+typedef struct {
+    Arena                      arena;       // nós das passagens arquivadas
+    NodePassagem*              arquivadas;
+    const ColunasPassagens*    colunas;     // colunasPassagens
+    const uint32_t*            linhas;      // fatia do índice temporal
+    size_t                     total;
+    const uint32_t*            pendentes;   // fatia dos pendentes do índice
+    size_t                     totalPendentes;
+    long long                  inicioMs;
+    long long                  fimMs;
+    const NodePassagem*        no;          // cursor nos nós (arquivadas e, sem índice, a lista)
+    size_t                     i;           // cursor na fatia
+    size_t                     j;           // cursor nos pendentes
+} VistaPassagens;
+
+#define VISTA_PASSAGENS_INIT { ARENA_INIT("Passagens arquivadas", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS), \
+                               NULL, NULL, NULL, 0, NULL, 0, 0, 0, NULL, 0, 0 }
+
+/**
+ * @brief Volta ao início da vista.
+ *
+ * @param v
+ */
+static inline void vista_reiniciar(VistaPassagens* v) {
+    v->no = v->arquivadas;
+    v->i  = 0;
+    v->j  = 0;
+}
+
+/**
+ * @brief Próxima passagem da vista.
+ *
+ * @param v
+ * @return const Passagem* NULL no fim
+ */
+static inline const Passagem* vista_seguinte(VistaPassagens* v) {
+    while (v->no) {
+        const NodePassagem* n = v->no;
+        v->no = passagem_seguinte(n);
+        if (n->passagem.ts >= v->inicioMs && n->passagem.ts <= v->fimMs)
+            return &n->passagem;
+    }
+    bool temFatia = v->i < v->total, temPendente = v->j < v->totalPendentes;
+    if (!temFatia && !temPendente) return NULL;
+    uint32_t linha;
+    if (temFatia && (!temPendente || !colunas_antes(v->colunas, v->pendentes[v->j], v->linhas[v->i])))
+        linha = v->linhas[v->i++];
+    else
+        linha = v->pendentes[v->j++];
+    return &v->colunas->origem[linha]->passagem;
+}
+
+/**
+ * @brief Liberta os nós das passagens arquivadas (a fatia não tem memória própria).
+ *
+ * @param v
+ */
+static inline void vista_libertar(VistaPassagens* v) {
+    arena_libertar(&v->arena);
+    v->arquivadas = NULL;
+    v->no = NULL;
+    v->total = 0;
+    v->totalPendentes = 0;
+}
+
+#endif // TIME_INDEX_H
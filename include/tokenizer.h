@@ -0,0 +1,40 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Um campo de uma linha, como intervalo [ini, fim) dentro do buffer
+ * (não é terminado em '\0').
+ *
+ */
+typedef struct {
+    const char* ini;
+    const char* fim;
+} Campo;
+
+/**
+ * @brief Tokenizador de ficheiros separados por tabulações.
+ * O buffer é classificado em blocos de 64 bytes (com SSE2/AVX2 quando
+ * disponíveis): cada bloco dá uma máscara de 64 bits com as posições dos
+ * '\t' e '\n', que depois são consumidas uma a uma. Cada byte é lido uma
+ * única vez, ao contrário de strchr + strtok + atoi.
+ *
+ */
+typedef struct {
+    const char* pos;      // início do próximo campo
+    const char* fim;
+    const char* base;     // início do bloco de 64 bytes da máscara atual
+    uint64_t    mascara;  // delimitadores do bloco atual ainda por consumir
+} Tokenizador;
+
+void tokenizador_init(Tokenizador* t, const char* ini, const char* fim);
+int  tokenizador_linha(Tokenizador* t, Campo* campos, int maxCampos);
+
+int    campoInteiro(Campo c);
+double campoDecimal(Campo c);
+void   campoCopiar(char* destino, size_t tamanho, Campo c);
+
+#endif // TOKENIZER_H
@@ -0,0 +1,81 @@
+#ifndef VEHICLE_GROUPS_H
+#define VEHICLE_GROUPS_H
+
+#include "data.h"
+#include "time_index.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GRUPOS_MAX_VEICULOS   (1 << 24)   // maior intervalo de idVeiculo com offsets diretos
+#define GRUPOS_CAPACIDADE_MIN 4096
+#define GRUPOS_PENDENTES_MIN  64          // menor limite de passagens pendentes
+
+/**
+ * @brief Passagens agrupadas por veículo em formato CSR (compressed sparse
+ * row): as passagens do veículo idMin + v são passagens[inicio[v] .. inicio[v+1]),
+ * por ordem de (ts, posição na lista). As consultas de velocidades e
+ * infrações leem estas fatias já agrupadas e ordenadas, e com uma pesquisa
+ * binária ficam só com as do período.
+ *
+ * O índice da lista principal (gruposPassagens) é construído no carregamento
+ * e mantido de forma incremental: uma passagem registada à cabeça da lista
+ * (registarPassagem) ou acrescentada no fim (modo de seguimento) fica num
+ * pequeno array de pendentes, ordenado por (veículo, ts), que é fundido nas
+ * fatias de uma só vez por grupos_consolidar() (antes de uma consulta ou
+ * quando passa de ~√total passagens). Se a lista mudar de outra forma é
+ * reconstruído.
+ * Também se constroem índices temporários a partir de uma VistaPassagens,
+ * para os períodos que incluem passagens arquivadas. Não é thread-safe.
+ *
+ */
+typedef struct {
+    const Passagem* passagem;
+    uint32_t        v;            // posição do veículo
+    bool            antes;        // posta à cabeça da lista: fica antes das que têm o mesmo ts
+} PendenteGrupo;
+
+typedef struct {
+    int32_t             idMin;
+    size_t              numVeiculos;  // tamanho do intervalo de ids
+    uint32_t*           inicio;       // numVeiculos + 1 offsets
+    const Passagem**    passagens;
+    size_t              total;
+    size_t              capacidade;
+    SubsistemaMemoria   subsistema;
+    const NodePassagem* cabeca;       // lista refletida (NULL se vier de uma vista)
+    const NodePassagem* cauda;        // último nó da lista já agrupado
+    PendenteGrupo*      pendentes;    // ainda fora das fatias, por (v, ts)
+    size_t              numPendentes;
+    size_t              capacidadePendentes;
+} GruposVeiculo;
+
+#define GRUPOS_VEICULO_INIT(subsistema) { 0, 0, NULL, NULL, 0, 0, (subsistema), NULL, NULL, NULL, 0, 0 }
+
+/**
+ * @brief Grupos da lista principal de passagens (definidos em vehicle_groups.c).
+ *
+ */
+extern GruposVeiculo gruposPassagens;
+
+bool   grupos_sincronizar(GruposVeiculo* g, const NodePassagem* lista);
+bool   grupos_consolidar(GruposVeiculo* g);
+bool   grupos_construirVista(GruposVeiculo* g, VistaPassagens* vista);
+size_t grupos_fatia(const GruposVeiculo* g, size_t v, long long inicioMs, long long fimMs,
+                    const Passagem* const** fatia);
+bool   grupos_posicao(const GruposVeiculo* g, int idVeiculo, size_t* v);
+void   grupos_libertar(GruposVeiculo* g);
+void   grupos_imprimirEstatisticas(const GruposVeiculo* g);
+
+/**
+ * @brief idVeiculo do grupo v.
+ *
+ * @param g
+ * @param v
+ * @return int
+ */
+static inline int grupos_idVeiculo(const GruposVeiculo* g, size_t v) {
+    return (int)(g->idMin + (int64_t)v);
+}
+
+#endif // VEHICLE_GROUPS_H
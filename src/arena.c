@@ -0,0 +1,133 @@
+#include <stdio.h>      // printf
+#include "arena.h"
+
+/**
+ * @brief Inicializa uma arena vazia (não reserva memória).
+ *
+ * @param arena
+ * @param nome Nome usado nas estatísticas
+ * @param tamanhoBloco Tamanho do primeiro bloco (0 = ARENA_BLOCO_PADRAO)
+ * @param subsistema Onde os blocos são contabilizados
+ */
+void arena_init(Arena* arena, const char* nome, size_t tamanhoBloco, SubsistemaMemoria subsistema) {
+    arena->nome            = nome;
+    arena->blocos          = NULL;
+    arena->tamanhoBloco    = tamanhoBloco ? tamanhoBloco : ARENA_BLOCO_PADRAO;
+    arena->numBlocos       = 0;
+    arena->numAlocacoes    = 0;
+    arena->bytesUsados     = 0;
+    arena->bytesReservados = 0;
+    arena->subsistema      = subsistema;
+}
+
+/**
+ * @brief Tamanho do próximo bloco: os blocos crescem para o dobro do anterior
+ * (até ARENA_BLOCO_MAXIMO), pelo que uma lista com N nós ocupa O(log N) blocos.
+ *
+ * @param arena
+ * @param bytes Pedido que tem de caber no bloco
+ * @return size_t
+ */
+static size_t tamanhoNovoBloco(const Arena* arena, size_t bytes) {
+    size_t tamanho = arena->tamanhoBloco;
+    if (arena->blocos) {
+        size_t limite = tamanho > ARENA_BLOCO_MAXIMO ? tamanho : ARENA_BLOCO_MAXIMO;
+        size_t dobro  = arena->blocos->tamanho * 2;
+        if (dobro > tamanho) tamanho = dobro < limite ? dobro : limite;
+    }
+    return bytes > tamanho ? bytes : tamanho;
+}
+
+/**
+ * @brief Reserva 'bytes' de memória na arena. Quando o bloco atual não tem
+ * espaço, é criado um novo bloco maior (o resto do anterior fica por usar).
+ * Os blocos existentes nunca mudam de sítio.
+ *
+ * @param arena
+ * @param bytes
+ * @return void* Memória alinhada a ARENA_ALINHAMENTO, ou NULL se faltar memória
+ */
+void* arena_alloc(Arena* arena, size_t bytes) {
+    bytes = (bytes + ARENA_ALINHAMENTO - 1) & ~(size_t)(ARENA_ALINHAMENTO - 1);
+    BlocoArena* b = arena->blocos;
+    if (!b || b->tamanho - b->usado < bytes) {
+        if (arena->tamanhoBloco == 0) arena->tamanhoBloco = ARENA_BLOCO_PADRAO;
+        size_t tamanho = tamanhoNovoBloco(arena, bytes);
+        b = memoria_alocar(arena->subsistema, sizeof(BlocoArena) + tamanho);
+        if (!b) return NULL;
+        b->tamanho = tamanho;
+        b->usado   = 0;
+        b->next    = arena->blocos;
+        arena->blocos = b;
+        arena->numBlocos++;
+        arena->bytesReservados += tamanho;
+        memoria_ajustarFolga(arena->subsistema, (long long)tamanho);
+    }
+    void* p = b->dados + b->usado;
+    b->usado += bytes;
+    arena->numAlocacoes++;
+    arena->bytesUsados += bytes;
+    memoria_ajustarFolga(arena->subsistema, -(long long)bytes);
+    return p;
+}
+
+/**
+ * @brief Passa todos os blocos de 'origem' para 'destino' (sem copiar dados),
+ * deixando 'origem' vazia. Usado para juntar as arenas privadas de cada thread
+ * de parsing na arena global da entidade. Os blocos passam a ser contabilizados
+ * no subsistema de 'destino'.
+ *
+ * @param destino
+ * @param origem
+ */
+void arena_juntar(Arena* destino, Arena* origem) {
+    if (!origem->blocos) return;
+    // Os blocos de origem vão para o fim, para o bloco atual de destino continuar à cabeça
+    BlocoArena** fim = &destino->blocos;
+    while (*fim) fim = &(*fim)->next;
+    *fim = origem->blocos;
+    if (origem->subsistema != destino->subsistema) {
+        for (BlocoArena* b = origem->blocos; b; b = b->next)
+            memoria_transferir(b, destino->subsistema);
+        long long folga = (long long)(origem->bytesReservados - origem->bytesUsados);
+        memoria_ajustarFolga(origem->subsistema, -folga);
+        memoria_ajustarFolga(destino->subsistema, folga);
+    }
+
+    destino->numBlocos       += origem->numBlocos;
+    destino->numAlocacoes    += origem->numAlocacoes;
+    destino->bytesUsados     += origem->bytesUsados;
+    destino->bytesReservados += origem->bytesReservados;
+    arena_init(origem, origem->nome, origem->tamanhoBloco, origem->subsistema);
+}
+
+/**
+ * @brief Liberta todos os blocos da arena de uma só vez. A arena fica vazia
+ * e pode voltar a ser usada.
+ *
+ * @param arena
+ */
+void arena_libertar(Arena* arena) {
+    BlocoArena* b = arena->blocos;
+    while (b) {
+        BlocoArena* seguinte = b->next;
+        memoria_libertar(b);
+        b = seguinte;
+    }
+    memoria_ajustarFolga(arena->subsistema, -(long long)(arena->bytesReservados - arena->bytesUsados));
+    arena_init(arena, arena->nome, arena->tamanhoBloco, arena->subsistema);
+}
+
+/**
+ * @brief Mostra as estatísticas de ocupação da arena.
+ *
+ * @param arena
+ */
+void arena_imprimirEstatisticas(const Arena* arena) {
+    double usadoKB     = arena->bytesUsados / 1024.0;
+    double reservadoKB = arena->bytesReservados / 1024.0;
+    printf("  %-12s %10zu alocacoes %6zu blocos %12.1f KB usados / %12.1f KB reservados (%5.1f%%)\n",
+           arena->nome ? arena->nome : "(arena)",
+           arena->numAlocacoes, arena->numBlocos, usadoKB, reservadoKB,
+           reservadoKB > 0 ? 100.0 * usadoKB / reservadoKB : 0.0);
+}
@@ -0,0 +1,286 @@
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // qsort
+#include "attribute_index.h"
+#include "dictionary.h"
+#include "id_index.h"
+#include "postal.h"
+#include "memory.h"
+
+IndiceAtributos indiceAtributos; // vazio (cabeças a NULL) até à primeira sincronização
+
+/**
+ * @brief Dono na construção do índice, ordenado por NIF.
+ *
+ */
+typedef struct {
+    int nif;
+    int distrito;
+} DistritoDono;
+
+static int cmpDistritoDono(const void* a, const void* b) {
+    const DistritoDono* d1 = a;
+    const DistritoDono* d2 = b;
+    return d1->nif < d2->nif ? -1 : d1->nif > d2->nif;
+}
+
+static Bitmap* novosBitmaps(int n) {
+    Bitmap* bitmaps = memoria_alocar(MEMORIA_INDICES, (size_t)(n > 0 ? n : 1) * sizeof *bitmaps);
+    if (!bitmaps) return NULL;
+    for (int i = 0; i < n; i++) bitmaps[i] = (Bitmap)BITMAP_INIT(MEMORIA_INDICES);
+    return bitmaps;
+}
+
+static void libertarBitmaps(Bitmap* bitmaps, int n) {
+    for (int i = 0; bitmaps && i < n; i++) bitmap_libertar(&bitmaps[i]);
+    memoria_libertar(bitmaps);
+}
+
+/**
+ * @brief Acrescenta um carro aos bitmaps dos seus atributos.
+ *
+ * @param idx
+ * @param c
+ * @param distrito -1 se o dono não tiver código postal válido
+ * @return bool false se faltar memória
+ */
+static bool indexarCarro(IndiceAtributos* idx, const Carro* c, int distrito) {
+    if (c->idVeiculo < 0) return true;
+    uint32_t id = (uint32_t)c->idVeiculo;
+    bool ok = true;
+    if (c->codigoMarca >= 0 && c->codigoMarca < idx->numMarcas)
+        ok = ok && bitmap_adicionar(&idx->marcas[c->codigoMarca], id);
+    if (c->codigoModelo >= 0 && c->codigoModelo < idx->numModelos)
+        ok = ok && bitmap_adicionar(&idx->modelos[c->codigoModelo], id);
+    if (c->ano >= ANO_MINIMO && c->ano <= ANO_MAXIMO) {
+        int a = c->ano - idx->anoBase;
+        ok = ok && bitmap_adicionar(&idx->anos[a], id) && bitmap_adicionar(&idx->faixas[a / ANOS_POR_FAIXA], id);
+    }
+    if (distrito >= 0 && distrito < NUM_DISTRITOS)
+        ok = ok && bitmap_adicionar(&idx->distritos[distrito], id);
+    return ok;
+}
+
+/**
+ * @brief (Re)constrói o índice se as listas não forem as que ele reflete.
+ *
+ * @param idx
+ * @param listaDonos
+ * @param listaCarros
+ * @return bool false se faltar memória (o índice fica vazio)
+ */
+bool indiceAtributos_sincronizar(IndiceAtributos* idx, const NodeDono* listaDonos, const NodeCarro* listaCarros) {
+    if (idx->cabecaCarros && idx->cabecaDonos == listaDonos && idx->cabecaCarros == listaCarros)
+        return true;
+    indiceAtributos_libertar(idx);
+    if (!listaCarros) return true;
+
+    // Intervalo dos anos, alinhado às faixas
+    int anoMin = ANO_MAXIMO, anoMax = ANO_MINIMO;
+    size_t numCarros = 0, numDonos = 0;
+    for (const NodeCarro* p = listaCarros; p; p = p->next, numCarros++) {
+        if (p->carro.ano < ANO_MINIMO || p->carro.ano > ANO_MAXIMO) continue;
+        if (p->carro.ano < anoMin) anoMin = p->carro.ano;
+        if (p->carro.ano > anoMax) anoMax = p->carro.ano;
+    }
+    for (const NodeDono* p = listaDonos; p; p = p->next) numDonos++;
+    idx->anoBase = anoMin <= anoMax ? anoMin - anoMin % ANOS_POR_FAIXA : ANO_MINIMO;
+    idx->numAnos = anoMin <= anoMax ? ((anoMax - idx->anoBase) / ANOS_POR_FAIXA + 1) * ANOS_POR_FAIXA : 0;
+    idx->numMarcas = dicionarioMarcas.total;
+    idx->numModelos = dicionarioModelos.total;
+
+    DistritoDono* donos = memoria_alocar(MEMORIA_INDICES, (numDonos + 1) * sizeof *donos);
+    idx->marcas = novosBitmaps(idx->numMarcas);
+    idx->modelos = novosBitmaps(idx->numModelos);
+    idx->anos = novosBitmaps(idx->numAnos);
+    idx->faixas = novosBitmaps(idx->numAnos / ANOS_POR_FAIXA);
+    for (int d = 0; d < NUM_DISTRITOS; d++) idx->distritos[d] = (Bitmap)BITMAP_INIT(MEMORIA_INDICES);
+    bool ok = donos && idx->marcas && idx->modelos && idx->anos && idx->faixas;
+
+    size_t n = 0;
+    for (const NodeDono* p = listaDonos; ok && p; p = p->next, n++)
+        donos[n] = (DistritoDono){ p->dono.numeroContribuinte, distritoCodigoPostal(p->dono.codigoPostal) };
+    if (ok) qsort(donos, numDonos, sizeof *donos, cmpDistritoDono);
+
+    for (const NodeCarro* p = listaCarros; ok && p; p = p->next) {
+        DistritoDono chave = { p->carro.donoContribuinte, -1 };
+        const DistritoDono* dono = bsearch(&chave, donos, numDonos, sizeof *donos, cmpDistritoDono);
+        ok = indexarCarro(idx, &p->carro, dono ? dono->distrito : -1);
+    }
+    memoria_libertar(donos);
+    if (!ok) {
+        fprintf(stderr, "Erro Crítico: falta de memória no índice de atributos.\n");
+        indiceAtributos_libertar(idx);
+        return false;
+    }
+    idx->numCarros = numCarros;
+    idx->cabecaDonos = listaDonos;
+    idx->cabecaCarros = listaCarros;
+    return true;
+}
+
+/**
+ * @brief Regista um carro acabado de pôr à cabeça da lista. Se o índice não
+ * refletia as listas anteriores nada muda; se o carro tiver uma marca, modelo
+ * ou ano fora das tabelas do índice, este é reconstruído.
+ *
+ * @param idx
+ * @param no Nova cabeça da lista de carros
+ * @param listaDonos
+ * @return bool true se o índice reflete as novas listas
+ */
+bool indiceAtributos_inserirCarro(IndiceAtributos* idx, const NodeCarro* no, const NodeDono* listaDonos) {
+    if (!idx->cabecaCarros || idx->cabecaCarros != no->next || idx->cabecaDonos != listaDonos)
+        return false;
+    const Carro* c = &no->carro;
+    bool anoIndexado = c->ano < ANO_MINIMO || c->ano > ANO_MAXIMO ||
+                       (c->ano >= idx->anoBase && c->ano < idx->anoBase + idx->numAnos);
+    if (c->codigoMarca >= idx->numMarcas || c->codigoModelo >= idx->numModelos || !anoIndexado) {
+        indiceAtributos_libertar(idx);
+        return indiceAtributos_sincronizar(idx, listaDonos, no);
+    }
+
+    const NodeDono* dono = NULL;
+    if (indiceIds_valido(&indiceDonos, listaDonos)) {
+        dono = indiceIds_procurar(&indiceDonos, c->donoContribuinte);
+    } else {
+        for (dono = listaDonos; dono && dono->dono.numeroContribuinte != c->donoContribuinte; dono = dono->next) {}
+    }
+    if (!indexarCarro(idx, c, dono ? distritoCodigoPostal(dono->dono.codigoPostal) : -1)) {
+        fprintf(stderr, "Erro Crítico: falta de memória no índice de atributos.\n");
+        indiceAtributos_libertar(idx);
+        return false;
+    }
+    idx->numCarros++;
+    idx->cabecaCarros = no;
+    return true;
+}
+
+/**
+ * @brief Regista um dono acabado de pôr à cabeça da lista (ainda sem carros,
+ * por isso os bitmaps não mudam).
+ *
+ * @param idx
+ * @param no Nova cabeça da lista de donos
+ */
+void indiceAtributos_inserirDono(IndiceAtributos* idx, const NodeDono* no) {
+    if (idx->cabecaCarros && idx->cabecaDonos == no->next)
+        idx->cabecaDonos = no;
+}
+
+/**
+ * @brief resultado = união dos anos [anoMin, anoMax]: faixas inteiras onde
+ * possível, anos soltos nas pontas.
+ *
+ * @param idx
+ * @param anoMin
+ * @param anoMax
+ * @param resultado Vazio
+ * @return bool false se faltar memória
+ */
+static bool unirAnos(const IndiceAtributos* idx, int anoMin, int anoMax, Bitmap* resultado) {
+    int primeiro = anoMin > idx->anoBase ? anoMin - idx->anoBase : 0;
+    int ultimo = anoMax < idx->anoBase + idx->numAnos ? anoMax - idx->anoBase : idx->numAnos - 1;
+    for (int a = primeiro; a <= ultimo; ) {
+        const Bitmap* parte;
+        if (a % ANOS_POR_FAIXA == 0 && a + ANOS_POR_FAIXA - 1 <= ultimo) {
+            parte = &idx->faixas[a / ANOS_POR_FAIXA];
+            a += ANOS_POR_FAIXA;
+        } else {
+            parte = &idx->anos[a];
+            a++;
+        }
+        Bitmap uniao = BITMAP_INIT(resultado->subsistema);
+        if (!bitmap_unir(resultado, parte, &uniao)) {
+            bitmap_libertar(resultado);
+            return false;
+        }
+        bitmap_libertar(resultado);
+        *resultado = uniao;
+    }
+    return true;
+}
+
+/**
+ * @brief Carros (idVeiculo) que satisfazem todos os atributos do filtro,
+ * por interseção dos bitmaps, dos mais pequenos para os maiores.
+ *
+ * @param idx Válido
+ * @param filtro Ativo (ver filtroCarros_ativo())
+ * @param resultado Vazio; fica no subsistema de memória dele
+ * @return bool false se faltar memória
+ */
+bool indiceAtributos_resolver(const IndiceAtributos* idx, const FiltroCarros* filtro, Bitmap* resultado) {
+    static const Bitmap vazio = BITMAP_INIT(MEMORIA_CONSULTAS);
+    const Bitmap* conjuntos[4];
+    int n = 0;
+
+    if (filtro->marca != FILTRO_QUALQUER)
+        conjuntos[n++] = filtro->marca >= 0 && filtro->marca < idx->numMarcas ? &idx->marcas[filtro->marca] : &vazio;
+    if (filtro->modelo != FILTRO_QUALQUER)
+        conjuntos[n++] = filtro->modelo >= 0 && filtro->modelo < idx->numModelos ? &idx->modelos[filtro->modelo] : &vazio;
+    if (filtro->distrito != FILTRO_QUALQUER)
+        conjuntos[n++] = filtro->distrito >= 0 && filtro->distrito < NUM_DISTRITOS ? &idx->distritos[filtro->distrito] : &vazio;
+    Bitmap anos = BITMAP_INIT(MEMORIA_CONSULTAS);
+    if (filtro->anoMin != INT_MIN || filtro->anoMax != INT_MAX) {
+        if (!unirAnos(idx, filtro->anoMin, filtro->anoMax, &anos)) return false;
+        conjuntos[n++] = &anos;
+    }
+    if (n == 0) return true;
+
+    // Os mais pequenos primeiro: cada interseção fica no máximo do tamanho do menor
+    uint64_t cardinalidades[4];
+    for (int i = 0; i < n; i++) cardinalidades[i] = bitmap_cardinalidade(conjuntos[i]);
+    for (int i = 1; i < n; i++) {
+        for (int j = i; j > 0 && cardinalidades[j] < cardinalidades[j - 1]; j--) {
+            const Bitmap* b = conjuntos[j]; conjuntos[j] = conjuntos[j - 1]; conjuntos[j - 1] = b;
+            uint64_t c = cardinalidades[j]; cardinalidades[j] = cardinalidades[j - 1]; cardinalidades[j - 1] = c;
+        }
+    }
+
+    bool ok = bitmap_unir(conjuntos[0], &vazio, resultado);
+    for (int i = 1; ok && i < n && resultado->num > 0; i++) {
+        Bitmap intersecao = BITMAP_INIT(resultado->subsistema);
+        ok = bitmap_intersetar(resultado, conjuntos[i], &intersecao);
+        bitmap_libertar(resultado);
+        *resultado = intersecao;
+    }
+    bitmap_libertar(&anos);
+    return ok;
+}
+
+/**
+ * @brief Diz se o filtro restringe algum atributo.
+ *
+ * @param filtro NULL = sem filtro
+ * @return bool
+ */
+bool filtroCarros_ativo(const FiltroCarros* filtro) {
+    return filtro && (filtro->marca != FILTRO_QUALQUER || filtro->modelo != FILTRO_QUALQUER ||
+                      filtro->distrito != FILTRO_QUALQUER ||
+                      filtro->anoMin != INT_MIN || filtro->anoMax != INT_MAX);
+}
+
+/**
+ * @brief Liberta o índice e deixa-o vazio (reutilizável).
+ *
+ * @param idx
+ */
+void indiceAtributos_libertar(IndiceAtributos* idx) {
+    libertarBitmaps(idx->marcas, idx->numMarcas);
+    libertarBitmaps(idx->modelos, idx->numModelos);
+    libertarBitmaps(idx->anos, idx->numAnos);
+    libertarBitmaps(idx->faixas, idx->numAnos / ANOS_POR_FAIXA);
+    for (int d = 0; d < NUM_DISTRITOS; d++) bitmap_libertar(&idx->distritos[d]);
+    *idx = (IndiceAtributos){ 0 };
+}
+
+void indiceAtributos_imprimirEstatisticas(const IndiceAtributos* idx) {
+    size_t bytes = 0;
+    for (int i = 0; i < idx->numMarcas; i++) bytes += bitmap_bytes(&idx->marcas[i]);
+    for (int i = 0; i < idx->numModelos; i++) bytes += bitmap_bytes(&idx->modelos[i]);
+    for (int i = 0; i < idx->numAnos; i++) bytes += bitmap_bytes(&idx->anos[i]);
+    for (int i = 0; i < idx->numAnos / ANOS_POR_FAIXA; i++) bytes += bitmap_bytes(&idx->faixas[i]);
+    for (int d = 0; d < NUM_DISTRITOS; d++) bytes += bitmap_bytes(&idx->distritos[d]);
+    printf("Indice de atributos: %zu carros, %d marcas, %d modelos, %d anos desde %d (%zu bytes)\n",
+           idx->numCarros, idx->numMarcas, idx->numModelos, idx->numAnos, idx->anoBase, bytes);
+}
@@ -0,0 +1,385 @@
+#include <string.h>     // memcpy, memmove
+#include "bitmap.h"
+
+/**
+ * @brief Posição do contentor com a chave (ou onde seria inserido).
+ *
+ * @param b
+ * @param chave
+ * @param pos
+ * @return bool true se existir
+ */
+static bool procurarContentor(const Bitmap* b, uint16_t chave, uint32_t* pos) {
+    uint32_t lo = 0, hi = b->num;
+    while (lo < hi) {
+        uint32_t meio = lo + (hi - lo) / 2;
+        if (b->contentores[meio].chave < chave) lo = meio + 1; else hi = meio;
+    }
+    *pos = lo;
+    return lo < b->num && b->contentores[lo].chave == chave;
+}
+
+/**
+ * @brief Primeiro valor do array que não é menor do que 'valor'.
+ *
+ * @param valores
+ * @param n
+ * @param valor
+ * @return uint32_t
+ */
+static uint32_t limiteValores(const uint16_t* valores, uint32_t n, uint16_t valor) {
+    uint32_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint32_t meio = lo + (hi - lo) / 2;
+        if (valores[meio] < valor) lo = meio + 1; else hi = meio;
+    }
+    return lo;
+}
+
+/**
+ * @brief Insere um contentor vazio (array sem valores) na posição indicada.
+ *
+ * @param b
+ * @param pos
+ * @param chave
+ * @return Contentor* NULL se faltar memória
+ */
+static Contentor* inserirContentor(Bitmap* b, uint32_t pos, uint16_t chave) {
+    if (b->num == b->capacidade) {
+        uint32_t nova = b->capacidade ? b->capacidade * 2 : 4;
+        Contentor* contentores = memoria_realocar(b->subsistema, b->contentores, nova * sizeof *contentores);
+        if (!contentores) return NULL;
+        memoria_ajustarFolga(b->subsistema, (long long)((nova - b->capacidade) * sizeof *contentores));
+        b->contentores = contentores;
+        b->capacidade = nova;
+    }
+    memmove(b->contentores + pos + 1, b->contentores + pos, (b->num - pos) * sizeof *b->contentores);
+    b->contentores[pos] = (Contentor){ chave, false, 0, 0, NULL, NULL };
+    b->num++;
+    memoria_ajustarFolga(b->subsistema, -(long long)sizeof *b->contentores);
+    return &b->contentores[pos];
+}
+
+/**
+ * @brief Tira o último contentor (vazio, sem memória própria).
+ *
+ * @param b
+ */
+static void descartarUltimo(Bitmap* b) {
+    b->num--;
+    memoria_ajustarFolga(b->subsistema, (long long)sizeof *b->contentores);
+}
+
+/**
+ * @brief Passa um contentor de array a mapa de bits.
+ *
+ * @param b
+ * @param c
+ * @return bool false se faltar memória (o contentor fica como estava)
+ */
+static bool converterEmMapa(const Bitmap* b, Contentor* c) {
+    uint64_t* palavras = memoria_alocarZeros(b->subsistema, BITMAP_PALAVRAS, sizeof *palavras);
+    if (!palavras) return false;
+    for (uint32_t i = 0; i < c->cardinalidade; i++)
+        palavras[c->valores[i] >> 6] |= 1ull << (c->valores[i] & 63);
+    memoria_ajustarFolga(b->subsistema, -(long long)((c->capacidade - c->cardinalidade) * sizeof *c->valores));
+    memoria_libertar(c->valores);
+    c->valores = NULL;
+    c->capacidade = 0;
+    c->palavras = palavras;
+    c->mapa = true;
+    return true;
+}
+
+/**
+ * @brief Valores de um mapa de bits, por ordem.
+ *
+ * @param palavras
+ * @param destino
+ * @return uint32_t Número de valores
+ */
+static uint32_t extrairValores(const uint64_t* palavras, uint16_t* destino) {
+    uint32_t n = 0;
+    for (uint32_t w = 0; w < BITMAP_PALAVRAS; w++) {
+        for (uint64_t m = palavras[w]; m; m &= m - 1)
+            destino[n++] = (uint16_t)(w * 64 + (uint32_t)__builtin_ctzll(m));
+    }
+    return n;
+}
+
+/**
+ * @brief Preenche um contentor vazio com valores ordenados: array com o
+ * tamanho exato, ou mapa se forem mais de BITMAP_LIMITE_ARRAY.
+ *
+ * @param b
+ * @param c
+ * @param valores
+ * @param n
+ * @return bool false se faltar memória
+ */
+static bool preencherContentor(const Bitmap* b, Contentor* c, const uint16_t* valores, uint32_t n) {
+    if (n > BITMAP_LIMITE_ARRAY) {
+        c->palavras = memoria_alocarZeros(b->subsistema, BITMAP_PALAVRAS, sizeof *c->palavras);
+        if (!c->palavras) return false;
+        for (uint32_t i = 0; i < n; i++)
+            c->palavras[valores[i] >> 6] |= 1ull << (valores[i] & 63);
+        c->mapa = true;
+    } else {
+        c->valores = memoria_alocar(b->subsistema, n * sizeof *c->valores);
+        if (!c->valores) return false;
+        memcpy(c->valores, valores, n * sizeof *c->valores);
+        c->capacidade = n;
+    }
+    c->cardinalidade = n;
+    return true;
+}
+
+/**
+ * @brief Acrescenta um valor.
+ *
+ * @param b
+ * @param valor
+ * @return bool false se faltar memória
+ */
+bool bitmap_adicionar(Bitmap* b, uint32_t valor) {
+    uint16_t chave = (uint16_t)(valor >> 16), baixo = (uint16_t)valor;
+    uint32_t pos;
+    Contentor* c = procurarContentor(b, chave, &pos) ? &b->contentores[pos] : inserirContentor(b, pos, chave);
+    if (!c) return false;
+
+    if (!c->mapa) {
+        uint32_t i = limiteValores(c->valores, c->cardinalidade, baixo);
+        if (i < c->cardinalidade && c->valores[i] == baixo) return true;
+        if (c->cardinalidade < BITMAP_LIMITE_ARRAY) {
+            if (c->cardinalidade == c->capacidade) {
+                uint32_t nova = c->capacidade ? c->capacidade * 2 : 4;
+                if (nova > BITMAP_LIMITE_ARRAY) nova = BITMAP_LIMITE_ARRAY;
+                uint16_t* valores = memoria_realocar(b->subsistema, c->valores, nova * sizeof *valores);
+                if (!valores) return false;
+                memoria_ajustarFolga(b->subsistema, (long long)((nova - c->capacidade) * sizeof *valores));
+                c->valores = valores;
+                c->capacidade = nova;
+            }
+            memmove(c->valores + i + 1, c->valores + i, (c->cardinalidade - i) * sizeof *c->valores);
+            c->valores[i] = baixo;
+            c->cardinalidade++;
+            memoria_ajustarFolga(b->subsistema, -(long long)sizeof *c->valores);
+            return true;
+        }
+        if (!converterEmMapa(b, c)) return false;
+    }
+
+    uint64_t bit = 1ull << (baixo & 63);
+    if (!(c->palavras[baixo >> 6] & bit)) {
+        c->palavras[baixo >> 6] |= bit;
+        c->cardinalidade++;
+    }
+    return true;
+}
+
+/**
+ * @brief Diz se o valor pertence ao conjunto.
+ *
+ * @param b
+ * @param valor
+ * @return bool
+ */
+bool bitmap_contem(const Bitmap* b, uint32_t valor) {
+    uint16_t baixo = (uint16_t)valor;
+    uint32_t pos;
+    if (!procurarContentor(b, (uint16_t)(valor >> 16), &pos)) return false;
+    const Contentor* c = &b->contentores[pos];
+    if (c->mapa) return (c->palavras[baixo >> 6] >> (baixo & 63)) & 1;
+    uint32_t i = limiteValores(c->valores, c->cardinalidade, baixo);
+    return i < c->cardinalidade && c->valores[i] == baixo;
+}
+
+uint64_t bitmap_cardinalidade(const Bitmap* b) {
+    uint64_t n = 0;
+    for (uint32_t i = 0; i < b->num; i++) n += b->contentores[i].cardinalidade;
+    return n;
+}
+
+/**
+ * @brief Interseção de dois contentores com a mesma chave, num contentor vazio.
+ *
+ * @param r Bitmap do resultado
+ * @param d Contentor do resultado
+ * @param x
+ * @param y
+ * @return bool false se faltar memória
+ */
+static bool intersetarContentores(const Bitmap* r, Contentor* d, const Contentor* x, const Contentor* y) {
+    uint16_t valores[BITMAP_LIMITE_ARRAY];
+    uint32_t n = 0;
+
+    if (x->mapa && y->mapa) {
+        uint64_t* palavras = memoria_alocar(r->subsistema, BITMAP_PALAVRAS * sizeof *palavras);
+        if (!palavras) return false;
+        uint32_t total = 0;
+        for (uint32_t w = 0; w < BITMAP_PALAVRAS; w++) {
+            palavras[w] = x->palavras[w] & y->palavras[w];
+            total += (uint32_t)__builtin_popcountll(palavras[w]);
+        }
+        if (total > BITMAP_LIMITE_ARRAY) {
+            d->palavras = palavras;
+            d->mapa = true;
+            d->cardinalidade = total;
+            return true;
+        }
+        n = extrairValores(palavras, valores);
+        memoria_libertar(palavras);
+    } else if (x->mapa || y->mapa) {
+        const Contentor* arr = x->mapa ? y : x;
+        const Contentor* mapa = x->mapa ? x : y;
+        for (uint32_t i = 0; i < arr->cardinalidade; i++) {
+            uint16_t v = arr->valores[i];
+            if ((mapa->palavras[v >> 6] >> (v & 63)) & 1) valores[n++] = v;
+        }
+    } else {
+        uint32_t i = 0, j = 0;
+        while (i < x->cardinalidade && j < y->cardinalidade) {
+            if (x->valores[i] < y->valores[j]) i++;
+            else if (x->valores[i] > y->valores[j]) j++;
+            else { valores[n++] = x->valores[i]; i++; j++; }
+        }
+    }
+    return n == 0 || preencherContentor(r, d, valores, n);
+}
+
+/**
+ * @brief União de dois contentores com a mesma chave (y pode ser NULL), num contentor vazio.
+ *
+ * @param r Bitmap do resultado
+ * @param d Contentor do resultado
+ * @param x
+ * @param y
+ * @return bool false se faltar memória
+ */
+static bool unirContentores(const Bitmap* r, Contentor* d, const Contentor* x, const Contentor* y) {
+    if (!y) {
+        if (!x->mapa) return preencherContentor(r, d, x->valores, x->cardinalidade);
+        d->palavras = memoria_alocar(r->subsistema, BITMAP_PALAVRAS * sizeof *d->palavras);
+        if (!d->palavras) return false;
+        memcpy(d->palavras, x->palavras, BITMAP_PALAVRAS * sizeof *d->palavras);
+        d->mapa = true;
+        d->cardinalidade = x->cardinalidade;
+        return true;
+    }
+
+    if (!x->mapa && !y->mapa) {
+        uint16_t valores[2 * BITMAP_LIMITE_ARRAY];
+        uint32_t i = 0, j = 0, n = 0;
+        while (i < x->cardinalidade || j < y->cardinalidade) {
+            if (j == y->cardinalidade || (i < x->cardinalidade && x->valores[i] < y->valores[j]))
+                valores[n++] = x->valores[i++];
+            else if (i == x->cardinalidade || y->valores[j] < x->valores[i])
+                valores[n++] = y->valores[j++];
+            else { valores[n++] = x->valores[i++]; j++; }
+        }
+        return preencherContentor(r, d, valores, n);
+    }
+
+    d->palavras = memoria_alocarZeros(r->subsistema, BITMAP_PALAVRAS, sizeof *d->palavras);
+    if (!d->palavras) return false;
+    d->mapa = true;
+    for (const Contentor* c = x; c; c = (c == x) ? y : NULL) {
+        if (c->mapa) {
+            for (uint32_t w = 0; w < BITMAP_PALAVRAS; w++) d->palavras[w] |= c->palavras[w];
+        } else {
+            for (uint32_t i = 0; i < c->cardinalidade; i++)
+                d->palavras[c->valores[i] >> 6] |= 1ull << (c->valores[i] & 63);
+        }
+    }
+    for (uint32_t w = 0; w < BITMAP_PALAVRAS; w++)
+        d->cardinalidade += (uint32_t)__builtin_popcountll(d->palavras[w]);
+    return true;
+}
+
+/**
+ * @brief resultado = a ∩ b. O resultado deve estar vazio (BITMAP_INIT) e pode
+ * ter outro subsistema de memória.
+ *
+ * @param a
+ * @param b
+ * @param resultado
+ * @return bool false se faltar memória (o resultado fica vazio)
+ */
+bool bitmap_intersetar(const Bitmap* a, const Bitmap* b, Bitmap* resultado) {
+    uint32_t i = 0, j = 0;
+    while (i < a->num && j < b->num) {
+        const Contentor* x = &a->contentores[i];
+        const Contentor* y = &b->contentores[j];
+        if (x->chave < y->chave) { i++; continue; }
+        if (x->chave > y->chave) { j++; continue; }
+        Contentor* d = inserirContentor(resultado, resultado->num, x->chave);
+        if (!d || !intersetarContentores(resultado, d, x, y)) {
+            if (d) descartarUltimo(resultado);
+            bitmap_libertar(resultado);
+            return false;
+        }
+        if (d->cardinalidade == 0) descartarUltimo(resultado);
+        i++; j++;
+    }
+    return true;
+}
+
+/**
+ * @brief resultado = a ∪ b. O resultado deve estar vazio (BITMAP_INIT) e pode
+ * ter outro subsistema de memória.
+ *
+ * @param a
+ * @param b
+ * @param resultado
+ * @return bool false se faltar memória (o resultado fica vazio)
+ */
+bool bitmap_unir(const Bitmap* a, const Bitmap* b, Bitmap* resultado) {
+    uint32_t i = 0, j = 0;
+    while (i < a->num || j < b->num) {
+        const Contentor* x = i < a->num ? &a->contentores[i] : NULL;
+        const Contentor* y = j < b->num ? &b->contentores[j] : NULL;
+        if (!x || (y && y->chave < x->chave)) { x = y; y = NULL; j++; }
+        else if (!y || x->chave < y->chave) { y = NULL; i++; }
+        else { i++; j++; }
+        Contentor* d = inserirContentor(resultado, resultado->num, x->chave);
+        if (!d || !unirContentores(resultado, d, x, y)) {
+            if (d) descartarUltimo(resultado);
+            bitmap_libertar(resultado);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Memória ocupada (contentores e valores, incluindo a capacidade extra).
+ *
+ * @param b
+ * @return size_t
+ */
+size_t bitmap_bytes(const Bitmap* b) {
+    size_t bytes = b->capacidade * sizeof *b->contentores;
+    for (uint32_t i = 0; i < b->num; i++) {
+        const Contentor* c = &b->contentores[i];
+        bytes += c->mapa ? BITMAP_PALAVRAS * sizeof *c->palavras : c->capacidade * sizeof *c->valores;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Liberta o conjunto e deixa-o vazio (reutilizável, no mesmo subsistema).
+ *
+ * @param b
+ */
+void bitmap_libertar(Bitmap* b) {
+    for (uint32_t i = 0; i < b->num; i++) {
+        Contentor* c = &b->contentores[i];
+        if (!c->mapa)
+            memoria_ajustarFolga(b->subsistema, -(long long)((c->capacidade - c->cardinalidade) * sizeof *c->valores));
+        memoria_libertar(c->valores);
+        memoria_libertar(c->palavras);
+    }
+    memoria_ajustarFolga(b->subsistema, -(long long)((b->capacidade - b->num) * sizeof *b->contentores));
+    memoria_libertar(b->contentores);
+    *b = (Bitmap)BITMAP_INIT(b->subsistema);
+}
@@ -0,0 +1,181 @@
+#include <stdio.h>      // fprintf, printf
+#include <string.h>     // memset
+#include "columns.h"
+
+ColunasPassagens colunasPassagens = { 0 };
+
+// Bytes de uma linha (o bit do tipoRegisto não conta para a folga)
+#define COLUNAS_BYTES_LINHA (sizeof(long long) + sizeof(int32_t) + sizeof(int16_t) + sizeof(NodePassagem*))
+
+/**
+ * @brief Garante espaço para mais uma linha em todas as colunas.
+ *
+ * @param col
+ * @return bool false se faltar memória (as colunas ficam como estavam)
+ */
+static bool garantirCapacidade(ColunasPassagens* col) {
+    if (col->total < col->capacidade) return true;
+    size_t nova = col->capacidade ? col->capacidade * 2 : COLUNAS_CAPACIDADE_INICIAL;
+
+    long long* ts = memoria_realocar(MEMORIA_INDICES, col->ts, nova * sizeof *ts);
+    if (ts) col->ts = ts;
+    int32_t* idVeiculo = memoria_realocar(MEMORIA_INDICES, col->idVeiculo, nova * sizeof *idVeiculo);
+    if (idVeiculo) col->idVeiculo = idVeiculo;
+    int16_t* idSensor = memoria_realocar(MEMORIA_INDICES, col->idSensor, nova * sizeof *idSensor);
+    if (idSensor) col->idSensor = idSensor;
+    const NodePassagem** origem = memoria_realocar(MEMORIA_INDICES, col->origem, nova * sizeof *origem);
+    if (origem) col->origem = origem;
+    uint64_t* tipo = memoria_realocar(MEMORIA_INDICES, col->tipoRegisto, (nova / 64) * sizeof *tipo);
+    if (tipo) {
+        memset(tipo + col->capacidade / 64, 0, (nova - col->capacidade) / 64 * sizeof *tipo);
+        col->tipoRegisto = tipo;
+    }
+    uint64_t* aCabeca = memoria_realocar(MEMORIA_INDICES, col->aCabeca, (nova / 64) * sizeof *aCabeca);
+    if (aCabeca) {
+        memset(aCabeca + col->capacidade / 64, 0, (nova - col->capacidade) / 64 * sizeof *aCabeca);
+        col->aCabeca = aCabeca;
+    }
+    if (!ts || !idVeiculo || !idSensor || !origem || !tipo || !aCabeca) {
+        fprintf(stderr, "Erro Crítico: falta de memória nas colunas de passagens.\n");
+        return false;
+    }
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)((nova - col->capacidade) * COLUNAS_BYTES_LINHA));
+    col->capacidade = nova;
+    return true;
+}
+
+/**
+ * @brief Acrescenta um nó às colunas.
+ *
+ * @param col
+ * @param no
+ * @param aCabeca true se o nó foi posto à cabeça da lista
+ * @return bool false se faltar memória ou o idSensor não couber em 16 bits
+ */
+static bool acrescentar(ColunasPassagens* col, const NodePassagem* no, bool aCabeca) {
+    const Passagem* p = &no->passagem;
+    if (p->idSensor < INT16_MIN || p->idSensor > INT16_MAX) {
+        fprintf(stderr, "Aviso: idSensor %d fora do intervalo das colunas de passagens.\n", p->idSensor);
+        return false;
+    }
+    if (!garantirCapacidade(col)) return false;
+
+    size_t i = col->total++;
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)COLUNAS_BYTES_LINHA);
+    col->ts[i]        = p->ts;
+    col->idVeiculo[i] = p->idVeiculo;
+    col->idSensor[i]  = (int16_t)p->idSensor;
+    col->origem[i]    = no;
+    uint64_t bit = (uint64_t)1 << (i % 64);
+    if (p->tipoRegisto & 1) col->tipoRegisto[i / 64] |= bit;
+    else                    col->tipoRegisto[i / 64] &= ~bit;
+    if (aCabeca) col->aCabeca[i / 64] |= bit;
+    else         col->aCabeca[i / 64] &= ~bit;
+    return true;
+}
+
+/**
+ * @brief Esvazia as colunas (ficam com a capacidade) para serem reconstruídas.
+ *
+ * @param col
+ * @param lista Nova cabeça
+ */
+static void reiniciar(ColunasPassagens* col, const NodePassagem* lista) {
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)(col->total * COLUNAS_BYTES_LINHA));
+    col->total  = 0;
+    col->cabeca = lista;
+    col->cauda  = NULL;
+    col->geracao++;
+}
+
+/**
+ * @brief Acrescenta os nós postos à cabeça da lista desde a última
+ * sincronização (de 'lista' até à cabeça anterior, exclusive), do mais antigo
+ * para o mais recente.
+ *
+ * @param col
+ * @param lista
+ * @return bool false se a cabeça anterior não estiver na lista (é outra lista) ou faltar memória
+ */
+static bool acrescentarCabeca(ColunasPassagens* col, const NodePassagem* lista) {
+    size_t novos = 0;
+    const NodePassagem* p = lista;
+    for (; p && p != col->cabeca && novos <= col->total; p = p->next) novos++;
+    if (p != col->cabeca) return false;
+
+    const NodePassagem** nos = memoria_alocar(MEMORIA_INDICES, novos * sizeof *nos);
+    if (!nos) return false;
+    p = lista;
+    for (size_t i = 0; i < novos; i++, p = p->next) nos[i] = p;
+    bool ok = true;
+    for (size_t i = novos; ok && i > 0; i--) ok = acrescentar(col, nos[i - 1], true);
+    memoria_libertar((void*)nos);
+    if (ok) col->cabeca = lista;
+    return ok;
+}
+
+/**
+ * @brief Atualiza as colunas para refletirem a lista. Os nós postos à cabeça
+ * (registarPassagem) e os acrescentados ao fim (modo de seguimento) são
+ * copiados de forma incremental; só se for outra lista é que as colunas são
+ * reconstruídas.
+ *
+ * @param col
+ * @param lista
+ * @return bool false se não foi possível construir as colunas (usar a lista)
+ */
+bool colunas_sincronizar(ColunasPassagens* col, const NodePassagem* lista) {
+    if (lista != col->cabeca && !(col->cabeca && lista && acrescentarCabeca(col, lista)))
+        reiniciar(col, lista);
+    // O next da cauda pode estar a ser escrito pela thread de seguimento
+    const NodePassagem* p = col->cauda ? passagem_seguinte(col->cauda) : col->cabeca;
+    for (; p; p = passagem_seguinte(p)) {
+        if (!acrescentar(col, p, false)) {
+            reiniciar(col, NULL); // tenta de novo na próxima consulta
+            return false;
+        }
+        col->cauda = p;
+    }
+    return true;
+}
+
+/**
+ * @brief Liberta as colunas (a lista de origem não é tocada).
+ *
+ * @param col
+ */
+void colunas_libertar(ColunasPassagens* col) {
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)((col->capacidade - col->total) * COLUNAS_BYTES_LINHA));
+    memoria_libertar(col->ts);
+    memoria_libertar(col->idVeiculo);
+    memoria_libertar(col->idSensor);
+    memoria_libertar(col->tipoRegisto);
+    memoria_libertar(col->aCabeca);
+    memoria_libertar(col->origem);
+    unsigned geracao = col->geracao;
+    memset(col, 0, sizeof *col);
+    col->geracao = geracao + 1;
+}
+
+/**
+ * @brief Memória reservada pelas colunas.
+ *
+ * @param col
+ * @return size_t
+ */
+size_t colunas_bytes(const ColunasPassagens* col) {
+    return col->capacidade * COLUNAS_BYTES_LINHA + 2 * (col->capacidade / 64) * sizeof *col->tipoRegisto;
+}
+
+/**
+ * @brief Mostra a memória das colunas como o que é: uma cache que se soma aos
+ * nós da lista, e não uma forma mais compacta de os guardar.
+ *
+ * @param col
+ */
+void colunas_imprimirEstatisticas(const ColunasPassagens* col) {
+    size_t bytes = colunas_bytes(col);
+    printf("Colunas de passagens (cache derivada da lista, alem dos nos): %zu linhas, %zu bytes reservados "
+           "(%.1f bytes por passagem, a somar aos %zu de cada NodePassagem)\n",
+           col->total, bytes, col->total ? (double)bytes / (double)col->total : 0.0, sizeof(NodePassagem));
+}
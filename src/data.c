@@ -0,0 +1,7 @@
+#include "data.h"
+
+Arena arenaDonos      = ARENA_INIT("Donos",      ARENA_BLOCO_PADRAO,      MEMORIA_DADOS);
+Arena arenaCarros     = ARENA_INIT("Carros",     ARENA_BLOCO_PADRAO,      MEMORIA_DADOS);
+Arena arenaSensores   = ARENA_INIT("Sensores",   ARENA_BLOCO_PADRAO / 16, MEMORIA_DADOS);
+Arena arenaDistancias = ARENA_INIT("Distancias", ARENA_BLOCO_PADRAO / 16, MEMORIA_DADOS);
+Arena arenaPassagens  = ARENA_INIT("Passagens",  ARENA_BLOCO_PADRAO,      MEMORIA_DADOS);
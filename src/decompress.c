@@ -0,0 +1,330 @@
+#define _GNU_SOURCE     // pipe2
+#include <stdio.h>      // fprintf, snprintf
+#include <string.h>     // strlen, strcmp, memchr, memcpy
+#ifndef _WIN32
+#include <errno.h>      // errno, EINTR
+#include <fcntl.h>      // O_CLOEXEC, fcntl
+#include <pthread.h>    // pthread_create, pthread_mutex_*, pthread_cond_*
+#include <signal.h>     // kill, SIGTERM
+#include <spawn.h>      // posix_spawnp
+#include <sys/stat.h>   // stat
+#include <sys/wait.h>   // waitpid
+#include <unistd.h>     // pipe, read, close
+#endif
+#include "decompress.h"
+#include "memory.h"
+
+/**
+ * @brief Descompressor a usar para um ficheiro, pela extensão.
+ *
+ * @param nomeFicheiro
+ * @return const char* "gzip", "zstd" ou NULL se o ficheiro não for comprimido
+ */
+static const char* descompressorPara(const char* nomeFicheiro) {
+    size_t n = strlen(nomeFicheiro);
+    if (n > 3 && strcmp(nomeFicheiro + n - 3, ".gz") == 0)  return "gzip";
+    if (n > 4 && strcmp(nomeFicheiro + n - 4, ".zst") == 0) return "zstd";
+    return NULL;
+}
+
+/**
+ * @brief Indica se o ficheiro é lido através de um descompressor.
+ *
+ * @param nomeFicheiro
+ * @return bool
+ */
+bool ficheiroComprimido(const char* nomeFicheiro) {
+    return descompressorPara(nomeFicheiro) != NULL;
+}
+
+/**
+ * @brief Se 'nomeFicheiro' não existir, procura "<nome>.zst" e "<nome>.gz".
+ *
+ * @param nomeFicheiro
+ * @param destino Recebe o caminho a usar (o original ou a versão comprimida)
+ * @param tamanho
+ * @return bool true se foi encontrada uma versão comprimida
+ */
+bool procurarVersaoComprimida(const char* nomeFicheiro, char* destino, size_t tamanho) {
+    snprintf(destino, tamanho, "%s", nomeFicheiro);
+#ifndef _WIN32
+    struct stat st;
+    if (stat(nomeFicheiro, &st) == 0) return false;
+    static const char* extensoes[] = { ".zst", ".gz" };
+    for (size_t i = 0; i < sizeof(extensoes) / sizeof(extensoes[0]); i++) {
+        char candidato[1024];
+        if ((size_t)snprintf(candidato, sizeof(candidato), "%s%s", nomeFicheiro, extensoes[i]) >= sizeof(candidato))
+            continue;
+        if (stat(candidato, &st) == 0 && (size_t)snprintf(destino, tamanho, "%s", candidato) < tamanho)
+            return true;
+    }
+    snprintf(destino, tamanho, "%s", nomeFicheiro);
+#endif
+    return false;
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief Um bloco do anel: só contém linhas completas (exceto, eventualmente, no fim do ficheiro).
+ *
+ */
+typedef struct {
+    char*  dados;
+    size_t capacidade;
+    size_t tamanho;
+} BlocoAnel;
+
+struct LeitorComprimido {
+    const char*     nomeFicheiro;
+    int             fd;           // saída do descompressor
+    pid_t           pid;
+    pthread_t       thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t  podeLer, podeEscrever;
+    BlocoAnel       blocos[ANEL_NUM_BLOCOS];
+    size_t          cabeca;       // próximo bloco a entregar ao parser
+    size_t          cauda;        // próximo bloco a encher
+    size_t          cheios;
+    bool            emUso;        // o parser tem o bloco 'cabeca'
+    bool            terminado;    // a produtora chegou ao fim (ou falhou)
+    bool            erro;
+    bool            cancelado;    // o parser desistiu antes do fim
+};
+
+/**
+ * @brief Thread produtora: lê a saída do descompressor para o bloco livre seguinte,
+ * corta-o na última fronteira de linha e passa o resto para o bloco a seguir.
+ *
+ * @param arg LeitorComprimido*
+ * @return void*
+ */
+static void* produzirBlocos(void* arg) {
+    LeitorComprimido* l = arg;
+    char*  resto = NULL;   // linha incompleta do bloco anterior
+    size_t nResto = 0, capResto = 0;
+    bool   eof = false;
+
+    while (!eof) {
+        pthread_mutex_lock(&l->mutex);
+        while (l->cheios == ANEL_NUM_BLOCOS && !l->cancelado)
+            pthread_cond_wait(&l->podeEscrever, &l->mutex);
+        bool cancelado = l->cancelado;
+        pthread_mutex_unlock(&l->mutex);
+        if (cancelado) break;
+
+        // Só a produtora mexe no bloco 'cauda' enquanto não for publicado
+        BlocoAnel* b = &l->blocos[l->cauda];
+        size_t n = 0;
+        if (nResto > 0) {
+            if (b->capacidade < nResto + ANEL_TAMANHO_BLOCO / 2) {
+                size_t nova = nResto + ANEL_TAMANHO_BLOCO;
+                char* d = memoria_realocar(MEMORIA_LEITURA, b->dados, nova);
+                if (!d) { l->erro = true; break; }
+                b->dados = d;
+                b->capacidade = nova;
+            }
+            memcpy(b->dados, resto, nResto);
+            n = nResto;
+            nResto = 0;
+        } else if (!b->dados) {
+            b->dados = memoria_alocar(MEMORIA_LEITURA, ANEL_TAMANHO_BLOCO);
+            if (!b->dados) { l->erro = true; break; }
+            b->capacidade = ANEL_TAMANHO_BLOCO;
+        }
+
+        // Enche o bloco; se não tiver nenhuma linha completa, cresce
+        const char* ultimo = NULL;
+        for (;;) {
+            while (n < b->capacidade) {
+                ssize_t r = read(l->fd, b->dados + n, b->capacidade - n);
+                if (r < 0 && errno == EINTR) continue;
+                if (r < 0) l->erro = true;
+                if (r <= 0) { eof = true; break; }
+                n += (size_t)r;
+            }
+            if (eof) break;
+            for (const char* p = b->dados + n; p > b->dados; p--) {
+                if (p[-1] == '\n') { ultimo = p; break; }
+            }
+            if (ultimo) break;
+            char* d = memoria_realocar(MEMORIA_LEITURA, b->dados, b->capacidade * 2);
+            if (!d) { l->erro = true; eof = true; break; }
+            b->dados = d;
+            b->capacidade *= 2;
+        }
+
+        if (eof) {
+            b->tamanho = n;
+        } else {
+            b->tamanho = (size_t)(ultimo - b->dados);
+            nResto = n - b->tamanho;
+            if (nResto > capResto) {
+                char* d = memoria_realocar(MEMORIA_LEITURA, resto, nResto);
+                if (!d) { l->erro = true; break; }
+                resto = d;
+                capResto = nResto;
+            }
+            memcpy(resto, ultimo, nResto);
+        }
+
+        pthread_mutex_lock(&l->mutex);
+        l->cauda = (l->cauda + 1) % ANEL_NUM_BLOCOS;
+        l->cheios++;
+        pthread_cond_signal(&l->podeLer);
+        pthread_mutex_unlock(&l->mutex);
+    }
+
+    memoria_libertar(resto);
+    pthread_mutex_lock(&l->mutex);
+    l->terminado = true;
+    pthread_cond_signal(&l->podeLer);
+    pthread_mutex_unlock(&l->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Lança o descompressor e a thread produtora.
+ *
+ * @param nomeFicheiro Ficheiro .gz ou .zst
+ * @return LeitorComprimido* ou NULL em caso de erro
+ */
+LeitorComprimido* abrirComprimido(const char* nomeFicheiro) {
+    const char* programa = descompressorPara(nomeFicheiro);
+    if (!programa) return NULL;
+
+    LeitorComprimido* l = memoria_alocarZeros(MEMORIA_LEITURA, 1, sizeof(LeitorComprimido));
+    if (!l) return NULL;
+    l->nomeFicheiro = nomeFicheiro;
+
+    // O tubo é close-on-exec: os carregadores correm em paralelo e um descompressor
+    // lançado por outra thread não pode herdar esta ponta de escrita (o EOF nunca chegaria)
+    int tubo[2];
+#ifdef __linux__
+    int r = pipe2(tubo, O_CLOEXEC);
+#else
+    int r = pipe(tubo);
+    if (r == 0) {
+        fcntl(tubo[0], F_SETFD, FD_CLOEXEC);
+        fcntl(tubo[1], F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    if (r != 0) {
+        memoria_libertar(l);
+        return NULL;
+    }
+
+    // O descompressor escreve para o tubo; é lançado sem passar pela shell
+    posix_spawn_file_actions_t acoes;
+    posix_spawn_file_actions_init(&acoes);
+    posix_spawn_file_actions_adddup2(&acoes, tubo[1], STDOUT_FILENO);
+    char* const argv[] = { (char*)programa, "-dc", "--", (char*)nomeFicheiro, NULL };
+    extern char** environ;
+    int erroSpawn = posix_spawnp(&l->pid, programa, &acoes, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&acoes);
+    close(tubo[1]);
+    if (erroSpawn != 0) {
+        fprintf(stderr, "Nao foi possivel executar %s para ler %s.\n", programa, nomeFicheiro);
+        close(tubo[0]);
+        memoria_libertar(l);
+        return NULL;
+    }
+    l->fd = tubo[0];
+
+    pthread_mutex_init(&l->mutex, NULL);
+    pthread_cond_init(&l->podeLer, NULL);
+    pthread_cond_init(&l->podeEscrever, NULL);
+    if (pthread_create(&l->thread, NULL, produzirBlocos, l) != 0) {
+        kill(l->pid, SIGTERM);
+        close(l->fd);
+        waitpid(l->pid, NULL, 0);
+        pthread_mutex_destroy(&l->mutex);
+        pthread_cond_destroy(&l->podeLer);
+        pthread_cond_destroy(&l->podeEscrever);
+        memoria_libertar(l);
+        return NULL;
+    }
+    return l;
+}
+
+/**
+ * @brief Devolve o bloco de linhas seguinte. O bloco anterior é devolvido ao anel,
+ * pelo que só é válido até à chamada seguinte.
+ *
+ * @param leitor
+ * @param ini
+ * @param fim
+ * @return bool false quando não houver mais dados
+ */
+bool proximoBlocoComprimido(LeitorComprimido* l, const char** ini, const char** fim) {
+    pthread_mutex_lock(&l->mutex);
+    if (l->emUso) {
+        l->cabeca = (l->cabeca + 1) % ANEL_NUM_BLOCOS;
+        l->cheios--;
+        l->emUso = false;
+        pthread_cond_signal(&l->podeEscrever);
+    }
+    while (l->cheios == 0 && !l->terminado)
+        pthread_cond_wait(&l->podeLer, &l->mutex);
+    bool ha = l->cheios > 0;
+    if (ha) {
+        BlocoAnel* b = &l->blocos[l->cabeca];
+        *ini = b->dados;
+        *fim = b->dados + b->tamanho;
+        l->emUso = true;
+    }
+    pthread_mutex_unlock(&l->mutex);
+    return ha;
+}
+
+/**
+ * @brief Termina a leitura (mesmo que não tenha chegado ao fim) e liberta tudo.
+ *
+ * @param leitor
+ * @return bool true se o descompressor terminou sem erros
+ */
+bool fecharComprimido(LeitorComprimido* l) {
+    if (!l) return false;
+    pthread_mutex_lock(&l->mutex);
+    bool incompleto = !l->terminado;
+    l->cancelado = true;
+    pthread_cond_signal(&l->podeEscrever);
+    pthread_mutex_unlock(&l->mutex);
+    if (incompleto) kill(l->pid, SIGTERM); // desbloqueia um read() pendente
+    pthread_join(l->thread, NULL);
+    close(l->fd);
+
+    int estado = 0;
+    while (waitpid(l->pid, &estado, 0) < 0 && errno == EINTR) {}
+    bool ok = !l->erro && !incompleto && WIFEXITED(estado) && WEXITSTATUS(estado) == 0;
+    if (!incompleto && !ok) {
+        fprintf(stderr, "Erro ao descomprimir %s.\n", l->nomeFicheiro);
+    }
+
+    for (int i = 0; i < ANEL_NUM_BLOCOS; i++)
+        memoria_libertar(l->blocos[i].dados);
+    pthread_mutex_destroy(&l->mutex);
+    pthread_cond_destroy(&l->podeLer);
+    pthread_cond_destroy(&l->podeEscrever);
+    memoria_libertar(l);
+    return ok;
+}
+
+#else // _WIN32: sem fork/pipe, os ficheiros comprimidos não são suportados
+
+LeitorComprimido* abrirComprimido(const char* nomeFicheiro) {
+    fprintf(stderr, "Ficheiros comprimidos (%s) nao sao suportados em Windows.\n", nomeFicheiro);
+    return NULL;
+}
+
+bool proximoBlocoComprimido(LeitorComprimido* leitor, const char** ini, const char** fim) {
+    (void)leitor; (void)ini; (void)fim;
+    return false;
+}
+
+bool fecharComprimido(LeitorComprimido* leitor) {
+    (void)leitor;
+    return false;
+}
+
+#endif
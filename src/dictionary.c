@@ -0,0 +1,150 @@
+#include <stdio.h>      // fprintf
+#include <string.h>     // memcpy, strncmp, strlen
+#include <stdint.h>     // uint32_t
+#include "dictionary.h"
+
+Dicionario dicionarioMarcas  = DICIONARIO_INIT("Marcas");
+Dicionario dicionarioModelos = DICIONARIO_INIT("Modelos");
+
+/**
+ * @brief Dispersão FNV-1a de um texto.
+ *
+ * @param texto
+ * @param comprimento
+ * @return uint32_t
+ */
+static uint32_t dispersao(const char* texto, size_t comprimento) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < comprimento; i++) {
+        h ^= (unsigned char)texto[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Posição da tabela onde está o texto, ou a posição livre onde deve ser inserido.
+ *
+ * @param d
+ * @param texto
+ * @param comprimento
+ * @return size_t
+ */
+static size_t posicaoTexto(const Dicionario* d, const char* texto, size_t comprimento) {
+    size_t mascara = d->numPosicoes - 1;
+    size_t i = dispersao(texto, comprimento) & mascara;
+    while (d->tabela[i] != 0) {
+        const char* t = d->textos[d->tabela[i] - 1];
+        if (strncmp(t, texto, comprimento) == 0 && t[comprimento] == '\0')
+            return i;
+        i = (i + 1) & mascara;
+    }
+    return i;
+}
+
+/**
+ * @brief Duplica a tabela e volta a inserir todos os códigos.
+ *
+ * @param d
+ * @return bool false se faltar memória
+ */
+static bool crescerTabela(Dicionario* d) {
+    size_t nova = d->numPosicoes ? d->numPosicoes * 2 : DICIONARIO_POSICOES_INICIAIS;
+    int* tabela = memoria_alocarZeros(MEMORIA_INDICES, nova, sizeof(int));
+    if (!tabela) return false;
+    memoria_libertar(d->tabela);
+    d->tabela = tabela;
+    d->numPosicoes = nova;
+    for (int c = 0; c < d->total; c++) {
+        const char* t = d->textos[c];
+        d->tabela[posicaoTexto(d, t, strlen(t))] = c + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Mensagem de falta de memória comum a dicionario_codigo().
+ *
+ * @param d
+ * @return int Sempre -1
+ */
+static int semMemoria(const Dicionario* d) {
+    fprintf(stderr, "Erro Crítico: falta de memória no dicionário de %s.\n", d->nome);
+    return -1;
+}
+
+/**
+ * @brief Código do texto [texto, texto + comprimento), inserindo-o se ainda não existir.
+ *
+ * @param d
+ * @param texto Não precisa de ser terminado em '\0'
+ * @param comprimento
+ * @return int Código (>= 0), ou -1 se faltar memória
+ */
+int dicionario_codigo(Dicionario* d, const char* texto, size_t comprimento) {
+    // Mantém a taxa de ocupação abaixo de 1/2
+    if ((size_t)(d->total + 1) * 2 > d->numPosicoes && !crescerTabela(d)) return semMemoria(d);
+
+    size_t pos = posicaoTexto(d, texto, comprimento);
+    if (d->tabela[pos] != 0) return d->tabela[pos] - 1;
+
+    if (d->total == d->capacidade) {
+        int capacidade = d->capacidade ? d->capacidade * 2 : 64;
+        const char** textos = memoria_realocar(MEMORIA_INDICES, d->textos, (size_t)capacidade * sizeof *textos);
+        if (!textos) return semMemoria(d);
+        memoria_ajustarFolga(MEMORIA_INDICES, (long long)(capacidade - d->capacidade) * (long long)sizeof *textos);
+        d->textos = textos;
+        d->capacidade = capacidade;
+    }
+    char* copia = arena_alloc(&d->arena, comprimento + 1);
+    if (!copia) return semMemoria(d);
+    memcpy(copia, texto, comprimento);
+    copia[comprimento] = '\0';
+
+    d->textos[d->total] = copia;
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)sizeof *d->textos);
+    d->tabela[pos] = ++d->total;
+    return d->total - 1;
+}
+
+/**
+ * @brief Código de um texto já existente.
+ *
+ * @param d
+ * @param texto
+ * @param comprimento
+ * @return int Código, ou -1 se o texto não estiver no dicionário
+ */
+int dicionario_procurar(const Dicionario* d, const char* texto, size_t comprimento) {
+    if (d->total == 0) return -1;
+    size_t pos = posicaoTexto(d, texto, comprimento);
+    return d->tabela[pos] - 1;
+}
+
+/**
+ * @brief Texto de um código ("" se o código não for válido).
+ *
+ * @param d
+ * @param codigo
+ * @return const char*
+ */
+const char* dicionario_texto(const Dicionario* d, int codigo) {
+    return (codigo >= 0 && codigo < d->total) ? d->textos[codigo] : "";
+}
+
+/**
+ * @brief Liberta o dicionário (os códigos deixam de ser válidos).
+ *
+ * @param d
+ */
+void dicionario_libertar(Dicionario* d) {
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)(d->capacidade - d->total) * (long long)sizeof *d->textos);
+    memoria_libertar(d->textos);
+    memoria_libertar(d->tabela);
+    arena_libertar(&d->arena);
+    d->textos      = NULL;
+    d->tabela      = NULL;
+    d->total       = 0;
+    d->capacidade  = 0;
+    d->numPosicoes = 0;
+}
@@ -0,0 +1,234 @@
+#include <stdio.h>      // printf, fprintf
+#include "distance_matrix.h"
+
+MatrizDistancias matrizDistancias = MATRIZ_DISTANCIAS_INIT;
+
+/**
+ * @brief Chave de um par de sensores, igual nas duas orientações.
+ *
+ * @param id1
+ * @param id2
+ * @return uint64_t
+ */
+static uint64_t chavePar(int id1, int id2) {
+    if (id1 > id2) { int t = id1; id1 = id2; id2 = t; }
+    return ((uint64_t)(uint32_t)id1 << 32) | (uint32_t)id2;
+}
+
+/**
+ * @brief Posição da tabela esparsa onde está a chave, ou a posição livre onde deve ser inserida.
+ *
+ * @param m Com tabela alocada
+ * @param chave
+ * @return size_t
+ */
+static size_t posicaoPar(const MatrizDistancias* m, uint64_t chave) {
+    size_t mascara = m->numPosicoes - 1;
+    size_t i = (size_t)((chave * 0x9E3779B97F4A7C15ull) >> 40) & mascara;
+    while (m->tabela[i].ocupada && m->tabela[i].chave != chave)
+        i = (i + 1) & mascara;
+    return i;
+}
+
+/**
+ * @brief Duplica a tabela esparsa e volta a inserir todos os pares.
+ *
+ * @param m
+ * @return bool false se faltar memória
+ */
+static bool crescerTabela(MatrizDistancias* m) {
+    size_t nova = m->numPosicoes ? m->numPosicoes * 2 : MATRIZ_POSICOES_INICIAIS;
+    EntradaDistancia* tabela = memoria_alocarZeros(MEMORIA_INDICES, nova, sizeof(EntradaDistancia));
+    if (!tabela) return false;
+
+    EntradaDistancia* antiga = m->tabela;
+    size_t numAntigas = m->numPosicoes;
+    m->tabela = tabela;
+    m->numPosicoes = nova;
+    for (size_t i = 0; i < numAntigas; i++) {
+        if (antiga[i].ocupada)
+            m->tabela[posicaoPar(m, antiga[i].chave)] = antiga[i];
+    }
+    memoria_libertar(antiga);
+    return true;
+}
+
+/**
+ * @brief Guarda a distância de um par na tabela esparsa.
+ *
+ * @param m
+ * @param d
+ * @param substituir Se false, um par já existente mantém a distância
+ * @return bool false se faltar memória
+ */
+static bool guardarEsparsa(MatrizDistancias* m, const Distancia* d, bool substituir) {
+    if ((m->total + 1) * 2 > m->numPosicoes && !crescerTabela(m))
+        return false;
+    uint64_t chave = chavePar(d->idSensor1, d->idSensor2);
+    EntradaDistancia* e = &m->tabela[posicaoPar(m, chave)];
+    if (e->ocupada && !substituir) return true;
+    if (!e->ocupada) m->total++;
+    *e = (EntradaDistancia){ chave, d->distancia, 1 };
+    return true;
+}
+
+/**
+ * @brief Distância na forma esparsa.
+ *
+ * @param m
+ * @param id1
+ * @param id2
+ * @return double -1.0 se não houver distância entre eles
+ */
+double matrizDistancias_procurarEsparsa(const MatrizDistancias* m, int id1, int id2) {
+    if (m->total == 0) return -1.0;
+    const EntradaDistancia* e = &m->tabela[posicaoPar(m, chavePar(id1, id2))];
+    return e->ocupada ? e->distancia : -1.0;
+}
+
+/**
+ * @brief Linha da matriz densa de um sensor, atribuindo uma nova se ainda não tiver.
+ *
+ * @param m
+ * @param id
+ * @return int -1 se o id estiver fora do intervalo ou não houver linhas livres
+ */
+static int linhaSensor(MatrizDistancias* m, int id) {
+    long long a = (long long)id - m->idMin;
+    if (a < 0 || a >= m->numIds) return -1;
+    if (m->linha[a] < 0 && m->numSensores < m->dimensao)
+        m->linha[a] = m->numSensores++;
+    return m->linha[a];
+}
+
+/**
+ * @brief Guarda a distância de um par na matriz densa (nas duas orientações).
+ *
+ * @param m
+ * @param d
+ * @param substituir Se false, um par já existente mantém a distância
+ * @return bool false se algum dos sensores não couber na matriz
+ */
+static bool guardarDensa(MatrizDistancias* m, const Distancia* d, bool substituir) {
+    int i = linhaSensor(m, d->idSensor1);
+    int j = linhaSensor(m, d->idSensor2);
+    if (i < 0 || j < 0) return false;
+    float* ij = &m->valores[(size_t)i * (size_t)m->dimensao + (size_t)j];
+    float* ji = &m->valores[(size_t)j * (size_t)m->dimensao + (size_t)i];
+    if (*ij >= 0.0f && !substituir) return true;
+    *ij = *ji = d->distancia;
+    return true;
+}
+
+/**
+ * @brief Tenta a forma densa: remapeia os ids e reserva a matriz.
+ *
+ * @param m Vazia
+ * @param lista Não vazia
+ * @return bool false se os ids não couberem (ou faltar memória)
+ */
+static bool prepararDensa(MatrizDistancias* m, NodeDistancia* lista) {
+    int idMin = lista->distancia.idSensor1, idMax = idMin;
+    for (NodeDistancia* p = lista; p; p = p->next) {
+        int ids[2] = { p->distancia.idSensor1, p->distancia.idSensor2 };
+        for (int k = 0; k < 2; k++) {
+            if (ids[k] < idMin) idMin = ids[k];
+            if (ids[k] > idMax) idMax = ids[k];
+        }
+    }
+    long long numIds = (long long)idMax - idMin + 1;
+    if (numIds > MATRIZ_MAX_IDS) return false;
+
+    m->linha = memoria_alocar(MEMORIA_INDICES, (size_t)numIds * sizeof(int));
+    if (!m->linha) return false;
+    for (long long a = 0; a < numIds; a++) m->linha[a] = -1;
+    m->idMin = idMin;
+    m->numIds = (int)numIds;
+
+    // Conta os sensores distintos para dimensionar a matriz
+    m->dimensao = MATRIZ_MAX_SENSORES;
+    for (NodeDistancia* p = lista; p; p = p->next) {
+        if (linhaSensor(m, p->distancia.idSensor1) < 0 || linhaSensor(m, p->distancia.idSensor2) < 0)
+            return false; // mais de MATRIZ_MAX_SENSORES sensores
+    }
+    int dimensao = (m->numSensores + MATRIZ_FOLGA_SENSORES) / MATRIZ_FOLGA_SENSORES * MATRIZ_FOLGA_SENSORES;
+    m->dimensao = dimensao > MATRIZ_MAX_SENSORES ? MATRIZ_MAX_SENSORES : dimensao;
+
+    size_t celulas = (size_t)m->dimensao * (size_t)m->dimensao;
+    m->valores = memoria_alocar(MEMORIA_INDICES, celulas * sizeof(float));
+    if (!m->valores) return false;
+    for (size_t c = 0; c < celulas; c++) m->valores[c] = -1.0f;
+    return true;
+}
+
+/**
+ * @brief (Re)constrói a matriz a partir da lista de distâncias: densa se os ids
+ * o permitirem, esparsa caso contrário.
+ *
+ * @param m
+ * @param lista
+ * @return bool false se faltar memória (a matriz fica vazia e obterDistancia percorre a lista)
+ */
+bool matrizDistancias_construir(MatrizDistancias* m, NodeDistancia* lista) {
+    matrizDistancias_libertar(m);
+    if (!lista) return true;
+
+    if (prepararDensa(m, lista)) {
+        for (NodeDistancia* p = lista; p; p = p->next)
+            guardarDensa(m, &p->distancia, false); // fica a primeira, como na pesquisa linear
+    } else {
+        matrizDistancias_libertar(m);
+        for (NodeDistancia* p = lista; p; p = p->next) {
+            if (!guardarEsparsa(m, &p->distancia, false)) {
+                fprintf(stderr, "Sem memoria para a matriz de distancias; a usar pesquisa linear.\n");
+                matrizDistancias_libertar(m);
+                return false;
+            }
+        }
+    }
+    m->cabeca = lista;
+    return true;
+}
+
+/**
+ * @brief Regista uma distância acabada de pôr à cabeça da lista. Se a matriz
+ * não refletia a lista anterior nada muda; se o par não couber na forma atual
+ * (sensor novo fora do intervalo ou sem linhas livres) a matriz é reconstruída.
+ *
+ * @param m
+ * @param no Nova cabeça da lista
+ * @return bool true se a matriz reflete a nova lista
+ */
+bool matrizDistancias_inserirCabeca(MatrizDistancias* m, NodeDistancia* no) {
+    if (no->next != NULL && !matrizDistancias_valida(m, no->next)) return false;
+    if (no->next == NULL) return matrizDistancias_construir(m, no);
+
+    bool ok = m->valores ? guardarDensa(m, &no->distancia, true) : guardarEsparsa(m, &no->distancia, true);
+    if (!ok) return matrizDistancias_construir(m, no);
+    m->cabeca = no;
+    return true;
+}
+
+/**
+ * @brief Liberta a matriz e deixa-a vazia (reutilizável).
+ *
+ * @param m
+ */
+void matrizDistancias_libertar(MatrizDistancias* m) {
+    memoria_libertar(m->linha);
+    memoria_libertar(m->valores);
+    memoria_libertar(m->tabela);
+    *m = (MatrizDistancias)MATRIZ_DISTANCIAS_INIT;
+}
+
+void matrizDistancias_imprimirEstatisticas(const MatrizDistancias* m) {
+    if (m->valores) {
+        printf("Matriz de distancias: densa, %d sensores em %d x %d (%zu bytes), ids %d..%d\n",
+               m->numSensores, m->dimensao, m->dimensao,
+               (size_t)m->dimensao * (size_t)m->dimensao * sizeof(float) + (size_t)m->numIds * sizeof(int),
+               m->idMin, m->idMin + m->numIds - 1);
+    } else {
+        printf("Matriz de distancias: esparsa, %zu pares em %zu posicoes (%zu bytes)\n",
+               m->total, m->numPosicoes, m->numPosicoes * sizeof(EntradaDistancia));
+    }
+}
@@ -0,0 +1,288 @@
+#include <stdio.h>      // printf, fprintf
+#include <string.h>     // memchr, memmove
+#ifndef _WIN32
+#include <errno.h>      // errno, EINTR
+#include <fcntl.h>      // open
+#include <poll.h>       // poll
+#include <pthread.h>    // pthread_create, pthread_join
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // pread, pipe, close
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#endif
+#include "follow.h"
+#include "read_files.h"
+#include "decompress.h"
+#include "segment.h"
+
+#ifndef _WIN32
+
+/**
+ * @brief Estado da (única) thread de seguimento.
+ *
+ */
+typedef struct {
+    const char*    nomeFicheiro;
+    NodePassagem** lista;
+    NodePassagem*  cauda;         // último nó publicado
+    size_t         offset;        // bytes de passagem.txt já consumidos
+    Arena          arena;         // nós criados pela thread (juntos à arenaPassagens no fim)
+    char*          buffer;        // bytes lidos ainda por interpretar (linha incompleta)
+    size_t         usado, capacidade;
+    int            pipeParar[2];  // escrever em [1] acorda a thread para terminar
+    int            fdInotify, wd;
+    size_t         recebidas;     // acedido com __atomic_*
+    pthread_t      thread;
+    bool           ativo;
+} Seguimento;
+
+static Seguimento seg = { .pipeParar = { -1, -1 }, .fdInotify = -1, .wd = -1 };
+
+/**
+ * @brief Publica um nó completo no fim da lista.
+ *
+ * @param no
+ */
+static void publicarPassagem(NodePassagem* no) {
+    no->next = NULL;
+    if (seg.cauda) __atomic_store_n(&seg.cauda->next, no, __ATOMIC_RELEASE);
+    else           __atomic_store_n(seg.lista, no, __ATOMIC_RELEASE);
+    seg.cauda = no;
+    __atomic_fetch_add(&seg.recebidas, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Interpreta todas as linhas completas do buffer e guarda o resto
+ * (uma linha ainda a ser escrita) para a próxima leitura.
+ *
+ * @return bool false se faltar memória
+ */
+static bool interpretarLinhasCompletas(void) {
+    const char* p = seg.buffer;
+    const char* fim = seg.buffer + seg.usado;
+    NodePassagem* no = NULL;
+    for (;;) {
+        const char* nl = memchr(p, '\n', (size_t)(fim - p));
+        if (!nl) break;
+        if (!no && !(no = arena_alloc(&seg.arena, sizeof(NodePassagem))))
+            return false;
+        if (parsearLinhaPassagem(p, nl, &no->passagem) && !segmento_arquivada(&segmentoPassagens, no->passagem.ts)) {
+            publicarPassagem(no);
+            no = NULL;
+        }
+        p = nl + 1;
+    }
+    seg.usado = (size_t)(fim - p);
+    memmove(seg.buffer, p, seg.usado);
+    return true;
+}
+
+/**
+ * @brief Lê tudo o que foi acrescentado ao ficheiro desde a última chamada.
+ *
+ * @return bool false se ocorrer um erro que obrigue a terminar o seguimento
+ */
+static bool lerNovasLinhas(void) {
+    int fd = open(seg.nomeFicheiro, O_RDONLY);
+    if (fd < 0) return true; // ficheiro a ser rodado: tenta de novo no próximo evento
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return true;
+    }
+    if ((size_t)st.st_size < seg.offset) {
+        fprintf(stderr, "\n[seguimento] %s foi truncado; a continuar a partir do inicio.\n", seg.nomeFicheiro);
+        seg.offset = 0;
+        seg.usado = 0;
+    }
+
+    bool ok = true;
+    while (ok && seg.offset < (size_t)st.st_size) {
+        if (seg.capacidade - seg.usado < SEGUIMENTO_BLOCO_LEITURA) {
+            size_t nova = seg.capacidade ? seg.capacidade * 2 : 2 * SEGUIMENTO_BLOCO_LEITURA;
+            char* b = memoria_realocar(MEMORIA_LEITURA, seg.buffer, nova);
+            if (!b) { ok = false; break; }
+            seg.buffer = b;
+            seg.capacidade = nova;
+        }
+        ssize_t n = pread(fd, seg.buffer + seg.usado, SEGUIMENTO_BLOCO_LEITURA, (off_t)seg.offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        seg.usado += (size_t)n;
+        seg.offset += (size_t)n;
+        ok = interpretarLinhasCompletas();
+    }
+    close(fd);
+    if (!ok) fprintf(stderr, "\n[seguimento] Falta de memoria; seguimento terminado.\n");
+    return ok;
+}
+
+#ifdef __linux__
+/**
+ * @brief (Re)coloca a vigilância inotify sobre o ficheiro. Depois de uma rotação
+ * o caminho passa a apontar para um ficheiro novo, que é lido desde o início.
+ *
+ */
+static void vigiarFicheiro(void) {
+    if (seg.fdInotify < 0) return;
+    seg.wd = inotify_add_watch(seg.fdInotify, seg.nomeFicheiro,
+                               IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+}
+
+/**
+ * @brief Consome os eventos pendentes do inotify.
+ *
+ * @return bool true se o ficheiro vigiado foi removido ou mudou de nome
+ */
+static bool consumirEventos(void) {
+    char eventos[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool rodado = false;
+    ssize_t n;
+    while ((n = read(seg.fdInotify, eventos, sizeof(eventos))) > 0) {
+        for (char* p = eventos; p < eventos + n; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            if (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) rodado = true;
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    return rodado;
+}
+#endif
+
+/**
+ * @brief Corpo da thread: apanha o que foi escrito entre o carregamento e o
+ * arranque e depois espera por alterações até lhe pedirem para terminar.
+ *
+ * @param arg não usado
+ * @return void*
+ */
+static void* seguirPassagens(void* arg) {
+    (void)arg;
+    if (!lerNovasLinhas()) return NULL;
+
+    for (;;) {
+        struct pollfd fds[2] = { { seg.pipeParar[0], POLLIN, 0 }, { seg.fdInotify, POLLIN, 0 } };
+        nfds_t nfds = seg.wd >= 0 ? 2 : 1;
+        int r = poll(fds, nfds, seg.wd >= 0 ? -1 : SEGUIMENTO_INTERVALO_MS);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0 || fds[0].revents) break;
+#ifdef __linux__
+        if (nfds == 2 && (fds[1].revents & POLLIN) && consumirEventos()) {
+            // Rotação: o caminho passa a ser um ficheiro novo, lido desde o início
+            if (seg.wd >= 0) inotify_rm_watch(seg.fdInotify, seg.wd);
+            seg.offset = 0;
+            seg.usado = 0;
+            vigiarFicheiro(); // se ainda não existir, passa a verificar periodicamente
+            continue;
+        }
+        if (seg.wd < 0 && seg.fdInotify >= 0) vigiarFicheiro();
+#endif
+        if (!lerNovasLinhas()) break;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Arranca a thread de seguimento de passagem.txt.
+ *
+ * @param nomeFicheiro
+ * @param listaPassagens Lista principal (as passagens novas são acrescentadas ao fim)
+ * @param offsetInicial Bytes do ficheiro que já foram carregados
+ * @return bool
+ */
+bool iniciarSeguimentoPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens, size_t offsetInicial) {
+    if (seg.ativo) return true;
+    if (ficheiroComprimido(nomeFicheiro)) {
+        printf("O modo de seguimento requer um ficheiro de texto (%s esta comprimido).\n", nomeFicheiro);
+        return false;
+    }
+
+    seg.nomeFicheiro = nomeFicheiro;
+    seg.lista        = listaPassagens;
+    seg.cauda        = NULL;
+    for (NodePassagem* p = *listaPassagens; p; p = p->next)
+        seg.cauda = p;
+    seg.offset = offsetInicial;
+    seg.usado  = 0;
+    arena_init(&seg.arena, "Passagens (seguimento)", ARENA_BLOCO_PADRAO, MEMORIA_DADOS);
+
+    if (pipe(seg.pipeParar) != 0) {
+        perror("Erro ao criar pipe de seguimento");
+        return false;
+    }
+#ifdef __linux__
+    seg.fdInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    vigiarFicheiro();
+#endif
+    if (seg.wd < 0)
+        printf("inotify indisponivel; %s sera verificado a cada %d ms.\n", nomeFicheiro, SEGUIMENTO_INTERVALO_MS);
+
+    if (pthread_create(&seg.thread, NULL, seguirPassagens, NULL) != 0) {
+        fprintf(stderr, "Erro ao criar a thread de seguimento.\n");
+        close(seg.pipeParar[0]);
+        close(seg.pipeParar[1]);
+        if (seg.fdInotify >= 0) close(seg.fdInotify);
+        seg.fdInotify = seg.wd = -1;
+        return false;
+    }
+    seg.ativo = true;
+    return true;
+}
+
+/**
+ * @brief Pede à thread de seguimento para terminar e espera por ela.
+ * Os nós criados passam para a arenaPassagens (libertados com a lista principal).
+ *
+ * @return size_t Bytes do ficheiro já interpretados (onde um novo seguimento deve começar)
+ */
+size_t pararSeguimentoPassagens(void) {
+    if (!seg.ativo) return 0;
+    char c = 1;
+    while (write(seg.pipeParar[1], &c, 1) < 0 && errno == EINTR) {}
+    pthread_join(seg.thread, NULL);
+
+    close(seg.pipeParar[0]);
+    close(seg.pipeParar[1]);
+    if (seg.fdInotify >= 0) close(seg.fdInotify);
+    seg.pipeParar[0] = seg.pipeParar[1] = seg.fdInotify = seg.wd = -1;
+
+    arena_juntar(&arenaPassagens, &seg.arena);
+    size_t consumidos = seg.offset - seg.usado; // a linha incompleta volta a ser lida
+    memoria_libertar(seg.buffer);
+    seg.buffer = NULL;
+    seg.usado = seg.capacidade = 0;
+    seg.ativo = false;
+    return consumidos;
+}
+
+bool seguimentoPassagensAtivo(void) {
+    return seg.ativo;
+}
+
+size_t passagensRecebidasSeguimento(void) {
+    return __atomic_load_n(&seg.recebidas, __ATOMIC_RELAXED);
+}
+
+#else // _WIN32: sem inotify nem pthreads
+
+bool iniciarSeguimentoPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens, size_t offsetInicial) {
+    (void)nomeFicheiro; (void)listaPassagens; (void)offsetInicial;
+    printf("O modo de seguimento nao esta disponivel em Windows.\n");
+    return false;
+}
+
+size_t pararSeguimentoPassagens(void) {
+    return 0;
+}
+
+bool seguimentoPassagensAtivo(void) {
+    return false;
+}
+
+size_t passagensRecebidasSeguimento(void) {
+    return 0;
+}
+
+#endif
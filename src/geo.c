@@ -0,0 +1,112 @@
+#include <stdio.h>      // snprintf
+#include <string.h>     // memcpy
+#include <math.h>       // NAN, isnan (macros, sem libm)
+#include "geo.h"
+#include "tokenizer.h"
+
+/**
+ * @brief Converte o texto de uma coordenada em graus decimais.
+ * Aceita até três números (graus, minutos, segundos) separados por quaisquer
+ * símbolos (º ’ ’’ , espaços) e uma letra de hemisfério.
+ *
+ * @param ini
+ * @param fim
+ * @param latitude true para validar contra ±90º, false para ±180º
+ * @param graus Recebe o valor
+ * @return bool false se o texto não for uma coordenada válida
+ */
+bool parsearCoordenada(const char* ini, const char* fim, bool latitude, double* graus) {
+    double partes[3] = { 0, 0, 0 };
+    int n = 0;
+    bool negativo = false;
+
+    for (const char* p = ini; p < fim; ) {
+        char c = *p;
+        if ((c >= '0' && c <= '9') || c == '.') {
+            if (n == 3) return false;
+            const char* q = p;
+            while (q < fim && ((*q >= '0' && *q <= '9') || *q == '.')) q++;
+            Campo numero = { p, q };
+            partes[n++] = campoDecimal(numero);
+            p = q;
+            continue;
+        }
+        if (c == '-' && n == 0)                        negativo = true;
+        else if (c == 'S' || c == 'W' || c == 'O')     negativo = true;
+        else if (c == 'N' || c == 'E')                 ;
+        else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) return false;
+        p++;
+    }
+    if (n == 0 || partes[1] >= 60 || partes[2] >= 60) return false;
+
+    double valor = partes[0] + partes[1] / 60.0 + partes[2] / 3600.0;
+    if (valor > (latitude ? 90.0 : 180.0)) return false;
+    *graus = negativo ? -valor : valor;
+    return true;
+}
+
+/**
+ * @brief Escreve uma coordenada em graus, minutos e segundos, no estilo de
+ * sensores.txt (ex.: "32º N, 22’, 56’’").
+ *
+ * @param graus
+ * @param latitude Escolhe o hemisfério (N/S ou E/W)
+ * @param destino
+ * @param tamanho
+ */
+void formatarCoordenada(double graus, bool latitude, char* destino, size_t tamanho) {
+    if (isnan(graus)) {
+        snprintf(destino, tamanho, "?");
+        return;
+    }
+    char hemisferio = latitude ? (graus < 0 ? 'S' : 'N') : (graus < 0 ? 'W' : 'E');
+    long segundos = (long)((graus < 0 ? -graus : graus) * 3600.0 + 0.5);
+    snprintf(destino, tamanho, "%ldº %c, %02ld’, %02ld’’",
+             segundos / 3600, hemisferio, segundos / 60 % 60, segundos % 60);
+}
+
+/**
+ * @brief Cópia de um texto para a arena (terminada em '\0').
+ *
+ * @param arena
+ * @param texto
+ * @param n
+ * @return const char* NULL se faltar memória
+ */
+static const char* copiarTexto(Arena* arena, const char* texto, size_t n) {
+    char* copia = arena_alloc(arena, n + 1);
+    if (!copia) return NULL;
+    memcpy(copia, texto, n);
+    copia[n] = '\0';
+    return copia;
+}
+
+/**
+ * @brief Preenche as coordenadas de um sensor a partir do texto. O texto é
+ * copiado para a arena com SENSOR_GUARDAR_TEXTO ou quando não é reconhecido
+ * (para não se perder informação); o valor fica NAN nesse último caso.
+ *
+ * @param sensor
+ * @param arena
+ * @param latitude
+ * @param nLatitude
+ * @param longitude
+ * @param nLongitude
+ * @return bool false se faltar memória
+ */
+bool definirCoordenadasSensor(Sensor* sensor, Arena* arena, const char* latitude, size_t nLatitude,
+                              const char* longitude, size_t nLongitude) {
+    bool latOk = parsearCoordenada(latitude, latitude + nLatitude, true, &sensor->latitude);
+    bool lonOk = parsearCoordenada(longitude, longitude + nLongitude, false, &sensor->longitude);
+    if (!latOk) sensor->latitude = NAN;
+    if (!lonOk) sensor->longitude = NAN;
+
+    sensor->latitudeTexto = sensor->longitudeTexto = NULL;
+    if (SENSOR_GUARDAR_TEXTO || !latOk) {
+        if (!(sensor->latitudeTexto = copiarTexto(arena, latitude, nLatitude))) return false;
+    }
+    if (SENSOR_GUARDAR_TEXTO || !lonOk) {
+        if (!(sensor->longitudeTexto = copiarTexto(arena, longitude, nLongitude))) return false;
+    }
+    return true;
+}
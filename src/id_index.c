@@ -0,0 +1,186 @@
+#include <stdio.h>      // printf, fprintf
+#include <stdint.h>     // uint32_t, uint64_t
+#include "id_index.h"
+
+IndiceIds indiceCarros = INDICE_IDS_INIT("Carros");
+IndiceIds indiceDonos  = INDICE_IDS_INIT("Donos");
+
+/**
+ * @brief Posição da tabela onde está a chave, ou a posição livre onde deve ser
+ * inserida. A posição inicial são os log2(numPosicoes) bits altos de uma
+ * dispersão multiplicativa (Fibonacci) de 64 bits, por isso cobre a tabela
+ * inteira seja qual for o seu tamanho.
+ *
+ * @param idx Com tabela alocada
+ * @param chave
+ * @return size_t
+ */
+static size_t posicaoChave(const IndiceIds* idx, int chave) {
+    size_t mascara = idx->numPosicoes - 1;
+    size_t i = (size_t)(((uint64_t)(uint32_t)chave * 0x9E3779B97F4A7C15ull) >> idx->deslocamento);
+    while (idx->tabela[i].valor != NULL && idx->tabela[i].chave != chave)
+        i = (i + 1) & mascara;
+    return i;
+}
+
+/**
+ * @brief Duplica a tabela e volta a inserir todas as entradas.
+ *
+ * @param idx
+ * @return bool false se faltar memória
+ */
+static bool crescerTabela(IndiceIds* idx) {
+    size_t nova = idx->numPosicoes ? idx->numPosicoes * 2 : INDICE_IDS_POSICOES_INICIAIS;
+    EntradaIndiceIds* tabela = memoria_alocarZeros(MEMORIA_INDICES, nova, sizeof(EntradaIndiceIds));
+    if (!tabela) return false;
+
+    EntradaIndiceIds* antiga = idx->tabela;
+    size_t numAntigas = idx->numPosicoes;
+    idx->tabela = tabela;
+    idx->numPosicoes = nova;
+    idx->deslocamento = 64;
+    for (size_t n = nova; n > 1; n >>= 1) idx->deslocamento--;
+    for (size_t i = 0; i < numAntigas; i++) {
+        if (antiga[i].valor != NULL)
+            idx->tabela[posicaoChave(idx, antiga[i].chave)] = antiga[i];
+    }
+    memoria_libertar(antiga);
+    return true;
+}
+
+/**
+ * @brief Acrescenta uma chave que ainda não está no índice.
+ *
+ * @param idx
+ * @param chave
+ * @param valor Não pode ser NULL
+ * @param ordem
+ * @return bool false se faltar memória
+ */
+static bool inserirEntrada(IndiceIds* idx, int chave, void* valor, int ordem) {
+    if ((idx->total + 1) * 2 > idx->numPosicoes && !crescerTabela(idx))
+        return false;
+    size_t i = posicaoChave(idx, chave);
+    idx->tabela[i] = (EntradaIndiceIds){ chave, ordem, valor };
+    idx->total++;
+    return true;
+}
+
+/**
+ * @brief Regista um nó acabado de pôr à cabeça da lista (a chave tem de ser
+ * nova). O índice só é atualizado se refletir a lista anterior ou se esta
+ * estiver vazia; se faltar memória é descartado e as pesquisas voltam a ser
+ * lineares.
+ *
+ * @param idx
+ * @param chave
+ * @param no Nova cabeça da lista
+ * @param anterior Cabeça anterior (o next de 'no')
+ * @return bool true se o índice continua a refletir a lista
+ */
+bool indiceIds_inserirCabeca(IndiceIds* idx, int chave, void* no, const void* anterior) {
+    if (anterior == NULL) indiceIds_libertar(idx);
+    else if (!indiceIds_valido(idx, anterior)) return false;
+
+    if (!inserirEntrada(idx, chave, no, idx->primeiraOrdem - 1)) {
+        indiceIds_libertar(idx);
+        return false;
+    }
+    idx->primeiraOrdem--;
+    idx->cabeca = no;
+    return true;
+}
+
+/**
+ * @brief Valor associado à chave.
+ *
+ * @param idx
+ * @param chave
+ * @return void* NULL se a chave não existir
+ */
+void* indiceIds_procurar(const IndiceIds* idx, int chave) {
+    if (idx->total == 0) return NULL;
+    return idx->tabela[posicaoChave(idx, chave)].valor;
+}
+
+/**
+ * @brief Posição (a contar de 0) do nó com a chave na lista indexada.
+ *
+ * @param idx
+ * @param chave
+ * @return int -1 se a chave não existir
+ */
+int indiceIds_posicao(const IndiceIds* idx, int chave) {
+    if (idx->total == 0) return -1;
+    const EntradaIndiceIds* e = &idx->tabela[posicaoChave(idx, chave)];
+    return e->valor ? e->ordem - idx->primeiraOrdem : -1;
+}
+
+/**
+ * @brief Liberta a tabela e deixa o índice vazio (reutilizável).
+ *
+ * @param idx
+ */
+void indiceIds_libertar(IndiceIds* idx) {
+    memoria_libertar(idx->tabela);
+    idx->tabela = NULL;
+    idx->numPosicoes = 0;
+    idx->deslocamento = 64;
+    idx->total = 0;
+    idx->primeiraOrdem = 0;
+    idx->cabeca = NULL;
+}
+
+void indiceIds_imprimirEstatisticas(const IndiceIds* idx) {
+    printf("Indice %s: %zu chaves em %zu posicoes (%zu bytes)\n",
+           idx->nome ? idx->nome : "(indice)", idx->total, idx->numPosicoes,
+           idx->numPosicoes * sizeof(EntradaIndiceIds));
+}
+
+/**
+ * @brief Sem memória para um índice: fica vazio e as pesquisas são lineares.
+ *
+ * @param idx
+ * @return bool false
+ */
+static bool desistirIndice(IndiceIds* idx) {
+    fprintf(stderr, "Sem memoria para o indice de %s; a usar pesquisa linear.\n", idx->nome);
+    indiceIds_libertar(idx);
+    return false;
+}
+
+/**
+ * @brief (Re)constrói o índice idVeiculo -> nó a partir da lista de carros.
+ *
+ * @param idx
+ * @param lista
+ * @return bool false se faltar memória
+ */
+bool indiceCarros_construir(IndiceIds* idx, NodeCarro* lista) {
+    indiceIds_libertar(idx);
+    int ordem = 0;
+    for (NodeCarro* p = lista; p; p = p->next, ordem++) {
+        if (indiceIds_procurar(idx, p->carro.idVeiculo)) continue; // fica o primeiro, como na pesquisa linear
+        if (!inserirEntrada(idx, p->carro.idVeiculo, p, ordem)) return desistirIndice(idx);
+    }
+    idx->cabeca = lista;
+    return true;
+}
+
+/**
+ * @brief (Re)constrói o índice NIF -> nó a partir da lista de donos.
+ *
+ * @param idx
+ * @param lista
+ * @return bool false se faltar memória
+ */
+bool indiceDonos_construir(IndiceIds* idx, NodeDono* lista) {
+    indiceIds_libertar(idx);
+    int ordem = 0;
+    for (NodeDono* p = lista; p; p = p->next, ordem++) {
+        if (indiceIds_procurar(idx, p->dono.numeroContribuinte)) continue;
+        if (!inserirEntrada(idx, p->dono.numeroContribuinte, p, ordem)) return desistirIndice(idx);
+    }
+    idx->cabeca = lista;
+    return true;
+}
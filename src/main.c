@@ -3,9 +3,24 @@
 #include <string.h> 
 #include <time.h>
 #include <locale.h>
+#include <sys/stat.h>
 #include "data.h"
 #include "read_files.h"
 #include "operations.h"
+#include "snapshot.h"
+#include "follow.h"
+#include "decompress.h"
+#include "columns.h"
+#include "dictionary.h"
+#include "memory.h"
+#include "segment.h"
+#include "id_index.h"
+#include "distance_matrix.h"
+#include "vehicle_groups.h"
+#include "postal_index.h"
+#include "plate_index.h"
+#include "name_index.h"
+#include "attribute_index.h"
 
 #ifdef _WIN32
   #include <windows.h>
@@ -53,6 +68,10 @@ int mostrarMenu() {
     printf(" 20. Calcular memoria total ocupada\n");                              // Req 4
     printf(" 21. Exportar dados para CSV\n");                                    // Req 17
     printf(" 22. Exportar dados para XML\n");                                    // Req 18
+    printf(" 23. Gravar snapshot binario da base de dados\n");
+    printf(" 24. %s seguimento de passagem.txt (%zu passagens recebidas)\n",
+           seguimentoPassagensAtivo() ? "Desativar" : "Ativar", passagensRecebidasSeguimento());
+    printf(" 25. Arquivar passagens antigas (segmento comprimido)\n");
     printf("\n 0. Sair\n");
     printf("---------------------------------------------\n");
     printf("Escolha uma opcao: ");
@@ -81,12 +100,38 @@ int main(void) {
     NodeDistancia* distancias = NULL;
     NodePassagem* passagens  = NULL;
 
+    const char* nomesFontes[NUM_FONTES] = {
+        [FONTE_DONOS]      = "Dados-Portagens-Trab-Pratico/donos.txt",
+        [FONTE_CARROS]     = "Dados-Portagens-Trab-Pratico/carros.txt",
+        [FONTE_SENSORES]   = "Dados-Portagens-Trab-Pratico/sensores.txt",
+        [FONTE_DISTANCIAS] = "Dados-Portagens-Trab-Pratico/distancias.txt",
+        [FONTE_PASSAGENS]  = "passagem.txt"
+    };
+    // Se um ficheiro só existir comprimido (ex.: passagem.txt.zst), é lido através do descompressor
+    char caminhosFontes[NUM_FONTES][256];
+    const char* fontes[NUM_FONTES];
+    for (int i = 0; i < NUM_FONTES; i++) {
+        fontes[i] = procurarVersaoComprimida(nomesFontes[i], caminhosFontes[i], sizeof caminhosFontes[i])
+                        ? caminhosFontes[i] : nomesFontes[i];
+    }
+
+    size_t offsetPassagens = 0; // bytes de passagem.txt já carregados (início do modo de seguimento)
+
     printf("A carregar base de dados...\n");
-    lerDonos("Dados-Portagens-Trab-Pratico/donos.txt", &donos);
-    lerCarros("Dados-Portagens-Trab-Pratico/carros.txt", &carros);
-    lerSensores("Dados-Portagens-Trab-Pratico/sensores.txt", &sensores);
-    lerDistancias("Dados-Portagens-Trab-Pratico/distancias.txt", &distancias);
-    lerPassagens("passagem.txt", &passagens);
+    // As passagens já arquivadas ficam no segmento (mapeado) e são ignoradas na leitura
+    if (segmento_abrir(&segmentoPassagens, SEGMENTO_FICHEIRO))
+        segmento_imprimirEstatisticas(&segmentoPassagens);
+    // Se houver um snapshot mais recente do que os ficheiros de texto, evita o parsing
+    if (snapshotAtualizado(SNAPSHOT_FICHEIRO, fontes, NUM_FONTES, &offsetPassagens) &&
+        carregarSnapshot(SNAPSHOT_FICHEIRO, &donos, &carros, &sensores, &distancias, &passagens)) {
+        // Linhas acrescentadas a passagem.txt depois do snapshot
+        offsetPassagens = lerPassagensDesde(fontes[FONTE_PASSAGENS], &passagens, offsetPassagens);
+    } else {
+        // Os cinco ficheiros são independentes: carregados em paralelo
+        offsetPassagens = carregarBaseDados(fontes, &donos, &carros, &sensores, &distancias, &passagens);
+    }
+    grupos_sincronizar(&gruposPassagens, passagens); // passagens agrupadas por veículo para as consultas
+    indiceAtributos_sincronizar(&indiceAtributos, donos, carros); // bitmaps para os filtros dos rankings
     printf("Dados carregados com sucesso.\n");
     esperarEnter();
 
@@ -95,6 +140,8 @@ int main(void) {
     do {
         opcao = mostrarMenu();
         time_t inicio, fim; // Variáveis para períodos de tempo
+        // Com o modo de seguimento ativo a thread pode publicar a cabeça (lista vazia)
+        NodePassagem* listaPassagens = passagem_cabeca(&passagens);
 
         switch (opcao) {
             case 1: registarDono(&donos); break;
@@ -103,7 +150,14 @@ int main(void) {
                 break;
             case 3: registarSensor(&sensores); break;
             case 4: registarDistancia(&distancias, sensores); break;
-            case 5: registarPassagem(&passagens, sensores, carros); break;
+            case 5:
+                // A thread de seguimento também escreve na cabeça da lista quando está vazia
+                if (seguimentoPassagensAtivo()) {
+                    printf("Desative o seguimento de %s antes de registar passagens.\n", fontes[FONTE_PASSAGENS]);
+                    break;
+                }
+                registarPassagem(&passagens, sensores, carros);
+                break;
             case 6: 
                 // Se quiser implementar listagem por NIF, seria aqui
                 // Por agora, pode chamar a imprimirListaDonos que tem (ordem de registo)
@@ -116,19 +170,22 @@ int main(void) {
             case 10: 
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    listarVeiculosPorPeriodo(passagens, carros, inicio, fim);
+                    listarVeiculosPorPeriodo(listaPassagens, carros, inicio, fim);
                 }
                 break;
             case 11: 
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    rankingVeiculos(passagens, distancias, inicio, fim);
+                    rankingVeiculos(listaPassagens, distancias, inicio, fim);
                 }
                 break;
-            case 12:
+            case 12: {
                 obterPeriodoTempo(&inicio, &fim);
-                rankingPorMarca(passagens, distancias, carros, inicio, fim);
+                FiltroCarros filtro;
+                lerFiltroCarros(&filtro);
+                rankingPorMarca(listaPassagens, distancias, carros, inicio, fim, &filtro);
                 break;
+            }
             case 13: // Marca mais comum
                 determinarMarcaMaisComum(carros);
                 break;
@@ -137,48 +194,121 @@ int main(void) {
             case 14: 
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    listarInfracoes(carros, passagens, distancias, inicio, fim);
+                    listarInfracoes(carros, listaPassagens, distancias, inicio, fim);
                 }
                 break;
             // case 15 para ranking infrações (antigo 11)
             case 15: 
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    rankingInfraVeiculos(passagens, distancias, carros, inicio, fim);
+                    rankingInfraVeiculos(listaPassagens, distancias, carros, inicio, fim);
                 }
                 break;
             // ... e assim por diante
             case 16: // Velocidades médias por veículo (antigo 12)
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    velocidadesMedias(passagens, distancias, carros, inicio, fim);
+                    velocidadesMedias(listaPassagens, distancias, carros, inicio, fim);
                 }
                 break;
             case 17: // Ranking de marcas por velocidade média (antigo 13)
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    rankingMarcasVelocidade(carros, passagens, distancias, inicio, fim);
+                    FiltroCarros filtro;
+                    lerFiltroCarros(&filtro);
+                    rankingMarcasVelocidade(carros, listaPassagens, distancias, inicio, fim, &filtro);
                 }
                 break;
             case 18: // Ranking de donos por velocidade média (antigo 14)
                 obterPeriodoTempo(&inicio, &fim);
                 if (inicio != -1 && fim != -1) {
-                    rankingDonosVelocidade(donos, carros, passagens, distancias, inicio, fim);
+                    FiltroCarros filtro;
+                    lerFiltroCarros(&filtro);
+                    rankingDonosVelocidade(donos, carros, listaPassagens, distancias, inicio, fim, &filtro);
                 }
                 break;
-            case 19: // Determinar marca mais comum (antigo 15)
-                determinarMarcaMaisComum(carros);
+            case 19: { // Velocidade média por código postal (antigo 15)
+                char codigo[DONO_MAX_CODIGOPOSTAL + 1];
+                printf("Codigo postal (ex: 4000-123, ou 4000-* para um prefixo): ");
+                scanf(" %10[^\n]", codigo);
+                limparBufferInput();
+                clock_t t0 = clock();
+                double velocidade = velocidadeMediaPorCodigoPostal(codigo, donos, carros, listaPassagens, distancias);
+                double tempo = (double)(clock() - t0) / CLOCKS_PER_SEC;
+                if (velocidade < 0)
+                    printf("Sem viagens validas para o codigo postal %s.\n", codigo);
+                else
+                    printf("Velocidade media em %s: %.2f km/h (Tempo: %.3f s)\n", codigo, velocidade, tempo);
                 break;
+            }
 
             case 20: // Calcular memória (antigo 16)
-                printf("Memoria total ocupada: %zu bytes\n", calcularMemoriaTotal(donos, carros, sensores, distancias, passagens));
+                printf("Memoria total ocupada: %zu bytes\n\n", calcularMemoriaTotal());
+                memoria_imprimirRelatorio();
+                printf("\nArenas:\n");
+                arena_imprimirEstatisticas(&arenaDonos);
+                arena_imprimirEstatisticas(&arenaCarros);
+                arena_imprimirEstatisticas(&dicionarioMarcas.arena);
+                arena_imprimirEstatisticas(&dicionarioModelos.arena);
+                arena_imprimirEstatisticas(&arenaSensores);
+                arena_imprimirEstatisticas(&arenaDistancias);
+                arena_imprimirEstatisticas(&arenaPassagens);
+                printf("Heap de nomes dos donos: %zu bytes usados / %zu reservados\n",
+                       heapNomesDonos.tamanho, heapNomesDonos.capacidade);
+                colunas_imprimirEstatisticas(&colunasPassagens);
+                indiceIds_imprimirEstatisticas(&indiceDonos);
+                indiceNomes_imprimirEstatisticas(&indiceNomes);
+                indiceIds_imprimirEstatisticas(&indiceCarros);
+                indiceMatriculas_imprimirEstatisticas(&indiceMatriculas);
+                matrizDistancias_imprimirEstatisticas(&matrizDistancias);
+                indicePostal_imprimirEstatisticas(&indicePostal);
+                indiceAtributos_imprimirEstatisticas(&indiceAtributos);
+                grupos_imprimirEstatisticas(&gruposPassagens);
+                segmento_imprimirEstatisticas(&segmentoPassagens);
+                if (memoria_exportar(MEMORIA_FICHEIRO))
+                    printf("Contadores gravados em %s\n", MEMORIA_FICHEIRO);
                 break;
             case 21: // Exportar CSV (antigo 17)
-                exportarDadosCSV(donos, carros, sensores, distancias, passagens);
+                exportarDadosCSV(donos, carros, sensores, distancias, listaPassagens);
                 break;
             case 22: // Exportar XML (antigo 18)
-                exportarDadosXML(donos, carros, sensores, distancias, passagens);
+                exportarDadosXML(donos, carros, sensores, distancias, listaPassagens);
+                break;
+            case 23:
+                if (seguimentoPassagensAtivo()) {
+                    printf("Desative o seguimento de %s antes de gravar o snapshot.\n", fontes[FONTE_PASSAGENS]);
+                    break;
+                }
+                gravarSnapshot(SNAPSHOT_FICHEIRO, donos, carros, sensores, distancias, listaPassagens,
+                               fontes[FONTE_PASSAGENS], offsetPassagens);
+                break;
+            case 24:
+                if (seguimentoPassagensAtivo()) {
+                    offsetPassagens = pararSeguimentoPassagens();
+                    printf("Seguimento de %s desativado.\n", fontes[FONTE_PASSAGENS]);
+                } else if (iniciarSeguimentoPassagens(fontes[FONTE_PASSAGENS], &passagens, offsetPassagens)) {
+                    printf("A seguir %s: as novas passagens sao acrescentadas em segundo plano.\n", fontes[FONTE_PASSAGENS]);
+                }
+                break;
+            case 25: {
+                if (seguimentoPassagensAtivo()) {
+                    printf("Desative o seguimento de %s antes de arquivar passagens.\n", fontes[FONTE_PASSAGENS]);
+                    break;
+                }
+                char dataStr[30];
+                printf("Arquivar as passagens ate (DD-MM-AAAA HH:MM:SS): ");
+                scanf(" %29[^\n]", dataStr);
+                limparBufferInput();
+                time_t corte = parseTimestamp(dataStr);
+                if (corte == -1) {
+                    printf("Formato de data invalido.\n");
+                } else if (arquivarPassagens(SEGMENTO_FICHEIRO, &passagens, (long long)corte * 1000 + 999) > 0 &&
+                           remove(SNAPSHOT_FICHEIRO) == 0) {
+                    // O snapshot ainda tinha as passagens arquivadas na lista
+                    printf("Snapshot %s removido (desatualizado).\n", SNAPSHOT_FICHEIRO);
+                }
                 break;
+            }
             case 0:
                 printf("A sair do programa...\n");
                 break;
@@ -194,11 +324,13 @@ int main(void) {
     } while (opcao != 0);
 
     // --- Libertação de Memória (Finalizar Programa) ---
+    pararSeguimentoPassagens(); // a thread de seguimento não pode continuar a escrever na lista
     libertarListaDonos(&donos);
     libertarListaCarros(&carros);
     libertarListaSensores(&sensores);
     libertarListaDistancias(&distancias);
     libertarListaPassagens(&passagens);
+    segmento_fechar(&segmentoPassagens);
 
     printf("Programa terminado.\n");
     return 0;
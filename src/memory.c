@@ -0,0 +1,285 @@
+#include <stdio.h>      // printf, fopen
+#include <stdlib.h>     // malloc, realloc, free
+#ifndef _WIN32
+#include <unistd.h>     // sysconf
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>     // malloc_usable_size
+#endif
+#include "memory.h"
+
+/**
+ * @brief Cabeçalho posto antes de cada alocação: guarda os bytes contabilizados
+ * e o subsistema, para que memoria_libertar() não precise de os receber.
+ * O tamanho é múltiplo do alinhamento máximo, pelo que o bloco devolvido
+ * fica alinhado como o de um malloc normal.
+ *
+ */
+typedef union {
+    struct {
+        size_t bytes;
+        int    subsistema;
+    } info;
+    max_align_t alinhamento;
+} CabecalhoMemoria;
+
+// Contadores globais: as threads de carregamento alocam em paralelo, por isso
+// são sempre atualizados com operações atómicas.
+static size_t    bytesAtuais[MEMORIA_NUM_SUBSISTEMAS];
+static size_t    bytesPico[MEMORIA_NUM_SUBSISTEMAS];
+static long long bytesFolga[MEMORIA_NUM_SUBSISTEMAS];
+static size_t    numAlocacoes[MEMORIA_NUM_SUBSISTEMAS];
+static size_t    totalAtual;
+static size_t    totalPico;
+
+static const char* const nomesSubsistemas[MEMORIA_NUM_SUBSISTEMAS] = {
+    "Dados", "Indices", "Leitura", "Consultas", "Exportacao"
+};
+
+/**
+ * @brief Bytes que o alocador reservou de facto para um bloco (o pedido
+ * arredondado, mais o cabeçalho interno do malloc).
+ *
+ * @param base
+ * @param pedidos
+ * @return size_t
+ */
+static size_t bytesAlocador(void* base, size_t pedidos) {
+#ifdef __GLIBC__
+    (void)pedidos;
+    return malloc_usable_size(base) + sizeof(size_t);
+#else
+    (void)base;
+    return pedidos;
+#endif
+}
+
+/**
+ * @brief Atualiza um pico com o valor atual, se este for maior.
+ *
+ * @param pico
+ * @param valor
+ */
+static void atualizarPico(size_t* pico, size_t valor) {
+    size_t anterior = __atomic_load_n(pico, __ATOMIC_RELAXED);
+    while (valor > anterior &&
+           !__atomic_compare_exchange_n(pico, &anterior, valor, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+static void contabilizar(int subsistema, size_t bytes) {
+    size_t atual = __atomic_add_fetch(&bytesAtuais[subsistema], bytes, __ATOMIC_RELAXED);
+    size_t total = __atomic_add_fetch(&totalAtual, bytes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&numAlocacoes[subsistema], 1, __ATOMIC_RELAXED);
+    atualizarPico(&bytesPico[subsistema], atual);
+    atualizarPico(&totalPico, total);
+}
+
+static void descontar(int subsistema, size_t bytes) {
+    __atomic_sub_fetch(&bytesAtuais[subsistema], bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&totalAtual, bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&numAlocacoes[subsistema], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Preenche o cabeçalho de um bloco acabado de alocar e contabiliza-o.
+ *
+ * @param base
+ * @param subsistema
+ * @param bytes Bytes pedidos (sem o cabeçalho)
+ * @return void* Memória para o chamador
+ */
+static void* registarBloco(CabecalhoMemoria* base, int subsistema, size_t bytes) {
+    base->info.bytes      = bytesAlocador(base, sizeof(CabecalhoMemoria) + bytes);
+    base->info.subsistema = subsistema;
+    contabilizar(subsistema, base->info.bytes);
+    return base + 1;
+}
+
+/**
+ * @brief malloc contabilizado no subsistema indicado. A memória tem de ser
+ * libertada com memoria_libertar() (nunca com free()).
+ *
+ * @param subsistema
+ * @param bytes
+ * @return void* NULL se faltar memória
+ */
+void* memoria_alocar(SubsistemaMemoria subsistema, size_t bytes) {
+    if (bytes > (size_t)-1 - sizeof(CabecalhoMemoria)) return NULL;
+    CabecalhoMemoria* base = malloc(sizeof(CabecalhoMemoria) + bytes);
+    return base ? registarBloco(base, subsistema, bytes) : NULL;
+}
+
+/**
+ * @brief calloc contabilizado no subsistema indicado.
+ *
+ * @param subsistema
+ * @param quantidade
+ * @param tamanho
+ * @return void* NULL se faltar memória
+ */
+void* memoria_alocarZeros(SubsistemaMemoria subsistema, size_t quantidade, size_t tamanho) {
+    if (tamanho && quantidade > ((size_t)-1 - sizeof(CabecalhoMemoria)) / tamanho) return NULL;
+    CabecalhoMemoria* base = calloc(1, sizeof(CabecalhoMemoria) + quantidade * tamanho);
+    return base ? registarBloco(base, subsistema, quantidade * tamanho) : NULL;
+}
+
+/**
+ * @brief realloc contabilizado. O bloco mantém o subsistema com que foi
+ * alocado; 'subsistema' só é usado quando p é NULL.
+ *
+ * @param subsistema
+ * @param p
+ * @param bytes
+ * @return void* NULL se faltar memória (p continua válido)
+ */
+void* memoria_realocar(SubsistemaMemoria subsistema, void* p, size_t bytes) {
+    if (!p) return memoria_alocar(subsistema, bytes);
+    if (bytes > (size_t)-1 - sizeof(CabecalhoMemoria)) return NULL;
+
+    CabecalhoMemoria* base = (CabecalhoMemoria*)p - 1;
+    int    sub      = base->info.subsistema;
+    size_t anterior = base->info.bytes;
+    CabecalhoMemoria* novo = realloc(base, sizeof(CabecalhoMemoria) + bytes);
+    if (!novo) return NULL;
+    descontar(sub, anterior);
+    return registarBloco(novo, sub, bytes);
+}
+
+/**
+ * @brief Liberta um bloco obtido com memoria_alocar/alocarZeros/realocar.
+ *
+ * @param p Pode ser NULL
+ */
+void memoria_libertar(void* p) {
+    if (!p) return;
+    CabecalhoMemoria* base = (CabecalhoMemoria*)p - 1;
+    descontar(base->info.subsistema, base->info.bytes);
+    free(base);
+}
+
+/**
+ * @brief Passa um bloco para outro subsistema (ex.: a arena de uma thread de
+ * leitura que é juntada à arena global).
+ *
+ * @param p
+ * @param subsistema
+ */
+void memoria_transferir(void* p, SubsistemaMemoria subsistema) {
+    if (!p) return;
+    CabecalhoMemoria* base = (CabecalhoMemoria*)p - 1;
+    if (base->info.subsistema == (int)subsistema) return;
+    descontar(base->info.subsistema, base->info.bytes);
+    base->info.subsistema = subsistema;
+    contabilizar(subsistema, base->info.bytes);
+}
+
+/**
+ * @brief Soma 'delta' à folga de um subsistema (memória reservada que ainda não
+ * foi usada). Chamada pelas arenas e pelos arrays que crescem por duplicação.
+ *
+ * @param subsistema
+ * @param delta
+ */
+void memoria_ajustarFolga(SubsistemaMemoria subsistema, long long delta) {
+    __atomic_add_fetch(&bytesFolga[subsistema], delta, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Contadores atuais de um subsistema.
+ *
+ * @param subsistema
+ * @param estatisticas
+ */
+void memoria_estatisticas(SubsistemaMemoria subsistema, EstatisticasMemoria* estatisticas) {
+    long long folga = __atomic_load_n(&bytesFolga[subsistema], __ATOMIC_RELAXED);
+    estatisticas->atual     = __atomic_load_n(&bytesAtuais[subsistema], __ATOMIC_RELAXED);
+    estatisticas->pico      = __atomic_load_n(&bytesPico[subsistema], __ATOMIC_RELAXED);
+    estatisticas->folga     = folga > 0 ? (size_t)folga : 0;
+    estatisticas->alocacoes = __atomic_load_n(&numAlocacoes[subsistema], __ATOMIC_RELAXED);
+}
+
+size_t memoria_totalAtual(void) {
+    return __atomic_load_n(&totalAtual, __ATOMIC_RELAXED);
+}
+
+size_t memoria_totalPico(void) {
+    return __atomic_load_n(&totalPico, __ATOMIC_RELAXED);
+}
+
+const char* memoria_nomeSubsistema(SubsistemaMemoria subsistema) {
+    return subsistema < MEMORIA_NUM_SUBSISTEMAS ? nomesSubsistemas[subsistema] : "?";
+}
+
+/**
+ * @brief Memória residente do processo, lida de /proc/self/statm.
+ *
+ * @return size_t Bytes, ou 0 se não estiver disponível
+ */
+size_t memoria_rss(void) {
+#ifndef _WIN32
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if (!fp) return 0;
+    unsigned long paginas = 0, residentes = 0;
+    int lidos = fscanf(fp, "%lu %lu", &paginas, &residentes);
+    fclose(fp);
+    if (lidos != 2) return 0;
+    long tamanhoPagina = sysconf(_SC_PAGESIZE);
+    return tamanhoPagina > 0 ? (size_t)residentes * (size_t)tamanhoPagina : 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Mostra os contadores de cada subsistema e compara o total com o RSS.
+ *
+ */
+void memoria_imprimirRelatorio(void) {
+    printf("%-12s %14s %14s %14s %10s\n", "Subsistema", "Atual (B)", "Pico (B)", "Folga (B)", "Alocacoes");
+    size_t folgaTotal = 0;
+    for (int s = 0; s < MEMORIA_NUM_SUBSISTEMAS; s++) {
+        EstatisticasMemoria e;
+        memoria_estatisticas(s, &e);
+        folgaTotal += e.folga;
+        printf("%-12s %14zu %14zu %14zu %10zu\n", nomesSubsistemas[s], e.atual, e.pico, e.folga, e.alocacoes);
+    }
+    size_t atual = memoria_totalAtual();
+    printf("%-12s %14zu %14zu %14zu\n", "Total", atual, memoria_totalPico(), folgaTotal);
+
+    size_t rss = memoria_rss();
+    if (rss == 0) {
+        printf("RSS do processo: indisponivel\n");
+        return;
+    }
+    // O RSS inclui código, pilhas e bibliotecas, mas não as páginas reservadas que
+    // nunca foram tocadas; por isso a diferença pode ter qualquer sinal.
+    printf("RSS do processo: %zu bytes (contabilizado = %.1f%% do RSS, diferenca %+lld bytes)\n",
+           rss, 100.0 * (double)atual / (double)rss, (long long)rss - (long long)atual);
+}
+
+/**
+ * @brief Grava os contadores num CSV (uma linha por subsistema, mais o total e o RSS),
+ * para ser lido por scripts de dimensionamento.
+ *
+ * @param nomeFicheiro
+ * @return bool false se não foi possível escrever o ficheiro
+ */
+bool memoria_exportar(const char* nomeFicheiro) {
+    FILE* fp = fopen(nomeFicheiro, "w");
+    if (!fp) {
+        perror("Erro ao criar ficheiro de memoria");
+        return false;
+    }
+    fprintf(fp, "Subsistema,Atual,Pico,Folga,Alocacoes\n");
+    size_t folgaTotal = 0, alocacoesTotal = 0;
+    for (int s = 0; s < MEMORIA_NUM_SUBSISTEMAS; s++) {
+        EstatisticasMemoria e;
+        memoria_estatisticas(s, &e);
+        folgaTotal += e.folga;
+        alocacoesTotal += e.alocacoes;
+        fprintf(fp, "%s,%zu,%zu,%zu,%zu\n", nomesSubsistemas[s], e.atual, e.pico, e.folga, e.alocacoes);
+    }
+    fprintf(fp, "Total,%zu,%zu,%zu,%zu\n", memoria_totalAtual(), memoria_totalPico(), folgaTotal, alocacoesTotal);
+    fprintf(fp, "RSS,%zu,,,\n", memoria_rss());
+    return fclose(fp) == 0;
+}
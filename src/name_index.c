@@ -0,0 +1,304 @@
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // qsort
+#include <string.h>     // strcmp, strncmp, strlen, memcpy, memmove
+#include "name_index.h"
+#include "memory.h"
+
+IndiceNomes indiceNomes = INDICE_NOMES_INIT;
+
+/**
+ * @brief Letra base de U+00C0..U+00FF (0xC3 0x80..0xBF em UTF-8), em minúscula.
+ * '*' = sem equivalente (× e ÷), os bytes ficam como estão.
+ *
+ */
+static const char letrasBase[64] =
+    "aaaaaaaceeeeiiiidnooooo*ouuuuyts"
+    "aaaaaaaceeeeiiiidnooooo*ouuuuyty";
+
+/**
+ * @brief Normaliza um nome para pesquisa: minúsculas, sem acentos (UTF-8
+ * latino), espaços seguidos reduzidos a um e sem espaços nas pontas.
+ * O resultado nunca é mais comprido do que o texto.
+ *
+ * @param texto
+ * @param destino
+ * @param tamanho Tamanho do destino
+ * @return size_t Comprimento do resultado
+ */
+size_t nome_normalizar(const char* texto, char* destino, size_t tamanho) {
+    size_t n = 0;
+    bool espaco = false;
+    for (const unsigned char* p = (const unsigned char*)texto; *p && n + 1 < tamanho; p++) {
+        if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            espaco = n > 0;
+            continue;
+        }
+        if (espaco) {
+            destino[n++] = ' ';
+            espaco = false;
+            if (n + 1 >= tamanho) break;
+        }
+        if (*p >= 'A' && *p <= 'Z') {
+            destino[n++] = (char)(*p - 'A' + 'a');
+        } else if (*p == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF && letrasBase[p[1] - 0x80] != '*') {
+            destino[n++] = letrasBase[*++p - 0x80];
+        } else {
+            destino[n++] = (char)*p;
+        }
+    }
+    destino[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Diz se o nome, ou uma das suas palavras, começa pela consulta
+ * (já normalizada). Versão linear da pesquisa do índice.
+ *
+ * @param nome
+ * @param consulta
+ * @return bool
+ */
+bool nome_corresponde(const char* nome, const char* consulta) {
+    char normalizado[DONO_MAX_NOME];
+    nome_normalizar(nome, normalizado, sizeof normalizado);
+    size_t comprimento = strlen(consulta);
+    for (const char* p = normalizado; p; p = strchr(p, ' ')) {
+        if (*p == ' ') p++;
+        if (strncmp(p, consulta, comprimento) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Garante espaço para n entradas e mais 'texto' bytes de nomes.
+ *
+ * @param idx
+ * @param n
+ * @param texto
+ * @return bool false se faltar memória
+ */
+static bool reservar(IndiceNomes* idx, size_t n, size_t texto) {
+    if (n > idx->capacidade) {
+        size_t nova = idx->capacidade ? idx->capacidade : INDICE_NOMES_CAPACIDADE_MIN;
+        while (nova < n) nova *= 2;
+        EntradaNome* entradas = memoria_realocar(MEMORIA_INDICES, idx->entradas, nova * sizeof *entradas);
+        if (!entradas) return false;
+        memoria_ajustarFolga(MEMORIA_INDICES, (long long)((nova - idx->capacidade) * sizeof *entradas));
+        idx->entradas = entradas;
+        idx->capacidade = nova;
+    }
+    texto += idx->tamanhoTextos;
+    if (texto > idx->capacidadeTextos) {
+        if (texto > UINT32_MAX) return false;
+        size_t nova = idx->capacidadeTextos ? idx->capacidadeTextos : INDICE_NOMES_CAPACIDADE_MIN * 8;
+        while (nova < texto) nova *= 2;
+        char* textos = memoria_realocar(MEMORIA_INDICES, idx->textos, nova);
+        if (!textos) return false;
+        memoria_ajustarFolga(MEMORIA_INDICES, (long long)(nova - idx->capacidadeTextos));
+        idx->textos = textos;
+        idx->capacidadeTextos = nova;
+    }
+    return true;
+}
+
+/**
+ * @brief Acrescenta o nome normalizado de um dono aos textos e as entradas
+ * das suas palavras ao fim do array (por ordenar). Requer reservar().
+ *
+ * @param idx
+ * @param no
+ * @param normalizado
+ * @param comprimento
+ * @param ordem
+ * @return size_t Número de entradas acrescentadas
+ */
+static size_t acrescentar(IndiceNomes* idx, NodeDono* no, const char* normalizado, size_t comprimento, int ordem) {
+    uint32_t inicio = (uint32_t)idx->tamanhoTextos;
+    memcpy(idx->textos + inicio, normalizado, comprimento + 1);
+    idx->tamanhoTextos += comprimento + 1;
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)(comprimento + 1));
+
+    size_t n = 0;
+    for (size_t i = 0; i < comprimento; i++) {
+        if (i > 0 && normalizado[i - 1] != ' ') continue;
+        idx->entradas[idx->total + n++] = (EntradaNome){ inicio + (uint32_t)i, ordem, no };
+    }
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)(n * sizeof *idx->entradas));
+    return n;
+}
+
+static size_t palavras(const char* normalizado, size_t comprimento) {
+    size_t n = comprimento > 0;
+    for (size_t i = 0; i < comprimento; i++)
+        if (normalizado[i] == ' ') n++;
+    return n;
+}
+
+static const char* textosOrdenacao; // qsort não passa contexto
+
+static int cmpEntradas(const void* a, const void* b) {
+    const EntradaNome* e1 = a;
+    const EntradaNome* e2 = b;
+    int c = strcmp(textosOrdenacao + e1->texto, textosOrdenacao + e2->texto);
+    if (c != 0) return c;
+    return e1->ordem < e2->ordem ? -1 : e1->ordem > e2->ordem;
+}
+
+/**
+ * @brief (Re)constrói o índice a partir da lista de donos.
+ *
+ * @param idx
+ * @param lista
+ * @return bool false se faltar memória (o índice fica vazio e as pesquisas são lineares)
+ */
+bool indiceNomes_construir(IndiceNomes* idx, NodeDono* lista) {
+    indiceNomes_libertar(idx);
+    if (!lista) return true;
+
+    // Primeira passagem só mede, para reservar tudo de uma vez
+    char normalizado[DONO_MAX_NOME];
+    size_t numDonos = 0, numEntradas = 0, texto = 0;
+    for (NodeDono* p = lista; p; p = p->next, numDonos++) {
+        size_t comprimento = nome_normalizar(nomeDono(&p->dono), normalizado, sizeof normalizado);
+        numEntradas += palavras(normalizado, comprimento);
+        texto += comprimento + 1;
+    }
+    if (numDonos > INT32_MAX || !reservar(idx, numEntradas, texto)) {
+        fprintf(stderr, "Sem memoria para o indice de nomes; a usar pesquisa linear.\n");
+        indiceNomes_libertar(idx);
+        return false;
+    }
+
+    int ordem = 0;
+    for (NodeDono* p = lista; p; p = p->next, ordem++) {
+        size_t comprimento = nome_normalizar(nomeDono(&p->dono), normalizado, sizeof normalizado);
+        idx->total += acrescentar(idx, p, normalizado, comprimento, ordem);
+    }
+    textosOrdenacao = idx->textos;
+    qsort(idx->entradas, idx->total, sizeof *idx->entradas, cmpEntradas);
+    idx->numDonos = numDonos;
+    idx->cabeca = lista;
+    return true;
+}
+
+/**
+ * @brief Primeira entrada cujo texto, limitado a 'comprimento' caracteres,
+ * não é menor do que a chave.
+ *
+ * @param idx
+ * @param chave
+ * @param comprimento
+ * @param incluirIguais false para saltar também os iguais (limite superior)
+ * @return size_t
+ */
+static size_t limite(const IndiceNomes* idx, const char* chave, size_t comprimento, bool incluirIguais) {
+    size_t lo = 0, hi = idx->total;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        int c = strncmp(idx->textos + idx->entradas[meio].texto, chave, comprimento);
+        if (c < 0 || (c == 0 && !incluirIguais)) lo = meio + 1; else hi = meio;
+    }
+    return lo;
+}
+
+/**
+ * @brief Regista um dono acabado de pôr à cabeça da lista. Se o índice não
+ * refletia a lista anterior nada muda.
+ *
+ * @param idx
+ * @param no Nova cabeça da lista
+ * @return bool true se o índice reflete a nova lista
+ */
+bool indiceNomes_inserirCabeca(IndiceNomes* idx, NodeDono* no) {
+    if (no->next == NULL) return indiceNomes_construir(idx, no);
+    if (!indiceNomes_valido(idx, no->next)) return false;
+
+    char normalizado[DONO_MAX_NOME];
+    size_t comprimento = nome_normalizar(nomeDono(&no->dono), normalizado, sizeof normalizado);
+    size_t n = palavras(normalizado, comprimento);
+    if (idx->primeiraOrdem == INT32_MIN || !reservar(idx, idx->total + n, comprimento + 1)) {
+        fprintf(stderr, "Sem memoria para o indice de nomes; a usar pesquisa linear.\n");
+        indiceNomes_libertar(idx);
+        return false;
+    }
+
+    // As novas entradas ficam no fim e cada uma vai para antes dos textos
+    // iguais (o dono novo é o primeiro da lista)
+    acrescentar(idx, no, normalizado, comprimento, --idx->primeiraOrdem);
+    for (size_t k = 0; k < n; k++) {
+        EntradaNome e = idx->entradas[idx->total]; // a próxima por inserir
+        const char* texto = idx->textos + e.texto;
+        size_t pos = limite(idx, texto, strlen(texto) + 1, true);
+        memmove(idx->entradas + pos + 1, idx->entradas + pos, (idx->total - pos) * sizeof *idx->entradas);
+        idx->entradas[pos] = e;
+        idx->total++;
+    }
+    idx->numDonos++;
+    idx->cabeca = no;
+    return true;
+}
+
+static int cmpOrdem(const void* a, const void* b) {
+    const EntradaNome* e1 = *(const EntradaNome* const*)a;
+    const EntradaNome* e2 = *(const EntradaNome* const*)b;
+    return e1->ordem < e2->ordem ? -1 : e1->ordem > e2->ordem;
+}
+
+/**
+ * @brief Donos cujo nome, ou uma palavra dele, começa pela consulta (sem
+ * distinguir maiúsculas nem acentos; um '*' final é ignorado).
+ *
+ * @param idx Válido
+ * @param consulta
+ * @param resultados Entradas de donos distintos, pela ordem da lista
+ *                   (libertar com memoria_libertar; NULL se não houver nenhum)
+ * @return size_t Número de donos (0 também se faltar memória)
+ */
+size_t indiceNomes_pesquisar(const IndiceNomes* idx, const char* consulta, const EntradaNome*** resultados) {
+    char chave[DONO_MAX_NOME];
+    size_t comprimento = nome_normalizar(consulta, chave, sizeof chave);
+    if (comprimento > 0 && chave[comprimento - 1] == '*') chave[--comprimento] = '\0';
+    if (comprimento > 0 && chave[comprimento - 1] == ' ') chave[--comprimento] = '\0';
+    *resultados = NULL;
+    if (comprimento == 0) return 0;
+
+    size_t primeira = limite(idx, chave, comprimento, true);
+    size_t ultima   = limite(idx, chave, comprimento, false);
+    if (primeira == ultima) return 0;
+
+    const EntradaNome** encontrados = memoria_alocar(MEMORIA_CONSULTAS, (ultima - primeira) * sizeof *encontrados);
+    if (!encontrados) {
+        fprintf(stderr, "Erro: falta de memória na pesquisa de nomes.\n");
+        return 0;
+    }
+    for (size_t i = primeira; i < ultima; i++)
+        encontrados[i - primeira] = &idx->entradas[i];
+    qsort(encontrados, ultima - primeira, sizeof *encontrados, cmpOrdem);
+
+    // Um dono pode corresponder em mais de uma palavra ("silva ... silva")
+    size_t n = 0;
+    for (size_t i = 0; i < ultima - primeira; i++)
+        if (n == 0 || encontrados[n - 1]->ordem != encontrados[i]->ordem)
+            encontrados[n++] = encontrados[i];
+    *resultados = encontrados;
+    return n;
+}
+
+/**
+ * @brief Liberta o índice e deixa-o vazio (reutilizável).
+ *
+ * @param idx
+ */
+void indiceNomes_libertar(IndiceNomes* idx) {
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)((idx->capacidade - idx->total) * sizeof *idx->entradas));
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)(idx->capacidadeTextos - idx->tamanhoTextos));
+    memoria_libertar(idx->entradas);
+    memoria_libertar(idx->textos);
+    *idx = (IndiceNomes)INDICE_NOMES_INIT;
+}
+
+void indiceNomes_imprimirEstatisticas(const IndiceNomes* idx) {
+    printf("Indice de nomes: %zu donos, %zu palavras (%zu bytes)\n",
+           idx->numDonos, idx->total,
+           idx->capacidade * sizeof(EntradaNome) + idx->capacidadeTextos);
+}
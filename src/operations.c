@@ -7,6 +7,7 @@
 
 #include <ctype.h>
 #include <time.h>
+#include <limits.h>
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -17,6 +18,19 @@
 
 
 #include "operations.h"
+#include "columns.h"
+#include "dictionary.h"
+#include "geo.h"
+#include "postal.h"
+#include "segment.h"
+#include "id_index.h"
+#include "distance_matrix.h"
+#include "time_index.h"
+#include "vehicle_groups.h"
+#include "postal_index.h"
+#include "plate_index.h"
+#include "name_index.h"
+#include "attribute_index.h"
 
 // --- Funções Auxiliares para o Menu ---
 
@@ -57,6 +71,65 @@ void obterPeriodoTempo(time_t* inicio, time_t* fim) {
     }
 }
 
+/**
+ * @brief Lê um filtro opcional por atributos dos carros (marca, modelo, anos
+ * de fabrico e distrito do código postal do dono). Enter deixa o campo livre.
+ *
+ * @param filtro Fica FILTRO_CARROS_INIT se o utilizador não quiser filtrar
+ */
+void lerFiltroCarros(FiltroCarros* filtro) {
+    char buffer[CARRO_MAX_MARCA > CARRO_MAX_MODELO ? CARRO_MAX_MARCA : CARRO_MAX_MODELO];
+    *filtro = (FiltroCarros)FILTRO_CARROS_INIT;
+
+    lerString("Filtrar por atributos dos carros? (s/n): ", buffer, sizeof(buffer));
+    if (buffer[0] != 's' && buffer[0] != 'S') return;
+
+    lerString("Marca (Enter = qualquer): ", buffer, sizeof(buffer));
+    if (buffer[0] != '\0') {
+        filtro->marca = dicionario_procurar(&dicionarioMarcas, buffer, strlen(buffer));
+        if (filtro->marca < 0) {
+            printf("Aviso: a marca '%s' nao existe; nenhum carro corresponde.\n", buffer);
+            filtro->marca = FILTRO_NENHUM;
+        }
+    }
+    lerString("Modelo (Enter = qualquer): ", buffer, sizeof(buffer));
+    if (buffer[0] != '\0') {
+        filtro->modelo = dicionario_procurar(&dicionarioModelos, buffer, strlen(buffer));
+        if (filtro->modelo < 0) {
+            printf("Aviso: o modelo '%s' nao existe; nenhum carro corresponde.\n", buffer);
+            filtro->modelo = FILTRO_NENHUM;
+        }
+    }
+    lerString("Ano de fabrico minimo (Enter = qualquer): ", buffer, sizeof(buffer));
+    if (sscanf(buffer, "%d", &filtro->anoMin) != 1) filtro->anoMin = INT_MIN;
+    lerString("Ano de fabrico maximo (Enter = qualquer): ", buffer, sizeof(buffer));
+    if (sscanf(buffer, "%d", &filtro->anoMax) != 1) filtro->anoMax = INT_MAX;
+    lerString("Distrito do codigo postal do dono (ex: 4 para 4000-123; Enter = qualquer): ", buffer, sizeof(buffer));
+    if (sscanf(buffer, "%d", &filtro->distrito) != 1 || filtro->distrito < 0) filtro->distrito = FILTRO_QUALQUER;
+}
+
+/**
+ * @brief Carros que satisfazem o filtro, pelos bitmaps do indiceAtributos.
+ *
+ * @param filtro NULL ou inativo = todos (o conjunto fica vazio e não é usado)
+ * @param listaCarros
+ * @param selecionados Vazio
+ * @return bool false (já com mensagem) se não for possível aplicar o filtro
+ */
+static bool selecionarCarros(const FiltroCarros* filtro, const NodeCarro* listaCarros, Bitmap* selecionados) {
+    if (!filtroCarros_ativo(filtro)) return true;
+    if (!indiceAtributos_valido(&indiceAtributos, listaCarros)) {
+        printf("Erro: o indice de atributos nao esta disponivel para esta lista de carros.\n");
+        return false;
+    }
+    if (!indiceAtributos_resolver(&indiceAtributos, filtro, selecionados)) {
+        printf("Erro ao alocar memoria para o filtro de carros.\n");
+        return false;
+    }
+    printf("Filtro: %llu veiculos selecionados.\n", (unsigned long long)bitmap_cardinalidade(selecionados));
+    return true;
+}
+
 /**
  * @brief Motor de paginação genérico para qualquer tipo de lista.
  * * @param lista Apontador genérico para o nó inicial da lista.
@@ -80,7 +153,7 @@ void paginarListaGenerica(void* lista, int totalItems, size_t tamanhoItem,
     }
 
     // 1. Converter a lista ligada para um array de ponteiros para acesso rápido
-    void** arrayDePonteiros = malloc(totalItems * sizeof(void*));
+    void** arrayDePonteiros = memoria_alocar(MEMORIA_CONSULTAS, totalItems * sizeof(void*));
     if (!arrayDePonteiros) {
         printf("Erro ao alocar memoria para paginacao.\n");
         return;
@@ -140,7 +213,7 @@ void paginarListaGenerica(void* lista, int totalItems, size_t tamanhoItem,
         }
     } while (opcao != 'e');
 
-    free(arrayDePonteiros);
+    memoria_libertar(arrayDePonteiros);
 }
 
 // --- Donos ---
@@ -172,27 +245,82 @@ void* obterNextDono(void* no) { return ((NodeDono*)no)->next; }
  */
 void imprimirItemDono(void* item, int indice) {
     NodeDono* p = (NodeDono*)item;
+    char codigoPostal[DONO_MAX_CODIGOPOSTAL];
+    formatarCodigoPostal(p->dono.codigoPostal, codigoPostal, sizeof(codigoPostal));
     printf("%4d) NIF=%-9d | Nome=\"%s\" | CP=%s\n",
-           indice, p->dono.numeroContribuinte, p->dono.nome, p->dono.codigoPostal);
+           indice, p->dono.numeroContribuinte, nomeDono(&p->dono), codigoPostal);
 }
 
 /**
- * @brief 
+ * @brief Pesquisa por nome, ou parte dele ("Clotilde Nasc", "nasc"), na lista
+ * principal através do indiceNomes; noutras (ex.: a cópia ordenada por nome)
+ * percorre-a.
+ *
+ * @param lista
+ * @param consulta
+ * @return int Número de donos encontrados
+ */
+static int pesquisarDonoPorNome(NodeDono* lista, const char* consulta) {
+    int encontrados = 0;
+    if (indiceNomes_valido(&indiceNomes, lista)) {
+        const EntradaNome** resultados;
+        size_t n = indiceNomes_pesquisar(&indiceNomes, consulta, &resultados);
+        for (size_t i = 0; i < n; i++) {
+            int posicao = indiceNomes_posicao(&indiceNomes, resultados[i]);
+            printf("--> Encontrado no indice %d:\n", posicao + 1);
+            imprimirItemDono(resultados[i]->dono, posicao + 1);
+        }
+        memoria_libertar(resultados);
+        encontrados = (int)n;
+    } else {
+        char chave[DONO_MAX_NOME];
+        size_t comprimento = nome_normalizar(consulta, chave, sizeof chave);
+        if (comprimento > 0 && chave[comprimento - 1] == '*') chave[--comprimento] = '\0';
+        if (comprimento > 0 && chave[comprimento - 1] == ' ') chave[--comprimento] = '\0';
+        int i = 0;
+        for (NodeDono* p = lista; p && comprimento > 0; p = p->next, i++) {
+            if (nome_corresponde(nomeDono(&p->dono), chave)) {
+                printf("--> Encontrado no indice %d:\n", i + 1);
+                imprimirItemDono(p, i + 1);
+                encontrados++;
+            }
+        }
+    }
+    if (encontrados == 0)
+        printf("Nenhum dono encontrado com o nome '%s'.\n", consulta);
+    return encontrados;
+}
+
+/**
+ * @brief Pesquisa por NIF (só algarismos) ou por nome.
  * 
  * @param lista 
  * @param termo 
- * @return int 
+ * @return int Número de donos encontrados
  */
 int pesquisarDono(void* lista, const char* termo) {
-    char buffer[20];
+    char buffer[DONO_MAX_NOME];
     int nifBusca;
-    printf("\nDigite o NIF a procurar: ");
-    lerString("", buffer, sizeof(buffer));
+    lerString("\nDigite o NIF ou o nome (ou parte dele) a procurar: ", buffer, sizeof(buffer));
+    if (buffer[0] == '\0' || buffer[strspn(buffer, "0123456789")] != '\0')
+        return pesquisarDonoPorNome((NodeDono*)lista, buffer);
     if (sscanf(buffer, "%d", &nifBusca) != 1) {
         printf("NIF invalido.\n");
         return 0;
     }
     
+    if (indiceIds_valido(&indiceDonos, lista)) {
+        int posicao = indiceIds_posicao(&indiceDonos, nifBusca);
+        if (posicao >= 0) {
+            printf("--> Encontrado no indice %d:\n", posicao + 1);
+            imprimirItemDono(indiceIds_procurar(&indiceDonos, nifBusca), posicao + 1);
+            return 1;
+        }
+        printf("Nenhum dono encontrado com o NIF %d.\n", nifBusca);
+        return 0;
+    }
+
+    // Lista sem índice (ex.: a cópia ordenada por nome)
     int i = 0;
     for (NodeDono* p = (NodeDono*)lista; p; p = p->next, i++) {
         if (p->dono.numeroContribuinte == nifBusca) {
@@ -255,30 +383,48 @@ void* obterNextCarro(void* no) { return ((NodeCarro*)no)->next; }
 void imprimirItemCarro(void* item, int indice) {
     NodeCarro* p = (NodeCarro*)item;
     printf("%4d) Mat=%-9s | Marca=%-15s | Modelo=%-15s | Ano=%d | DonoNIF=%d\n",
-           indice, p->carro.matricula, p->carro.marca, p->carro.modelo, p->carro.ano, p->carro.donoContribuinte);
+           indice, p->carro.matricula, marcaCarro(&p->carro), modeloCarro(&p->carro), p->carro.ano, p->carro.donoContribuinte);
 }
 
 /**
- * @brief 
+ * @brief Pesquisa por matrícula exata ou por prefixo ("06-FK-*"). Na lista
+ * principal usa o indiceMatriculas; noutras (ex.: a cópia ordenada) percorre-a.
  * 
  * @param lista 
  * @param termo 
- * @return int 
+ * @return int Número de carros encontrados
  */
 int pesquisarCarro(void* lista, const char* termo) {
     char matriculaBusca[CARRO_MAX_MATRICULA];
-    lerString("\nDigite a matricula a procurar: ", matriculaBusca, sizeof(matriculaBusca));
+    lerString("\nDigite a matricula a procurar (ou prefixo terminado em *): ", matriculaBusca, sizeof(matriculaBusca));
+    bool exata;
+    size_t comprimento = matricula_padrao(matriculaBusca, &exata);
     
-    int i = 0;
-    for (NodeCarro* p = (NodeCarro*)lista; p; p = p->next, i++) {
-        if (strcmp(p->carro.matricula, matriculaBusca) == 0) {
-            printf("--> Encontrado no indice %d:\n", i + 1);
-            imprimirItemCarro(p, i + 1);
-            return 1;
+    int encontrados = 0;
+    if (indiceMatriculas_valido(&indiceMatriculas, lista)) {
+        IntervaloMatriculas intervalo;
+        indiceMatriculas_intervalo(&indiceMatriculas, matriculaBusca, comprimento, &intervalo);
+        for (const EntradaMatricula* e; (e = indiceMatriculas_seguinte(&intervalo)) != NULL; ) {
+            int posicao = indiceMatriculas_posicao(&indiceMatriculas, e);
+            printf("--> Encontrado no indice %d:\n", posicao + 1);
+            imprimirItemCarro(e->carro, posicao + 1);
+            encontrados++;
+            if (exata) break; // só a primeira, como na lista
+        }
+    } else {
+        int i = 0;
+        for (NodeCarro* p = (NodeCarro*)lista; p; p = p->next, i++) {
+            if (strncmp(p->carro.matricula, matriculaBusca, comprimento) == 0) {
+                printf("--> Encontrado no indice %d:\n", i + 1);
+                imprimirItemCarro(p, i + 1);
+                encontrados++;
+                if (exata) break;
+            }
         }
     }
-    printf("Nenhum carro encontrado com a matricula %s.\n", matriculaBusca);
-    return 0;
+    if (encontrados == 0)
+        printf("Nenhum carro encontrado com a matricula %s.\n", matriculaBusca);
+    return encontrados;
 }
 
 /**
@@ -333,12 +479,13 @@ void* obterNextSensor(void* no) {
  */
 void imprimirItemSensor(void* item, int indice) {
     NodeSensor* p = (NodeSensor*)item;
+    char lat[GEO_MAX_TEXTO], lon[GEO_MAX_TEXTO];
     printf("%4d) ID=%-3d | Designacao: %-25s | Lat: %-20s | Lon: %s\n",
            indice, 
            p->sensor.idSensor,
            p->sensor.designacao,
-           p->sensor.latitude,
-           p->sensor.longitude);
+           textoCoordenada(p->sensor.latitudeTexto, p->sensor.latitude, true, lat, sizeof(lat)),
+           textoCoordenada(p->sensor.longitudeTexto, p->sensor.longitude, false, lon, sizeof(lon)));
 }
 
 /**
@@ -501,7 +648,7 @@ void imprimirListaDistancias(NodeDistancia* lista) {
  */
 int contarPassagens(NodePassagem* lista) {
     int count = 0;
-    for (NodePassagem* p = lista; p; p = p->next) count++;
+    for (NodePassagem* p = lista; p; p = passagem_seguinte(p)) count++;
     return count;
 }
 /**
@@ -511,7 +658,7 @@ int contarPassagens(NodePassagem* lista) {
  * @return void* 
  */
 void* obterNextPassagem(void* no) { 
-    return ((NodePassagem*)no)->next; 
+    return passagem_seguinte(no); 
 }
 
 /**
@@ -550,7 +697,7 @@ int pesquisarPassagem(void* lista, const char* termo) {
     int i = 0;
     int encontrados = 0;
     printf("Passagens encontradas para o Veiculo ID %d:\n", idVeiculoBusca);
-    for (NodePassagem* p = (NodePassagem*)lista; p; p = p->next, i++) {
+    for (NodePassagem* p = (NodePassagem*)lista; p; p = passagem_seguinte(p), i++) {
         if (p->passagem.idVeiculo == idVeiculoBusca) {
             imprimirItemPassagem(p, i + 1); // Mostra o índice global, mas não é crucial para a pesquisa
             encontrados++;
@@ -590,14 +737,15 @@ void imprimirListaPassagens(NodePassagem* lista) {
  * @param lista 
  */
 void libertarListaDonos(NodeDono** lista) {
-    NodeDono *atual = *lista, *seguinte;
     int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
+    for (NodeDono* p = *lista; p; p = p->next)
         cont++;
-    }
+    arena_libertar(&arenaDonos); // todos os nós da lista principal vivem nesta arena
+    indiceIds_libertar(&indiceDonos);
+    indiceNomes_libertar(&indiceNomes);
+    indicePostal_libertar(&indicePostal);
+    indiceAtributos_libertar(&indiceAtributos);
+    strings_libertar(&heapNomesDonos);
     *lista = NULL;
     printf("\nMemória de %d nós Dono libertada.\n", cont);
 }
@@ -610,14 +758,16 @@ void libertarListaDonos(NodeDono** lista) {
  * @param lista 
  */
 void libertarListaCarros(NodeCarro** lista) {
-    NodeCarro *atual = *lista, *seguinte;
     int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
+    for (NodeCarro* p = *lista; p; p = p->next)
         cont++;
-    }
+    arena_libertar(&arenaCarros); // todos os nós da lista principal vivem nesta arena
+    indiceIds_libertar(&indiceCarros);
+    indiceMatriculas_libertar(&indiceMatriculas);
+    indicePostal_libertar(&indicePostal);
+    indiceAtributos_libertar(&indiceAtributos);
+    dicionario_libertar(&dicionarioMarcas);
+    dicionario_libertar(&dicionarioModelos);
     *lista = NULL;
     printf("\nMemória de %d nós Carro libertada.\n", cont);
 }
@@ -630,14 +780,10 @@ void libertarListaCarros(NodeCarro** lista) {
  * @param lista 
  */
 void libertarListaSensores(NodeSensor** lista) {
-    NodeSensor *atual = *lista, *seguinte;
     int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
+    for (NodeSensor* p = *lista; p; p = p->next)
         cont++;
-    }
+    arena_libertar(&arenaSensores); // todos os nós da lista principal vivem nesta arena
     *lista = NULL;
     printf("\nMemória de %d nós Sensor libertada.\n", cont);
 }
@@ -650,64 +796,41 @@ void libertarListaSensores(NodeSensor** lista) {
  * @param lista 
  */
 void libertarListaDistancias(NodeDistancia** lista) {
-    NodeDistancia *atual = *lista, *seguinte;
     int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
+    for (NodeDistancia* p = *lista; p; p = p->next)
         cont++;
-    }
+    arena_libertar(&arenaDistancias); // todos os nós da lista principal vivem nesta arena
+    matrizDistancias_libertar(&matrizDistancias);
     *lista = NULL;
     printf("\nMemória de %d nós Distancia libertada.\n", cont);
 }
 
 
-// Funçao para determinar a memoria ocupada por todas as estruturas do programa
-size_t calcularMemoriaTotal(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor* listaSensores, NodeDistancia* listaDistancias, NodePassagem* listaPassagens) {
-    size_t memoriaTotal = 0;
-    for (NodeDono* p = listaDonos; p; p = p->next) {
-        memoriaTotal += sizeof(NodeDono);
-    }
-
-    // Calcular memória ocupada pela lista de carros
-    for (NodeCarro* p = listaCarros; p; p = p->next) {
-        memoriaTotal += sizeof(NodeCarro);
-    }
-
-    // Calcular memória ocupada pela lista de sensores
-    for (NodeSensor* p = listaSensores; p; p = p->next) {
-        memoriaTotal += sizeof(NodeSensor);
-    }
-
-    // Calcular memória ocupada pela lista de distâncias
-    for (NodeDistancia* p = listaDistancias; p; p = p->next) {
-        memoriaTotal += sizeof(NodeDistancia);
-    }
-
-    // Calcular memória ocupada pela lista de passagens
-    for (NodePassagem* p = listaPassagens; p; p = p->next) {
-        memoriaTotal += sizeof(NodePassagem);
-    }
-
-    return memoriaTotal;
+/**
+ * @brief Memória ocupada pelo programa, tal como o alocador a vê: todas as
+ * alocações contabilizadas (listas, índices, buffers e memória temporária),
+ * incluindo o cabeçalho de cada bloco e a capacidade ainda por usar das arenas.
+ * 
+ * @return size_t Bytes
+ */
+size_t calcularMemoriaTotal(void) {
+    return memoria_totalAtual();
 }
 
 
 /**
- * @brief 
+ * @brief Liberta a lista principal de passagens (a arenaPassagens inteira).
  * 
  * @param lista 
  */
 void libertarListaPassagens(NodePassagem** lista) {
-    NodePassagem *atual = *lista, *seguinte;
     int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
+    for (NodePassagem* p = *lista; p; p = p->next)
         cont++;
-    }
+    arena_libertar(&arenaPassagens); // todos os nós da lista principal vivem nesta arena
+    colunas_libertar(&colunasPassagens);
+    indiceTemporal_libertar(&indiceTemporal);
+    grupos_libertar(&gruposPassagens);
     *lista = NULL;
     printf("\nMemória de %d nós Passagem libertada.\n", cont);
 }
@@ -770,7 +893,7 @@ int comparar_matricula(const Carro *a, const Carro *b) {
  * @return int 
  */
 int comparar_marca(const Carro *a, const Carro *b) {
-    return strcmp(a->marca, b->marca);
+    return strcmp(marcaCarro(a), marcaCarro(b));
 }
 
 /**
@@ -781,7 +904,7 @@ int comparar_marca(const Carro *a, const Carro *b) {
  * @return int 
  */
 int comparar_modelo(const Carro *a, const Carro *b) {
-    return strcmp(a->modelo, b->modelo);
+    return strcmp(modeloCarro(a), modeloCarro(b));
 }
 
 /**
@@ -860,8 +983,8 @@ void mostrar_veiculos_periodo(Passagem passagens[], int total_passagens, Carro c
     for (int i = 0; i < totalEncontrados; i++) {
         printf("Matrícula: %s\tMarca: %s\tModelo: %s\n",
                encontrados[i].matricula,
-               encontrados[i].marca,
-               encontrados[i].modelo);
+               marcaCarro(&encontrados[i]),
+               modeloCarro(&encontrados[i]));
     }
 
     if (totalEncontrados == 0) {
@@ -912,18 +1035,27 @@ void registarDono(NodeDono** listaDonos) {
         }
     } while (!validarCodigoPostal(codigoPostal));
 
-    // Alocar e inserir o novo dono
-    NodeDono* novo = malloc(sizeof(NodeDono));
+    // Alocar e inserir o novo dono (o nome primeiro: se falhar, não fica um nó
+    // sem nome na arena)
+    RefString refNome;
+    if (!strings_adicionar(&heapNomesDonos, nome, strlen(nome), &refNome)) {
+        printf("Erro critico: Falha ao alocar memoria.\n");
+        return;
+    }
+    NodeDono* novo = arena_alloc(&arenaDonos, sizeof(NodeDono));
     if (!novo) {
         printf("Erro critico: Falha ao alocar memoria.\n");
         return;
     }
 
     novo->dono.numeroContribuinte = nif;
-    strcpy(novo->dono.nome, nome);
-    strcpy(novo->dono.codigoPostal, codigoPostal);
+    novo->dono.nome = refNome;
+    novo->dono.codigoPostal = empacotarCodigoPostal(codigoPostal, strlen(codigoPostal));
     novo->next = *listaDonos;
     *listaDonos = novo;
+    indiceIds_inserirCabeca(&indiceDonos, nif, novo, novo->next);
+    indiceNomes_inserirCabeca(&indiceNomes, novo);
+    indiceAtributos_inserirDono(&indiceAtributos, novo);
 
     printf("\nDono '%s' registado com sucesso!\n", nome);
 }
@@ -946,14 +1078,16 @@ void registarCarro(NodeCarro** listaCarros, NodeDono* listaDonos) {
         lerString("Matricula (XX-XX-XX ou XX-NN-XX ou NN-XX-NN): ", novoCarro.matricula, sizeof(novoCarro.matricula));
         if (!validarMatricula(novoCarro.matricula)) { // Supondo que validarMatricula foi melhorada
             printf("Erro: Formato de matricula invalido.\n");
-        } else if (/* Lógica para verificar se matrícula já existe */ false) {
-             // Pode adicionar uma função pesquisarCarroPorMatricula se quiser garantir unicidade
+        } else if (pesquisarCarroPorMatricula(*listaCarros, novoCarro.matricula) != NULL) {
+            printf("Erro: A matricula %s ja esta registada.\n", novoCarro.matricula);
+            novoCarro.matricula[0] = '\0';
         }
     } while (!validarMatricula(novoCarro.matricula));
 
-    // Validar Marca e Modelo
-    do { lerString("Marca: ", novoCarro.marca, sizeof(novoCarro.marca)); } while (strlen(novoCarro.marca) == 0);
-    do { lerString("Modelo: ", novoCarro.modelo, sizeof(novoCarro.modelo)); } while (strlen(novoCarro.modelo) == 0);
+    // Validar Marca e Modelo (guardados como códigos dos dicionários)
+    char marca[CARRO_MAX_MARCA], modelo[CARRO_MAX_MODELO];
+    do { lerString("Marca: ", marca, sizeof(marca)); } while (strlen(marca) == 0);
+    do { lerString("Modelo: ", modelo, sizeof(modelo)); } while (strlen(modelo) == 0);
 
     // Validar Ano
     do {
@@ -988,12 +1122,17 @@ void registarCarro(NodeCarro** listaCarros, NodeDono* listaDonos) {
         }
     } while (novoCarro.idVeiculo == 0);
 
-    NodeCarro* novoNode = malloc(sizeof(NodeCarro));
-    if (!novoNode) { printf("Erro critico: Falha ao alocar memoria.\n"); return; }
+    novoCarro.codigoMarca  = dicionario_codigo(&dicionarioMarcas, marca, strlen(marca));
+    novoCarro.codigoModelo = dicionario_codigo(&dicionarioModelos, modelo, strlen(modelo));
+    NodeCarro* novoNode = arena_alloc(&arenaCarros, sizeof(NodeCarro));
+    if (!novoNode || novoCarro.codigoMarca < 0 || novoCarro.codigoModelo < 0) { printf("Erro critico: Falha ao alocar memoria.\n"); return; }
 
     novoNode->carro = novoCarro;
     novoNode->next = *listaCarros;
     *listaCarros = novoNode;
+    indiceIds_inserirCabeca(&indiceCarros, novoCarro.idVeiculo, novoNode, novoNode->next);
+    indiceMatriculas_inserirCabeca(&indiceMatriculas, novoNode);
+    indiceAtributos_inserirCarro(&indiceAtributos, novoNode, listaDonos);
 
     printf("\nCarro com matricula %s registado com sucesso!\n", novoCarro.matricula);
 }
@@ -1007,6 +1146,8 @@ void registarCarro(NodeCarro** listaCarros, NodeDono* listaDonos) {
  */
 void registarSensor(NodeSensor** listaSensores) {
     char buffer[SENSOR_MAX_DESIGNACAO];
+    char latitude[SENSOR_MAX_LATITUDE], longitude[SENSOR_MAX_LONGITUDE];
+    double graus;
     Sensor novoSensor;
 
     printf("\n--- Registar Novo Sensor ---\n");
@@ -1025,12 +1166,29 @@ void registarSensor(NodeSensor** listaSensores) {
 
     // Validar Designação, Latitude e Longitude (não podem estar vazios)
     do { lerString("Designacao: ", novoSensor.designacao, sizeof(novoSensor.designacao)); } while (strlen(novoSensor.designacao) == 0);
-    do { lerString("Latitude (texto): ", novoSensor.latitude, sizeof(novoSensor.latitude)); } while (strlen(novoSensor.latitude) == 0);
-    do { lerString("Longitude (texto): ", novoSensor.longitude, sizeof(novoSensor.longitude)); } while (strlen(novoSensor.longitude) == 0);
+    // Coordenadas em graus/minutos/segundos (ex.: 41º N, 08’, 45’’) ou decimais (ex.: 41.1458)
+    do {
+        lerString("Latitude (texto): ", latitude, sizeof(latitude));
+        if (!parsearCoordenada(latitude, latitude + strlen(latitude), true, &graus)) {
+            printf("Erro: Latitude invalida.\n");
+            latitude[0] = '\0';
+        }
+    } while (strlen(latitude) == 0);
+    do {
+        lerString("Longitude (texto): ", longitude, sizeof(longitude));
+        if (!parsearCoordenada(longitude, longitude + strlen(longitude), false, &graus)) {
+            printf("Erro: Longitude invalida.\n");
+            longitude[0] = '\0';
+        }
+    } while (strlen(longitude) == 0);
 
     // Alocar e inserir o novo sensor
-    NodeSensor *novoNode = malloc(sizeof(NodeSensor));
-    if (!novoNode) { printf("Erro critico: Falha ao alocar memoria.\n"); return; }
+    NodeSensor *novoNode = arena_alloc(&arenaSensores, sizeof(NodeSensor));
+    if (!novoNode || !definirCoordenadasSensor(&novoSensor, &arenaSensores, latitude, strlen(latitude),
+                                               longitude, strlen(longitude))) {
+        printf("Erro critico: Falha ao alocar memoria.\n");
+        return;
+    }
 
     novoNode->sensor = novoSensor;
     novoNode->next = *listaSensores;
@@ -1091,12 +1249,13 @@ void registarDistancia(NodeDistancia** listaDistancias, NodeSensor* listaSensore
         }
     } while (novaDistancia.distancia == 0);
 
-    NodeDistancia* novoNode = malloc(sizeof(NodeDistancia));
+    NodeDistancia* novoNode = arena_alloc(&arenaDistancias, sizeof(NodeDistancia));
     if (!novoNode) { printf("Erro critico: Falha ao alocar memoria.\n"); return; }
 
     novoNode->distancia = novaDistancia;
     novoNode->next = *listaDistancias;
     *listaDistancias = novoNode;
+    matrizDistancias_inserirCabeca(&matrizDistancias, novoNode);
 
     printf("\nDistancia entre sensor %d e %d registada com sucesso!\n", novaDistancia.idSensor1, novaDistancia.idSensor2);
 }
@@ -1153,13 +1312,15 @@ void registarPassagem(NodePassagem** listaPassagens, NodeSensor* listaSensores,
     } while (novaPassagem.tipoRegisto == -1);
 
     // Preencher timestamp e adicionar à lista
-    novaPassagem.ts = parseTimestamp(novaPassagem.dataHora);
-    NodePassagem *novoNode = malloc(sizeof(NodePassagem));
+    novaPassagem.ts = parseTimestampMs(novaPassagem.dataHora);
+    NodePassagem *novoNode = arena_alloc(&arenaPassagens, sizeof(NodePassagem));
     if (!novoNode) { printf("Erro critico: Falha ao alocar memoria.\n"); return; }
     
     novoNode->passagem = novaPassagem;
     novoNode->next = *listaPassagens;
     *listaPassagens = novoNode;
+    if (gruposPassagens.cabeca == novoNode->next)
+        grupos_sincronizar(&gruposPassagens, novoNode); // fica pendente até à próxima consulta
 
     printf("\nPassagem do veiculo %d no sensor %d registada com sucesso!\n", novaPassagem.idVeiculo, novaPassagem.idSensor);
 }
@@ -1297,7 +1458,7 @@ TreeNodeInfracao** armazenarInfracoes(TreeNodeInfracao* arvInfra, int* total) {
     *total = count;
     if (count == 0)
         return NULL;
-    TreeNodeInfracao** arr = malloc(count * sizeof(TreeNodeInfracao*));
+    TreeNodeInfracao** arr = memoria_alocar(MEMORIA_CONSULTAS, count * sizeof(TreeNodeInfracao*));
     if (!arr) {
         perror("Erro ao alocar memória para vetor de infrações");
         *total = 0;
@@ -1317,19 +1478,103 @@ void libertarArvoreInfracoes(TreeNodeInfracao* arvInfra) {
         return;
     libertarArvoreInfracoes(arvInfra->left);
     libertarArvoreInfracoes(arvInfra->right);
-    free(arvInfra);
+    memoria_libertar(arvInfra);
 }
 
 
 
 
 /**
- * @brief Função de parsing da timesstamp
+ * @brief Número de dias desde 1970-01-01 de uma data do calendário gregoriano,
+ * calculado aritmeticamente (algoritmo "days from civil"), sem mktime nem TZ/DST.
  * 
- * @param dataHora 
- * @return time_t 
+ * @param ano 
+ * @param mes 1..12
+ * @param dia 1..31
+ * @return long long 
  */
-time_t parseTimestamp(const char *dataHora) {
+static long long diasDesdeEpoca(int ano, int mes, int dia) {
+    ano -= mes <= 2;
+    long long era = (ano >= 0 ? ano : ano - 399) / 400;
+    unsigned yoe = (unsigned)(ano - era * 400);                              // [0, 399]
+    unsigned doy = (153u * (unsigned)(mes > 2 ? mes - 3 : mes + 9) + 2) / 5 + (unsigned)dia - 1; // [0, 365]
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                    // [0, 146096]
+    return era * 146097 + (long long)doe - 719468;
+}
+
+/**
+ * @brief Lê exatamente n dígitos a partir de s.
+ * Pára no primeiro carácter que não seja dígito (incluindo o '\0'), por isso nunca lê
+ * para lá do fim da string.
+ * 
+ * @param s 
+ * @param n 
+ * @return int O valor lido ou -1 se algum dos n caracteres não for dígito
+ */
+static int lerDigitos(const char *s, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        v = v * 10 + (s[i] - '0');
+    }
+    return v;
+}
+
+/**
+ * @brief Converte campos de data/hora já validados em milissegundos desde a época.
+ * 
+ * @return long long 
+ */
+static long long camposParaMs(long long dias, int H, int M, int S, int ms) {
+    return ((dias * 86400LL) + H * 3600LL + M * 60LL + S) * 1000LL + ms;
+}
+
+/**
+ * @brief Memoização da última data vista por cada thread (as passagens vêm
+ * agrupadas por dia, por isso quase todas as linhas reutilizam o mesmo valor).
+ * 
+ */
+static _Thread_local char      cacheData[10];
+static _Thread_local long long cacheDias;
+static _Thread_local bool      cacheValida = false;
+
+/**
+ * @brief Função de parsing da timestamp com precisão de milissegundos.
+ * Caminho rápido para o formato fixo "DD-MM-AAAA_HH:MM:SS.mmm" (também aceita ' '
+ * em vez de '_' e a ausência de ".mmm"); qualquer outro formato passa pelo strptime.
+ * 
+ * @param dataHora 
+ * @return long long Milissegundos desde 1970-01-01 00:00:00 ou -1 em caso de erro
+ */
+long long parseTimestampMs(const char *dataHora) {
+    const char *s = dataHora;
+    int dia = lerDigitos(s, 2);
+    if (dia >= 0 && s[2] == '-' && lerDigitos(s + 3, 2) >= 0 && s[5] == '-' && lerDigitos(s + 6, 4) >= 0 &&
+        (s[10] == '_' || s[10] == ' ')) {
+        int H = lerDigitos(s + 11, 2);
+        int M = (H >= 0 && s[13] == ':') ? lerDigitos(s + 14, 2) : -1;
+        int S = (M >= 0 && s[16] == ':') ? lerDigitos(s + 17, 2) : -1;
+        if (S >= 0 && H < 24 && M < 60 && S < 61) {
+            int ms = 0;
+            if (s[19] == '.') {
+                int escala = 100;
+                for (int i = 20; i < 23 && s[i] >= '0' && s[i] <= '9'; i++, escala /= 10)
+                    ms += (s[i] - '0') * escala;
+            }
+
+            if (!cacheValida || memcmp(cacheData, s, sizeof(cacheData)) != 0) {
+                int mes = lerDigitos(s + 3, 2);
+                int ano = lerDigitos(s + 6, 4);
+                if (mes < 1 || mes > 12 || dia < 1 || dia > 31) return -1;
+                memcpy(cacheData, s, sizeof(cacheData));
+                cacheDias = diasDesdeEpoca(ano, mes, dia);
+                cacheValida = true;
+            }
+            return camposParaMs(cacheDias, H, M, S, ms);
+        }
+    }
+
+    // Caminho lento: formatos livres (ex.: "1-9-2010 8:05:00"), sem milissegundos
     struct tm tm = {0}; // Inicializar a struct a zeros
     char buffer[25]; // Espaço suficiente para a string
 
@@ -1343,21 +1588,33 @@ time_t parseTimestamp(const char *dataHora) {
         *underscore_pos = ' ';
     }
 
-    // Usar strptime no buffer modificado, lendo apenas a parte sem milissegundos
     if (strptime(buffer, "%d-%m-%Y %H:%M:%S", &tm) == NULL) {
-        // Se ainda assim falhar, pode ser um formato inesperado.
-        // fprintf(stderr, "Aviso: Nao foi possivel analisar a data/hora: %s\n", dataHora);
         return -1; // Retorna -1 em caso de erro
     }
+    int mes = tm.tm_mon + 1;
+    if (mes < 1 || mes > 12 || tm.tm_mday < 1 || tm.tm_mday > 31 ||
+        tm.tm_hour < 0 || tm.tm_hour > 23 || tm.tm_min < 0 || tm.tm_min > 59 || tm.tm_sec < 0 || tm.tm_sec > 60) {
+        return -1;
+    }
+    return camposParaMs(diasDesdeEpoca(tm.tm_year + 1900, mes, tm.tm_mday), tm.tm_hour, tm.tm_min, tm.tm_sec, 0);
+}
 
-    // Assegurar que o DST (Daylight Saving Time) é determinado automaticamente
-    tm.tm_isdst = -1; 
-    
-    return mktime(&tm);
+/**
+ * @brief Função de parsing da timestamp, em segundos (usada para os períodos
+ * introduzidos pelo utilizador). Usa o mesmo relógio que parseTimestampMs, por isso
+ * os valores são diretamente comparáveis com Passagem.ts / 1000.
+ * 
+ * @param dataHora 
+ * @return time_t Segundos desde a época ou -1 em caso de erro
+ */
+time_t parseTimestamp(const char *dataHora) {
+    long long ms = parseTimestampMs(dataHora);
+    return ms < 0 ? (time_t)-1 : (time_t)(ms / 1000);
 }
 
 /**
- * @brief Função para obter distâncias entre sensores
+ * @brief Função para obter distâncias entre sensores. Usa a matrizDistancias
+ * quando esta reflete a lista recebida; caso contrário percorre a lista.
  * 
  * @param lista 
  * @param id1 
@@ -1365,6 +1622,8 @@ time_t parseTimestamp(const char *dataHora) {
  * @return double 
  */
 double obterDistancia(NodeDistancia* lista, int id1, int id2) {
+    if (matrizDistancias_valida(&matrizDistancias, lista))
+        return matrizDistancias_procurar(&matrizDistancias, id1, id2);
     for (NodeDistancia* p = lista; p; p = p->next) {
         if ((p->distancia.idSensor1 == id1 && p->distancia.idSensor2 == id2) ||
             (p->distancia.idSensor1 == id2 && p->distancia.idSensor2 == id1)) {
@@ -1377,34 +1636,32 @@ double obterDistancia(NodeDistancia* lista, int id1, int id2) {
 /**
  * @brief Função para calcular a velocidade média total de um veículo 
  * 
- * @param passagens 
+ * @param passagens Passagens do veículo, por ordem de data
+ * @param n 
  * @param listaDistancias 
  * @return double 
  */
-double calcularVelocidadeMediaPonderada(NodePassagem* passagens, NodeDistancia* listaDistancias) {
-    // A lista de passagens para um veículo já deve vir ordenada por data
-    if (!passagens) return -1.0;
+double calcularVelocidadeMediaPonderada(const Passagem* const* passagens, size_t n, NodeDistancia* listaDistancias) {
+    if (n == 0) return -1.0;
 
     double somaVelocidadesPonderadas = 0.0;
     double tempoTotalViagem = 0.0;
     int viagensValidas = 0;
 
-    // Percorre a lista à procura de uma ENTRADA
-    for (NodePassagem* pEntrada = passagens; pEntrada; pEntrada = pEntrada->next) {
-        if (pEntrada->passagem.tipoRegisto == 0) { // Encontrou uma entrada (tipo 0)
+    // Percorre as passagens à procura de uma ENTRADA
+    for (size_t e = 0; e < n; e++) {
+        if (passagens[e]->tipoRegisto == 0) { // Encontrou uma entrada (tipo 0)
             
             // Agora, a partir desta entrada, procure a PRÓXIMA saída
-            NodePassagem* pSaida = NULL;
-            for (pSaida = pEntrada->next; pSaida; pSaida = pSaida->next) {
-                if (pSaida->passagem.tipoRegisto == 1) { // Encontrou uma saída (tipo 1)
-                    break; // Encontrou o par, sai do loop interno
-                }
-            }
+            size_t s = e + 1;
+            while (s < n && passagens[s]->tipoRegisto != 1) s++;
 
             // Se um par Entrada->Saída foi encontrado
-            if (pSaida) {
-                double distancia = obterDistancia(listaDistancias, pEntrada->passagem.idSensor, pSaida->passagem.idSensor);
-                double tempo_s = difftime(pSaida->passagem.ts, pEntrada->passagem.ts);
+            if (s < n) {
+                const Passagem* entrada = passagens[e];
+                const Passagem* saida   = passagens[s];
+                double distancia = obterDistancia(listaDistancias, entrada->idSensor, saida->idSensor);
+                double tempo_s = (saida->ts - entrada->ts) / 1000.0;
 
                 // Define um tempo máximo razoável para uma viagem (ex: 24 horas = 86400s)
                 const double MAX_TEMPO_VIAGEM = 86400.0; 
@@ -1417,8 +1674,8 @@ double calcularVelocidadeMediaPonderada(NodePassagem* passagens, NodeDistancia*
                     viagensValidas++;
                 }
                 
-                // Move o ponteiro principal para depois da saída encontrada para não reprocessar
-                pEntrada = pSaida; 
+                // Continua depois da saída encontrada para não reprocessar
+                e = s; 
             }
         }
     }
@@ -1431,30 +1688,31 @@ double calcularVelocidadeMediaPonderada(NodePassagem* passagens, NodeDistancia*
 }
 
 /**
- * @brief 
+ * @brief Maior velocidade entre uma entrada e a saída seguinte
  * 
- * @param passagens 
+ * @param passagens Passagens do veículo, por ordem de data
+ * @param n 
  * @param listaDistancias 
  * @return double 
  */
-double calcularVelocidadeInfracao(NodePassagem* passagens,
+double calcularVelocidadeInfracao(const Passagem* const* passagens, size_t n,
                                   NodeDistancia* listaDistancias)
 {
     double maxVel = 0.0;
-    NodePassagem* pendente = NULL;
+    const Passagem* pendente = NULL;
 
-    for (NodePassagem* p = passagens; p; p = p->next) {
-        if (p->passagem.tipoRegisto == 0) {
+    for (size_t i = 0; i < n; i++) {
+        const Passagem* p = passagens[i];
+        if (p->tipoRegisto == 0) {
             // marca este registo de entrada
             pendente = p;
         }
-        else if (p->passagem.tipoRegisto == 1 && pendente) {
+        else if (p->tipoRegisto == 1 && pendente) {
             // quando aparece a saída correspondente
             double d  = obterDistancia(listaDistancias,
-                                       pendente->passagem.idSensor,
-                                       p->passagem.idSensor);
-            double dt = difftime(p->passagem.ts,
-                                 pendente->passagem.ts);
+                                       pendente->idSensor,
+                                       p->idSensor);
+            double dt = (p->ts - pendente->ts) / 1000.0;
 
             if (d >= 0 && dt > 0 && dt <= 86400) {
                 double vel = (d / dt) * 3600.0;  // km/h
@@ -1469,131 +1727,98 @@ double calcularVelocidadeInfracao(NodePassagem* passagens,
 }
 
 /**
- * @brief Função auxiliar para filtrar passagens dentro do intervalo [inicio, fim]
+ * @brief Função auxiliar para filtrar passagens dentro do intervalo [inicio, fim],
+ * sem copiar: a vista aponta para uma fatia do índice temporal. As passagens
+ * arquivadas no segmento (só dos blocos do período) vêm primeiro; são as
+ * únicas que precisam de memória (a arena da vista).
  * 
  * @param lista 
  * @param inicio 
  * @param fim 
- * @return NodePassagem* 
- */
-NodePassagem* filtrarPassagens(NodePassagem* lista, time_t inicio, time_t fim) {
-    NodePassagem* filtradas = NULL;
-    NodePassagem* ultimo = NULL;
-    for (NodePassagem* p = lista; p; p = p->next) {
-        // Se o campo ts já estiver preenchido, use-o
-        time_t t = p->passagem.ts;  
-        // Caso contrário, use parseTimestamp
-        // time_t t = (p->passagem.ts != 0 ? p->passagem.ts : parseTimestamp(p->passagem.dataHora));
-        if (t >= inicio && t <= fim) {
-            NodePassagem* nova = malloc(sizeof(NodePassagem));
-            if (!nova) {
-                perror("Erro ao alocar memória para passagem filtrada");
-                return filtradas;
-            }
-            nova->passagem = p->passagem;
-            nova->next = NULL;
-            if (filtradas == NULL) {
-                filtradas = nova;
-                ultimo = nova;
-            } else {
-                ultimo->next = nova;
-                ultimo = nova;
-            }
-        }
+ * @param vista Inicializada com VISTA_PASSAGENS_INIT; libertar com vista_libertar()
+ * @return bool false se não houver passagens no período (a vista já foi libertada)
+ */
+bool filtrarPassagens(NodePassagem* lista, time_t inicio, time_t fim, VistaPassagens* vista) {
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
+    NodePassagem* caudaArquivadas = NULL;
+    vista->inicioMs = inicioMs;
+    vista->fimMs    = fimMs;
+    segmento_filtrar(&segmentoPassagens, inicioMs, fimMs, SEGMENTO_SO_PERIODO, &vista->arena,
+                     &vista->arquivadas, &caudaArquivadas);
+
+    if (colunas_sincronizar(&colunasPassagens, lista) &&
+        indiceTemporal_sincronizar(&indiceTemporal, &colunasPassagens)) {
+        size_t primeira, ultima;
+        indiceTemporal_intervalo(&indiceTemporal, &colunasPassagens, inicioMs, fimMs, &primeira, &ultima);
+        vista->colunas = &colunasPassagens;
+        vista->linhas  = indiceTemporal.linhas + primeira;
+        vista->total   = ultima - primeira;
+        vista->totalPendentes = indiceTemporal_pendentes(&indiceTemporal, &colunasPassagens, inicioMs, fimMs,
+                                                         &vista->pendentes);
+    } else if (caudaArquivadas) {
+        caudaArquivadas->next = lista; // sem índice: a lista é filtrada ao percorrer a vista
+    } else {
+        vista->arquivadas = lista;
     }
-    return filtradas;
-}
 
-/**
- * @brief Função hash simples: módulo do idVeiculo com o número de buckets
- * 
- * @param idVeiculo 
- * @param numBuckets 
- * @return size_t 
- */
-static size_t hashFunction(int idVeiculo, size_t numBuckets) {
-    return ((size_t)idVeiculo) % numBuckets;
+    vista_reiniciar(vista);
+    bool vazia = vista_seguinte(vista) == NULL;
+    vista_reiniciar(vista);
+    if (vazia) vista_libertar(vista);
+    return !vazia;
 }
 
 /**
- * @brief Cria a tabela hash com um número especificado de buckets
+ * @brief Passagens do período agrupadas por veículo e ordenadas por data. Sem
+ * passagens arquivadas no período usa gruposPassagens (cada veículo é uma fatia
+ * contígua, que grupos_fatia() limita ao período); caso contrário, ou se o
+ * índice não puder ser construído, agrupa a vista do período num índice
+ * temporário.
  * 
- * @param numBuckets 
- * @return HashTablePassagens* 
- */
-HashTablePassagens* criarHashTablePassagens(size_t numBuckets) {
-    HashTablePassagens* ht = malloc(sizeof(HashTablePassagens));
-    if (!ht) {
-        perror("Erro ao alocar memória para HashTablePassagens");
-        return NULL;
-    }
-    ht->numBuckets = numBuckets;
-    ht->buckets = calloc(numBuckets, sizeof(PassagemGroup*));
-    if (!ht->buckets) {
-        perror("Erro ao alocar memória para os buckets da tabela hash");
-        free(ht);
-        return NULL;
-    }
-    return ht;
-}
-
-/**
- * @brief Insere uma passagem na tabela hash, agrupando-a pelo idVeiculo
- * 
- * @param ht 
- * @param passagem 
+ * @param lista 
+ * @param inicio 
+ * @param fim 
+ * @param vista Inicializada com VISTA_PASSAGENS_INIT; libertar com vista_libertar()
+ * @param temporarios Inicializados com GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS); libertar com grupos_libertar()
+ * @return const GruposVeiculo* NULL se não houver passagens no período
  */
-void inserirPassagemHash(HashTablePassagens* ht, const Passagem* passagem) {
-    if (!ht) return;
-    size_t index = hashFunction(passagem->idVeiculo, ht->numBuckets);
-    PassagemGroup* grupo = ht->buckets[index];
+static const GruposVeiculo* agruparPassagens(NodePassagem* lista, time_t inicio, time_t fim,
+                                             VistaPassagens* vista, GruposVeiculo* temporarios) {
+    if (!filtrarPassagens(lista, inicio, fim, vista)) return NULL;
 
-    // Procura se já existe um grupo para esse veículo
-    while (grupo) {
-        if (grupo->idVeiculo == passagem->idVeiculo)
-            break;
-        grupo = grupo->next;
+    bool comArquivadas = vista->arquivadas != NULL && vista->arquivadas != lista;
+    if (!comArquivadas && grupos_sincronizar(&gruposPassagens, lista) && grupos_consolidar(&gruposPassagens)) {
+        vista_libertar(vista);
+        return &gruposPassagens;
     }
-    // Se não existe, cria um novo grupo
-    if (!grupo) {
-        grupo = malloc(sizeof(PassagemGroup));
-        if (!grupo) {
-            perror("Erro ao alocar memória para PassagemGroup");
-            return;
-        }
-        grupo->idVeiculo = passagem->idVeiculo;
-        grupo->passagens = NULL;
-        grupo->next = ht->buckets[index];
-        ht->buckets[index] = grupo;
-    }
-    // Insere a passagem no início da lista ligada do grupo
-    NodePassagem* novoNo = malloc(sizeof(NodePassagem));
-    if (!novoNo) {
-        perror("Erro ao alocar memória para NodePassagem");
-        return;
+    if (!grupos_construirVista(temporarios, vista)) {
+        vista_libertar(vista);
+        return NULL;
     }
-    novoNo->passagem = *passagem;
-    novoNo->next = grupo->passagens;
-    grupo->passagens = novoNo;
+    return temporarios;
 }
 
 /**
- * @brief Busca a lista de passagens para um veículo específico
+ * @brief Todas as passagens, incluindo as arquivadas no segmento, agrupadas por
+ * veículo: gruposPassagens se não houver arquivadas ou, se houver (ou o índice
+ * não puder ser construído), um índice temporário.
  * 
- * @param ht 
- * @param idVeiculo 
- * @return NodePassagem* 
+ * @param lista 
+ * @param todas Inicializada com VISTA_PASSAGENS_INIT; libertar com vista_libertar()
+ * @param temporarios Inicializados com GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS); libertar com grupos_libertar()
+ * @return const GruposVeiculo* NULL se a lista estiver vazia ou faltar memória
  */
-NodePassagem* pesquisarPassagensParaVeiculo(HashTablePassagens* ht, int idVeiculo) {
-    if (!ht) return NULL;
-    size_t index = hashFunction(idVeiculo, ht->numBuckets);
-    PassagemGroup* grupo = ht->buckets[index];
-    while (grupo) {
-        if (grupo->idVeiculo == idVeiculo)
-            return grupo->passagens;
-        grupo = grupo->next;
-    }
-    return NULL;
+static const GruposVeiculo* agruparLista(NodePassagem* lista, VistaPassagens* todas, GruposVeiculo* temporarios) {
+    NodePassagem* caudaArquivadas = NULL;
+    todas->inicioMs = LLONG_MIN;
+    todas->fimMs = LLONG_MAX;
+    segmento_filtrar(&segmentoPassagens, LLONG_MIN, LLONG_MAX, SEGMENTO_SO_PERIODO, &todas->arena,
+                     &todas->arquivadas, &caudaArquivadas);
+    if (!todas->arquivadas && grupos_sincronizar(&gruposPassagens, lista) && grupos_consolidar(&gruposPassagens))
+        return &gruposPassagens;
+    if (caudaArquivadas) caudaArquivadas->next = lista; // as arquivadas vêm antes da lista
+    else                 todas->arquivadas = lista;
+    return grupos_construirVista(temporarios, todas) ? temporarios : NULL;
 }
 
 /**
@@ -1610,84 +1835,36 @@ NodeSensor* pesquisarSensorPorId(NodeSensor* listaSensores, int idSensor) {
 }
 
 /**
- * @brief Libera toda a tabela hash e as passagens agrupadas
- * 
- * @param ht 
- */
-void libertarHashTablePassagens(HashTablePassagens* ht) {
-    if (!ht) return;
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        PassagemGroup* grupo = ht->buckets[i];
-        while (grupo) {
-            PassagemGroup* temp = grupo;
-            // Libera a lista de passagens do grupo
-            NodePassagem* p = grupo->passagens;
-            while (p) {
-                NodePassagem* tempNo = p;
-                p = p->next;
-                free(tempNo);
-            }
-            grupo = grupo->next;
-            free(temp);
-        }
-    }
-    free(ht->buckets);
-    free(ht);
-}
-
-/**
- * @brief Função auxiliar para mesclar duas listas ordenadas de passagens por data/hora
- * 
- * @param left 
- * @param right 
- * @return NodePassagem* 
+ * @brief Carro com o idVeiculo indicado. Usa o indiceCarros quando este reflete
+ * a lista recebida; caso contrário percorre a lista.
+ *
+ * @param listaCarros
+ * @param idVeiculo
+ * @return NodeCarro* NULL se não existir
  */
-static NodePassagem* mergePassagens(NodePassagem* left, NodePassagem* right) {
-    if (!left)  return right;
-    if (!right) return left;
-
-    NodePassagem* result;
-    // compara time_t (ts) em vez de string
-    if (left->passagem.ts <= right->passagem.ts) {
-        result = left;
-        result->next = mergePassagens(left->next, right);
-    } else {
-        result = right;
-        result->next = mergePassagens(left, right->next);
+NodeCarro* pesquisarCarroPorId(NodeCarro* listaCarros, int idVeiculo) {
+    if (indiceIds_valido(&indiceCarros, listaCarros))
+        return indiceIds_procurar(&indiceCarros, idVeiculo);
+    for (NodeCarro* p = listaCarros; p; p = p->next) {
+        if (p->carro.idVeiculo == idVeiculo)
+            return p;
     }
-    return result;
+    return NULL;
 }
 
-
 /**
- * @brief Função auxiliar para aplicar merge sort na lista de passagens
- * 
- * @param head 
- * @return NodePassagem* 
+ * @brief Carro com a matrícula indicada. Usa o indiceMatriculas quando este
+ * reflete a lista recebida; caso contrário percorre a lista.
+ *
+ * @param listaCarros
+ * @param matricula
+ * @return NodeCarro* NULL se não existir
  */
-static NodePassagem* mergeSortPassagens(NodePassagem* head) {
-    if (!head || !head->next)
-        return head;
-    
-    // Encontrar o meio da lista usando o método do ponteiro lento/rápido
-    NodePassagem* slow = head;
-    NodePassagem* fast = head->next;
-    while (fast && fast->next) {
-        slow = slow->next;
-        fast = fast->next->next;
-    }
-    NodePassagem* mid = slow->next;
-    slow->next = NULL;
-    
-    NodePassagem* left = mergeSortPassagens(head);
-    NodePassagem* right = mergeSortPassagens(mid);
-    
-    return mergePassagens(left, right);
-}
-
-NodeCarro* pesquisarCarroPorId(NodeCarro* listaCarros, int idVeiculo) {
+NodeCarro* pesquisarCarroPorMatricula(NodeCarro* listaCarros, const char* matricula) {
+    if (indiceMatriculas_valido(&indiceMatriculas, listaCarros))
+        return indiceMatriculas_procurar(&indiceMatriculas, matricula);
     for (NodeCarro* p = listaCarros; p; p = p->next) {
-        if (p->carro.idVeiculo == idVeiculo)
+        if (strcmp(p->carro.matricula, matricula) == 0)
             return p;
     }
     return NULL;
@@ -1702,7 +1879,7 @@ NodeCarro* pesquisarCarroPorId(NodeCarro* listaCarros, int idVeiculo) {
  */
 void inserirInfracao(TreeNodeInfracao** root, const char* matricula, double velocidadeMedia) {
     if (*root == NULL) {
-        *root = malloc(sizeof(TreeNodeInfracao));
+        *root = memoria_alocar(MEMORIA_CONSULTAS, sizeof(TreeNodeInfracao));
         if (!*root) {
             perror("Erro ao alocar memória para infração");
             return;
@@ -1744,47 +1921,35 @@ void listarInfracoes(NodeCarro*     listaCarros,
     TreeNodeInfracao* arvInfra = NULL;
     clock_t start = clock();
 
-    // --- Módulo 1: filtrar passagens no intervalo ---
-    NodePassagem* passagensFiltradas = filtrarPassagens(listaPassagens, inicio, fim);
-    if (!passagensFiltradas) {
+    // --- Módulo 1: passagens do intervalo, já agrupadas por veículo e ordenadas ---
+    VistaPassagens passagensFiltradas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposPeriodo = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparPassagens(listaPassagens, inicio, fim, &passagensFiltradas, &gruposPeriodo);
+    if (!grupos) {
         printf("Nenhuma passagem encontrada no intervalo especificado.\n");
         return;
     }
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
 
-    // --- Módulo 2: agrupar por veículo numa hash table ---
-    HashTablePassagens* ht = criarHashTablePassagens(10);
-    if (!ht) {
-        libertarListaPassagens(&passagensFiltradas);
-        return;
-    }
-    for (NodePassagem* p = passagensFiltradas; p; p = p->next)
-        inserirPassagemHash(ht, &p->passagem);
-
-    // --- Módulo 3: ordenar cronologicamente cada grupo ---
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        for (PassagemGroup* g = ht->buckets[i]; g; g = g->next) {
-            g->passagens = mergeSortPassagens(g->passagens);
+    // --- Módulo 2: detectar infrações e construir árvore ---
+    for (size_t v = 0; v < grupos->numVeiculos; v++) {
+        const Passagem* const* fatia;
+        size_t n = grupos_fatia(grupos, v, inicioMs, fimMs, &fatia);
+        if (n == 0) continue;
+        double maxVel = calcularVelocidadeInfracao(fatia, n, listaDistancias);
+        if (maxVel > 120.0 && maxVel < 300.0) {
+            NodeCarro* carro = pesquisarCarroPorId(listaCarros, grupos_idVeiculo(grupos, v));
+            if (carro)
+                inserirInfracao(&arvInfra, carro->carro.matricula, maxVel);
         }
     }
 
-    // --- Módulo 4: detectar infrações e construir árvore ---
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        for (PassagemGroup* g = ht->buckets[i]; g; g = g->next) {
-            double maxVel = calcularVelocidadeInfracao(g->passagens, listaDistancias);
-            if (maxVel > 120.0 && maxVel < 300.0) {
-                NodeCarro* carro = pesquisarCarroPorId(listaCarros, g->idVeiculo);
-                if (carro)
-                    inserirInfracao(&arvInfra, carro->carro.matricula, maxVel);
-            }
-        }
-    }
-
-    // --- Módulo 5: converter árvore em array e medir tempo ---
+    // --- Módulo 3: converter árvore em array e medir tempo ---
     int totalInfra = 0;
     TreeNodeInfracao** infraArray = armazenarInfracoes(arvInfra, &totalInfra);
     double processingTime = (double)(clock() - start) / CLOCKS_PER_SEC;
 
-    // --- Módulo 6: exibir resultados ou mensagem de “nenhuma infração” ---
+    // --- Módulo 4: exibir resultados ou mensagem de “nenhuma infração” ---
     if (!infraArray || totalInfra == 0) {
         printf("Nenhuma infração encontrada no período especificado.\n");
     } else {
@@ -1826,18 +1991,24 @@ void listarInfracoes(NodeCarro*     listaCarros,
             }
             else if (opcao=='b') {
                 char busca[CARRO_MAX_MATRICULA];
-                printf("Matrícula: ");
+                printf("Matrícula (ou prefixo terminado em *): ");
                 scanf("%s", busca);
+                // O array vem da travessia em ordem da árvore: está ordenado por matrícula
+                bool exata;
+                size_t comprimento = matricula_padrao(busca, &exata);
+                int lo = 0, hi = totalInfra;
+                while (lo < hi) {
+                    int meio = lo + (hi - lo) / 2;
+                    if (strncmp(infraArray[meio]->matricula, busca, comprimento) < 0) lo = meio + 1; else hi = meio;
+                }
                 int found = 0;
-                for (int i = 0; i < totalInfra; i++) {
-                    if (strcmp(infraArray[i]->matricula, busca) == 0) {
-                        printf("Encontrado no índice %d: %.2f km/h\n",
-                               i+1, infraArray[i]->velocidadeMedia);
-                        found = 1;
-                        break;
-                    }
+                for (int i = lo; i < totalInfra && strncmp(infraArray[i]->matricula, busca, comprimento) == 0; i++) {
+                    printf("Encontrado no índice %d: %s | %.2f km/h\n",
+                           i+1, infraArray[i]->matricula, infraArray[i]->velocidadeMedia);
+                    found = 1;
                 }
-                if (!found) printf("Matrícula '%s' não encontrada.\n", busca);
+                if (!found && exata) printf("Matrícula '%s' não encontrada.\n", busca);
+                else if (!found)     printf("Nenhuma matrícula começa por '%.*s'.\n", (int)comprimento, busca);
                 printf("Pressione Enter para continuar...");
                 while (getchar()!='\n');
                 getchar();
@@ -1845,11 +2016,11 @@ void listarInfracoes(NodeCarro*     listaCarros,
         } while (opcao != 's');
     }
 
-    // --- Módulo 7: libertar memória ---
-    free(infraArray);
+    // --- Módulo 5: libertar memória ---
+    memoria_libertar(infraArray);
     libertarArvoreInfracoes(arvInfra);
-    libertarHashTablePassagens(ht);
-    libertarListaPassagens(&passagensFiltradas);
+    grupos_libertar(&gruposPeriodo);
+    vista_libertar(&passagensFiltradas);
 }
 
 /**
@@ -1875,90 +2046,74 @@ int cmpRanking(const void* a, const void* b) {
  * @param fim 
  */
 void rankingInfraVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim) {
-    // 1. Filtrar as passagens dentro do intervalo
-
-    NodePassagem* passagensFiltradas = filtrarPassagens(listaPassagens, inicio, fim);
-    if (!passagensFiltradas) {
+    // 1. Passagens do intervalo, agrupadas por veículo e ordenadas por data
+    VistaPassagens passagensFiltradas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposPeriodo = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparPassagens(listaPassagens, inicio, fim, &passagensFiltradas, &gruposPeriodo);
+    if (!grupos) {
         printf("Nenhuma passagem encontrada no intervalo especificado.\n");
         return;
     }
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
     
-    // 2. Criar uma tabela hash para agrupar as passagens por veículo
-    HashTablePassagens* ht = criarHashTablePassagens(10);
-    if (!ht) {
-        printf("Erro ao criar a tabela hash para passagens.\n");
-        libertarListaPassagens(&passagensFiltradas);
-        return;
-    }
-    for (NodePassagem* p = passagensFiltradas; p; p = p->next) {
-        inserirPassagemHash(ht, &p->passagem);
-    }
-    
-    // 3. Preparar estrutura para ranking
-    RankingInfra* ranking = malloc(sizeof(RankingInfra) * MAX_CARROS);
+    // 2. Preparar estrutura para ranking
+    RankingInfra* ranking = memoria_alocar(MEMORIA_CONSULTAS, sizeof(RankingInfra) * MAX_CARROS);
     if (!ranking) {
         perror("Erro ao alocar ranking");
-        libertarHashTablePassagens(ht);
-        libertarListaPassagens(&passagensFiltradas);
+        grupos_libertar(&gruposPeriodo);
+        vista_libertar(&passagensFiltradas);
         return;
     }
     int nRanking = 0;
     
-    // 4. Para cada grupo na tabela hash, ordenar passagens e contar infrações
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        PassagemGroup* grupo = ht->buckets[i];
-        while (grupo) { 
-
-            // Ordena as passagens do grupo (assumindo que foram inseridas sem ordem)
-            grupo->passagens = mergeSortPassagens(grupo->passagens);
-
-            int count = 0;
-            // Percorre as passagens consecutivas e calcula a velocidade média de cada par
-            for (NodePassagem* p = grupo->passagens; p && p->next; p = p->next) {
-                double d = obterDistancia(listaDistancias, p->passagem.idSensor, p->next->passagem.idSensor);
-                if (d < 0)
-                    continue; // ignora se a distância não for encontrada
-    
-                double dt = difftime(p->next->passagem.ts, p->passagem.ts);
-                if (dt > 0) {
-                    double speed = (d / dt) * 3600.0;
-                    if (speed > 120.0)
-                        count++;
-                }
+    // 3. Para cada veículo, contar infrações entre passagens consecutivas
+    for (size_t v = 0; v < grupos->numVeiculos && nRanking < MAX_CARROS; v++) {
+        const Passagem* const* fatia;
+        size_t n = grupos_fatia(grupos, v, inicioMs, fimMs, &fatia);
+
+        int count = 0;
+        // Percorre as passagens consecutivas e calcula a velocidade média de cada par
+        for (size_t i = 0; i + 1 < n; i++) {
+            double d = obterDistancia(listaDistancias, fatia[i]->idSensor, fatia[i + 1]->idSensor);
+            if (d < 0)
+                continue; // ignora se a distância não for encontrada
+
+            double dt = (fatia[i + 1]->ts - fatia[i]->ts) / 1000.0;
+            if (dt > 0) {
+                double speed = (d / dt) * 3600.0;
+                if (speed > 120.0)
+                    count++;
             }
+        }
 
-    
-            if (count > 0) {
-                // Buscar os dados do veículo para obter a matrícula
-                NodeCarro* carro = pesquisarCarroPorId(listaCarros, grupo->idVeiculo);
-                if (!carro) {
-                    printf("Erro: Veículo com ID %d não encontrado.\n", grupo->idVeiculo);
-                    continue;
-                }                
-                if (carro) {
-                    ranking[nRanking].idVeiculo = grupo->idVeiculo;
-                    strncpy(ranking[nRanking].matricula, carro->carro.matricula, CARRO_MAX_MATRICULA);
-                    ranking[nRanking].infraCount = count;
-                    nRanking++;
-                }
+        if (count > 0) {
+            // Buscar os dados do veículo para obter a matrícula
+            int idVeiculo = grupos_idVeiculo(grupos, v);
+            NodeCarro* carro = pesquisarCarroPorId(listaCarros, idVeiculo);
+            if (!carro) {
+                printf("Erro: Veículo com ID %d não encontrado.\n", idVeiculo);
+                continue;
             }
-            grupo = grupo->next;
+            ranking[nRanking].idVeiculo = idVeiculo;
+            strncpy(ranking[nRanking].matricula, carro->carro.matricula, CARRO_MAX_MATRICULA);
+            ranking[nRanking].infraCount = count;
+            nRanking++;
         }
     }
     
     // Se nenhum veículo teve infração, informa e encerra a função
     if (nRanking == 0) {
         printf("Nenhuma infração encontrada no período especificado.\n");
-        free(ranking);
-        libertarHashTablePassagens(ht);
-        libertarListaPassagens(&passagensFiltradas);
+        memoria_libertar(ranking);
+        grupos_libertar(&gruposPeriodo);
+        vista_libertar(&passagensFiltradas);
         return;
     }
     
-    // 5. Ordenar o ranking (ordem decrescente de infrações)
+    // 4. Ordenar o ranking (ordem decrescente de infrações)
     qsort(ranking, nRanking, sizeof(RankingInfra), cmpRanking);
     
-    // 6. Exibir ranking com paginação
+    // 5. Exibir ranking com paginação
     int pageSize = 10;
     int currentPage = 0;
     char opcao;
@@ -1987,14 +2142,33 @@ void rankingInfraVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDist
             currentPage--;
     } while(opcao != 's');
     
-    // 7. Liberar recursos
-    free(ranking);
-    libertarHashTablePassagens(ht);
-    libertarListaPassagens(&passagensFiltradas);
+    // 6. Liberar recursos
+    memoria_libertar(ranking);
+    grupos_libertar(&gruposPeriodo);
+    vista_libertar(&passagensFiltradas);
 }
 
 
 
+/**
+ * @brief Passagens percorridas pelos rankings por km: as do segmento de arquivo a
+ * partir do período, até à passagem seguinte de cada veículo (que pode já estar
+ * fora do período), ligadas à lista principal.
+ * 
+ * @param lista 
+ * @param inicioMs 
+ * @param fimMs 
+ * @param arena Arena dos nós descomprimidos
+ * @return NodePassagem* 
+ */
+static NodePassagem* passagensComArquivo(NodePassagem* lista, long long inicioMs, long long fimMs, Arena* arena) {
+    NodePassagem *cabeca, *cauda;
+    segmento_filtrar(&segmentoPassagens, inicioMs, fimMs, SEGMENTO_COM_SEGUINTES, arena, &cabeca, &cauda);
+    if (!cauda) return lista;
+    cauda->next = lista;
+    return cabeca;
+}
+
 /**
  * @brief Gera e apresenta um ranking de veículos com base na distância percorrida e um periodo de tempo.
  *
@@ -2005,25 +2179,28 @@ void rankingInfraVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDist
  */
 void rankingVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim) {
     int maxVeiculos = 40000; // Ajustar conforme necessário
-    KmVeiculo *ranking = calloc(maxVeiculos, sizeof(KmVeiculo));
+    KmVeiculo *ranking = memoria_alocarZeros(MEMORIA_CONSULTAS, maxVeiculos, sizeof(KmVeiculo));
     int nVeiculos = 0;
 
     // 1. Processar passagens e calcular distâncias
-    for (NodePassagem* p = listaPassagens; p; p = p->next) {
-        time_t t = parseTimestamp(p->passagem.dataHora);
-        if (t < inicio || t > fim) continue;
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
+    Arena arenaArquivo = ARENA_INIT("Passagens arquivadas", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
+    NodePassagem* passagens = passagensComArquivo(listaPassagens, inicioMs, fimMs, &arenaArquivo);
+    for (NodePassagem* p = passagens; p; p = passagem_seguinte(p)) {
+        long long t = p->passagem.ts;
+        if (t < inicioMs || t > fimMs) continue;
 
         int idV = p->passagem.idVeiculo;
         int idS = p->passagem.idSensor;
         int idS_ant = -1;
 
-        NodePassagem* ant = p->next;
+        NodePassagem* ant = passagem_seguinte(p);
         while (ant) {
             if (ant->passagem.idVeiculo == idV) {
                 idS_ant = ant->passagem.idSensor;
                 break;
             }
-            ant = ant->next;
+            ant = passagem_seguinte(ant);
         }
         if (idS_ant == -1) continue;
 
@@ -2044,6 +2221,8 @@ void rankingVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancia
         ranking[idx].km += dist;
     }
 
+    arena_libertar(&arenaArquivo);
+
     qsort(ranking, nVeiculos, sizeof(KmVeiculo), cmpVeiculoRanking);
 
     // 2. Paginação e busca
@@ -2061,8 +2240,9 @@ void rankingVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancia
             printf("%2d) Veículo %d: %.2f km\n", i + 1, ranking[i].idVeiculo, ranking[i].km);
         }
 
-        struct tm *tmInicio = localtime(&inicio);
-        struct tm *tmFim = localtime(&fim);
+        // parseTimestamp não aplica fuso horário, por isso a conversão inversa é com gmtime
+        struct tm *tmInicio = gmtime(&inicio);
+        struct tm *tmFim = gmtime(&fim);
         char inicioStr[20], fimStr[20];
         strftime(inicioStr, sizeof(inicioStr), "%d-%m-%Y %H:%M:%S", tmInicio);
         strftime(fimStr, sizeof(fimStr), "%d-%m-%Y %H:%M:%S", tmFim);
@@ -2115,7 +2295,7 @@ void rankingVeiculos(NodePassagem* listaPassagens, NodeDistancia* listaDistancia
         }
     } while (opcao != 's');
 
-    free(ranking);
+    memoria_libertar(ranking);
 }
 
 
@@ -2140,51 +2320,59 @@ int cmpMarcaRanking(const void *a, const void *b) {
  * @param inicio 
  * @param fim 
  */
-void rankingPorMarca(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim) {
-    int maxMarcas = 100; // Ajustar conforme necessário
-    KmMarca *ranking = calloc(maxMarcas, sizeof(KmMarca));
+void rankingPorMarca(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim, const FiltroCarros* filtro) {
+    Bitmap selecionados = BITMAP_INIT(MEMORIA_CONSULTAS);
+    if (!selecionarCarros(filtro, listaCarros, &selecionados)) return;
+    bool filtrar = filtroCarros_ativo(filtro);
+
+    // Uma entrada por marca do dicionário; posicaoMarca[código] dá a sua posição
+    // no ranking (-1 = ainda não apareceu), pela ordem em que as marcas aparecem
+    int totalMarcas = dicionarioMarcas.total;
+    KmMarca *ranking = memoria_alocarZeros(MEMORIA_CONSULTAS, totalMarcas + 1, sizeof(KmMarca));
+    int *posicaoMarca = memoria_alocar(MEMORIA_CONSULTAS, (totalMarcas + 1) * sizeof(int));
+    if (!ranking || !posicaoMarca) {
+        printf("Erro ao alocar memoria para o ranking por marca.\n");
+        memoria_libertar(ranking);
+        memoria_libertar(posicaoMarca);
+        bitmap_libertar(&selecionados);
+        return;
+    }
+    for (int i = 0; i < totalMarcas; i++) posicaoMarca[i] = -1;
     int nMarcas = 0;
 
     // 1. Processar passagens e calcular distâncias por marca
-    for (NodePassagem* p = listaPassagens; p; p = p->next) {
-        time_t t = parseTimestamp(p->passagem.dataHora);
-        if (t < inicio || t > fim) continue;
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
+    Arena arenaArquivo = ARENA_INIT("Passagens arquivadas", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
+    NodePassagem* passagens = passagensComArquivo(listaPassagens, inicioMs, fimMs, &arenaArquivo);
+    for (NodePassagem* p = passagens; p; p = passagem_seguinte(p)) {
+        long long t = p->passagem.ts;
+        if (t < inicioMs || t > fimMs) continue;
 
         int idV = p->passagem.idVeiculo;
+        if (filtrar && !bitmap_contem(&selecionados, (uint32_t)idV)) continue;
         int idS = p->passagem.idSensor;
         int idS_ant = -1;
 
-        NodePassagem* ant = p->next;
+        NodePassagem* ant = passagem_seguinte(p);
         while (ant) {
             if (ant->passagem.idVeiculo == idV) {
                 idS_ant = ant->passagem.idSensor;
                 break;
             }
-            ant = ant->next;
+            ant = passagem_seguinte(ant);
         }
         if (idS_ant == -1) continue;
 
         // Encontrar a marca do veículo
-        char marca[CARRO_MAX_MARCA] = "";
-        for (NodeCarro* c = listaCarros; c; c = c->next) {
-            if (c->carro.idVeiculo == idV) {
-                strncpy(marca, c->carro.marca, CARRO_MAX_MARCA);
-                break;
-            }
-        }
-        if (strlen(marca) == 0) continue;
+        NodeCarro* c = pesquisarCarroPorId(listaCarros, idV);
+        int codigoMarca = c ? c->carro.codigoMarca : -1;
+        if (codigoMarca < 0 || codigoMarca >= totalMarcas) continue;
 
-        // Verificar se a marca já está no ranking
-        int idx = -1;
-        for (int i = 0; i < nMarcas; i++) {
-            if (strcmp(ranking[i].marca, marca) == 0) {
-                idx = i;
-                break;
-            }
-        }
+        // Posição da marca no ranking (acesso direto pelo código)
+        int idx = posicaoMarca[codigoMarca];
         if (idx == -1) {
-            idx = nMarcas++;
-            strncpy(ranking[idx].marca, marca, CARRO_MAX_MARCA);
+            idx = posicaoMarca[codigoMarca] = nMarcas++;
+            ranking[idx].codigoMarca = codigoMarca;
             ranking[idx].km = 0.0;
         }
 
@@ -2192,15 +2380,36 @@ void rankingPorMarca(NodePassagem* listaPassagens, NodeDistancia* listaDistancia
         ranking[idx].km += dist;
     }
 
+    arena_libertar(&arenaArquivo);
+
     qsort(ranking, nMarcas, sizeof(KmMarca), cmpMarcaRanking);
 
     // 2. Exibir o ranking
     printf("\n=== Ranking por Marca ===\n");
     for (int i = 0; i < nMarcas; i++) {
-        printf("%2d) Marca: %s | Total de km: %.2f\n", i + 1, ranking[i].marca, ranking[i].km);
+        printf("%2d) Marca: %s | Total de km: %.2f\n", i + 1, dicionario_texto(&dicionarioMarcas, ranking[i].codigoMarca), ranking[i].km);
     }
 
-    free(ranking);
+    memoria_libertar(posicaoMarca);
+    memoria_libertar(ranking);
+    bitmap_libertar(&selecionados);
+}
+
+/**
+ * @brief Posição de um veículo no ranking de velocidades médias (ordenado por idVeiculo).
+ * 
+ * @param ranking 
+ * @param n 
+ * @param idVeiculo 
+ * @return int -1 se o veículo não estiver no ranking
+ */
+static int procurarVelocidadeMedia(const VelocidadeMedia* ranking, int n, int idVeiculo) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int meio = lo + (hi - lo) / 2;
+        if (ranking[meio].idVeiculo < idVeiculo) lo = meio + 1; else hi = meio;
+    }
+    return lo < n && ranking[lo].idVeiculo == idVeiculo ? lo : -1;
 }
 
 /**
@@ -2213,73 +2422,61 @@ void rankingPorMarca(NodePassagem* listaPassagens, NodeDistancia* listaDistancia
  * @param fim 
  */
 void velocidadesMedias(NodePassagem* listaPassagens, NodeDistancia* listaDistancias, NodeCarro* listaCarros, time_t inicio, time_t fim) {
-    // 1. Filtrar as passagens no intervalo
-    NodePassagem* passagensFiltradas = filtrarPassagens(listaPassagens, inicio, fim);
-    if (!passagensFiltradas) {
+    // 1. Passagens do intervalo, agrupadas por veículo e ordenadas por data
+    VistaPassagens passagensFiltradas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposPeriodo = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparPassagens(listaPassagens, inicio, fim, &passagensFiltradas, &gruposPeriodo);
+    if (!grupos) {
         printf("Nenhuma passagem encontrada no intervalo especificado.\n");
         return;
     }
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
     
-    // 2. Agrupar passagens por veículo usando a tabela hash existente
-    HashTablePassagens* ht = criarHashTablePassagens(100);
-    if (!ht) {
-        printf("Erro ao criar a tabela hash para passagens.\n");
-        libertarListaPassagens(&passagensFiltradas);
-        return;
-    }
-    for (NodePassagem* p = passagensFiltradas; p; p = p->next) {
-        inserirPassagemHash(ht, &p->passagem);
-    }
-    
-    // 3. Para cada grupo, ordenar as passagens e calcular a velocidade média
+    // 2. Para cada veículo, calcular a velocidade média
 
     size_t capacidade = 1000;
-    VelocidadeMedia* ranking = malloc(sizeof(VelocidadeMedia) * capacidade);
+    VelocidadeMedia* ranking = memoria_alocar(MEMORIA_CONSULTAS, sizeof(VelocidadeMedia) * capacidade);
     if (!ranking) {
         perror("Erro ao alocar memoria para ranking de velocidades");
-        libertarHashTablePassagens(ht);
-        libertarListaPassagens(&passagensFiltradas);
+        grupos_libertar(&gruposPeriodo);
+        vista_libertar(&passagensFiltradas);
         return;
     }
     int nVeiculos = 0;
     
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        PassagemGroup* grupo = ht->buckets[i];
-        while (grupo) {
-            // Ordena as passagens do grupo para garantir que estão ordenadas por data/hora
-            grupo->passagens = mergeSortPassagens(grupo->passagens);
-            double velMedia = calcularVelocidadeMediaPonderada(grupo->passagens, listaDistancias);
-            if (velMedia > 0) {
-                // Expande o array se necessário
-                if (nVeiculos >= capacidade) {
-                    capacidade *= 2;
-                    VelocidadeMedia* temp = realloc(ranking, sizeof(VelocidadeMedia) * capacidade);
-                    if (!temp) {
-                        perror("Erro ao realocar ranking");
-                        free(ranking);
-                        libertarHashTablePassagens(ht);
-                        libertarListaPassagens(&passagensFiltradas);
-                        return;
-                    }
-                    ranking = temp;
+    for (size_t v = 0; v < grupos->numVeiculos; v++) {
+        const Passagem* const* fatia;
+        size_t n = grupos_fatia(grupos, v, inicioMs, fimMs, &fatia);
+        double velMedia = calcularVelocidadeMediaPonderada(fatia, n, listaDistancias);
+        if (velMedia > 0) {
+            // Expande o array se necessário
+            if (nVeiculos >= capacidade) {
+                capacidade *= 2;
+                VelocidadeMedia* temp = memoria_realocar(MEMORIA_CONSULTAS, ranking, sizeof(VelocidadeMedia) * capacidade);
+                if (!temp) {
+                    perror("Erro ao realocar ranking");
+                    memoria_libertar(ranking);
+                    grupos_libertar(&gruposPeriodo);
+                    vista_libertar(&passagensFiltradas);
+                    return;
                 }
-                ranking[nVeiculos].idVeiculo = grupo->idVeiculo;
-                ranking[nVeiculos].velocidadeMedia = velMedia;
-                nVeiculos++;
+                ranking = temp;
             }
-            grupo = grupo->next;
+            ranking[nVeiculos].idVeiculo = grupos_idVeiculo(grupos, v);
+            ranking[nVeiculos].velocidadeMedia = velMedia;
+            nVeiculos++;
         }
     }
     
     if (nVeiculos == 0) {
         printf("Nenhum veículo com velocidade calculada no período especificado.\n");
-        free(ranking);
-        libertarHashTablePassagens(ht);
-        libertarListaPassagens(&passagensFiltradas);
+        memoria_libertar(ranking);
+        grupos_libertar(&gruposPeriodo);
+        vista_libertar(&passagensFiltradas);
         return;
     }
     
-    // 4. Exibir os resultados com menu de paginação e pesquisa por matrícula
+    // 3. Exibir os resultados com menu de paginação e pesquisa por matrícula
     int pageSize = 10;
     int currentPage = 0;
     char opcao;
@@ -2314,18 +2511,35 @@ void velocidadesMedias(NodePassagem* listaPassagens, NodeDistancia* listaDistanc
             currentPage--;
         else if (opcao == 'b') {
             char matriculaBusca[CARRO_MAX_MATRICULA];
-            printf("Digite a matrícula para busca: ");
+            printf("Digite a matrícula para busca (ou prefixo terminado em *): ");
             scanf("%s", matriculaBusca);
+            bool exata;
+            size_t comprimento = matricula_padrao(matriculaBusca, &exata);
             int encontrado = 0;
-            for (int i = 0; i < nVeiculos; i++) {
-                NodeCarro* carro = pesquisarCarroPorId(listaCarros, ranking[i].idVeiculo);
-                if (carro && strcmp(carro->carro.matricula, matriculaBusca) == 0) {
+            if (indiceMatriculas_valido(&indiceMatriculas, listaCarros)) {
+                // Carros da matrícula pelo índice; o ranking está por idVeiculo crescente
+                IntervaloMatriculas intervalo;
+                indiceMatriculas_intervalo(&indiceMatriculas, matriculaBusca, comprimento, &intervalo);
+                for (const EntradaMatricula* e; !(exata && encontrado) && (e = indiceMatriculas_seguinte(&intervalo)) != NULL; ) {
+                    const NodeCarro* carro = e->carro;
+                    int i = procurarVelocidadeMedia(ranking, nVeiculos, carro->carro.idVeiculo);
+                    if (i < 0) continue;
                     printf("Veículo encontrado: ID %d | Matrícula: %s | Velocidade Média: %.2f km/h\n",
                            ranking[i].idVeiculo,
                            carro->carro.matricula,
                            ranking[i].velocidadeMedia);
-                    encontrado = 1;
-                    break;
+                    encontrado++;
+                }
+            } else {
+                for (int i = 0; i < nVeiculos && !(exata && encontrado); i++) {
+                    NodeCarro* carro = pesquisarCarroPorId(listaCarros, ranking[i].idVeiculo);
+                    if (carro && strncmp(carro->carro.matricula, matriculaBusca, comprimento) == 0) {
+                        printf("Veículo encontrado: ID %d | Matrícula: %s | Velocidade Média: %.2f km/h\n",
+                               ranking[i].idVeiculo,
+                               carro->carro.matricula,
+                               ranking[i].velocidadeMedia);
+                        encontrado++;
+                    }
                 }
             }
             if (!encontrado)
@@ -2341,10 +2555,10 @@ void velocidadesMedias(NodePassagem* listaPassagens, NodeDistancia* listaDistanc
         }
     } while(opcao != 's');
     
-    // 5. Liberar recursos
-    free(ranking);
-    libertarHashTablePassagens(ht);
-    libertarListaPassagens(&passagensFiltradas);
+    // 4. Liberar recursos
+    memoria_libertar(ranking);
+    grupos_libertar(&gruposPeriodo);
+    vista_libertar(&passagensFiltradas);
 }
 
 /**
@@ -2372,69 +2586,74 @@ static int cmpMarcaVelocidade(const void* a, const void* b) {
  * Calcula e exibe um ranking de marcas de veículos com base na sua velocidade média 
  * num determinado período.
  */
-void rankingMarcasVelocidade(NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim) {
-    // --- Módulo 1: Filtrar passagens no intervalo de tempo ---
-    NodePassagem* passagensFiltradas = filtrarPassagens(listaPassagens, inicio, fim);
-    if (!passagensFiltradas) {
+void rankingMarcasVelocidade(NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias, time_t inicio, time_t fim, const FiltroCarros* filtro) {
+    // --- Módulo 0: Carros selecionados pelo filtro de atributos (se houver) ---
+    Bitmap selecionados = BITMAP_INIT(MEMORIA_CONSULTAS);
+    if (!selecionarCarros(filtro, listaCarros, &selecionados)) return;
+    bool filtrar = filtroCarros_ativo(filtro);
+
+    // --- Módulo 1: Passagens do intervalo, agrupadas por veículo e ordenadas ---
+    VistaPassagens passagensFiltradas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposPeriodo = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparPassagens(listaPassagens, inicio, fim, &passagensFiltradas, &gruposPeriodo);
+    if (!grupos) {
         printf("Nenhuma passagem encontrada no intervalo especificado.\n");
+        bitmap_libertar(&selecionados);
         return;
     }
-
-    // --- Módulo 2: Agrupar passagens por veículo numa hash table ---
-    HashTablePassagens* ht = criarHashTablePassagens(100); // 100 buckets, ajuste se necessário
-    for (NodePassagem* p = passagensFiltradas; p; p = p->next) {
-        inserirPassagemHash(ht, &p->passagem);
-    }
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
     
-    // --- Módulo 3: Calcular velocidade por veículo e agregar por marca ---
-    int capacidadeMarcas = 50; // Capacidade inicial para o array de marcas
-    MarcaVelocidade* rankingMarcas = malloc(sizeof(MarcaVelocidade) * capacidadeMarcas);
+    // --- Módulo 2: Calcular velocidade por veículo e agregar por marca ---
+    // Array denso indexado pelo código da marca: posicaoMarca[código] é a posição
+    // da marca em rankingMarcas (-1 = ainda não apareceu)
+    int totalMarcas = dicionarioMarcas.total;
+    MarcaVelocidade* rankingMarcas = memoria_alocar(MEMORIA_CONSULTAS, sizeof(MarcaVelocidade) * (totalMarcas + 1));
+    int* posicaoMarca = memoria_alocar(MEMORIA_CONSULTAS, sizeof(int) * (totalMarcas + 1));
+    if (!rankingMarcas || !posicaoMarca) {
+        printf("Erro ao alocar memoria para o ranking de marcas.\n");
+        memoria_libertar(rankingMarcas);
+        memoria_libertar(posicaoMarca);
+        grupos_libertar(&gruposPeriodo);
+        vista_libertar(&passagensFiltradas);
+        bitmap_libertar(&selecionados);
+        return;
+    }
+    for (int j = 0; j < totalMarcas; j++) posicaoMarca[j] = -1;
     int nMarcas = 0;
 
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        for (PassagemGroup* g = ht->buckets[i]; g; g = g->next) {
-            
-            // Ordenar passagens do veículo e calcular sua velocidade média
-            g->passagens = mergeSortPassagens(g->passagens);
-            double velMediaVeiculo = calcularVelocidadeMediaPonderada(g->passagens, listaDistancias);
-
-            if (velMediaVeiculo > 0) {
-                // Obter a marca do veículo
-                NodeCarro* carro = pesquisarCarroPorId(listaCarros, g->idVeiculo);
-                if (!carro) continue; // Pula se o carro não for encontrado
-
-                // Procurar se a marca já existe no nosso array de ranking
-                int idxMarca = -1;
-                for (int j = 0; j < nMarcas; j++) {
-                    if (strcmp(rankingMarcas[j].marca, carro->carro.marca) == 0) {
-                        idxMarca = j;
-                        break;
-                    }
-                }
-
-                if (idxMarca != -1) { // Marca já existe, atualiza os valores
-                    rankingMarcas[idxMarca].somaVelocidades += velMediaVeiculo;
-                    rankingMarcas[idxMarca].numVeiculos++;
-                } else { // Nova marca, adiciona ao array
-                    if (nMarcas >= capacidadeMarcas) { // Realocar se necessário
-                        capacidadeMarcas *= 2;
-                        rankingMarcas = realloc(rankingMarcas, sizeof(MarcaVelocidade) * capacidadeMarcas);
-                    }
-                    strncpy(rankingMarcas[nMarcas].marca, carro->carro.marca, CARRO_MAX_MARCA);
-                    rankingMarcas[nMarcas].somaVelocidades = velMediaVeiculo;
-                    rankingMarcas[nMarcas].numVeiculos = 1;
-                    nMarcas++;
-                }
+    for (size_t v = 0; v < grupos->numVeiculos; v++) {
+        if (filtrar && !bitmap_contem(&selecionados, (uint32_t)grupos_idVeiculo(grupos, v))) continue;
+        const Passagem* const* fatia;
+        size_t n = grupos_fatia(grupos, v, inicioMs, fimMs, &fatia);
+        double velMediaVeiculo = calcularVelocidadeMediaPonderada(fatia, n, listaDistancias);
+
+        if (velMediaVeiculo > 0) {
+            // Obter a marca do veículo
+            NodeCarro* carro = pesquisarCarroPorId(listaCarros, grupos_idVeiculo(grupos, v));
+            if (!carro) continue; // Pula se o carro não for encontrado
+            int codigoMarca = carro->carro.codigoMarca;
+            if (codigoMarca < 0 || codigoMarca >= totalMarcas) continue;
+
+            int idxMarca = posicaoMarca[codigoMarca];
+            if (idxMarca != -1) { // Marca já existe, atualiza os valores
+                rankingMarcas[idxMarca].somaVelocidades += velMediaVeiculo;
+                rankingMarcas[idxMarca].numVeiculos++;
+            } else { // Nova marca, acrescenta ao ranking
+                posicaoMarca[codigoMarca] = nMarcas;
+                rankingMarcas[nMarcas].codigoMarca = codigoMarca;
+                rankingMarcas[nMarcas].somaVelocidades = velMediaVeiculo;
+                rankingMarcas[nMarcas].numVeiculos = 1;
+                nMarcas++;
             }
         }
     }
 
-    // --- Módulo 4: Ordenar o ranking de marcas ---
+    // --- Módulo 3: Ordenar o ranking de marcas ---
     if (nMarcas > 0) {
         qsort(rankingMarcas, nMarcas, sizeof(MarcaVelocidade), cmpMarcaVelocidade);
     }
 
-    // --- Módulo 5: Exibir os resultados ---
+    // --- Módulo 4: Exibir os resultados ---
     printf("\n=== Ranking de Marcas por Velocidade Média ===\n");
     if (nMarcas == 0) {
         printf("Não foi possível calcular a velocidade média para nenhuma marca no período indicado.\n");
@@ -2443,26 +2662,31 @@ void rankingMarcasVelocidade(NodeCarro* listaCarros, NodePassagem* listaPassagen
             double velMediaFinal = rankingMarcas[i].somaVelocidades / rankingMarcas[i].numVeiculos;
             printf("%2d) Marca: %-15s | Velocidade Média: %.2f km/h  (%d veículos)\n",
                    i + 1,
-                   rankingMarcas[i].marca,
+                   dicionario_texto(&dicionarioMarcas, rankingMarcas[i].codigoMarca),
                    velMediaFinal,
                    rankingMarcas[i].numVeiculos);
         }
     }
 
-    // --- Módulo 6: Libertar memória ---
-    free(rankingMarcas);
-    libertarHashTablePassagens(ht);
-    libertarListaPassagens(&passagensFiltradas);
+    // --- Módulo 5: Libertar memória ---
+    memoria_libertar(posicaoMarca);
+    memoria_libertar(rankingMarcas);
+    grupos_libertar(&gruposPeriodo);
+    vista_libertar(&passagensFiltradas);
+    bitmap_libertar(&selecionados);
 }
 
 /**
  * @brief --- Função auxiliar para pesquisar um Dono por NIF ---
+ * Usa o indiceDonos quando este reflete a lista recebida.
  * 
  * @param listaDonos 
  * @param nif 
  * @return NodeDono* 
  */
 NodeDono* pesquisarDonoPorNIF(NodeDono* listaDonos, int nif) {
+    if (indiceIds_valido(&indiceDonos, listaDonos))
+        return indiceIds_procurar(&indiceDonos, nif);
     for (NodeDono* p = listaDonos; p; p = p->next) {
         if (p->dono.numeroContribuinte == nif) {
             return p;
@@ -2495,62 +2719,66 @@ static int cmpDonoVelocidade(const void* a, const void* b) {
  * Calcula e exibe um ranking de donos com base na velocidade média dos seus veículos.
  */
 void rankingDonosVelocidade(NodeDono* listaDonos, NodeCarro* listaCarros, NodePassagem* listaPassagens, 
-                          NodeDistancia* listaDistancias, time_t inicio, time_t fim) {
+                          NodeDistancia* listaDistancias, time_t inicio, time_t fim, const FiltroCarros* filtro) {
     
-    // Módulo 1: Filtrar e agrupar passagens (igual à função anterior)
-    NodePassagem* passagensFiltradas = filtrarPassagens(listaPassagens, inicio, fim);
-    if (!passagensFiltradas) {
+    // Módulo 0: Carros selecionados pelo filtro de atributos (se houver)
+    Bitmap selecionados = BITMAP_INIT(MEMORIA_CONSULTAS);
+    if (!selecionarCarros(filtro, listaCarros, &selecionados)) return;
+    bool filtrar = filtroCarros_ativo(filtro);
+
+    // Módulo 1: Passagens do intervalo, agrupadas por veículo (igual à função anterior)
+    VistaPassagens passagensFiltradas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposPeriodo = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparPassagens(listaPassagens, inicio, fim, &passagensFiltradas, &gruposPeriodo);
+    if (!grupos) {
         printf("Nenhuma passagem encontrada no intervalo especificado.\n");
+        bitmap_libertar(&selecionados);
         return;
     }
-    HashTablePassagens* ht = criarHashTablePassagens(100);
-    for (NodePassagem* p = passagensFiltradas; p; p = p->next) {
-        inserirPassagemHash(ht, &p->passagem);
-    }
+    long long inicioMs = (long long)inicio * 1000, fimMs = (long long)fim * 1000 + 999;
     
     // Módulo 2: Calcular velocidade por veículo e agregar por DONO
     int capacidadeDonos = 500; // Capacidade inicial para o array de donos
-    DonoVelocidade* rankingDonos = malloc(sizeof(DonoVelocidade) * capacidadeDonos);
+    DonoVelocidade* rankingDonos = memoria_alocar(MEMORIA_CONSULTAS, sizeof(DonoVelocidade) * capacidadeDonos);
     int nDonos = 0;
 
-    for (size_t i = 0; i < ht->numBuckets; i++) {
-        for (PassagemGroup* g = ht->buckets[i]; g; g = g->next) {
-            
-            g->passagens = mergeSortPassagens(g->passagens);
-            double velMediaVeiculo = calcularVelocidadeMediaPonderada(g->passagens, listaDistancias);
-
-            if (velMediaVeiculo > 0) {
-                // Obter o NIF do dono do veículo
-                NodeCarro* carro = pesquisarCarroPorId(listaCarros, g->idVeiculo);
-                if (!carro) continue;
-                int nifDono = carro->carro.donoContribuinte;
-
-                // Procurar se o dono já existe no nosso array de ranking
-                int idxDono = -1;
-                for (int j = 0; j < nDonos; j++) {
-                    if (rankingDonos[j].nifDono == nifDono) {
-                        idxDono = j;
-                        break;
-                    }
+    for (size_t v = 0; v < grupos->numVeiculos; v++) {
+        if (filtrar && !bitmap_contem(&selecionados, (uint32_t)grupos_idVeiculo(grupos, v))) continue;
+        const Passagem* const* fatia;
+        size_t n = grupos_fatia(grupos, v, inicioMs, fimMs, &fatia);
+        double velMediaVeiculo = calcularVelocidadeMediaPonderada(fatia, n, listaDistancias);
+
+        if (velMediaVeiculo > 0) {
+            // Obter o NIF do dono do veículo
+            NodeCarro* carro = pesquisarCarroPorId(listaCarros, grupos_idVeiculo(grupos, v));
+            if (!carro) continue;
+            int nifDono = carro->carro.donoContribuinte;
+
+            // Procurar se o dono já existe no nosso array de ranking
+            int idxDono = -1;
+            for (int j = 0; j < nDonos; j++) {
+                if (rankingDonos[j].nifDono == nifDono) {
+                    idxDono = j;
+                    break;
                 }
+            }
 
-                if (idxDono != -1) { // Dono já existe, atualiza os valores
-                    rankingDonos[idxDono].somaVelocidades += velMediaVeiculo;
-                    rankingDonos[idxDono].numVeiculos++;
-                } else { // Novo dono, adiciona ao array
-                    NodeDono* dono = pesquisarDonoPorNIF(listaDonos, nifDono);
-                    if (!dono) continue; // Pula se não encontrar os dados do dono
+            if (idxDono != -1) { // Dono já existe, atualiza os valores
+                rankingDonos[idxDono].somaVelocidades += velMediaVeiculo;
+                rankingDonos[idxDono].numVeiculos++;
+            } else { // Novo dono, adiciona ao array
+                NodeDono* dono = pesquisarDonoPorNIF(listaDonos, nifDono);
+                if (!dono) continue; // Pula se não encontrar os dados do dono
 
-                    if (nDonos >= capacidadeDonos) { // Realocar se necessário
-                        capacidadeDonos *= 2;
-                        rankingDonos = realloc(rankingDonos, sizeof(DonoVelocidade) * capacidadeDonos);
-                    }
-                    rankingDonos[nDonos].nifDono = nifDono;
-                    strncpy(rankingDonos[nDonos].nomeDono, dono->dono.nome, DONO_MAX_NOME);
-                    rankingDonos[nDonos].somaVelocidades = velMediaVeiculo;
-                    rankingDonos[nDonos].numVeiculos = 1;
-                    nDonos++;
+                if (nDonos >= capacidadeDonos) { // Realocar se necessário
+                    capacidadeDonos *= 2;
+                    rankingDonos = memoria_realocar(MEMORIA_CONSULTAS, rankingDonos, sizeof(DonoVelocidade) * capacidadeDonos);
                 }
+                rankingDonos[nDonos].nifDono = nifDono;
+                rankingDonos[nDonos].nomeDono = dono->dono.nome;
+                rankingDonos[nDonos].somaVelocidades = velMediaVeiculo;
+                rankingDonos[nDonos].numVeiculos = 1;
+                nDonos++;
             }
         }
     }
@@ -2571,7 +2799,7 @@ void rankingDonosVelocidade(NodeDono* listaDonos, NodeCarro* listaCarros, NodePa
             double velMediaFinal = rankingDonos[i].somaVelocidades / rankingDonos[i].numVeiculos;
             printf("%2d) Dono: %-25s (NIF: %d) | Vel. Média: %.2f km/h (%d veículos)\n",
                    i + 1,
-                   rankingDonos[i].nomeDono,
+                   strings_texto(&heapNomesDonos, rankingDonos[i].nomeDono),
                    rankingDonos[i].nifDono,
                    velMediaFinal,
                    rankingDonos[i].numVeiculos);
@@ -2579,9 +2807,10 @@ void rankingDonosVelocidade(NodeDono* listaDonos, NodeCarro* listaCarros, NodePa
     }
 
     // Módulo 5: Libertar memória
-    free(rankingDonos);
-    libertarHashTablePassagens(ht);
-    libertarListaPassagens(&passagensFiltradas);
+    memoria_libertar(rankingDonos);
+    grupos_libertar(&gruposPeriodo);
+    vista_libertar(&passagensFiltradas);
+    bitmap_libertar(&selecionados);
 }
 
 // --- Funções Auxiliares para a Exportação CSV ---
@@ -2602,11 +2831,13 @@ static void exportarDonosCSV(NodeDono* head, const char* filepath) {
     }
     // Header com uma coluna para cada variável da struct Dono
     fprintf(fp, "NumeroContribuinte,Nome,CodigoPostal\n");
+    char codigoPostal[DONO_MAX_CODIGOPOSTAL];
     for (NodeDono* p = head; p; p = p->next) {
+        formatarCodigoPostal(p->dono.codigoPostal, codigoPostal, sizeof(codigoPostal));
         fprintf(fp, "%d,\"%s\",\"%s\"\n", 
                 p->dono.numeroContribuinte, 
-                p->dono.nome, 
-                p->dono.codigoPostal);
+                nomeDono(&p->dono), 
+                codigoPostal);
     }
     fclose(fp);
     printf("Ficheiro %s exportado com sucesso.\n", filepath);
@@ -2629,8 +2860,8 @@ static void exportarCarrosCSV(NodeCarro* head, const char* filepath) {
     for (NodeCarro* p = head; p; p = p->next) {
         fprintf(fp, "\"%s\",\"%s\",\"%s\",%d,%d,%d\n",
                 p->carro.matricula,
-                p->carro.marca,
-                p->carro.modelo,
+                marcaCarro(&p->carro),
+                modeloCarro(&p->carro),
                 p->carro.ano,
                 p->carro.donoContribuinte,
                 p->carro.idVeiculo);
@@ -2653,12 +2884,13 @@ static void exportarSensoresCSV(NodeSensor* head, const char* filepath) {
     }
     // Header com uma coluna para cada variável da struct Sensor
     fprintf(fp, "IdSensor,Designacao,Latitude,Longitude\n");
+    char lat[GEO_MAX_TEXTO], lon[GEO_MAX_TEXTO];
     for (NodeSensor* p = head; p; p = p->next) {
         fprintf(fp, "%d,\"%s\",\"%s\",\"%s\"\n",
                 p->sensor.idSensor,
                 p->sensor.designacao,
-                p->sensor.latitude,
-                p->sensor.longitude);
+                textoCoordenada(p->sensor.latitudeTexto, p->sensor.latitude, true, lat, sizeof(lat)),
+                textoCoordenada(p->sensor.longitudeTexto, p->sensor.longitude, false, lon, sizeof(lon)));
     }
     fclose(fp);
     printf("Ficheiro %s exportado com sucesso.\n", filepath);
@@ -2688,6 +2920,22 @@ static void exportarDistanciasCSV(NodeDistancia* head, const char* filepath) {
     printf("Ficheiro %s exportado com sucesso.\n", filepath);
 }
 
+/**
+ * @brief Passagens a exportar: as arquivadas no segmento (nós criados na arena),
+ * por ordem de data, seguidas das da lista.
+ * 
+ * @param lista 
+ * @param arena 
+ * @return NodePassagem* 
+ */
+static NodePassagem* passagensComArquivadas(NodePassagem* lista, Arena* arena) {
+    NodePassagem *arquivadas, *caudaArquivadas;
+    segmento_filtrar(&segmentoPassagens, LLONG_MIN, LLONG_MAX, SEGMENTO_SO_PERIODO, arena, &arquivadas, &caudaArquivadas);
+    if (!arquivadas) return lista;
+    caudaArquivadas->next = lista;
+    return arquivadas;
+}
+
 /**
  * @brief 
  * 
@@ -2702,7 +2950,7 @@ static void exportarPassagensCSV(NodePassagem* head, const char* filepath) {
     }
     // Header com uma coluna para cada variável da struct Passagem
     fprintf(fp, "IdSensor,IdVeiculo,DataHora,TipoRegisto\n");
-    for (NodePassagem* p = head; p; p = p->next) {
+    for (NodePassagem* p = head; p; p = passagem_seguinte(p)) {
         fprintf(fp, "%d,%d,\"%s\",%d\n",
                 p->passagem.idSensor,
                 p->passagem.idVeiculo,
@@ -2734,7 +2982,9 @@ void exportarDadosCSV(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor*
     exportarCarrosCSV(listaCarros, "Export-CSV/carros.csv");
     exportarSensoresCSV(listaSensores, "Export-CSV/sensores.csv");
     exportarDistanciasCSV(listaDistancias, "Export-CSV/distancias.csv");
-    exportarPassagensCSV(listaPassagens, "Export-CSV/passagens.csv");
+    Arena arenaArquivo = ARENA_INIT("Passagens arquivadas", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
+    exportarPassagensCSV(passagensComArquivadas(listaPassagens, &arenaArquivo), "Export-CSV/passagens.csv");
+    arena_libertar(&arenaArquivo);
     
     printf("--- Exportação concluída. ---\n");
 }
@@ -2782,10 +3032,12 @@ void exportarDadosXML(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor*
         fprintf(fp, "\t\t<dono>\n");
         fprintf(fp, "\t\t\t<numeroContribuinte>%d</numeroContribuinte>\n", p->dono.numeroContribuinte);
         fprintf(fp, "\t\t\t<nome>");
-        escreverStringXML(fp, p->dono.nome);
+        escreverStringXML(fp, nomeDono(&p->dono));
         fprintf(fp, "</nome>\n");
         fprintf(fp, "\t\t\t<codigoPostal>");
-        escreverStringXML(fp, p->dono.codigoPostal);
+        char codigoPostal[DONO_MAX_CODIGOPOSTAL];
+        formatarCodigoPostal(p->dono.codigoPostal, codigoPostal, sizeof(codigoPostal));
+        escreverStringXML(fp, codigoPostal);
         fprintf(fp, "</codigoPostal>\n");
         fprintf(fp, "\t\t</dono>\n");
     }
@@ -2799,10 +3051,10 @@ void exportarDadosXML(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor*
         escreverStringXML(fp, p->carro.matricula);
         fprintf(fp, "</matricula>\n");
         fprintf(fp, "\t\t\t<marca>");
-        escreverStringXML(fp, p->carro.marca);
+        escreverStringXML(fp, marcaCarro(&p->carro));
         fprintf(fp, "</marca>\n");
         fprintf(fp, "\t\t\t<modelo>");
-        escreverStringXML(fp, p->carro.modelo);
+        escreverStringXML(fp, modeloCarro(&p->carro));
         fprintf(fp, "</modelo>\n");
         fprintf(fp, "\t\t\t<ano>%d</ano>\n", p->carro.ano);
         fprintf(fp, "\t\t\t<donoContribuinte>%d</donoContribuinte>\n", p->carro.donoContribuinte);
@@ -2820,10 +3072,11 @@ void exportarDadosXML(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor*
         escreverStringXML(fp, p->sensor.designacao);
         fprintf(fp, "</designacao>\n");
         fprintf(fp, "\t\t\t<latitude>");
-        escreverStringXML(fp, p->sensor.latitude);
+        char coordenada[GEO_MAX_TEXTO];
+        escreverStringXML(fp, textoCoordenada(p->sensor.latitudeTexto, p->sensor.latitude, true, coordenada, sizeof(coordenada)));
         fprintf(fp, "</latitude>\n");
         fprintf(fp, "\t\t\t<longitude>");
-        escreverStringXML(fp, p->sensor.longitude);
+        escreverStringXML(fp, textoCoordenada(p->sensor.longitudeTexto, p->sensor.longitude, false, coordenada, sizeof(coordenada)));
         fprintf(fp, "</longitude>\n");
         fprintf(fp, "\t\t</sensor>\n");
     }
@@ -2840,9 +3093,10 @@ void exportarDadosXML(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor*
     }
     fprintf(fp, "\t</listaDistancias>\n\n");
 
-    // --- Exportar Passagens ---
+    // --- Exportar Passagens (as arquivadas primeiro) ---
+    Arena arenaArquivo = ARENA_INIT("Passagens arquivadas", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
     fprintf(fp, "\t<listaPassagens>\n");
-    for (NodePassagem* p = listaPassagens; p; p = p->next) {
+    for (NodePassagem* p = passagensComArquivadas(listaPassagens, &arenaArquivo); p; p = passagem_seguinte(p)) {
         fprintf(fp, "\t\t<passagem>\n");
         fprintf(fp, "\t\t\t<idSensor>%d</idSensor>\n", p->passagem.idSensor);
         fprintf(fp, "\t\t\t<idVeiculo>%d</idVeiculo>\n", p->passagem.idVeiculo);
@@ -2853,6 +3107,7 @@ void exportarDadosXML(NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor*
         fprintf(fp, "\t\t</passagem>\n");
     }
     fprintf(fp, "\t</listaPassagens>\n");
+    arena_libertar(&arenaArquivo);
 
     // Fechar o elemento-raiz
     fprintf(fp, "</baseDeDados>\n");
@@ -2874,44 +3129,34 @@ void debugVeiculo(int idVeiculoDebug, NodeCarro* listaCarros, NodePassagem* list
     printf("--- INICIANDO DEBUG PARA O VEICULO ID: %d ---\n", idVeiculoDebug);
     printf("==============================================\n");
 
-    // Passo 1: Isolar as passagens apenas para este veículo
-    NodePassagem* passagensVeiculo = NULL;
-    NodePassagem* cauda = NULL;
-    for (NodePassagem* p = listaPassagens; p; p = p->next) {
-        if (p->passagem.idVeiculo == idVeiculoDebug) {
-            NodePassagem* nova = malloc(sizeof(NodePassagem));
-            if (!nova) {
-                printf("ERRO: Falha ao alocar memoria para debug.\n");
-                return;
-            }
-            nova->passagem = p->passagem;
-            nova->next = NULL;
-            if (passagensVeiculo == NULL) {
-                passagensVeiculo = cauda = nova;
-            } else {
-                cauda->next = nova;
-                cauda = nova;
-            }
-        }
-    }
-
-    if (passagensVeiculo == NULL) {
+    // Passo 1: As passagens deste veículo, já ordenadas por data/hora, são uma
+    // fatia do índice por veículo (sem índice, agrupa-se a lista num temporário)
+    VistaPassagens todas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposTemporarios = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparLista(listaPassagens, &todas, &gruposTemporarios);
+
+    const Passagem* const* passagensVeiculo = NULL;
+    size_t n = 0, v;
+    if (grupos && grupos_posicao(grupos, idVeiculoDebug, &v))
+        n = grupos_fatia(grupos, v, LLONG_MIN, LLONG_MAX, &passagensVeiculo);
+    if (n == 0) {
         printf("Nenhuma passagem encontrada para o veiculo ID %d.\n", idVeiculoDebug);
+        grupos_libertar(&gruposTemporarios);
+        vista_libertar(&todas);
         return;
     }
 
-    // Passo 2: Ordenar as passagens do veículo por data/hora
-    passagensVeiculo = mergeSortPassagens(passagensVeiculo);
+    // Passo 2: Listar as passagens do veículo
     printf("\n[INFO] Encontradas e ordenadas as seguintes passagens:\n");
-    for (NodePassagem* p = passagensVeiculo; p; p = p->next) {
-        printf(" -> Sensor: %d | Data: %s\n", p->passagem.idSensor, p->passagem.dataHora);
+    for (size_t i = 0; i < n; i++) {
+        printf(" -> Sensor: %d | Data: %s\n", passagensVeiculo[i]->idSensor, passagensVeiculo[i]->dataHora);
     }
 
     // Passo 3: Informação do Veículo
     NodeCarro* carro = pesquisarCarroPorId(listaCarros, idVeiculoDebug);
     if (carro) {
         printf("\n[INFO] Detalhes do Veiculo: Matricula %s, Marca %s, Modelo %s\n",
-               carro->carro.matricula, carro->carro.marca, carro->carro.modelo);
+               carro->carro.matricula, marcaCarro(&carro->carro), modeloCarro(&carro->carro));
     } else {
         printf("\n[AVISO] Nao foram encontrados detalhes para o veiculo ID %d.\n", idVeiculoDebug);
     }
@@ -2922,21 +3167,23 @@ void debugVeiculo(int idVeiculoDebug, NodeCarro* listaCarros, NodePassagem* list
     double tempoTotalViagem = 0.0;
     int trocosValidos = 0;
 
-    for (NodePassagem* p = passagensVeiculo; p && p->next; p = p->next) {
-        printf("\n-> A analisar troco: Sensor %d para Sensor %d\n", p->passagem.idSensor, p->next->passagem.idSensor);
+    for (size_t i = 0; i + 1 < n; i++) {
+        const Passagem* p1 = passagensVeiculo[i];
+        const Passagem* p2 = passagensVeiculo[i + 1];
+        printf("\n-> A analisar troco: Sensor %d para Sensor %d\n", p1->idSensor, p2->idSensor);
 
         // Obter Timestamps
-        time_t ts1 = p->passagem.ts;
-        time_t ts2 = p->next->passagem.ts;
-        printf("   - DataHora 1: %s (Timestamp Lido: %ld)\n", p->passagem.dataHora, ts1);
-        printf("   - DataHora 2: %s (Timestamp Lido: %ld)\n", p->next->passagem.dataHora, ts2);
+        long long ts1 = p1->ts;
+        long long ts2 = p2->ts;
+        printf("   - DataHora 1: %s (Timestamp Lido: %lld ms)\n", p1->dataHora, ts1);
+        printf("   - DataHora 2: %s (Timestamp Lido: %lld ms)\n", p2->dataHora, ts2);
         
         // Obter Distância
-        double distancia = obterDistancia(listaDistancias, p->passagem.idSensor, p->next->passagem.idSensor);
+        double distancia = obterDistancia(listaDistancias, p1->idSensor, p2->idSensor);
         printf("   - Distancia entre sensores: %.2f km\n", distancia);
 
         // Calcular Tempo
-        double tempo_s = difftime(ts2, ts1);
+        double tempo_s = (ts2 - ts1) / 1000.0;
         printf("   - Tempo de viagem no troco: %.2f segundos\n", tempo_s);
 
         // Validações
@@ -2965,8 +3212,9 @@ void debugVeiculo(int idVeiculoDebug, NodeCarro* listaCarros, NodePassagem* list
     }
     printf("==============================================\n");
 
-    // Limpar a memória alocada para a lista temporária
-    libertarListaPassagens(&passagensVeiculo);
+    // Limpar o índice temporário e as passagens arquivadas (se foram precisos)
+    grupos_libertar(&gruposTemporarios);
+    vista_libertar(&todas);
 }
 
 /**
@@ -2983,70 +3231,66 @@ void lerString(const char* prompt, char* buffer, int tamanho) {
 }
 
 /**
- * @brief 
+ * @brief Velocidade média das viagens dos veículos dos donos de um código postal
  * 
- * @param codPostal 
+ * @param codPostal Código ("4000-123") ou prefixo terminado em '*' ("4000-*")
  * @param listaDonos 
  * @param listaCarros 
  * @param listaPassagens 
  * @param listaDistancias 
- * @return double 
+ * @return double -1.0 se o código for inválido ou não houver viagens
  */
 double velocidadeMediaPorCodigoPostal(const char* codPostal, NodeDono* listaDonos, NodeCarro* listaCarros, NodePassagem* listaPassagens, NodeDistancia* listaDistancias) {
     double distanciaTotal = 0.0;
     double tempoTotalSegundos = 0.0;
     int viagensConsideradas = 0; // Contador para garantir que houve viagens válidas
 
-    for (NodeDono* dono = listaDonos; dono != NULL; dono = dono->next) {
-        if (strcmp(dono->dono.codigoPostal, codPostal) != 0)
-            continue;
-
-        int nif = dono->dono.numeroContribuinte;
+    // Donos do código (ou prefixo) e os seus veículos: fatias contíguas do índice postal
+    size_t primeiro, ultimo;
+    if (!indicePostal_sincronizar(&indicePostal, listaDonos, listaCarros) ||
+        !indicePostal_intervalo(&indicePostal, codPostal, &primeiro, &ultimo))
+        return -1.0;
+    const int* veiculos;
+    size_t numVeiculos = indicePostal_veiculos(&indicePostal, primeiro, ultimo, &veiculos);
+    if (numVeiculos == 0) return -1.0;
+
+    // As passagens de cada veículo já estão agrupadas e ordenadas por data/hora
+    VistaPassagens todas = VISTA_PASSAGENS_INIT;
+    GruposVeiculo gruposTemporarios = GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS);
+    const GruposVeiculo* grupos = agruparLista(listaPassagens, &todas, &gruposTemporarios);
+
+    for (size_t i = 0; grupos && i < numVeiculos; i++) {
+        const Passagem* const* fatia;
+        size_t v, n = 0;
+        if (grupos_posicao(grupos, veiculos[i], &v))
+            n = grupos_fatia(grupos, v, LLONG_MIN, LLONG_MAX, &fatia);
+
+        // Cada saída fecha a última entrada pendente do veículo
+        const Passagem* entradaPendente = NULL;
+        for (size_t k = 0; k < n; k++) {
+            const Passagem* pass = fatia[k];
+            if (pass->tipoRegisto == 0) { // Entrada
+                entradaPendente = pass;
+            } else if (pass->tipoRegisto == 1 && entradaPendente != NULL) { // Saída correspondente a uma entrada pendente
+                double dist = obterDistancia(listaDistancias, entradaPendente->idSensor, pass->idSensor);
+                
+                if (dist > 0) { // Distância tem que ser positiva
+                    double delta = (pass->ts - entradaPendente->ts) / 1000.0;
 
-        for (NodeCarro* carro = listaCarros; carro != NULL; carro = carro->next) {
-            if (carro->carro.donoContribuinte != nif)
-                continue;
+                    const double MAX_TEMPO_VIAGEM_SEGUNDOS = 24 * 3600.0; // Ex: 24 horas
 
-            int idVeiculo = carro->carro.idVeiculo;
-            NodePassagem* entradaPendente = NULL;
-
-            // Para esta lógica funcionar bem, a listaPassagens deveria estar ordenada
-            // globalmente por idVeiculo e depois por tempo, ou deveríamos filtrar
-            // as passagens por idVeiculo primeiro.
-            // Esta abordagem simplificada assume que para um dado veículo,
-            // uma entrada é seguida por uma saída correspondente antes de outra entrada.
-            for (NodePassagem* pass = listaPassagens; pass != NULL; pass = pass->next) {
-                if (pass->passagem.idVeiculo != idVeiculo)
-                    continue;
-
-                if (pass->passagem.tipoRegisto == 0) { // Entrada
-                    entradaPendente = pass;
-                } else if (pass->passagem.tipoRegisto == 1 && entradaPendente != NULL) { // Saída correspondente a uma entrada pendente
-                    
-                    // Verifica se esta saída é realmente para a última entrada deste veículo
-                    // (Numa lista global, outra entrada para o mesmo veículo poderia ter atualizado entradaPendente)
-                    // No entanto, mantemos a lógica original do seu colega para este ponto.
-                    
-                    double dist = obterDistancia(listaDistancias, entradaPendente->passagem.idSensor, pass->passagem.idSensor);
-                    
-                    if (dist > 0) { // Distância tem que ser positiva
-                        time_t t1 = entradaPendente->passagem.ts; // Usar timestamp pré-calculado
-                        time_t t2 = pass->passagem.ts;   // Usar timestamp pré-calculado
-                        double delta = difftime(t2, t1);
-
-                        const double MAX_TEMPO_VIAGEM_SEGUNDOS = 24 * 3600.0; // Ex: 24 horas
-
-                        if (delta > 0 && delta < MAX_TEMPO_VIAGEM_SEGUNDOS) {
-                            distanciaTotal += dist;
-                            tempoTotalSegundos += delta;
-                            viagensConsideradas++;
-                        }
+                    if (delta > 0 && delta < MAX_TEMPO_VIAGEM_SEGUNDOS) {
+                        distanciaTotal += dist;
+                        tempoTotalSegundos += delta;
+                        viagensConsideradas++;
                     }
-                    entradaPendente = NULL; // Reset para procurar novo par entrada-saída
                 }
+                entradaPendente = NULL; // Reset para procurar novo par entrada-saída
             }
         }
     }
+    grupos_libertar(&gruposTemporarios);
+    vista_libertar(&todas);
 
     if (tempoTotalSegundos == 0 || viagensConsideradas == 0) {
         return -1.0; // Evitar divisão por zero ou nenhuma viagem válida
@@ -3076,7 +3320,7 @@ int compararCarrosPorMatricula(const void* a, const void* b) {
 int compararDonosPorNome(const void* a, const void* b) {
     NodeDono* donoA = *(NodeDono**)a; // 'a' e 'b' são ponteiros para NodeDono*
     NodeDono* donoB = *(NodeDono**)b;
-    return strcmp(donoA->dono.nome, donoB->dono.nome);
+    return strcmp(nomeDono(&donoA->dono), nomeDono(&donoB->dono));
 }
 
 /**
@@ -3088,85 +3332,96 @@ int compararDonosPorNome(const void* a, const void* b) {
  * @param fim 
  */
 void listarVeiculosPorPeriodo(NodePassagem* listaPassagens, NodeCarro* listaCarros, time_t inicio, time_t fim) {
-    if (!listaPassagens || !listaCarros) {
+    if ((!listaPassagens && !segmentoPassagens.cabecalho) || !listaCarros) {
         printf("Nao ha passagens ou carros carregados para processar.\n");
         return;
     }
 
+    // Só as passagens do período: as arquivadas dos blocos do período e uma fatia do índice temporal
+    VistaPassagens vista = VISTA_PASSAGENS_INIT;
+    if (!filtrarPassagens(listaPassagens, inicio, fim, &vista)) {
+        printf("\nNenhum veiculo circulou no periodo especificado.\n");
+        return;
+    }
+
     NodeCarro* listaCarrosPeriodoOriginal = NULL; // Lista temporária NÃO ordenada
     NodeCarro* caudaCarrosPeriodoOriginal = NULL;
     int totalCarrosNoPeriodo = 0;
+    Arena arenaTemp = ARENA_INIT("Carros periodo", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS); // nós das duas listas temporárias
 
     int* idsVeiculosAdicionados = NULL;
     int capacidadeIds = 100;
     int contadorIds = 0;
-    idsVeiculosAdicionados = malloc(capacidadeIds * sizeof(int));
+    idsVeiculosAdicionados = memoria_alocar(MEMORIA_CONSULTAS, capacidadeIds * sizeof(int));
     if (!idsVeiculosAdicionados) {
         printf("Erro ao alocar memoria para IDs de veiculos.\n");
+        vista_libertar(&vista);
         return;
     }
 
-    for (NodePassagem* p = listaPassagens; p; p = p->next) {
-        if (p->passagem.ts >= inicio && p->passagem.ts <= fim) {
-            int idVeiculoAtual = p->passagem.idVeiculo;
-            bool jaAdicionado = false;
-            for (int i = 0; i < contadorIds; i++) {
-                if (idsVeiculosAdicionados[i] == idVeiculoAtual) {
-                    jaAdicionado = true;
-                    break;
-                }
+    for (const Passagem* ps; (ps = vista_seguinte(&vista)) != NULL; ) {
+        int idVeiculoAtual = ps->idVeiculo;
+        bool jaAdicionado = false;
+        for (int i = 0; i < contadorIds; i++) {
+            if (idsVeiculosAdicionados[i] == idVeiculoAtual) {
+                jaAdicionado = true;
+                break;
             }
+        }
+
+        if (!jaAdicionado) {
+            NodeCarro* carroEncontrado = pesquisarCarroPorId(listaCarros, idVeiculoAtual);
+            if (carroEncontrado) {
+                NodeCarro* novoNode = arena_alloc(&arenaTemp, sizeof(NodeCarro));
+                if (!novoNode) {
+                    fprintf(stderr, "Erro ao alocar memoria para NodeCarro temporario.\n");
+                    memoria_libertar(idsVeiculosAdicionados);
+                    vista_libertar(&vista);
+                    arena_libertar(&arenaTemp);
+                    return;
+                }
+                novoNode->carro = carroEncontrado->carro;
+                novoNode->next = NULL;
+
+                if (listaCarrosPeriodoOriginal == NULL) {
+                    listaCarrosPeriodoOriginal = caudaCarrosPeriodoOriginal = novoNode;
+                } else {
+                    caudaCarrosPeriodoOriginal->next = novoNode;
+                    caudaCarrosPeriodoOriginal = novoNode;
+                }
+                totalCarrosNoPeriodo++;
 
-            if (!jaAdicionado) {
-                NodeCarro* carroEncontrado = pesquisarCarroPorId(listaCarros, idVeiculoAtual);
-                if (carroEncontrado) {
-                    NodeCarro* novoNode = malloc(sizeof(NodeCarro));
-                    if (!novoNode) {
-                        fprintf(stderr, "Erro ao alocar memoria para NodeCarro temporario.\n");
-                        free(idsVeiculosAdicionados);
-                        libertarListaCarros(&listaCarrosPeriodoOriginal);
+                if (contadorIds >= capacidadeIds) {
+                    capacidadeIds *= 2;
+                    int* temp = memoria_realocar(MEMORIA_CONSULTAS, idsVeiculosAdicionados, capacidadeIds * sizeof(int));
+                    if (!temp) {
+                        fprintf(stderr, "Erro ao realocar memoria para IDs de veiculos.\n");
+                        memoria_libertar(idsVeiculosAdicionados);
+                        vista_libertar(&vista);
+                        arena_libertar(&arenaTemp);
                         return;
                     }
-                    novoNode->carro = carroEncontrado->carro;
-                    novoNode->next = NULL;
-
-                    if (listaCarrosPeriodoOriginal == NULL) {
-                        listaCarrosPeriodoOriginal = caudaCarrosPeriodoOriginal = novoNode;
-                    } else {
-                        caudaCarrosPeriodoOriginal->next = novoNode;
-                        caudaCarrosPeriodoOriginal = novoNode;
-                    }
-                    totalCarrosNoPeriodo++;
-
-                    if (contadorIds >= capacidadeIds) {
-                        capacidadeIds *= 2;
-                        int* temp = realloc(idsVeiculosAdicionados, capacidadeIds * sizeof(int));
-                        if (!temp) {
-                            fprintf(stderr, "Erro ao realocar memoria para IDs de veiculos.\n");
-                            free(idsVeiculosAdicionados);
-                            libertarListaCarros(&listaCarrosPeriodoOriginal);
-                            return;
-                        }
-                        idsVeiculosAdicionados = temp;
-                    }
-                    idsVeiculosAdicionados[contadorIds++] = idVeiculoAtual;
+                    idsVeiculosAdicionados = temp;
                 }
+                idsVeiculosAdicionados[contadorIds++] = idVeiculoAtual;
             }
         }
     }
-    free(idsVeiculosAdicionados);
+    memoria_libertar(idsVeiculosAdicionados);
+    vista_libertar(&vista);
 
     if (listaCarrosPeriodoOriginal == NULL) {
         printf("\nNenhum veiculo circulou no periodo especificado.\n");
+        arena_libertar(&arenaTemp);
         return;
     }
 
     // --- Bloco de Ordenação ---
     // 1. Converter listaCarrosPeriodoOriginal para um array de NodeCarro*
-    NodeCarro** arrayParaOrdenar = malloc(totalCarrosNoPeriodo * sizeof(NodeCarro*));
+    NodeCarro** arrayParaOrdenar = memoria_alocar(MEMORIA_CONSULTAS, totalCarrosNoPeriodo * sizeof(NodeCarro*));
     if (!arrayParaOrdenar) {
         fprintf(stderr, "Erro ao alocar array para ordenacao.\n");
-        libertarListaCarros(&listaCarrosPeriodoOriginal);
+        arena_libertar(&arenaTemp);
         return;
     }
     NodeCarro* tempNode = listaCarrosPeriodoOriginal;
@@ -3182,12 +3437,11 @@ void listarVeiculosPorPeriodo(NodePassagem* listaPassagens, NodeCarro* listaCarr
     NodeCarro* listaCarrosOrdenada = NULL;
     NodeCarro* caudaOrdenada = NULL;
     for (int i = 0; i < totalCarrosNoPeriodo; i++) {
-        NodeCarro* novoNodeOrdenado = malloc(sizeof(NodeCarro));
+        NodeCarro* novoNodeOrdenado = arena_alloc(&arenaTemp, sizeof(NodeCarro));
         if (!novoNodeOrdenado) {
             fprintf(stderr, "Erro ao alocar memoria para lista ordenada.\n");
-            free(arrayParaOrdenar);
-            libertarListaCarros(&listaCarrosPeriodoOriginal);
-            libertarListaCarros(&listaCarrosOrdenada); // Liberta o que foi construído
+            memoria_libertar(arrayParaOrdenar);
+            arena_libertar(&arenaTemp); // Liberta as duas listas
             return;
         }
         novoNodeOrdenado->carro = arrayParaOrdenar[i]->carro; // Copia os dados
@@ -3200,8 +3454,7 @@ void listarVeiculosPorPeriodo(NodePassagem* listaPassagens, NodeCarro* listaCarr
             caudaOrdenada = novoNodeOrdenado;
         }
     }
-    free(arrayParaOrdenar); // Já não precisamos do array de ponteiros
-    libertarListaCarros(&listaCarrosPeriodoOriginal); // A lista original já não é necessária
+    memoria_libertar(arrayParaOrdenar); // Já não precisamos do array de ponteiros
 
     // --- Fim do Bloco de Ordenação ---
 
@@ -3215,7 +3468,8 @@ void listarVeiculosPorPeriodo(NodePassagem* listaPassagens, NodeCarro* listaCarr
         "--- Veiculos em Circulacao no Periodo (Ordenado por Matricula) ---"
     );
 
-    libertarListaCarros(&listaCarrosOrdenada); // Liberta a lista ordenada que criámos
+    printf("\nMemória de %d nós Carro libertada.\n", totalCarrosNoPeriodo);
+    arena_libertar(&arenaTemp); // Liberta as listas temporárias que criámos
 }
 
 /**
@@ -3239,7 +3493,7 @@ void imprimirListaDonosOrdemAlfabetica(NodeDono* listaDonos) {
     }
 
     // 2. Criar um array de ponteiros para NodeDono
-    NodeDono** arrayParaOrdenar = malloc(totalDonos * sizeof(NodeDono*));
+    NodeDono** arrayParaOrdenar = memoria_alocar(MEMORIA_CONSULTAS, totalDonos * sizeof(NodeDono*));
     if (!arrayParaOrdenar) {
         fprintf(stderr, "Erro ao alocar array para ordenacao de donos.\n");
         return;
@@ -3258,15 +3512,16 @@ void imprimirListaDonosOrdemAlfabetica(NodeDono* listaDonos) {
     // Esta lista será temporária, apenas para exibição paginada.
     NodeDono* listaDonosOrdenada = NULL;
     NodeDono* caudaOrdenada = NULL;
+    Arena arenaTemp = ARENA_INIT("Donos ordenados", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
     for (int i = 0; i < totalDonos; i++) {
         // Criamos novos nós, mas eles vão apontar para os dados originais dos donos
         // ou, para segurança, podemos copiar os dados do dono.
         // Vamos copiar os dados para evitar modificar a lista original se os nós fossem alterados.
-        NodeDono* novoNodeOrdenado = malloc(sizeof(NodeDono));
+        NodeDono* novoNodeOrdenado = arena_alloc(&arenaTemp, sizeof(NodeDono));
         if (!novoNodeOrdenado) {
             fprintf(stderr, "Erro ao alocar memoria para lista ordenada de donos.\n");
-            free(arrayParaOrdenar);
-            libertarListaDonos(&listaDonosOrdenada); // Liberta o que foi construído
+            memoria_libertar(arrayParaOrdenar);
+            arena_libertar(&arenaTemp); // Liberta o que foi construído
             return;
         }
         novoNodeOrdenado->dono = arrayParaOrdenar[i]->dono; // Copia a struct Dono
@@ -3279,7 +3534,7 @@ void imprimirListaDonosOrdemAlfabetica(NodeDono* listaDonos) {
             caudaOrdenada = novoNodeOrdenado;
         }
     }
-    free(arrayParaOrdenar); // O array de ponteiros já não é necessário
+    memoria_libertar(arrayParaOrdenar); // O array de ponteiros já não é necessário
 
     // 5. Chamar a função de paginação genérica com a lista ordenada
     // As funções auxiliares contarDonos, obterNextDono, imprimirItemDono, pesquisarDono
@@ -3296,7 +3551,8 @@ void imprimirListaDonosOrdemAlfabetica(NodeDono* listaDonos) {
     );
 
     // 6. Libertar a lista ligada ordenada temporária
-    libertarListaDonos(&listaDonosOrdenada);
+    printf("\nMemória de %zu nós Dono libertada.\n", arenaTemp.numAlocacoes);
+    arena_libertar(&arenaTemp);
 }
 
 /**
@@ -3310,53 +3566,38 @@ void determinarMarcaMaisComum(NodeCarro* listaCarros) {
         return;
     }
 
-    MarcaContagem* contagens = NULL;
+    // Uma contagem por marca do dicionário, pela ordem em que as marcas aparecem na lista;
+    // posicaoMarca[código] é a posição da marca em contagens (-1 = ainda não apareceu)
+    int totalMarcas = dicionarioMarcas.total;
     int numMarcasUnicas = 0;
-    int capacidadeMarcas = 10; // Capacidade inicial do array de contagens
-
-    contagens = malloc(capacidadeMarcas * sizeof(MarcaContagem));
-    if (!contagens) {
+    MarcaContagem* contagens = memoria_alocar(MEMORIA_CONSULTAS, (totalMarcas + 1) * sizeof(MarcaContagem));
+    int* posicaoMarca = memoria_alocar(MEMORIA_CONSULTAS, (totalMarcas + 1) * sizeof(int));
+    if (!contagens || !posicaoMarca) {
         printf("Erro ao alocar memoria para contagem de marcas.\n");
+        memoria_libertar(contagens);
+        memoria_libertar(posicaoMarca);
         return;
     }
+    for (int i = 0; i < totalMarcas; i++) posicaoMarca[i] = -1;
 
     // 1. Contar ocorrências de cada marca
     for (NodeCarro* p = listaCarros; p != NULL; p = p->next) {
-        const char* marcaAtual = p->carro.marca;
-        bool encontrada = false;
-
-        // Procura se a marca já foi contada
-        for (int i = 0; i < numMarcasUnicas; i++) {
-            if (strcmp(contagens[i].marca, marcaAtual) == 0) {
-                contagens[i].contagem++;
-                encontrada = true;
-                break;
-            }
-        }
-
-        // Se não foi encontrada, adiciona como nova marca
-        if (!encontrada) {
-            if (numMarcasUnicas >= capacidadeMarcas) {
-                // Aumenta a capacidade do array se necessário
-                capacidadeMarcas *= 2;
-                MarcaContagem* temp = realloc(contagens, capacidadeMarcas * sizeof(MarcaContagem));
-                if (!temp) {
-                    printf("Erro ao realocar memoria para contagem de marcas.\n");
-                    free(contagens);
-                    return;
-                }
-                contagens = temp;
-            }
-            strcpy(contagens[numMarcasUnicas].marca, marcaAtual);
-            contagens[numMarcasUnicas].contagem = 1;
-            numMarcasUnicas++;
+        int codigoMarca = p->carro.codigoMarca;
+        if (codigoMarca < 0 || codigoMarca >= totalMarcas) continue;
+        int idx = posicaoMarca[codigoMarca];
+        if (idx == -1) {
+            idx = posicaoMarca[codigoMarca] = numMarcasUnicas++;
+            contagens[idx].codigoMarca = codigoMarca;
+            contagens[idx].contagem = 0;
         }
+        contagens[idx].contagem++;
     }
+    memoria_libertar(posicaoMarca);
 
     // 2. Encontrar a contagem máxima
     if (numMarcasUnicas == 0) {
         printf("\nNenhuma marca encontrada (lista de carros vazia ou sem marcas).\n");
-        free(contagens);
+        memoria_libertar(contagens);
         return;
     }
 
@@ -3372,9 +3613,9 @@ void determinarMarcaMaisComum(NodeCarro* listaCarros) {
     printf("A(s) marca(s) mais comum(ns) aparece(m) %d vez(es):\n", maxContagem);
     for (int i = 0; i < numMarcasUnicas; i++) {
         if (contagens[i].contagem == maxContagem) {
-            printf("- %s\n", contagens[i].marca);
+            printf("- %s\n", dicionario_texto(&dicionarioMarcas, contagens[i].codigoMarca));
         }
     }
 
-    free(contagens); // Libertar a memória do array de contagens
+    memoria_libertar(contagens); // Libertar a memória do array de contagens
 }
\ No newline at end of file
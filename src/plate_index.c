@@ -0,0 +1,288 @@
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // qsort
+#include <string.h>     // strncmp, strlen, memmove
+#include "plate_index.h"
+#include "memory.h"
+
+IndiceMatriculas indiceMatriculas = INDICE_MATRICULAS_INIT;
+
+/**
+ * @brief Primeiros 8 caracteres (até ao fim do texto) em big-endian, completados com zeros.
+ *
+ * @param texto
+ * @param comprimento
+ * @return uint64_t
+ */
+static uint64_t empacotar(const char* texto, size_t comprimento) {
+    uint64_t chave = 0;
+    size_t i = 0;
+    for (; i < 8 && i < comprimento && texto[i] != '\0'; i++)
+        chave = (chave << 8) | (unsigned char)texto[i];
+    return chave << (8 * (8 - i));
+}
+
+/**
+ * @brief Compara os primeiros 'comprimento' caracteres da matrícula de uma
+ * entrada com o texto (como strncmp, mas os 8 primeiros sem ir ao nó).
+ *
+ * @param e
+ * @param chave empacotar(texto, comprimento)
+ * @param texto
+ * @param comprimento
+ * @return int
+ */
+static int comparar(const EntradaMatricula* e, uint64_t chave, const char* texto, size_t comprimento) {
+    size_t n = comprimento < 8 ? comprimento : 8;
+    uint64_t mascara = n == 8 ? ~0ull : ~(~0ull >> (8 * n));
+    uint64_t a = e->chave & mascara, b = chave & mascara;
+    if (a != b) return a < b ? -1 : 1;
+    if (comprimento <= 8 || (e->chave & 0xFF) == 0) return 0; // o texto acaba nos 8 primeiros
+    return strncmp(e->carro->carro.matricula + 8, texto + 8, comprimento - 8);
+}
+
+static int cmpEntradas(const void* a, const void* b) {
+    const EntradaMatricula* e1 = a;
+    const EntradaMatricula* e2 = b;
+    int c = comparar(e1, e2->chave, e2->carro->carro.matricula, CARRO_MAX_MATRICULA);
+    if (c != 0) return c;
+    return e1->ordem < e2->ordem ? -1 : e1->ordem > e2->ordem;
+}
+
+/**
+ * @brief Garante espaço para mais uma entrada.
+ *
+ * @param idx
+ * @param n
+ * @return bool false se faltar memória
+ */
+static bool reservar(IndiceMatriculas* idx, size_t n) {
+    if (n <= idx->capacidade) return true;
+    size_t nova = idx->capacidade ? idx->capacidade : INDICE_MATRICULAS_CAPACIDADE_MIN;
+    while (nova < n) nova *= 2;
+    EntradaMatricula* entradas = memoria_realocar(MEMORIA_INDICES, idx->entradas, nova * sizeof *entradas);
+    if (!entradas) return false;
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)((nova - idx->capacidade) * sizeof *entradas));
+    idx->entradas = entradas;
+    idx->capacidade = nova;
+    return true;
+}
+
+/**
+ * @brief (Re)constrói o índice a partir da lista de carros.
+ *
+ * @param idx
+ * @param lista
+ * @return bool false se faltar memória (o índice fica vazio e as pesquisas são lineares)
+ */
+bool indiceMatriculas_construir(IndiceMatriculas* idx, NodeCarro* lista) {
+    indiceMatriculas_libertar(idx);
+    if (!lista) return true;
+
+    size_t n = 0;
+    for (NodeCarro* p = lista; p; p = p->next) n++;
+    if (n > INT32_MAX || !reservar(idx, n)) {
+        fprintf(stderr, "Sem memoria para o indice de matriculas; a usar pesquisa linear.\n");
+        indiceMatriculas_libertar(idx);
+        return false;
+    }
+    for (NodeCarro* p = lista; p; p = p->next, idx->total++) {
+        idx->entradas[idx->total] = (EntradaMatricula){
+            empacotar(p->carro.matricula, CARRO_MAX_MATRICULA), p, (int)idx->total };
+    }
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)(n * sizeof *idx->entradas));
+    qsort(idx->entradas, idx->total, sizeof *idx->entradas, cmpEntradas);
+    idx->cabeca = lista;
+    return true;
+}
+
+/**
+ * @brief Máximo de carros pendentes: inserir nos pendentes custa O(pendentes)
+ * e cada fusão O(total), pelo que o equilíbrio fica perto de √total.
+ *
+ * @param idx
+ * @return size_t
+ */
+static size_t limitePendentes(const IndiceMatriculas* idx) {
+    size_t k = INDICE_MATRICULAS_PENDENTES_MIN;
+    while ((k * 2) * (k * 2) <= idx->total) k *= 2;
+    return k;
+}
+
+/**
+ * @brief Põe uma entrada nos pendentes, antes das matrículas iguais (é a
+ * primeira da lista).
+ *
+ * @param idx
+ * @param e
+ * @return bool false se faltar memória
+ */
+static bool inserirPendente(IndiceMatriculas* idx, EntradaMatricula e) {
+    if (idx->numPendentes == idx->capacidadePendentes) {
+        size_t nova = idx->capacidadePendentes ? idx->capacidadePendentes * 2 : INDICE_MATRICULAS_PENDENTES_MIN;
+        EntradaMatricula* pendentes = memoria_realocar(MEMORIA_INDICES, idx->pendentes, nova * sizeof *pendentes);
+        if (!pendentes) return false;
+        memoria_ajustarFolga(MEMORIA_INDICES, (long long)((nova - idx->capacidadePendentes) * sizeof *pendentes));
+        idx->pendentes = pendentes;
+        idx->capacidadePendentes = nova;
+    }
+    size_t lo = 0, hi = idx->numPendentes;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        if (comparar(&idx->pendentes[meio], e.chave, e.carro->carro.matricula, CARRO_MAX_MATRICULA) < 0) lo = meio + 1;
+        else hi = meio;
+    }
+    memmove(idx->pendentes + lo + 1, idx->pendentes + lo, (idx->numPendentes - lo) * sizeof *idx->pendentes);
+    idx->pendentes[lo] = e;
+    idx->numPendentes++;
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)sizeof *idx->pendentes);
+    return true;
+}
+
+/**
+ * @brief Funde os pendentes nas entradas, do fim para o início (sem memória temporária).
+ *
+ * @param idx
+ * @return bool false se faltar memória
+ */
+static bool fundirPendentes(IndiceMatriculas* idx) {
+    size_t total = idx->total + idx->numPendentes;
+    if (!reservar(idx, total)) return false;
+    size_t a = idx->total, b = idx->numPendentes, k = total;
+    while (b > 0) {
+        if (a > 0 && cmpEntradas(&idx->entradas[a - 1], &idx->pendentes[b - 1]) > 0)
+            idx->entradas[--k] = idx->entradas[--a];
+        else
+            idx->entradas[--k] = idx->pendentes[--b];
+    }
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)(idx->numPendentes * sizeof *idx->entradas));
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)(idx->numPendentes * sizeof *idx->pendentes));
+    idx->total = total;
+    idx->numPendentes = 0;
+    return true;
+}
+
+/**
+ * @brief Regista um carro acabado de pôr à cabeça da lista (nos pendentes).
+ * Se o índice não refletia a lista anterior nada muda.
+ *
+ * @param idx
+ * @param no Nova cabeça da lista
+ * @return bool true se o índice reflete a nova lista
+ */
+bool indiceMatriculas_inserirCabeca(IndiceMatriculas* idx, NodeCarro* no) {
+    if (no->next == NULL) return indiceMatriculas_construir(idx, no);
+    if (!indiceMatriculas_valido(idx, no->next)) return false;
+
+    EntradaMatricula e = { empacotar(no->carro.matricula, CARRO_MAX_MATRICULA), no, idx->primeiraOrdem - 1 };
+    if (!inserirPendente(idx, e) || (idx->numPendentes > limitePendentes(idx) && !fundirPendentes(idx))) {
+        fprintf(stderr, "Sem memoria para o indice de matriculas; a usar pesquisa linear.\n");
+        indiceMatriculas_libertar(idx);
+        return false;
+    }
+    idx->primeiraOrdem--;
+    idx->cabeca = no;
+    return true;
+}
+
+/**
+ * @brief Fatia [primeira, primeira + n) de um array ordenado de entradas com
+ * as matrículas que começam pelos primeiros 'comprimento' caracteres do texto.
+ *
+ * @param entradas
+ * @param total
+ * @param chave empacotar(texto, comprimento)
+ * @param texto
+ * @param comprimento
+ * @param primeira
+ * @return size_t n
+ */
+static size_t fatia(const EntradaMatricula* entradas, size_t total, uint64_t chave,
+                    const char* texto, size_t comprimento, size_t* primeira) {
+    size_t lo = 0, hi = total;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        if (comparar(&entradas[meio], chave, texto, comprimento) < 0) lo = meio + 1; else hi = meio;
+    }
+    *primeira = lo;
+    hi = total;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        if (comparar(&entradas[meio], chave, texto, comprimento) <= 0) lo = meio + 1; else hi = meio;
+    }
+    return lo - *primeira;
+}
+
+/**
+ * @brief Entradas cuja matrícula começa pelos primeiros 'comprimento' caracteres
+ * do texto. Com comprimento = strlen(texto) + 1 (o '\0' incluído) a
+ * correspondência é exata; ver matricula_padrao().
+ *
+ * @param idx Válido
+ * @param texto
+ * @param comprimento
+ * @param intervalo Recebe as fatias, a percorrer com indiceMatriculas_seguinte()
+ * @return size_t Número de entradas
+ */
+size_t indiceMatriculas_intervalo(const IndiceMatriculas* idx, const char* texto, size_t comprimento,
+                                  IntervaloMatriculas* intervalo) {
+    uint64_t chave = empacotar(texto, comprimento);
+    size_t primeira;
+    intervalo->numEntradas  = fatia(idx->entradas, idx->total, chave, texto, comprimento, &primeira);
+    intervalo->entradas     = idx->entradas + primeira;
+    intervalo->numPendentes = fatia(idx->pendentes, idx->numPendentes, chave, texto, comprimento, &primeira);
+    intervalo->pendentes    = idx->pendentes + primeira;
+    return intervalo->numEntradas + intervalo->numPendentes;
+}
+
+/**
+ * @brief Próxima entrada de um intervalo, por ordem de matrícula e, nas
+ * matrículas iguais, pela ordem da lista.
+ *
+ * @param intervalo
+ * @return const EntradaMatricula* NULL no fim
+ */
+const EntradaMatricula* indiceMatriculas_seguinte(IntervaloMatriculas* intervalo) {
+    bool temEntrada = intervalo->numEntradas > 0, temPendente = intervalo->numPendentes > 0;
+    if (!temEntrada && !temPendente) return NULL;
+    if (temEntrada && (!temPendente || cmpEntradas(intervalo->entradas, intervalo->pendentes) < 0)) {
+        intervalo->numEntradas--;
+        return intervalo->entradas++;
+    }
+    intervalo->numPendentes--;
+    return intervalo->pendentes++;
+}
+
+/**
+ * @brief Número de caracteres a comparar para um padrão de pesquisa: uma
+ * matrícula exata ("06-FK-48", com o '\0') ou um prefixo terminado em '*' ("06-FK-*").
+ *
+ * @param padrao
+ * @param exata Recebe true se o padrão for uma matrícula exata (pode ser NULL)
+ * @return size_t
+ */
+size_t matricula_padrao(const char* padrao, bool* exata) {
+    size_t n = strlen(padrao);
+    bool prefixo = n > 0 && padrao[n - 1] == '*';
+    if (exata) *exata = !prefixo;
+    return prefixo ? n - 1 : n + 1;
+}
+
+/**
+ * @brief Liberta o índice e deixa-o vazio (reutilizável).
+ *
+ * @param idx
+ */
+void indiceMatriculas_libertar(IndiceMatriculas* idx) {
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)((idx->capacidade - idx->total) * sizeof *idx->entradas));
+    memoria_ajustarFolga(MEMORIA_INDICES,
+                         -(long long)((idx->capacidadePendentes - idx->numPendentes) * sizeof *idx->pendentes));
+    memoria_libertar(idx->entradas);
+    memoria_libertar(idx->pendentes);
+    *idx = (IndiceMatriculas)INDICE_MATRICULAS_INIT;
+}
+
+void indiceMatriculas_imprimirEstatisticas(const IndiceMatriculas* idx) {
+    printf("Indice de matriculas: %zu matriculas (+%zu pendentes) em %zu posicoes (%zu bytes)\n",
+           idx->total, idx->numPendentes, idx->capacidade,
+           (idx->capacidade + idx->capacidadePendentes) * sizeof(EntradaMatricula));
+}
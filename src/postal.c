@@ -0,0 +1,55 @@
+#include <stdio.h>      // snprintf
+#include "postal.h"
+
+/**
+ * @brief Empacota um código postal da forma DDDD[D]-DDD (1 a 5 dígitos, hífen,
+ * 1 a 3 dígitos) ou só com o prefixo.
+ *
+ * @param texto Não precisa de ser terminado em '\0'
+ * @param comprimento
+ * @return uint32_t Código empacotado, ou CODIGO_POSTAL_INVALIDO
+ */
+uint32_t empacotarCodigoPostal(const char* texto, size_t comprimento) {
+    uint32_t partes[2] = { 0, 0 };
+    unsigned digitos[2] = { 0, 0 };
+    int parte = 0;
+
+    for (size_t i = 0; i < comprimento; i++) {
+        char c = texto[i];
+        if (c >= '0' && c <= '9') {
+            partes[parte] = partes[parte] * 10 + (uint32_t)(c - '0');
+            digitos[parte]++;
+        } else if (c == '-' && parte == 0) {
+            parte = 1;
+        } else {
+            return CODIGO_POSTAL_INVALIDO;
+        }
+    }
+    if (digitos[0] == 0 || digitos[0] > CODIGO_POSTAL_MAX_PREFIXO || digitos[1] > CODIGO_POSTAL_MAX_SUFIXO)
+        return CODIGO_POSTAL_INVALIDO;
+    if (parte == 1 && digitos[1] == 0) return CODIGO_POSTAL_INVALIDO; // "4000-"
+
+    return ((uint32_t)digitos[0] << 29) | (partes[0] << 12) | ((uint32_t)digitos[1] << 10) | partes[1];
+}
+
+/**
+ * @brief Reconstrói o texto de um código postal empacotado ("" se for inválido).
+ *
+ * @param codigo
+ * @param destino
+ * @param tamanho DONO_MAX_CODIGOPOSTAL chega para qualquer código
+ */
+void formatarCodigoPostal(uint32_t codigo, char* destino, size_t tamanho) {
+    int digitosPrefixo = (int)(codigo >> 29);
+    int digitosSufixo  = (int)((codigo >> 10) & 0x3);
+    unsigned prefixo   = (codigo >> 12) & 0x1FFFF;
+    unsigned sufixo    = codigo & 0x3FF;
+
+    if (codigo == CODIGO_POSTAL_INVALIDO) {
+        if (tamanho > 0) destino[0] = '\0';
+    } else if (digitosSufixo == 0) {
+        snprintf(destino, tamanho, "%0*u", digitosPrefixo, prefixo);
+    } else {
+        snprintf(destino, tamanho, "%0*u-%0*u", digitosPrefixo, prefixo, digitosSufixo, sufixo);
+    }
+}
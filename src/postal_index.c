@@ -0,0 +1,200 @@
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // qsort
+#include <string.h>     // strcmp, strncmp, strlen, memcpy, memmove
+#include "postal_index.h"
+#include "postal.h"
+#include "memory.h"
+
+IndicePostal indicePostal = INDICE_POSTAL_INIT;
+
+/**
+ * @brief Carro na construção do índice: ordenado por (nif, ordem na lista).
+ *
+ */
+typedef struct {
+    int    nif;
+    int    idVeiculo;
+    size_t ordem;
+} CarroPostal;
+
+static int cmpCarroPostal(const void* a, const void* b) {
+    const CarroPostal* c1 = a;
+    const CarroPostal* c2 = b;
+    if (c1->nif != c2->nif) return c1->nif < c2->nif ? -1 : 1;
+    return c1->ordem < c2->ordem ? -1 : c1->ordem > c2->ordem;
+}
+
+/**
+ * @brief Dono na construção do índice: ordenado por (código, ordem na lista).
+ *
+ */
+typedef struct {
+    EntradaPostal entrada;
+    size_t        ordem;
+} DonoPostal;
+
+static int cmpDonoPostal(const void* a, const void* b) {
+    const DonoPostal* d1 = a;
+    const DonoPostal* d2 = b;
+    int c = strcmp(d1->entrada.codigo, d2->entrada.codigo);
+    if (c != 0) return c;
+    return d1->ordem < d2->ordem ? -1 : d1->ordem > d2->ordem;
+}
+
+/**
+ * @brief (Re)constrói o índice se as listas não forem as que ele reflete.
+ *
+ * @param idx
+ * @param listaDonos
+ * @param listaCarros
+ * @return bool false se faltar memória (o índice fica vazio)
+ */
+bool indicePostal_sincronizar(IndicePostal* idx, const NodeDono* listaDonos, const NodeCarro* listaCarros) {
+    if (idx->donos && idx->cabecaDonos == listaDonos && idx->cabecaCarros == listaCarros)
+        return true;
+    indicePostal_libertar(idx);
+
+    size_t numDonos = 0, numCarros = 0;
+    for (const NodeDono* p = listaDonos; p; p = p->next)
+        if (p->dono.codigoPostal != CODIGO_POSTAL_INVALIDO) numDonos++;
+    for (const NodeCarro* p = listaCarros; p; p = p->next)
+        numCarros++;
+
+    DonoPostal* donos = memoria_alocar(MEMORIA_INDICES, (numDonos + 1) * sizeof *donos);
+    CarroPostal* carros = memoria_alocar(MEMORIA_INDICES, (numCarros + 1) * sizeof *carros);
+    if (!donos || !carros) {
+        fprintf(stderr, "Erro Crítico: falta de memória no índice postal.\n");
+        memoria_libertar(donos);
+        memoria_libertar(carros);
+        return false;
+    }
+
+    size_t n = 0;
+    for (const NodeDono* p = listaDonos; p; p = p->next) {
+        if (p->dono.codigoPostal == CODIGO_POSTAL_INVALIDO) continue;
+        formatarCodigoPostal(p->dono.codigoPostal, donos[n].entrada.codigo, sizeof donos[n].entrada.codigo);
+        donos[n].entrada.nif = p->dono.numeroContribuinte;
+        donos[n].ordem = n;
+        n++;
+    }
+    n = 0;
+    for (const NodeCarro* p = listaCarros; p; p = p->next, n++)
+        carros[n] = (CarroPostal){ p->carro.donoContribuinte, p->carro.idVeiculo, n };
+    qsort(donos, numDonos, sizeof *donos, cmpDonoPostal);
+    qsort(carros, numCarros, sizeof *carros, cmpCarroPostal);
+
+    // Primeira passagem conta os veículos de cada dono, a segunda copia-os
+    size_t numVeiculos = 0;
+    int* veiculos = NULL;
+    for (int copiar = 0; copiar < 2; copiar++) {
+        numVeiculos = 0;
+        for (size_t d = 0; d < numDonos; d++) {
+            int nif = donos[d].entrada.nif;
+            size_t lo = 0, hi = numCarros;
+            while (lo < hi) {
+                size_t meio = lo + (hi - lo) / 2;
+                if (carros[meio].nif < nif) lo = meio + 1; else hi = meio;
+            }
+            donos[d].entrada.primeiroVeiculo = (uint32_t)numVeiculos;
+            for (; lo < numCarros && carros[lo].nif == nif; lo++, numVeiculos++)
+                if (copiar) veiculos[numVeiculos] = carros[lo].idVeiculo;
+        }
+        donos[numDonos].entrada.primeiroVeiculo = (uint32_t)numVeiculos;
+        if (!copiar && (numVeiculos > UINT32_MAX ||
+                        !(veiculos = memoria_alocar(MEMORIA_INDICES, (numVeiculos + 1) * sizeof *veiculos)))) {
+            fprintf(stderr, "Erro Crítico: falta de memória no índice postal.\n");
+            memoria_libertar(donos);
+            memoria_libertar(carros);
+            return false;
+        }
+    }
+    memoria_libertar(carros);
+
+    // Fica só a parte EntradaPostal, compactada no mesmo bloco
+    EntradaPostal* entradas = (EntradaPostal*)donos;
+    for (size_t d = 0; d <= numDonos; d++)
+        memmove(&entradas[d], &donos[d].entrada, sizeof *entradas);
+    EntradaPostal* compactadas = memoria_realocar(MEMORIA_INDICES, entradas, (numDonos + 1) * sizeof *entradas);
+
+    idx->donos = compactadas ? compactadas : entradas;
+    idx->numDonos = numDonos;
+    idx->veiculos = veiculos;
+    idx->numVeiculos = numVeiculos;
+    idx->cabecaDonos = listaDonos;
+    idx->cabecaCarros = listaCarros;
+    return true;
+}
+
+/**
+ * @brief Primeiro dono cujo código, limitado a 'comprimento' caracteres, não é menor do que 'chave'.
+ *
+ * @param idx
+ * @param chave
+ * @param comprimento
+ * @param incluirIguais false para saltar também os iguais (limite superior)
+ * @return size_t
+ */
+static size_t limite(const IndicePostal* idx, const char* chave, size_t comprimento, bool incluirIguais) {
+    size_t lo = 0, hi = idx->numDonos;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        int c = strncmp(idx->donos[meio].codigo, chave, comprimento);
+        if (c < 0 || (c == 0 && !incluirIguais)) lo = meio + 1; else hi = meio;
+    }
+    return lo;
+}
+
+/**
+ * @brief Donos [primeiro, ultimo) com um código postal. O padrão é um código
+ * ("4000-123") ou um prefixo terminado em '*' ("4000-*", "40*").
+ *
+ * @param idx Sincronizado
+ * @param padrao
+ * @param primeiro
+ * @param ultimo
+ * @return bool false se o padrão não for válido
+ */
+bool indicePostal_intervalo(const IndicePostal* idx, const char* padrao, size_t* primeiro, size_t* ultimo) {
+    char chave[DONO_MAX_CODIGOPOSTAL];
+    size_t comprimento = strlen(padrao);
+
+    if (comprimento > 0 && padrao[comprimento - 1] == '*') {
+        comprimento--;
+        if (comprimento >= sizeof chave) return false;
+        bool hifen = false;
+        for (size_t i = 0; i < comprimento; i++) {
+            if (padrao[i] == '-' && i > 0 && !hifen) hifen = true;
+            else if (padrao[i] < '0' || padrao[i] > '9') return false;
+        }
+        memcpy(chave, padrao, comprimento);
+        chave[comprimento] = '\0';
+    } else {
+        // Código exato: normalizado como no índice ("4000-12" continua distinto de "4000-012")
+        uint32_t codigo = empacotarCodigoPostal(padrao, comprimento);
+        if (codigo == CODIGO_POSTAL_INVALIDO) return false;
+        formatarCodigoPostal(codigo, chave, sizeof chave);
+        comprimento = sizeof chave;
+    }
+
+    *primeiro = limite(idx, chave, comprimento, true);
+    *ultimo   = limite(idx, chave, comprimento, false);
+    return true;
+}
+
+/**
+ * @brief Liberta o índice e deixa-o vazio (reutilizável).
+ *
+ * @param idx
+ */
+void indicePostal_libertar(IndicePostal* idx) {
+    memoria_libertar(idx->donos);
+    memoria_libertar(idx->veiculos);
+    *idx = (IndicePostal)INDICE_POSTAL_INIT;
+}
+
+void indicePostal_imprimirEstatisticas(const IndicePostal* idx) {
+    printf("Indice postal: %zu donos, %zu veiculos (%zu bytes)\n",
+           idx->numDonos, idx->numVeiculos,
+           (idx->donos ? idx->numDonos + 1 : 0) * sizeof(EntradaPostal) +
+           (idx->veiculos ? idx->numVeiculos + 1 : 0) * sizeof(int));
+}
@@ -1,206 +1,209 @@
-#include <stdio.h>      // fopen, fgets, fclose, fprintf, , printf
-#include <stdlib.h>     // malloc, free, atoi
-#include <string.h>     // strtok, strcpy, strncpy, strchr
+#include <stdio.h>      // fopen, fclose, fprintf, printf
+#include <string.h>     // strcpy, memchr
+#include <time.h>       // clock_gettime
+#ifndef _WIN32
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap, munmap, madvise
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close, sysconf
+#include <pthread.h>    // pthread_create, pthread_join
+#endif
 #include "read_files.h" 
 #include "data.h"      
 #include "operations.h"
+#include "tokenizer.h"
+#include "decompress.h"
+#include "dictionary.h"
+#include "geo.h"
+#include "postal.h"
+#include "segment.h"
+#include "id_index.h"
+#include "plate_index.h"
+#include "name_index.h"
+#include "distance_matrix.h"
 
 /**
- * @brief Liberta toda a memória alocada para uma lista ligada de Donos.
+ * @brief Liberta a arena de uma lista cuja leitura falhou a meio (falta de memória).
  * Função auxiliar para ser usada dentro de read_files.c.
  * 
- * @param lista 
+ * @param arena 
  */
-static void libertarListaDonosParcial(NodeDono** lista) {
-    NodeDono* atual = *lista;
-    NodeDono* proximo;
-    int count = 0;
-
-    while (atual != NULL) {
-        proximo = atual->next; // Guarda referência para o próximo nó
-        free(atual);           // Liberta a memória do nó atual
-        atual = proximo;       // Move para o próximo nó
-        count++;
-    }
-
-    *lista = NULL; // Define o ponteiro original da lista como NULL
+static void libertarArenaParcial(Arena* arena) {
+    size_t count = arena->numAlocacoes;
+    arena_libertar(arena);
     if (count > 0) {
-         fprintf(stderr, " -> Memória de %d nós libertada.\n", count);
+        fprintf(stderr, " -> Memória de %zu nós %s libertada.\n", count, arena->nome);
     }
 }
 
+
+
 /**
- * @brief Liberta toda a memória alocada para uma lista ligada de Carros.
- * Função auxiliar para ser usada dentro de read_files.c.
- * 
- * @param lista 
+ * @brief Interpreta um bloco de linhas completas [ini, fim) de um ficheiro.
+ * Devolve false para interromper a leitura (falta de memória).
  */
-static void libertarListaCarrosParcial(NodeCarro** lista) {
-    NodeCarro* atual = *lista;
-    NodeCarro* proximo;
-    int count = 0;
-    while (atual != NULL) {
-        proximo = atual->next; // Guarda referência para o próximo nó
-        free(atual);           // Liberta a memória do nó atual
-        atual = proximo;       // Move para o próximo nó
-        count++;
-    }
-    *lista = NULL; // Define o ponteiro original da lista como NULL
-    if (count > 0) {
-         fprintf(stderr, " -> Memória de %d nós Carro libertada.\n", count);
-    }
-}
+typedef bool (*ParserBloco)(const char* ini, const char* fim, void* ctx);
 
 /**
- * @brief --- Função Auxiliar Estática para Liberar Sensores em Caso de Erro ---
+ * @brief Resultado de lerFicheiroPorBlocos().
  * 
- * @param lista 
  */
-static void libertarListaSensoresParcial(NodeSensor** lista) {
-    NodeSensor *atual = *lista, *proximo;
-    int count = 0;
-    while (atual) {
-        proximo = atual->next;
-        free(atual);
-        atual = proximo;
-        count++;
-    }
-    *lista = NULL;
-    if (count > 0) {
-        fprintf(stderr, " -> Memória de %d nós Sensor libertada.\n", count);
-    }
-}
+typedef enum {
+    LEITURA_OK,
+    LEITURA_ERRO_ABRIR,    // ficheiro inexistente, vazio ou descompressor indisponível
+    LEITURA_INTERROMPIDA   // o parser pediu para parar ou a descompressão falhou
+} ResultadoLeitura;
 
 /**
- * @brief Liberta todos os nós de NodeDistancia de uma lista.
- *        Usada internamente se ocorrer erro de malloc em lerDistancias().
+ * @brief Entrega o conteúdo de um ficheiro ao parser. Ficheiros de texto são
+ * mapeados em memória e entregues num só bloco; ficheiros .gz / .zst são
+ * descomprimidos em pipeline (ver decompress.h) e entregues em blocos de
+ * linhas completas, enquanto o bloco seguinte ainda está a ser descomprimido.
+ * 
+ * @param nomeFicheiro 
+ * @param parser 
+ * @param ctx Passado ao parser
+ * @param bytes Recebe o número de bytes (descomprimidos) entregues; pode ser NULL
+ * @return ResultadoLeitura 
  */
-static void libertarListaDistanciasParcial(NodeDistancia** lista) {
-    NodeDistancia *atual = *lista, *seguinte;
-    int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
-        cont++;
-    }
-    *lista = NULL;
-    if (cont > 0) {
-        fprintf(stderr, " -> Memória de %d nós Distancia libertada por erro.\n", cont);
+static ResultadoLeitura lerFicheiroPorBlocos(const char* nomeFicheiro, ParserBloco parser, void* ctx, size_t* bytes) {
+    size_t total = 0;
+    ResultadoLeitura resultado = LEITURA_OK;
+
+    if (ficheiroComprimido(nomeFicheiro)) {
+        LeitorComprimido* leitor = abrirComprimido(nomeFicheiro);
+        if (!leitor) return LEITURA_ERRO_ABRIR;
+        const char *ini, *fim;
+        while (proximoBlocoComprimido(leitor, &ini, &fim)) {
+            total += (size_t)(fim - ini);
+            if (!parser(ini, fim, ctx)) {
+                resultado = LEITURA_INTERROMPIDA;
+                break;
+            }
+        }
+        if (!fecharComprimido(leitor)) resultado = LEITURA_INTERROMPIDA;
+    } else {
+        const char* dados = mapearFicheiro(nomeFicheiro, &total);
+        if (!dados) return LEITURA_ERRO_ABRIR;
+        if (!parser(dados, dados + total, ctx)) resultado = LEITURA_INTERROMPIDA;
+        desmapearFicheiro(dados, total);
     }
+    if (bytes) *bytes = total;
+    return resultado;
 }
 
 /**
- * @brief * Função auxiliar para libertar parcialmente em caso de erro
+ * @brief Comprimento de um campo truncado a tamanho - 1 bytes
+ * (como o campoCopiar para um char[tamanho]).
  * 
- * @param lista 
+ * @param c 
+ * @param tamanho 
+ * @return size_t 
  */
-static void libertarListaPassagensParcial(NodePassagem** lista) {
-    NodePassagem *atual = *lista, *seguinte;
-    int cont = 0;
-    while (atual) {
-        seguinte = atual->next;
-        free(atual);
-        atual = seguinte;
-        cont++;
-    }
-    *lista = NULL;
-    if (cont > 0) {
-        fprintf(stderr, " -> Memória de %d nós Passagem libertada por erro.\n", cont);
-    }
+static size_t comprimentoCampo(Campo c, size_t tamanho) {
+    size_t n = (size_t)(c.fim - c.ini);
+    return n > tamanho - 1 ? tamanho - 1 : n;
 }
 
+// --- Função Principal de Leitura de Donos ---
 
+/**
+ * @brief Destino dos nós criados pelo parser de donos.
+ * 
+ */
+typedef struct {
+    NodeDono**   lista;
+    Arena*       arena;
+    HeapStrings* nomes;
+    size_t       codigosInvalidos;   // códigos postais que não puderam ser empacotados
+} DestinoDonos;
 
-// --- Função Principal de Leitura de Donos ---
+/**
+ * @brief Interpreta linhas <numContribuinte>\t<nome>\t<codPostal>.
+ * 
+ * @param ini 
+ * @param fim 
+ * @param ctx DestinoDonos*
+ * @return bool false se faltar memória
+ */
+static bool parsearBlocoDonos(const char* ini, const char* fim, void* ctx) {
+    DestinoDonos* d = ctx;
+    Tokenizador tok;
+    Campo campos[3];
+    int n;
+    tokenizador_init(&tok, ini, fim);
+    while ((n = tokenizador_linha(&tok, campos, 3)) >= 0) {
+        if (n < 3) continue; // linhas em branco ou incompletas
+
+        NodeDono* novoNode = arena_alloc(d->arena, sizeof(NodeDono));
+        if (novoNode == NULL) {
+            fprintf(stderr, "Erro Crítico: Falha ao alocar memória para novo Dono.\n");
+            return false;
+        }
+        novoNode->dono.numeroContribuinte = campoInteiro(campos[0]);
+        if (!strings_adicionar(d->nomes, campos[1].ini, comprimentoCampo(campos[1], DONO_MAX_NOME), &novoNode->dono.nome))
+            return false;
+        novoNode->dono.codigoPostal = empacotarCodigoPostal(campos[2].ini, (size_t)(campos[2].fim - campos[2].ini));
+        if (novoNode->dono.codigoPostal == CODIGO_POSTAL_INVALIDO) d->codigosInvalidos++;
+
+        novoNode->next = *d->lista;
+        *d->lista = novoNode;
+    }
+    return true;
+}
 
 /**
  * @brief Função para ler os dados dos donos a partir de um ficheiro de texto
- * e armazená-los numa lista ligada.
- * (Versão com inicialização e libertação de memória em caso de erro no malloc)
+ * (ou .gz / .zst) e armazená-los numa lista ligada.
  * 
  * @param nomeFicheiro 
  * @param listaDonos 
+ * @param arena Arena onde são alocados os nós
+ * @param nomes Heap onde são guardados os nomes
  */
-void lerDonos(const char* nomeFicheiro, NodeDono** listaDonos) {
+static void lerDonosArena(const char* nomeFicheiro, NodeDono** listaDonos, Arena* arena, HeapStrings* nomes) {
+    *listaDonos = NULL;
+    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
 
-    // 1. Abrir o ficheiro
-    FILE *fp = fopen(nomeFicheiro, "r");
-    if (!fp) {
+    DestinoDonos destino = { listaDonos, arena, nomes, 0 };
+    ResultadoLeitura r = lerFicheiroPorBlocos(nomeFicheiro, parsearBlocoDonos, &destino, NULL);
+    if (r == LEITURA_ERRO_ABRIR) {
         fprintf(stderr, "Erro ao abrir ficheiro: %s\n", nomeFicheiro);
+        return;
+    }
+    if (r == LEITURA_INTERROMPIDA) {
+        fprintf(stderr, " -> A libertar memória já alocada...\n");
+        libertarArenaParcial(arena);
         *listaDonos = NULL;
         return;
     }
-
-    // 2. Variáveis para armazenar temporariamente os dados lidos de CADA linha
-    int numContribuinteLido;
-    char nomeLido[DONO_MAX_NOME];
-    char codigoPostalLido[DONO_MAX_CODIGOPOSTAL];
-    char linha[512];
-
-    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
-    *listaDonos = NULL;
-
-    // 3. Ler o ficheiro linha a linha
-    while (fgets(linha, sizeof(linha), fp)) {
-
-        // Ignorar linhas em branco ou que não contenham o delimitador tab
-        if (strchr(linha, '\t') == NULL) {
-            continue;
-        }
-        // --- Parsing da Linha ---
-        char *token;
-
-        // <numContribuinte>
-        token = strtok(linha, "\t");
-        if (token == NULL) continue;
-        numContribuinteLido = atoi(token);
-
-        // <nome>
-        token = strtok(NULL, "\t");
-        if (token == NULL) continue;
-        strncpy(nomeLido, token, DONO_MAX_NOME - 1);
-        nomeLido[DONO_MAX_NOME - 1] = '\0';
-
-        // <codPostal>
-        token = strtok(NULL, "\t\n\r");
-        if (token == NULL) continue;
-        strncpy(codigoPostalLido, token, DONO_MAX_CODIGOPOSTAL - 1);
-        codigoPostalLido[DONO_MAX_CODIGOPOSTAL - 1] = '\0';
-
-        // --- Inserção na Lista Ligada ---
-
-        NodeDono* novoNode = (NodeDono*)malloc(sizeof(NodeDono));
-        if (novoNode == NULL) {
-            fprintf(stderr, "Erro Crítico: Falha ao alocar memória para novo Dono.\n");
-            fclose(fp); 
-            fprintf(stderr, " -> A libertar memória já alocada...\n");
-            libertarListaDonosParcial(listaDonos);
-            return; 
-        }
-
-        novoNode->dono.numeroContribuinte = numContribuinteLido;
-        strcpy(novoNode->dono.nome, nomeLido);
-        strcpy(novoNode->dono.codigoPostal, codigoPostalLido);
-
-        novoNode->next = *listaDonos;
-        *listaDonos = novoNode;
-
-    } 
-
-    fclose(fp);
+    if (destino.codigosInvalidos > 0)
+        fprintf(stderr, "Aviso: %zu codigos postais fora do formato NNNN-NNN em %s.\n", destino.codigosInvalidos, nomeFicheiro);
     printf(">> Ficheiro %s lido e dados dos donos carregados para a lista ligada.\n", nomeFicheiro);
 }
+
+/**
+ * @brief Lê os donos para a lista principal (nós na arenaDonos, nomes no heapNomesDonos).
+ * 
+ * @param nomeFicheiro 
+ * @param listaDonos 
+ */
+void lerDonos(const char* nomeFicheiro, NodeDono** listaDonos) {
+    lerDonosArena(nomeFicheiro, listaDonos, &arenaDonos, &heapNomesDonos);
+    indiceDonos_construir(&indiceDonos, *listaDonos);
+    indiceNomes_construir(&indiceNomes, *listaDonos);
+}
 /**
  * @brief  Ordena um array de donos alfabeticamente pelo nome
  * 
  * @param donos 
  * @param total 
+ * @param nomes Heap onde estão os nomes dos donos
  */
-void ordenar_por_nome(Dono *donos, int total){
+void ordenar_por_nome(Dono *donos, int total, const HeapStrings *nomes){
     for(int i = 0; i < total - 1; i++){
         for(int j = 0; j < total - i - 1; j++){
-            if ( strcmp(donos[j].nome, donos[j+1].nome) > 0 ) {
+            if ( strcmp(strings_texto(nomes, donos[j].nome), strings_texto(nomes, donos[j+1].nome)) > 0 ) {
                 Dono tmp = donos[j];
                 donos[j] = donos[j + 1];
                 donos[j + 1] = tmp;
@@ -216,34 +219,95 @@ void ordenar_por_nome(Dono *donos, int total){
  */
 void ordenar_donos(const char *ficheiro) {
     NodeDono* lista = NULL;
-    lerDonos(ficheiro, &lista);
+    Arena arena = ARENA_INIT("Donos (ordenar)", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
+    HeapStrings nomes = HEAP_STRINGS_INIT("Nomes (ordenar)", MEMORIA_CONSULTAS);
+    lerDonosArena(ficheiro, &lista, &arena, &nomes);
     if (!lista) {
         printf("Erro a ler ficheiro de donos ou lista vazia.\n");
+        arena_libertar(&arena);
+        strings_libertar(&nomes);
         return;
     }
 
-    Dono array[MAX_DONOS];
     int total = 0;
-    for (NodeDono* p = lista; p && total < MAX_DONOS; p = p->next) {
-        array[total++] = p->dono;
-    }
-    if (total == 0) {
-        printf("Não foram lidos donos.\n");
+    for (NodeDono* p = lista; p; p = p->next)
+        total++;
+    Dono* array = memoria_alocar(MEMORIA_CONSULTAS, (size_t)total * sizeof(Dono));
+    if (!array) {
+        printf("Erro ao alocar memoria para ordenar os donos.\n");
+        arena_libertar(&arena);
+        strings_libertar(&nomes);
         return;
     }
+    int n = 0;
+    for (NodeDono* p = lista; p; p = p->next)
+        array[n++] = p->dono;
 
-    ordenar_por_nome(array, total);
+    ordenar_por_nome(array, total, &nomes);
 
     printf("\n--- Donos ordenados alfabeticamente ---\n");
+    char codigoPostal[DONO_MAX_CODIGOPOSTAL];
     for (int i = 0; i < total; i++) {
+        formatarCodigoPostal(array[i].codigoPostal, codigoPostal, sizeof(codigoPostal));
         printf("%2d) Nome: %s | NIF: %d | CP: %s\n",
                i + 1,
-               array[i].nome,
+               strings_texto(&nomes, array[i].nome),
                array[i].numeroContribuinte,
-               array[i].codigoPostal);
+               codigoPostal);
     }
 
-    libertarListaDonosParcial(&lista);
+    memoria_libertar(array);
+    arena_libertar(&arena);
+    strings_libertar(&nomes);
+}
+
+/**
+ * @brief Código de um campo num dicionário, truncado a tamanho - 1 bytes
+ * (como o campoCopiar para um char[tamanho]).
+ * 
+ * @param d 
+ * @param tamanho 
+ * @param c 
+ * @return int Código, ou -1 se faltar memória
+ */
+static int campoCodigo(Dicionario* d, size_t tamanho, Campo c) {
+    return dicionario_codigo(d, c.ini, comprimentoCampo(c, tamanho));
+}
+
+/**
+ * @brief Interpreta linhas <matrícula>\t<marca>\t<modelo>\t<ano>\t<dono>\t<codVeiculo>.
+ * 
+ * @param ini 
+ * @param fim 
+ * @param ctx NodeCarro** (lista principal)
+ * @return bool false se faltar memória
+ */
+static bool parsearBlocoCarros(const char* ini, const char* fim, void* ctx) {
+    NodeCarro** listaCarros = ctx;
+    Tokenizador tok;
+    Campo campos[6];
+    int n;
+    tokenizador_init(&tok, ini, fim);
+    while ((n = tokenizador_linha(&tok, campos, 6)) >= 0) {
+        if (n < 6) continue; // Ignora linhas sem todos os campos
+
+        NodeCarro* novoNode = arena_alloc(&arenaCarros, sizeof(NodeCarro));
+        if (novoNode == NULL) {
+            fprintf(stderr, "Erro Crítico: Falha ao alocar memória para novo Carro.\n");
+            return false;
+        }
+        campoCopiar(novoNode->carro.matricula, CARRO_MAX_MATRICULA, campos[0]);
+        novoNode->carro.codigoMarca  = campoCodigo(&dicionarioMarcas, CARRO_MAX_MARCA, campos[1]);
+        novoNode->carro.codigoModelo = campoCodigo(&dicionarioModelos, CARRO_MAX_MODELO, campos[2]);
+        if (novoNode->carro.codigoMarca < 0 || novoNode->carro.codigoModelo < 0) return false;
+        novoNode->carro.ano = campoInteiro(campos[3]);
+        novoNode->carro.donoContribuinte = campoInteiro(campos[4]);
+        novoNode->carro.idVeiculo = campoInteiro(campos[5]);
+
+        novoNode->next = *listaCarros;
+        *listaCarros = novoNode;
+    }
+    return true;
 }
 
 /**
@@ -253,96 +317,63 @@ void ordenar_donos(const char *ficheiro) {
  * @param listaCarros 
  */
 void lerCarros(const char* nomeFicheiro, NodeCarro** listaCarros) {
-    // 1. Abrir o ficheiro
-    FILE *fp = fopen(nomeFicheiro, "r");
-    if (!fp) {
+    *listaCarros = NULL;
+    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
+
+    ResultadoLeitura r = lerFicheiroPorBlocos(nomeFicheiro, parsearBlocoCarros, listaCarros, NULL);
+    if (r == LEITURA_ERRO_ABRIR) {
         fprintf(stderr, "Erro ao abrir ficheiro: %s\n", nomeFicheiro);
+        return;
+    }
+    if (r == LEITURA_INTERROMPIDA) {
+        fprintf(stderr, " -> A libertar memória já alocada...\n");
+        libertarArenaParcial(&arenaCarros); // Libertar memória
         *listaCarros = NULL;
         return;
     }
+    indiceCarros_construir(&indiceCarros, *listaCarros);
+    indiceMatriculas_construir(&indiceMatriculas, *listaCarros);
+    printf(">> Ficheiro %s lido e dados dos carros carregados.\n", nomeFicheiro);
+}
 
-    // 2. Variáveis temporárias
-    char matriculaLida[CARRO_MAX_MATRICULA];
-    char marcaLida[CARRO_MAX_MARCA];
-    char modeloLido[CARRO_MAX_MODELO];
-    int anoLido;
-    int donoContribuinteLido;
-    int idVeiculoLido;
-    char linha[512];
-
-    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
-
-    // Inicialização da lista
-    *listaCarros = NULL;
-
-    // 3. Ler linha a linha
-    while (fgets(linha, sizeof(linha), fp)) {
-
-        if (strchr(linha, '\t') == NULL) continue; // Ignora linhas sem tabulação
-
-        char *token;
-
-        // <matrícula>
-        token = strtok(linha, "\t");
-        if (token == NULL) continue;
-        strncpy(matriculaLida, token, CARRO_MAX_MATRICULA - 1);
-        matriculaLida[CARRO_MAX_MATRICULA - 1] = '\0';
-
-        // <marca>
-        token = strtok(NULL, "\t");
-        if (token == NULL) continue;
-        strncpy(marcaLida, token, CARRO_MAX_MARCA - 1);
-        marcaLida[CARRO_MAX_MARCA - 1] = '\0';
-
-        // <modelo>
-        token = strtok(NULL, "\t");
-        if (token == NULL) continue;
-        strncpy(modeloLido, token, CARRO_MAX_MODELO - 1);
-        modeloLido[CARRO_MAX_MODELO - 1] = '\0';
-
-        // <ano>
-        token = strtok(NULL, "\t");
-        if (token == NULL) continue;
-        anoLido = atoi(token);
-
-        // <dono> (NIF do dono)
-        token = strtok(NULL, "\t");
-        if (token == NULL) continue;
-        donoContribuinteLido = atoi(token);
-
-        // <codVeiculo> (ID do veículo)
-        token = strtok(NULL, "\t\n\r"); // Apanha o último token
-        if (token == NULL) continue;
-        idVeiculoLido = atoi(token);
-
-        // --- Inserção na Lista Ligada ---
 
-        NodeCarro* novoNode = (NodeCarro*)malloc(sizeof(NodeCarro));
-        if (novoNode == NULL) {
-            fprintf(stderr, "Erro Crítico: Falha ao alocar memória para novo Carro.\n");
-            fclose(fp);
-            fprintf(stderr, " -> A libertar memória já alocada...\n");
-            libertarListaCarrosParcial(listaCarros); // Libertar memória
-            return;
+/**
+ * @brief Interpreta linhas <idSensor>\t<designacao>\t<latitude>\t<longitude>.
+ * 
+ * @param ini 
+ * @param fim 
+ * @param ctx NodeSensor** (lista principal)
+ * @return bool false se faltar memória
+ */
+static bool parsearBlocoSensores(const char* ini, const char* fim, void* ctx) {
+    NodeSensor** listaSensores = ctx;
+    Tokenizador tok;
+    Campo campos[4];
+    int n;
+    tokenizador_init(&tok, ini, fim);
+    while ((n = tokenizador_linha(&tok, campos, 4)) >= 0) {
+        if (n < 4) continue; // ignora linhas em branco ou incompletas
+
+        NodeSensor *novo = arena_alloc(&arenaSensores, sizeof(NodeSensor));
+        if (!novo) {
+            fprintf(stderr, "Erro Crítico: falha malloc em lerSensores()\n");
+            return false;
+        }
+        novo->sensor.idSensor = campoInteiro(campos[0]);
+        campoCopiar(novo->sensor.designacao, SENSOR_MAX_DESIGNACAO, campos[1]);
+        if (!definirCoordenadasSensor(&novo->sensor, &arenaSensores,
+                                      campos[2].ini, comprimentoCampo(campos[2], SENSOR_MAX_LATITUDE),
+                                      campos[3].ini, comprimentoCampo(campos[3], SENSOR_MAX_LONGITUDE))) {
+            fprintf(stderr, "Erro Crítico: falha malloc em lerSensores()\n");
+            return false;
         }
 
-        strcpy(novoNode->carro.matricula, matriculaLida);
-        strcpy(novoNode->carro.marca, marcaLida);
-        strcpy(novoNode->carro.modelo, modeloLido);  
-        novoNode->carro.ano = anoLido;
-        novoNode->carro.donoContribuinte = donoContribuinteLido;
-        novoNode->carro.idVeiculo = idVeiculoLido;
-
-        novoNode->next = *listaCarros;
-        *listaCarros = novoNode;
-
+        novo->next = *listaSensores;
+        *listaSensores = novo;
     }
-
-    fclose(fp);
-    printf(">> Ficheiro %s lido e dados dos carros carregados.\n", nomeFicheiro);
+    return true;
 }
 
-
 /**
  * @brief Lê os dados dos sensores a partir de um ficheiro e constrói uma lista ligada.
  * 
@@ -350,69 +381,54 @@ void lerCarros(const char* nomeFicheiro, NodeCarro** listaCarros) {
  * @param listaSensores 
  */
 void lerSensores(const char* nomeFicheiro, NodeSensor** listaSensores) {
-    FILE *fp = fopen(nomeFicheiro, "r");
-    if (!fp) {
+    *listaSensores = NULL;  // inicia lista vazia
+    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
+
+    ResultadoLeitura r = lerFicheiroPorBlocos(nomeFicheiro, parsearBlocoSensores, listaSensores, NULL);
+    if (r == LEITURA_ERRO_ABRIR) {
         fprintf(stderr, "Erro ao abrir ficheiro: %s\n", nomeFicheiro);
+        return;
+    }
+    if (r == LEITURA_INTERROMPIDA) {
+        libertarArenaParcial(&arenaSensores);
         *listaSensores = NULL;
         return;
     }
+    printf(">> Ficheiro %s lido e dados de sensores carregados.\n", nomeFicheiro);
+}
 
-    *listaSensores = NULL;  // inicia lista vazia
-    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
-
-    char linha[512];
-    while (fgets(linha, sizeof(linha), fp)) {
-        // ignora linhas sem tab
-        if (!strchr(linha, '\t')) 
-            continue;
-
-        int  idSensorLido;
-        char designacaoLida[SENSOR_MAX_DESIGNACAO];
-        char latitudeLida[SENSOR_MAX_LATITUDE];
-        char longitudeLida[SENSOR_MAX_LONGITUDE];
-
-        // <idSensor>
-        char *token = strtok(linha, "\t");
-        if (!token) continue;
-        idSensorLido = atoi(token);
-
-        // <designacao>
-        token = strtok(NULL, "\t");
-        if (!token) continue;
-        strncpy(designacaoLida, token, SENSOR_MAX_DESIGNACAO-1);
-        designacaoLida[SENSOR_MAX_DESIGNACAO-1] = '\0';
-
-        // <latitude>
-        token = strtok(NULL, "\t");
-        if (!token) continue;
-        strncpy(latitudeLida, token, SENSOR_MAX_LATITUDE-1);
-        latitudeLida[SENSOR_MAX_LATITUDE-1] = '\0';
-
-        // <longitude>
-        token = strtok(NULL, "\t\n\r");
-        if (!token) continue;
-        strncpy(longitudeLida, token, SENSOR_MAX_LONGITUDE-1);
-        longitudeLida[SENSOR_MAX_LONGITUDE-1] = '\0';
-
-        NodeSensor *novo = malloc(sizeof(NodeSensor));
-        if (!novo) {
-            fprintf(stderr, "Erro Crítico: falha malloc em lerSensores()\n");
-            fclose(fp);
-            libertarListaSensoresParcial(listaSensores);
-            return;
+/**
+ * @brief Interpreta linhas <idSensor1>\t<idSensor2>\t<distancia>.
+ * 
+ * @param ini 
+ * @param fim 
+ * @param ctx NodeDistancia** (lista principal)
+ * @return bool false se faltar memória
+ */
+static bool parsearBlocoDistancias(const char* ini, const char* fim, void* ctx) {
+    NodeDistancia** listaDistancias = ctx;
+    Tokenizador tok;
+    Campo campos[3];
+    int n;
+    tokenizador_init(&tok, ini, fim);
+    while ((n = tokenizador_linha(&tok, campos, 3)) >= 0) {
+        if (n < 3) continue;
+
+        NodeDistancia *no = arena_alloc(&arenaDistancias, sizeof(NodeDistancia));
+        if (!no) {
+            fprintf(stderr, "Erro crítico: falha malloc em lerDistancias()\n");
+            return false;
         }
-        novo->sensor.idSensor = idSensorLido;
-        strcpy(novo->sensor.designacao, designacaoLida);
-        strcpy(novo->sensor.latitude,    latitudeLida);
-        strcpy(novo->sensor.longitude,   longitudeLida);
+        no->distancia.idSensor1 = campoInteiro(campos[0]);
+        no->distancia.idSensor2 = campoInteiro(campos[1]);
+        no->distancia.distancia = (float)campoDecimal(campos[2]);
 
-        novo->next = *listaSensores;
-        *listaSensores = novo;
+        no->next = *listaDistancias;
+        *listaDistancias = no;
     }
-
-    fclose(fp);
-    printf(">> Ficheiro %s lido e dados de sensores carregados.\n", nomeFicheiro);
+    return true;
 }
+
 /**
  * @brief Lê distâncias entre sensores de um ficheiro e armazena numa lista ligada.
  * 
@@ -420,138 +436,471 @@ void lerSensores(const char* nomeFicheiro, NodeSensor** listaSensores) {
  * @param listaDistancias 
  */
 void lerDistancias(const char* nomeFicheiro, NodeDistancia** listaDistancias) {
-    FILE *fp = fopen(nomeFicheiro, "r");
-    if (!fp) {
+    *listaDistancias = NULL;
+    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
+
+    ResultadoLeitura r = lerFicheiroPorBlocos(nomeFicheiro, parsearBlocoDistancias, listaDistancias, NULL);
+    if (r == LEITURA_ERRO_ABRIR) {
         fprintf(stderr, "Erro ao abrir ficheiro: %s\n", nomeFicheiro);
+        return;
+    }
+    if (r == LEITURA_INTERROMPIDA) {
+        libertarArenaParcial(&arenaDistancias);
         *listaDistancias = NULL;
         return;
     }
+    matrizDistancias_construir(&matrizDistancias, *listaDistancias);
+    printf(">> Ficheiro %s lido e distâncias carregadas.\n", nomeFicheiro);
+}
 
-    *listaDistancias = NULL;
-    printf("\n>> A ler o ficheiro %s...\n", nomeFicheiro);
-
-    char linha[256];
-    while (fgets(linha, sizeof(linha), fp)) {
-        // Se não tiver tabulação, ignora
-        if (!strchr(linha, '\t')) 
-            continue;
+/**
+ * @brief Tempo monotónico em segundos, usado para medir o débito de leitura.
+ * 
+ * @return double 
+ */
+double segundosAgora(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
 
-        // Extrai cada campo
-        char *token = strtok(linha, "\t");
-        if (!token) continue;
-        int id1 = atoi(token);
+/**
+ * @brief Disponibiliza o conteúdo de um ficheiro em memória.
+ * Em POSIX o ficheiro é mapeado com mmap (sem cópias para buffers do stdio);
+ * em Windows é lido de uma só vez para um bloco alocado.
+ * 
+ * @param nomeFicheiro 
+ * @param tamanho Recebe o número de bytes disponíveis
+ * @return const char* Início dos dados ou NULL em caso de erro / ficheiro vazio
+ */
+const char *mapearFicheiro(const char *nomeFicheiro, size_t *tamanho) {
+    *tamanho = 0;
+#ifdef _WIN32
+    FILE *fp = fopen(nomeFicheiro, "rb");
+    if (!fp) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long n = ftell(fp);
+    rewind(fp);
+    char *dados = n > 0 ? memoria_alocar(MEMORIA_LEITURA, (size_t)n) : NULL;
+    if (dados && fread(dados, 1, (size_t)n, fp) != (size_t)n) {
+        memoria_libertar(dados);
+        dados = NULL;
+    }
+    fclose(fp);
+    if (dados) *tamanho = (size_t)n;
+    return dados;
+#else
+    int fd = open(nomeFicheiro, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void *dados = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // o mapeamento mantém-se válido depois do close
+    if (dados == MAP_FAILED) return NULL;
+    madvise(dados, (size_t)st.st_size, MADV_SEQUENTIAL);
+    *tamanho = (size_t)st.st_size;
+    return dados;
+#endif
+}
 
-        token = strtok(NULL, "\t");
-        if (!token) continue;
-        int id2 = atoi(token);
+/**
+ * @brief Liberta os dados obtidos com mapearFicheiro().
+ * 
+ * @param dados 
+ * @param tamanho 
+ */
+void desmapearFicheiro(const char *dados, size_t tamanho) {
+    if (!dados) return;
+#ifdef _WIN32
+    (void)tamanho;
+    memoria_libertar((void *)dados);
+#else
+    munmap((void *)dados, tamanho);
+#endif
+}
 
-        token = strtok(NULL, "\t\n\r");
-        if (!token) continue;
-        float dist = atof(token);
+/**
+ * @brief Preenche uma passagem a partir dos campos de uma linha de passagem.txt.
+ * Formato: <idSensor>\t<idVeiculo>\t<dataHora>\t<tipoRegisto>
+ * 
+ * @param campos 
+ * @param n Número de campos da linha
+ * @param out Passagem a preencher
+ * @return true se a linha tinha pelo menos o sensor e o veículo
+ */
+static bool camposParaPassagem(const Campo *campos, int n, Passagem *out) {
+    if (n < 2) return false;
+    out->idSensor  = campoInteiro(campos[0]);
+    out->idVeiculo = campoInteiro(campos[1]);
+    if (n >= 3) campoCopiar(out->dataHora, PASSAGEM_MAX_DATAHORA, campos[2]);
+    else        out->dataHora[0] = '\0';
+    out->tipoRegisto = n >= 4 ? campoInteiro(campos[3]) : 0;
+    out->ts = parseTimestampMs(out->dataHora);
+    return true;
+}
 
-        NodeDistancia *no = malloc(sizeof(NodeDistancia));
-        if (!no) {
-            fprintf(stderr, "Erro crítico: falha malloc em lerDistancias()\n");
-            fclose(fp);
-            libertarListaDistanciasParcial(listaDistancias);
-            return;
-        }
+/**
+ * @brief Faz o parsing de uma linha de passagem.txt diretamente sobre o buffer
+ * (sem strtok nem cópias intermédias).
+ * 
+ * @param ini Início da linha
+ * @param fim Fim da linha (exclusivo, sem o '\n')
+ * @param out Passagem a preencher
+ * @return true se a linha tinha o formato esperado
+ */
+bool parsearLinhaPassagem(const char *ini, const char *fim, Passagem *out) {
+    Tokenizador tok;
+    Campo campos[4];
+    tokenizador_init(&tok, ini, fim);
+    return camposParaPassagem(campos, tokenizador_linha(&tok, campos, 4), out);
+}
 
-        no->distancia.idSensor1 = id1;
-        no->distancia.idSensor2 = id2;
-        no->distancia.distancia  = dist;
+/**
+ * @brief Intervalo de bytes de passagem.txt atribuído a uma thread de parsing.
+ * Começa sempre no início de uma linha e termina a seguir a um '\n' (ou no fim do ficheiro).
+ * 
+ */
+typedef struct {
+    const char   *ini, *fim;
+    Arena         arena;         // arena privada da thread
+    NodePassagem *cabeca, *cauda;
+    size_t        total;
+    int           erro;
+} FatiaPassagens;
 
-        no->next = *listaDistancias;
-        *listaDistancias = no;
+/**
+ * @brief Faz o parsing de todas as linhas de uma fatia para a sua arena,
+ * ligando os nós pela ordem do ficheiro.
+ * 
+ * @param arg FatiaPassagens*
+ * @return void* 
+ */
+static void *parsearFatiaPassagens(void *arg) {
+    FatiaPassagens *f = arg;
+
+    // Estimativa barata (tamanho da fatia / comprimento mínimo de uma linha):
+    // normalmente a fatia inteira cabe no primeiro bloco da arena. Com um segmento
+    // de arquivo muitas linhas são ignoradas, por isso a arena cresce a pedido.
+    size_t primeiroBloco = segmentoPassagens.cabecalho
+                               ? ARENA_BLOCO_PADRAO
+                               : ((size_t)(f->fim - f->ini) / PASSAGEM_MIN_LINHA + 1) * sizeof(NodePassagem);
+    arena_init(&f->arena, "Passagens", primeiroBloco, MEMORIA_DADOS);
+
+    Tokenizador tok;
+    Campo campos[4];
+    int n;
+    NodePassagem *no = NULL;
+    tokenizador_init(&tok, f->ini, f->fim);
+    while ((n = tokenizador_linha(&tok, campos, 4)) >= 0) {
+        // Um nó de uma linha inválida anterior é reaproveitado
+        if (!no && !(no = arena_alloc(&f->arena, sizeof(NodePassagem)))) {
+            f->erro = 1;
+            break;
+        }
+        // As passagens que já estão no segmento de arquivo não voltam à lista
+        if (camposParaPassagem(campos, n, &no->passagem) && !segmento_arquivada(&segmentoPassagens, no->passagem.ts)) {
+            no->next = NULL;
+            if (f->cauda) f->cauda->next = no;
+            else          f->cabeca = no;
+            f->cauda = no;
+            f->total++;
+            no = NULL;
+        }
     }
-
-    fclose(fp);
-    printf(">> Ficheiro %s lido e distâncias carregadas.\n", nomeFicheiro);
+    return NULL;
 }
 
+/**
+ * @brief Número de threads a usar para um ficheiro de passagens deste tamanho:
+ * uma por core, mas nunca fatias com menos de PASSAGENS_MIN_BYTES_THREAD.
+ * 
+ * @param tamanho 
+ * @return size_t 
+ */
+static size_t numThreadsParsing(size_t tamanho) {
+#ifdef _WIN32
+    (void)tamanho;
+    return 1;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n = cores > 0 ? (size_t)cores : 1;
+    if (n > PASSAGENS_MAX_THREADS) n = PASSAGENS_MAX_THREADS;
+    size_t porTamanho = tamanho / PASSAGENS_MIN_BYTES_THREAD + 1;
+    return n < porTamanho ? n : porTamanho;
+#endif
+}
 
 /**
- * @brief Pool de nós do tipo NodePassagem
+ * @brief Passagens lidas de um ficheiro comprimido, bloco a bloco.
  * 
  */
-static NodePassagem *passPool = NULL;
-static size_t poolPos = 0, poolSize = 0;
+typedef struct {
+    NodePassagem **lista;
+    NodePassagem  *cauda;
+    size_t         total;
+} DestinoPassagens;
 
 /**
- * @brief Inicializa um pool de memória para armazenar nós de passagens.
+ * @brief Interpreta um bloco descomprimido de passagem.txt como uma fatia,
+ * na thread atual, e acrescenta-o ao fim da lista.
  * 
- * @param N 
+ * @param ini 
+ * @param fim 
+ * @param ctx DestinoPassagens*
+ * @return bool false se faltar memória
  */
-static void pool_init_passagens(size_t N) {
-    passPool = malloc(N * sizeof(*passPool));
-    poolPos  = 0;
-    poolSize = N;
+static bool parsearBlocoPassagens(const char* ini, const char* fim, void* ctx) {
+    DestinoPassagens *d = ctx;
+    FatiaPassagens f = { .ini = ini, .fim = fim };
+    parsearFatiaPassagens(&f);
+    if (f.cabeca) {
+        if (d->cauda) d->cauda->next = f.cabeca;
+        else          *d->lista = f.cabeca;
+        d->cauda = f.cauda;
+        d->total += f.total;
+    }
+    arena_juntar(&arenaPassagens, &f.arena);
+    if (f.erro) fprintf(stderr, "Erro Crítico: falta de memória na arena de passagens.\n");
+    return !f.erro;
 }
 
 /**
- * @brief Aloca um novo nó do pool de passagens.
+ * @brief Lê um passagem.txt comprimido: o parsing de cada bloco sobrepõe-se à
+ * descompressão do seguinte (ver decompress.h).
  * 
- * @return NodePassagem* 
+ * @param nomeFicheiro 
+ * @param listaPassagens 
+ * @return size_t Sempre 0: o modo de seguimento não se aplica a ficheiros comprimidos
  */
-static NodePassagem *pool_alloc_passagem(void) {
-    if (poolPos >= poolSize) return NULL;
-    return &passPool[poolPos++];
+static size_t lerPassagensComprimidas(const char* nomeFicheiro, NodePassagem** listaPassagens) {
+    double t0 = segundosAgora();
+    DestinoPassagens destino = { listaPassagens, NULL, 0 };
+    size_t bytes = 0;
+    ResultadoLeitura r = lerFicheiroPorBlocos(nomeFicheiro, parsearBlocoPassagens, &destino, &bytes);
+    if (r == LEITURA_ERRO_ABRIR) {
+        fprintf(stderr, "Erro ao abrir %s (ou ficheiro vazio)\n", nomeFicheiro);
+        return 0;
+    }
+    if (r == LEITURA_INTERROMPIDA)
+        fprintf(stderr, "Aviso: leitura de %s incompleta (%zu passagens lidas).\n", nomeFicheiro, destino.total);
+
+    double dt = segundosAgora() - t0;
+    double mb = bytes / (1024.0 * 1024.0);
+    printf("Lidas %zu passagens (arena de %.1f MB, descompressão em pipeline) em %.3f s (%.1f MB/s).\n",
+           destino.total, arenaPassagens.bytesReservados / (1024.0 * 1024.0), dt, dt > 0 ? mb / dt : 0.0);
+    return 0;
 }
 
 /**
  * @brief Lê os registos de passagens de um ficheiro e armazena-os numa lista ligada.
- * Usa um pool para alocação eficiente de memória.
+ * O ficheiro é mapeado em memória e dividido em fatias alinhadas em '\n';
+ * cada fatia é interpretada por uma thread para a sua própria arena e no fim
+ * as fatias são encadeadas pela ordem do ficheiro e as arenas juntas na
+ * arenaPassagens. Ficheiros .gz / .zst são lidos por lerPassagensComprimidas().
  * 
  * @param nomeFicheiro 
  * @param listaPassagens 
+ * @return size_t Número de bytes lidos (onde o modo de seguimento deve continuar)
  */
-void lerPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens) {
-    FILE *fp = fopen(nomeFicheiro, "r");
-    if (!fp) {
-        fprintf(stderr, "Erro ao abrir %s\n", nomeFicheiro);
-        *listaPassagens = NULL;
-        return;
+size_t lerPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens) {
+    *listaPassagens = NULL;
+    if (ficheiroComprimido(nomeFicheiro))
+        return lerPassagensComprimidas(nomeFicheiro, listaPassagens);
+
+    double t0 = segundosAgora();
+    size_t tamanho;
+    const char *dados = mapearFicheiro(nomeFicheiro, &tamanho);
+    if (!dados) {
+        fprintf(stderr, "Erro ao abrir %s (ou ficheiro vazio)\n", nomeFicheiro);
+        return 0;
     }
 
-    // 1) Contar linhas úteis
-    size_t lines = 0;
-    char buf[256];
-    while (fgets(buf, sizeof buf, fp))
-       if (strchr(buf, '\t')) lines++;
-    rewind(fp);
-
-    // 2) Prepara pool
-    pool_init_passagens(lines);
+    // 1) Divide o ficheiro em fatias alinhadas no início de uma linha
+    size_t nThreads = numThreadsParsing(tamanho);
+    FatiaPassagens *fatias = memoria_alocarZeros(MEMORIA_LEITURA, nThreads, sizeof(FatiaPassagens));
+    if (!fatias) {
+        fprintf(stderr, "Erro Crítico: falha malloc em lerPassagens()\n");
+        desmapearFicheiro(dados, tamanho);
+        return 0;
+    }
+    const char *fimDados = dados + tamanho;
+    const char *ini = dados;
+    for (size_t i = 0; i < nThreads; i++) {
+        const char *fim = (i == nThreads - 1) ? fimDados : dados + tamanho / nThreads * (i + 1);
+        if (fim < ini) fim = ini;
+        if (fim < fimDados) {
+            const char *nl = memchr(fim, '\n', (size_t)(fimDados - fim));
+            fim = nl ? nl + 1 : fimDados;
+        }
+        fatias[i].ini = ini;
+        fatias[i].fim = fim;
+        ini = fim;
+    }
 
-    *listaPassagens = NULL;
-    NodePassagem *tail = NULL;
-
-    // 3) Faz o parsing e insere em O(1) do pool
-    while (fgets(buf, sizeof buf, fp)) {
-        if (!strchr(buf, '\t')) continue;
-        char *tok = strtok(buf, "\t");
-        int s = tok ? atoi(tok) : 0;
-        tok = strtok(NULL, "\t");     int v = tok ? atoi(tok) : 0;
-        tok = strtok(NULL, "\t");     char dt[PASSAGEM_MAX_DATAHORA] = "";
-                                       if (tok) strncpy(dt, tok, sizeof dt-1);
-        tok = strtok(NULL, "\t\n");   int t = tok ? atoi(tok) : 0;
-
-        NodePassagem *no = pool_alloc_passagem();
-        no->passagem.idSensor     = s;
-        no->passagem.idVeiculo    = v;
-        strcpy(no->passagem.dataHora, dt);
-        no->passagem.tipoRegisto  = t;
-        no->passagem.ts = parseTimestamp(no->passagem.dataHora);
-        no->next = NULL;
-
-        if (!*listaPassagens) {
-            *listaPassagens = tail = no;
-        } else {
-            tail->next = no;
-            tail = no;
+    // 2) Parsing em paralelo (a primeira fatia corre na thread atual)
+#ifndef _WIN32
+    pthread_t *threads = memoria_alocar(MEMORIA_LEITURA, nThreads * sizeof(pthread_t));
+    size_t lancadas = 1;
+    if (threads) {
+        for (; lancadas < nThreads; lancadas++) {
+            if (pthread_create(&threads[lancadas], NULL, parsearFatiaPassagens, &fatias[lancadas]) != 0)
+                break;
         }
     }
-    fclose(fp);
-    printf("Lidas %zu passagens (pool de %zu nós).\n", poolPos, poolSize);
+    parsearFatiaPassagens(&fatias[0]);
+    for (size_t i = 1; i < lancadas; i++)
+        pthread_join(threads[i], NULL);
+    for (size_t i = lancadas; i < nThreads; i++) // threads que não foi possível criar
+        parsearFatiaPassagens(&fatias[i]);
+    memoria_libertar(threads);
+#else
+    for (size_t i = 0; i < nThreads; i++)
+        parsearFatiaPassagens(&fatias[i]);
+#endif
+    desmapearFicheiro(dados, tamanho);
+
+    // 3) Encadeia as fatias pela ordem do ficheiro e passa as arenas para a global
+    size_t total = 0;
+    NodePassagem *cauda = NULL;
+    for (size_t i = 0; i < nThreads; i++) {
+        FatiaPassagens *f = &fatias[i];
+        if (f->erro)
+            fprintf(stderr, "Erro Crítico: falta de memória na arena de passagens (fatia %zu).\n", i);
+        if (f->cabeca) {
+            if (cauda) cauda->next = f->cabeca;
+            else       *listaPassagens = f->cabeca;
+            cauda = f->cauda;
+            total += f->total;
+        }
+        arena_juntar(&arenaPassagens, &f->arena);
+    }
+    memoria_libertar(fatias);
+
+    double dt = segundosAgora() - t0;
+    double mb = tamanho / (1024.0 * 1024.0);
+    printf("Lidas %zu passagens (arena de %.1f MB, %zu threads) em %.3f s (%.1f MB/s).\n",
+           total, arenaPassagens.bytesReservados / (1024.0 * 1024.0), nThreads, dt, dt > 0 ? mb / dt : 0.0);
+    return tamanho;
+}
+
+/**
+ * @brief Acrescenta ao fim da lista as passagens de passagem.txt a partir de um
+ * offset (as linhas escritas depois de um snapshot), na thread atual.
+ * 
+ * @param nomeFicheiro 
+ * @param listaPassagens 
+ * @param offset Bytes do ficheiro já refletidos na lista
+ * @return size_t Novo offset (onde o modo de seguimento deve continuar)
+ */
+size_t lerPassagensDesde(const char* nomeFicheiro, NodePassagem** listaPassagens, size_t offset) {
+    if (ficheiroComprimido(nomeFicheiro)) return offset;
+    size_t tamanho;
+    const char *dados = mapearFicheiro(nomeFicheiro, &tamanho);
+    if (!dados) return offset;
+    if (tamanho <= offset) {
+        desmapearFicheiro(dados, tamanho);
+        return offset;
+    }
+
+    FatiaPassagens f = { .ini = dados + offset, .fim = dados + tamanho };
+    parsearFatiaPassagens(&f);
+    desmapearFicheiro(dados, tamanho);
+    if (f.erro) fprintf(stderr, "Erro Crítico: falta de memória na arena de passagens.\n");
+    if (f.cabeca) {
+        NodePassagem **fim = listaPassagens;
+        while (*fim) fim = &(*fim)->next;
+        *fim = f.cabeca;
+    }
+    arena_juntar(&arenaPassagens, &f.arena);
+    printf("Lidas %zu passagens novas de %s (desde o byte %zu).\n", f.total, nomeFicheiro, offset);
+    return tamanho;
 }
 
+/**
+ * @brief Um ficheiro a carregar numa thread própria, com o respetivo tempo.
+ * 
+ */
+typedef struct {
+    FonteDados   fonte;
+    const char  *nomeFicheiro;
+    void        *lista;     // NodeX** conforme a fonte
+    size_t       bytes;     // só para passagem.txt
+    double       segundos;
+} TarefaCarregamento;
+
+/**
+ * @brief Corpo de cada thread de carregamento. Os carregadores são independentes
+ * entre si: cada um escreve apenas na sua lista e na sua arena.
+ * 
+ * @param arg TarefaCarregamento*
+ * @return void* 
+ */
+static void *executarCarregamento(void *arg) {
+    TarefaCarregamento *t = arg;
+    double t0 = segundosAgora();
+    switch (t->fonte) {
+        case FONTE_DONOS:      lerDonos(t->nomeFicheiro, (NodeDono **)t->lista); break;
+        case FONTE_CARROS:     lerCarros(t->nomeFicheiro, (NodeCarro **)t->lista); break;
+        case FONTE_SENSORES:   lerSensores(t->nomeFicheiro, (NodeSensor **)t->lista); break;
+        case FONTE_DISTANCIAS: lerDistancias(t->nomeFicheiro, (NodeDistancia **)t->lista); break;
+        case FONTE_PASSAGENS:  t->bytes = lerPassagens(t->nomeFicheiro, (NodePassagem **)t->lista); break;
+        default: break;
+    }
+    t->segundos = segundosAgora() - t0;
+    return NULL;
+}
+
+/**
+ * @brief Carrega os cinco ficheiros de dados em simultâneo (uma thread por
+ * ficheiro) e mostra o tempo de cada um e o total. Os ficheiros pequenos
+ * ficam escondidos atrás da leitura de passagem.txt.
+ * 
+ * @param fontes Caminhos indexados por FonteDados
+ * @return size_t Bytes lidos de passagem.txt (ver lerPassagens)
+ */
+size_t carregarBaseDados(const char *const fontes[NUM_FONTES], NodeDono **listaDonos, NodeCarro **listaCarros,
+                         NodeSensor **listaSensores, NodeDistancia **listaDistancias, NodePassagem **listaPassagens) {
+    TarefaCarregamento tarefas[NUM_FONTES] = {
+        { FONTE_DONOS,      fontes[FONTE_DONOS],      listaDonos,      0, 0.0 },
+        { FONTE_CARROS,     fontes[FONTE_CARROS],     listaCarros,     0, 0.0 },
+        { FONTE_SENSORES,   fontes[FONTE_SENSORES],   listaSensores,   0, 0.0 },
+        { FONTE_DISTANCIAS, fontes[FONTE_DISTANCIAS], listaDistancias, 0, 0.0 },
+        { FONTE_PASSAGENS,  fontes[FONTE_PASSAGENS],  listaPassagens,  0, 0.0 },
+    };
+
+    double t0 = segundosAgora();
+#ifndef _WIN32
+    // passagem.txt (o mais demorado) corre na thread atual; os restantes em paralelo
+    pthread_t threads[NUM_FONTES];
+    bool lancada[NUM_FONTES] = { false };
+    for (int i = 0; i < NUM_FONTES; i++) {
+        if (i != FONTE_PASSAGENS)
+            lancada[i] = pthread_create(&threads[i], NULL, executarCarregamento, &tarefas[i]) == 0;
+    }
+    executarCarregamento(&tarefas[FONTE_PASSAGENS]);
+    for (int i = 0; i < NUM_FONTES; i++) {
+        if (lancada[i]) pthread_join(threads[i], NULL);
+        else if (i != FONTE_PASSAGENS) executarCarregamento(&tarefas[i]); // sem thread: carrega aqui
+    }
+#else
+    for (int i = 0; i < NUM_FONTES; i++)
+        executarCarregamento(&tarefas[i]);
+#endif
+    double total = segundosAgora() - t0;
+
+    double soma = 0.0;
+    printf("\nTempos de carregamento:\n");
+    for (int i = 0; i < NUM_FONTES; i++) {
+        printf("  %-45s %8.3f s\n", tarefas[i].nomeFicheiro, tarefas[i].segundos);
+        soma += tarefas[i].segundos;
+    }
+    printf("  %-45s %8.3f s (soma dos ficheiros: %.3f s)\n", "Total", total, soma);
+    return tarefas[FONTE_PASSAGENS].bytes;
+}
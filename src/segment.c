@@ -0,0 +1,772 @@
+#include <stdio.h>      // fopen, fwrite, rename
+#include <stdlib.h>     // qsort
+#include <string.h>     // memcmp, memcpy, memset
+#include <time.h>       // gmtime_r, strftime
+#include "segment.h"
+#include "read_files.h" // mapearFicheiro, segundosAgora
+#include "columns.h"
+#include "time_index.h"
+#include "vehicle_groups.h"
+
+SegmentoPassagens segmentoPassagens = { 0 };
+
+/**
+ * @brief Uma passagem descomprimida (ou a comprimir) de um bloco.
+ *
+ */
+typedef struct {
+    long long ts;
+    int32_t   idVeiculo;
+    int32_t   idSensor;
+    int32_t   tipoRegisto;
+    uint32_t  ordem;      // posição de chegada, para a ordenação ser estável
+} LinhaSegmento;
+
+static size_t alinhar8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+/**
+ * @brief Número de palavras de 64 bits com os ids e o tipo de um bloco.
+ *
+ * @param b
+ * @return size_t
+ */
+static size_t palavrasBloco(const SegmentoBloco* b) {
+    uint64_t bits = (uint64_t)b->numLinhas * (b->bitsVeiculo + b->bitsSensor + 1u);
+    return (size_t)((bits + 63) / 64);
+}
+
+/**
+ * @brief Bits necessários para representar valores de 0 a 'maximo'.
+ *
+ * @param maximo
+ * @return uint8_t
+ */
+static uint8_t bitsNecessarios(uint32_t maximo) {
+    uint8_t bits = 0;
+    while (maximo) {
+        bits++;
+        maximo >>= 1;
+    }
+    return bits;
+}
+
+static uint32_t lerBits(const uint64_t* palavras, uint64_t pos, unsigned largura) {
+    if (largura == 0) return 0;
+    size_t   i      = (size_t)(pos >> 6);
+    unsigned desloc = (unsigned)(pos & 63);
+    uint64_t v = palavras[i] >> desloc;
+    if (desloc + largura > 64) v |= palavras[i + 1] << (64 - desloc);
+    return (uint32_t)(v & (((uint64_t)1 << largura) - 1));
+}
+
+static void escreverBits(uint64_t* palavras, uint64_t pos, uint32_t valor, unsigned largura) {
+    if (largura == 0) return;
+    size_t   i      = (size_t)(pos >> 6);
+    unsigned desloc = (unsigned)(pos & 63);
+    palavras[i] |= (uint64_t)valor << desloc;
+    if (desloc + largura > 64) palavras[i + 1] |= (uint64_t)valor >> (64 - desloc);
+}
+
+// --- Leitura ---
+
+/**
+ * @brief Confirma que o diretório só aponta para dentro do ficheiro, para que
+ * um segmento corrompido não leve a leituras fora do mapeamento.
+ *
+ * @param dados
+ * @param tamanho
+ * @return bool
+ */
+static bool segmentoValido(const unsigned char* dados, size_t tamanho) {
+    const SegmentoCabecalho* cab = (const SegmentoCabecalho*)dados;
+    if (tamanho < sizeof *cab || memcmp(cab->magia, SEGMENTO_MAGIA, sizeof cab->magia) != 0 ||
+        cab->versao != SEGMENTO_VERSAO || cab->tamanhoTotal > tamanho || // depois pode haver um acrescento interrompido
+        cab->linhasPorBloco == 0 || cab->linhasPorBloco > SEGMENTO_LINHAS_BLOCO ||
+        cab->offsetDiretorio % 8 != 0 || cab->offsetDiretorio > cab->tamanhoTotal ||
+        cab->numBlocos > (cab->tamanhoTotal - cab->offsetDiretorio) / sizeof(SegmentoBloco))
+        return false;
+
+    const SegmentoBloco* blocos = (const SegmentoBloco*)(dados + cab->offsetDiretorio);
+    uint64_t linhas = 0;
+    for (uint64_t i = 0; i < cab->numBlocos; i++) {
+        const SegmentoBloco* b = &blocos[i];
+        if (b->offset % 8 != 0 || b->numLinhas == 0 || b->numLinhas > cab->linhasPorBloco ||
+            b->bitsVeiculo > 32 || b->bitsSensor > 32 || b->tsMin > b->tsMax ||
+            (i > 0 && b->tsMin < blocos[i - 1].tsMax))
+            return false;
+        uint64_t fim = b->offset + alinhar8(b->bytesTs) + palavrasBloco(b) * 8;
+        if (fim > cab->offsetDiretorio) return false;
+        linhas += b->numLinhas;
+    }
+    return linhas == cab->numLinhas;
+}
+
+/**
+ * @brief Abre (mapeia) um segmento. Se o ficheiro não existir o segmento fica vazio.
+ *
+ * @param seg
+ * @param nomeFicheiro
+ * @return bool true se o segmento foi aberto
+ */
+bool segmento_abrir(SegmentoPassagens* seg, const char* nomeFicheiro) {
+    segmento_fechar(seg);
+    size_t tamanho;
+    const unsigned char* dados = (const unsigned char*)mapearFicheiro(nomeFicheiro, &tamanho);
+    if (!dados) return false;
+    if (!segmentoValido(dados, tamanho)) {
+        fprintf(stderr, "Aviso: %s nao e um segmento de passagens valido; ignorado.\n", nomeFicheiro);
+        desmapearFicheiro((const char*)dados, tamanho);
+        return false;
+    }
+    SegmentoCabecalho* cabecalho = memoria_alocar(MEMORIA_LEITURA, sizeof *cabecalho);
+    if (!cabecalho) {
+        desmapearFicheiro((const char*)dados, tamanho);
+        return false;
+    }
+    memcpy(cabecalho, dados, sizeof *cabecalho);
+    seg->dados     = dados;
+    seg->tamanho   = tamanho;
+    seg->cabecalho = cabecalho;
+    seg->blocos    = (const SegmentoBloco*)(dados + cabecalho->offsetDiretorio);
+    return true;
+}
+
+/**
+ * @brief Fecha o segmento (os nós já descomprimidos não são afetados).
+ *
+ * @param seg
+ */
+void segmento_fechar(SegmentoPassagens* seg) {
+    if (seg->dados) desmapearFicheiro((const char*)seg->dados, seg->tamanho);
+    memoria_libertar((void*)seg->cabecalho);
+    memset(seg, 0, sizeof *seg);
+}
+
+/**
+ * @brief Descomprime um bloco.
+ *
+ * @param seg
+ * @param b
+ * @param linhas Espaço para linhasPorBloco linhas
+ * @return bool false se os varints do bloco estiverem corrompidos
+ */
+static bool descomprimirBloco(const SegmentoPassagens* seg, const SegmentoBloco* b, LinhaSegmento* linhas) {
+    const unsigned char* p     = seg->dados + b->offset;
+    const unsigned char* fimTs = p + b->bytesTs;
+    const uint64_t* palavras   = (const uint64_t*)(seg->dados + b->offset + alinhar8(b->bytesTs));
+    uint64_t posVeiculo = 0;
+    uint64_t posSensor  = (uint64_t)b->numLinhas * b->bitsVeiculo;
+    uint64_t posTipo    = posSensor + (uint64_t)b->numLinhas * b->bitsSensor;
+    long long ts = b->tsMin;
+
+    for (uint32_t i = 0; i < b->numLinhas; i++) {
+        uint64_t delta = 0;
+        unsigned desloc = 0;
+        unsigned char byte;
+        do {
+            if (p == fimTs || desloc > 63) return false;
+            byte = *p++;
+            delta |= (uint64_t)(byte & 0x7F) << desloc;
+            desloc += 7;
+        } while (byte & 0x80);
+        ts += (long long)delta;
+
+        linhas[i].ts          = ts;
+        linhas[i].idVeiculo   = b->minVeiculo + (int32_t)lerBits(palavras, posVeiculo, b->bitsVeiculo);
+        linhas[i].idSensor    = b->minSensor + (int32_t)lerBits(palavras, posSensor, b->bitsSensor);
+        linhas[i].tipoRegisto = (int32_t)lerBits(palavras, posTipo, 1);
+        linhas[i].ordem       = i;
+        posVeiculo += b->bitsVeiculo;
+        posSensor  += b->bitsSensor;
+        posTipo    += 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Escreve a dataHora de um ts no formato de passagem.txt ("DD-MM-AAAA_HH:MM:SS.mmm").
+ * O ts não tem fuso horário (ver parseTimestampMs), por isso a conversão é com gmtime.
+ *
+ * @param ts
+ * @param destino
+ * @param tamanho
+ */
+static void formatarDataHora(long long ts, char* destino, size_t tamanho) {
+    time_t segundos = (time_t)(ts / 1000);
+    struct tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &segundos);
+#else
+    gmtime_r(&segundos, &tm);
+#endif
+    size_t n = strftime(destino, tamanho, "%d-%m-%Y_%H:%M:%S", &tm);
+    if (n > 0) snprintf(destino + n, tamanho - n, ".%03u", (unsigned)(ts % 1000));
+}
+
+/**
+ * @brief Índice do primeiro bloco que pode ter passagens com ts >= inicioMs
+ * (pesquisa binária no diretório, que está ordenado por ts).
+ *
+ * @param seg
+ * @param inicioMs
+ * @return size_t
+ */
+static size_t primeiroBloco(const SegmentoPassagens* seg, long long inicioMs) {
+    size_t lo = 0, hi = (size_t)seg->cabecalho->numBlocos;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        if (seg->blocos[meio].tsMax < inicioMs) lo = meio + 1;
+        else                                    hi = meio;
+    }
+    return lo;
+}
+
+/**
+ * @brief Conjunto de idVeiculo (endereçamento aberto) com uma marca "pendente"
+ * por veículo: um veículo está pendente se a sua última passagem já vista está
+ * dentro do período (ainda não se viu a passagem seguinte).
+ *
+ */
+typedef struct {
+    int32_t* ids;
+    uint8_t* estado;        // VEICULO_LIVRE, VEICULO_VISTO ou VEICULO_PENDENTE
+    size_t   numPosicoes;   // potência de 2
+    size_t   total;
+    size_t   pendentes;
+} VeiculosPendentes;
+
+enum { VEICULO_LIVRE, VEICULO_VISTO, VEICULO_PENDENTE };
+
+static size_t posicaoVeiculo(const VeiculosPendentes* v, int32_t id) {
+    size_t mascara = v->numPosicoes - 1;
+    size_t i = ((uint32_t)id * 2654435761u) & mascara;
+    while (v->estado[i] != VEICULO_LIVRE && v->ids[i] != id)
+        i = (i + 1) & mascara;
+    return i;
+}
+
+/**
+ * @brief Duplica a tabela de veículos e volta a inserir todos.
+ *
+ * @param v
+ * @return bool false se faltar memória
+ */
+static bool crescerVeiculos(VeiculosPendentes* v) {
+    VeiculosPendentes maior = { 0 };
+    maior.numPosicoes = v->numPosicoes ? v->numPosicoes * 2 : 1024;
+    maior.ids    = memoria_alocar(MEMORIA_CONSULTAS, maior.numPosicoes * sizeof *maior.ids);
+    maior.estado = memoria_alocarZeros(MEMORIA_CONSULTAS, maior.numPosicoes, sizeof *maior.estado);
+    if (!maior.ids || !maior.estado) {
+        memoria_libertar(maior.ids);
+        memoria_libertar(maior.estado);
+        return false;
+    }
+    for (size_t i = 0; i < v->numPosicoes; i++) {
+        if (v->estado[i] == VEICULO_LIVRE) continue;
+        size_t pos = posicaoVeiculo(&maior, v->ids[i]);
+        maior.ids[pos]    = v->ids[i];
+        maior.estado[pos] = v->estado[i];
+    }
+    maior.total     = v->total;
+    maior.pendentes = v->pendentes;
+    memoria_libertar(v->ids);
+    memoria_libertar(v->estado);
+    *v = maior;
+    return true;
+}
+
+/**
+ * @brief Regista uma passagem de um veículo: dentro do período fica pendente,
+ * depois do período deixa de estar.
+ *
+ * @param v
+ * @param id
+ * @param noPeriodo
+ * @return bool false se faltar memória
+ */
+static bool marcarVeiculo(VeiculosPendentes* v, int32_t id, bool noPeriodo) {
+    if (!noPeriodo && v->pendentes == 0) return true;
+    if ((v->total + 1) * 2 > v->numPosicoes && !crescerVeiculos(v)) return false;
+
+    size_t pos = posicaoVeiculo(v, id);
+    uint8_t novo = noPeriodo ? VEICULO_PENDENTE : VEICULO_VISTO;
+    if (v->estado[pos] == VEICULO_LIVRE) {
+        if (!noPeriodo) return true; // veículo que não passou no período
+        v->ids[pos] = id;
+        v->total++;
+    } else if (v->estado[pos] == novo) {
+        return true;
+    } else if (v->estado[pos] == VEICULO_PENDENTE) {
+        v->pendentes--;
+    }
+    if (novo == VEICULO_PENDENTE) v->pendentes++;
+    v->estado[pos] = novo;
+    return true;
+}
+
+/**
+ * @brief Cria nós (na arena) para as passagens arquivadas dos blocos que intersetam
+ * [inicioMs, fimMs], por ordem de ts. Só esses blocos são descomprimidos, mais os
+ * blocos seguintes estritamente necessários com SEGMENTO_COM_SEGUINTES.
+ *
+ * @param seg
+ * @param inicioMs
+ * @param fimMs
+ * @param modo
+ * @param arena
+ * @param cabeca Recebe o primeiro nó (NULL se não houver)
+ * @param cauda Recebe o último nó
+ * @return bool false se faltar memória ou um bloco estiver corrompido
+ */
+bool segmento_filtrar(const SegmentoPassagens* seg, long long inicioMs, long long fimMs, ModoFiltroSegmento modo,
+                      Arena* arena, NodePassagem** cabeca, NodePassagem** cauda) {
+    *cabeca = *cauda = NULL;
+    if (!seg->cabecalho || seg->cabecalho->numBlocos == 0) return true;
+
+    LinhaSegmento* linhas = NULL;
+    VeiculosPendentes pendentes = { 0 };
+    bool ok = true;
+    for (size_t b = primeiroBloco(seg, inicioMs); ok && b < seg->cabecalho->numBlocos; b++) {
+        const SegmentoBloco* bloco = &seg->blocos[b];
+        if (bloco->tsMin > fimMs && (modo == SEGMENTO_SO_PERIODO || pendentes.pendentes == 0)) break;
+        if (!linhas && !(linhas = memoria_alocar(MEMORIA_CONSULTAS, seg->cabecalho->linhasPorBloco * sizeof *linhas))) {
+            ok = false;
+            break;
+        }
+        if (!descomprimirBloco(seg, bloco, linhas)) {
+            fprintf(stderr, "Erro: bloco %zu do segmento de passagens corrompido.\n", b);
+            ok = false;
+            break;
+        }
+        for (uint32_t i = 0; ok && i < bloco->numLinhas; i++) {
+            const LinhaSegmento* l = &linhas[i];
+            bool noPeriodo = l->ts >= inicioMs && l->ts <= fimMs;
+            if (modo == SEGMENTO_SO_PERIODO && !noPeriodo) continue;
+            if (modo == SEGMENTO_COM_SEGUINTES && l->ts >= inicioMs &&
+                !marcarVeiculo(&pendentes, l->idVeiculo, noPeriodo)) {
+                ok = false;
+                break;
+            }
+            NodePassagem* no = arena_alloc(arena, sizeof(NodePassagem));
+            if (!no) {
+                ok = false;
+                break;
+            }
+            no->passagem.idSensor    = l->idSensor;
+            no->passagem.idVeiculo   = l->idVeiculo;
+            no->passagem.tipoRegisto = l->tipoRegisto;
+            no->passagem.ts          = l->ts;
+            formatarDataHora(l->ts, no->passagem.dataHora, sizeof no->passagem.dataHora);
+            no->next = NULL;
+            if (*cauda) (*cauda)->next = no;
+            else        *cabeca = no;
+            *cauda = no;
+        }
+        if (!ok) fprintf(stderr, "Erro Crítico: falta de memória ao ler o segmento de passagens.\n");
+    }
+    memoria_libertar(linhas);
+    memoria_libertar(pendentes.ids);
+    memoria_libertar(pendentes.estado);
+    return ok;
+}
+
+// --- Escrita ---
+
+static int compararLinhas(const void* a, const void* b) {
+    const LinhaSegmento* x = a;
+    const LinhaSegmento* y = b;
+    if (x->ts != y->ts) return x->ts < y->ts ? -1 : 1;
+    return (x->ordem > y->ordem) - (x->ordem < y->ordem);
+}
+
+/**
+ * @brief Avança o ficheiro com zeros até um múltiplo de 8 bytes e devolve a posição.
+ *
+ * @param fp
+ * @return uint64_t
+ */
+static uint64_t alinharFicheiro(FILE* fp) {
+    long pos = ftell(fp);
+    while (pos % 8 != 0) {
+        fputc(0, fp);
+        pos++;
+    }
+    return (uint64_t)pos;
+}
+
+/**
+ * @brief Comprime um bloco de linhas (já ordenadas por ts) e escreve-o no ficheiro.
+ *
+ * @param fp
+ * @param linhas
+ * @param n
+ * @param bufferTs Espaço para 10 bytes por linha
+ * @param palavras Espaço para as palavras do pior caso (65 bits por linha)
+ * @param bloco Recebe a entrada do diretório
+ */
+static void escreverBloco(FILE* fp, const LinhaSegmento* linhas, uint32_t n,
+                          unsigned char* bufferTs, uint64_t* palavras, SegmentoBloco* bloco) {
+    memset(bloco, 0, sizeof *bloco);
+    bloco->numLinhas  = n;
+    bloco->tsMin      = linhas[0].ts;
+    bloco->tsMax      = linhas[n - 1].ts;
+    bloco->minVeiculo = linhas[0].idVeiculo;
+    bloco->minSensor  = linhas[0].idSensor;
+    int32_t maxVeiculo = linhas[0].idVeiculo, maxSensor = linhas[0].idSensor;
+    for (uint32_t i = 1; i < n; i++) {
+        if (linhas[i].idVeiculo < bloco->minVeiculo) bloco->minVeiculo = linhas[i].idVeiculo;
+        if (linhas[i].idVeiculo > maxVeiculo)        maxVeiculo = linhas[i].idVeiculo;
+        if (linhas[i].idSensor < bloco->minSensor)   bloco->minSensor = linhas[i].idSensor;
+        if (linhas[i].idSensor > maxSensor)          maxSensor = linhas[i].idSensor;
+    }
+    bloco->bitsVeiculo = bitsNecessarios((uint32_t)((int64_t)maxVeiculo - bloco->minVeiculo));
+    bloco->bitsSensor  = bitsNecessarios((uint32_t)((int64_t)maxSensor - bloco->minSensor));
+
+    size_t bytesTs = 0;
+    long long anterior = bloco->tsMin;
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t delta = (uint64_t)(linhas[i].ts - anterior);
+        anterior = linhas[i].ts;
+        do {
+            unsigned char byte = delta & 0x7F;
+            delta >>= 7;
+            bufferTs[bytesTs++] = byte | (delta ? 0x80 : 0);
+        } while (delta);
+    }
+    bloco->bytesTs = (uint32_t)bytesTs;
+
+    size_t numPalavras = palavrasBloco(bloco);
+    memset(palavras, 0, numPalavras * sizeof *palavras);
+    uint64_t posVeiculo = 0;
+    uint64_t posSensor  = (uint64_t)n * bloco->bitsVeiculo;
+    uint64_t posTipo    = posSensor + (uint64_t)n * bloco->bitsSensor;
+    for (uint32_t i = 0; i < n; i++) {
+        escreverBits(palavras, posVeiculo, (uint32_t)((int64_t)linhas[i].idVeiculo - bloco->minVeiculo), bloco->bitsVeiculo);
+        escreverBits(palavras, posSensor, (uint32_t)((int64_t)linhas[i].idSensor - bloco->minSensor), bloco->bitsSensor);
+        escreverBits(palavras, posTipo, linhas[i].tipoRegisto & 1, 1);
+        posVeiculo += bloco->bitsVeiculo;
+        posSensor  += bloco->bitsSensor;
+        posTipo    += 1;
+    }
+
+    bloco->offset = alinharFicheiro(fp);
+    fwrite(bufferTs, 1, bytesTs, fp);
+    alinharFicheiro(fp);
+    fwrite(palavras, sizeof *palavras, numPalavras, fp);
+}
+
+/**
+ * @brief Número de blocos para n linhas.
+ *
+ * @param n
+ * @return size_t
+ */
+static size_t blocosPara(size_t n) {
+    return (n + SEGMENTO_LINHAS_BLOCO - 1) / SEGMENTO_LINHAS_BLOCO;
+}
+
+/**
+ * @brief Comprime e escreve, a partir da posição atual do ficheiro, as linhas
+ * (já ordenadas por ts) em blocos de SEGMENTO_LINHAS_BLOCO linhas.
+ *
+ * @param fp
+ * @param linhas
+ * @param n
+ * @param diretorio Recebe uma entrada por bloco
+ * @return bool false se faltar memória
+ */
+static bool escreverBlocos(FILE* fp, const LinhaSegmento* linhas, size_t n, SegmentoBloco* diretorio) {
+    unsigned char* bufferTs = memoria_alocar(MEMORIA_EXPORTACAO, (size_t)SEGMENTO_LINHAS_BLOCO * 10);
+    uint64_t* palavras      = memoria_alocar(MEMORIA_EXPORTACAO, ((size_t)SEGMENTO_LINHAS_BLOCO * 65 / 64 + 1) * sizeof *palavras);
+    bool ok = bufferTs && palavras;
+    for (size_t b = 0; ok && b < blocosPara(n); b++) {
+        size_t ini = b * SEGMENTO_LINHAS_BLOCO;
+        size_t num = n - ini < SEGMENTO_LINHAS_BLOCO ? n - ini : SEGMENTO_LINHAS_BLOCO;
+        escreverBloco(fp, linhas + ini, (uint32_t)num, bufferTs, palavras, &diretorio[b]);
+    }
+    memoria_libertar(bufferTs);
+    memoria_libertar(palavras);
+    return ok;
+}
+
+/**
+ * @brief Grava um segmento novo com as linhas dadas (já ordenadas por ts). O ficheiro
+ * é escrito com um nome temporário e só depois renomeado, como o snapshot.
+ *
+ * @param nomeFicheiro
+ * @param linhas
+ * @param n
+ * @param corte
+ * @return bool
+ */
+static bool gravarSegmento(const char* nomeFicheiro, const LinhaSegmento* linhas, size_t n, long long corte) {
+    char temporario[512];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", nomeFicheiro);
+    FILE* fp = fopen(temporario, "wb");
+    if (!fp) {
+        fprintf(stderr, "Erro ao criar o ficheiro %s\n", temporario);
+        return false;
+    }
+
+    size_t numBlocos = blocosPara(n);
+    SegmentoBloco* diretorio = memoria_alocarZeros(MEMORIA_EXPORTACAO, numBlocos, sizeof *diretorio);
+    bool ok = diretorio != NULL;
+
+    SegmentoCabecalho cab = {0};
+    memcpy(cab.magia, SEGMENTO_MAGIA, sizeof(cab.magia));
+    cab.versao         = SEGMENTO_VERSAO;
+    cab.linhasPorBloco = SEGMENTO_LINHAS_BLOCO;
+    cab.numLinhas      = n;
+    cab.numBlocos      = numBlocos;
+    cab.corte          = corte;
+    fwrite(&cab, sizeof(cab), 1, fp); // reescrito no fim, já com os offsets
+
+    ok = ok && escreverBlocos(fp, linhas, n, diretorio);
+    if (ok) {
+        cab.offsetDiretorio = alinharFicheiro(fp);
+        fwrite(diretorio, sizeof *diretorio, numBlocos, fp);
+        cab.tamanhoTotal = (uint64_t)ftell(fp);
+        rewind(fp);
+        fwrite(&cab, sizeof(cab), 1, fp);
+        ok = !ferror(fp);
+    }
+    memoria_libertar(diretorio);
+    if (fclose(fp) != 0) ok = false;
+
+    if (!ok || rename(temporario, nomeFicheiro) != 0) {
+        fprintf(stderr, "Erro ao gravar o segmento %s.\n", nomeFicheiro);
+        remove(temporario);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Acrescenta ao fim do segmento aberto os blocos das linhas dadas (já
+ * ordenadas por ts e todas posteriores ao corte do segmento), seguidos de um
+ * diretório novo com os blocos antigos e os novos. O cabeçalho só é reescrito
+ * no fim: se a escrita for interrompida antes, o ficheiro fica com o conteúdo
+ * anterior (mais bytes sem uso no fim, que a leitura ignora). Os blocos e o
+ * diretório já mapeados não são alterados.
+ *
+ * @param nomeFicheiro
+ * @param seg Aberto a partir de nomeFicheiro
+ * @param linhas
+ * @param n
+ * @param corte
+ * @return bool
+ */
+static bool acrescentarSegmento(const char* nomeFicheiro, const SegmentoPassagens* seg,
+                                const LinhaSegmento* linhas, size_t n, long long corte) {
+    FILE* fp = fopen(nomeFicheiro, "r+b");
+    if (!fp) {
+        fprintf(stderr, "Erro ao abrir o ficheiro %s\n", nomeFicheiro);
+        return false;
+    }
+
+    SegmentoCabecalho cab = *seg->cabecalho;
+    size_t anteriores = (size_t)cab.numBlocos;
+    size_t numBlocos  = anteriores + blocosPara(n);
+    SegmentoBloco* diretorio = memoria_alocarZeros(MEMORIA_EXPORTACAO, numBlocos, sizeof *diretorio);
+    bool ok = diretorio && fseek(fp, (long)cab.tamanhoTotal, SEEK_SET) == 0;
+    if (ok) {
+        memcpy(diretorio, seg->blocos, anteriores * sizeof *diretorio);
+        ok = escreverBlocos(fp, linhas, n, diretorio + anteriores);
+    }
+    if (ok) {
+        cab.numLinhas      += n;
+        cab.numBlocos       = numBlocos;
+        cab.corte           = corte;
+        cab.offsetDiretorio = alinharFicheiro(fp);
+        fwrite(diretorio, sizeof *diretorio, numBlocos, fp);
+        cab.tamanhoTotal = (uint64_t)ftell(fp);
+        ok = fflush(fp) == 0 && !ferror(fp); // blocos e diretório antes do cabeçalho
+    }
+    if (ok) {
+        rewind(fp);
+        fwrite(&cab, sizeof(cab), 1, fp);
+        ok = !ferror(fp);
+    }
+    memoria_libertar(diretorio);
+    if (fclose(fp) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Erro ao acrescentar passagens ao segmento %s.\n", nomeFicheiro);
+    return ok;
+}
+
+/**
+ * @brief Regrava o segmento inteiro com as linhas que já tinha mais as novas.
+ *
+ * @param nomeFicheiro
+ * @param seg Segmento atual (pode estar vazio)
+ * @param novas Linhas a juntar
+ * @param n
+ * @param corte
+ * @return bool
+ */
+static bool regravarSegmento(const char* nomeFicheiro, const SegmentoPassagens* seg,
+                             const LinhaSegmento* novas, size_t n, long long corte) {
+    size_t existentes = seg->cabecalho ? (size_t)seg->cabecalho->numLinhas : 0;
+    LinhaSegmento* linhas = memoria_alocar(MEMORIA_EXPORTACAO, (existentes + n) * sizeof *linhas);
+    if (!linhas) {
+        fprintf(stderr, "Erro Crítico: falta de memória ao arquivar passagens.\n");
+        return false;
+    }
+    size_t total = 0;
+    bool ok = true;
+    for (size_t b = 0; ok && seg->cabecalho && b < seg->cabecalho->numBlocos; b++) {
+        ok = descomprimirBloco(seg, &seg->blocos[b], linhas + total);
+        total += seg->blocos[b].numLinhas;
+    }
+    memcpy(linhas + total, novas, n * sizeof *linhas);
+    total += n;
+    for (size_t i = 0; i < total; i++)
+        linhas[i].ordem = (uint32_t)i;
+    qsort(linhas, total, sizeof *linhas, compararLinhas);
+    ok = ok && gravarSegmento(nomeFicheiro, linhas, total, corte);
+    memoria_libertar(linhas);
+    return ok;
+}
+
+/**
+ * @brief Indica se o próximo arquivo deve regravar (compactar) o segmento em vez
+ * de lhe acrescentar blocos: quando os blocos parciais deixados por arquivos
+ * pequenos passam do dobro dos necessários, ou quando os diretórios antigos,
+ * que ficam no ficheiro sem uso, passam de metade do que é usado. Entre duas
+ * compactações de um segmento com B blocos há pelo menos ~B arquivos, pelo que
+ * em média cada arquivo regrava da ordem de SEGMENTO_LINHAS_BLOCO linhas.
+ *
+ * @param seg
+ * @param novas
+ * @return bool
+ */
+static bool compactarSegmento(const SegmentoPassagens* seg, size_t novas) {
+    const SegmentoCabecalho* cab = seg->cabecalho;
+    uint64_t blocos = cab->numBlocos + blocosPara(novas);
+    if (blocos > 2 * blocosPara((size_t)cab->numLinhas + novas) + 1) return true;
+
+    uint64_t usados = sizeof *cab + cab->numBlocos * sizeof(SegmentoBloco);
+    for (uint64_t b = 0; b < cab->numBlocos; b++)
+        usados += alinhar8(seg->blocos[b].bytesTs) + palavrasBloco(&seg->blocos[b]) * 8;
+    return cab->tamanhoTotal - usados > usados / 2;
+}
+
+/**
+ * @brief Passa as passagens com ts <= corteMs da lista principal para o segmento
+ * e reconstrói a lista numa arena nova só com as passagens mais recentes.
+ * Normalmente as passagens arquivadas são todas posteriores ao corte anterior e
+ * os seus blocos são acrescentados ao fim do segmento, pelo que cada arquivo só
+ * custa as passagens que arquiva. O segmento só é regravado inteiro se houver
+ * passagens anteriores ao corte (registadas à mão com uma data antiga) ou se
+ * precisar de ser compactado (ver compactarSegmento). Passagens com ts <= corte
+ * que apareçam depois nos ficheiros de texto são ignoradas na leitura (ver
+ * segmento_arquivada). Não pode ser chamado com o modo de seguimento ativo.
+ *
+ * @param nomeFicheiro
+ * @param listaPassagens
+ * @param corteMs
+ * @return size_t Número de passagens arquivadas (0 se não havia nenhuma ou houve erro)
+ */
+size_t arquivarPassagens(const char* nomeFicheiro, NodePassagem** listaPassagens, long long corteMs) {
+    double t0 = segundosAgora();
+    SegmentoPassagens* seg = &segmentoPassagens;
+    long long corteAnterior = seg->cabecalho ? seg->cabecalho->corte : -1;
+    long long corte = corteMs > corteAnterior ? corteMs : corteAnterior;
+
+    // 1) Lista nova só com as passagens que ficam em memória (a antiga só é
+    //    libertada depois de o segmento estar gravado)
+    Arena nova = ARENA_INIT(arenaPassagens.nome, arenaPassagens.tamanhoBloco, arenaPassagens.subsistema);
+    NodePassagem *cabeca = NULL, *cauda = NULL;
+    size_t novas = 0, tardias = 0;
+    for (const NodePassagem* p = *listaPassagens; p; p = p->next) {
+        long long ts = p->passagem.ts;
+        if (ts >= 0 && ts <= corte) {
+            novas++;
+            if (ts <= corteAnterior) tardias++;
+            continue;
+        }
+        NodePassagem* no = arena_alloc(&nova, sizeof(NodePassagem));
+        if (!no) {
+            fprintf(stderr, "Erro Crítico: falta de memória ao arquivar passagens.\n");
+            arena_libertar(&nova);
+            return 0;
+        }
+        no->passagem = p->passagem;
+        no->next = NULL;
+        if (cauda) cauda->next = no;
+        else       cabeca = no;
+        cauda = no;
+    }
+    if (novas == 0) {
+        arena_libertar(&nova);
+        printf("Nao ha passagens ate essa data para arquivar.\n");
+        return 0;
+    }
+
+    // 2) Linhas novas, ordenadas por ts (estável: pela ordem da lista), acrescentadas
+    //    ao segmento ou, se for preciso, juntas às existentes num segmento regravado
+    LinhaSegmento* linhas = memoria_alocar(MEMORIA_EXPORTACAO, novas * sizeof *linhas);
+    if (!linhas) {
+        fprintf(stderr, "Erro Crítico: falta de memória ao arquivar passagens.\n");
+        arena_libertar(&nova);
+        return 0;
+    }
+    size_t n = 0;
+    for (const NodePassagem* p = *listaPassagens; p; p = p->next) {
+        const Passagem* ps = &p->passagem;
+        if (ps->ts < 0 || ps->ts > corte) continue;
+        linhas[n] = (LinhaSegmento){ ps->ts, ps->idVeiculo, ps->idSensor, ps->tipoRegisto, (uint32_t)n };
+        n++;
+    }
+    qsort(linhas, n, sizeof *linhas, compararLinhas);
+    bool acrescentar = seg->cabecalho && tardias == 0 && !compactarSegmento(seg, n);
+    bool ok = acrescentar ? acrescentarSegmento(nomeFicheiro, seg, linhas, n, corte)
+                          : regravarSegmento(nomeFicheiro, seg, linhas, n, corte);
+    memoria_libertar(linhas);
+    if (!ok) {
+        arena_libertar(&nova);
+        return 0;
+    }
+
+    // 3) Troca o segmento e a lista (se o segmento novo não abrir, fica tudo como estava)
+    SegmentoPassagens novoSegmento = { 0 };
+    if (!segmento_abrir(&novoSegmento, nomeFicheiro)) {
+        fprintf(stderr, "Erro: nao foi possivel abrir o segmento %s gravado; a lista de passagens nao foi alterada.\n",
+                nomeFicheiro);
+        arena_libertar(&nova);
+        return 0;
+    }
+    segmento_fechar(seg);
+    *seg = novoSegmento;
+    colunas_libertar(&colunasPassagens); // os índices apontam para os nós antigos
+    indiceTemporal_libertar(&indiceTemporal);
+    grupos_libertar(&gruposPassagens);
+    arena_libertar(&arenaPassagens);
+    arenaPassagens = nova;
+    *listaPassagens = cabeca;
+
+    size_t total = (size_t)seg->cabecalho->numLinhas;
+    printf("Arquivadas %zu passagens em %s (%s; %zu no total, %.1f bytes por passagem) em %.3f s.\n",
+           novas, nomeFicheiro, acrescentar ? "acrescentadas" : "segmento regravado", total,
+           total ? (double)seg->cabecalho->tamanhoTotal / (double)total : 0.0, segundosAgora() - t0);
+    return novas;
+}
+
+/**
+ * @brief Mostra o tamanho do segmento e o período que cobre.
+ *
+ * @param seg
+ */
+void segmento_imprimirEstatisticas(const SegmentoPassagens* seg) {
+    if (!seg->cabecalho) {
+        printf("Segmento de passagens arquivadas: nenhum\n");
+        return;
+    }
+    const SegmentoCabecalho* cab = seg->cabecalho;
+    char corte[PASSAGEM_MAX_DATAHORA];
+    formatarDataHora(cab->corte, corte, sizeof(corte));
+    printf("Segmento de passagens arquivadas: %llu passagens em %llu blocos, %zu bytes (%.1f por passagem), ate %s\n",
+           (unsigned long long)cab->numLinhas, (unsigned long long)cab->numBlocos, seg->tamanho,
+           cab->numLinhas ? (double)seg->tamanho / (double)cab->numLinhas : 0.0, corte);
+}
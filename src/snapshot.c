@@ -0,0 +1,523 @@
+// snapshot.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>     // sysconf
+#include <pthread.h>
+#endif
+
+#include "snapshot.h"
+#include "read_files.h"
+#include "decompress.h"
+#include "operations.h"
+#include "dictionary.h"
+#include "geo.h"
+#include "postal.h"
+#include "id_index.h"
+#include "plate_index.h"
+#include "name_index.h"
+#include "distance_matrix.h"
+
+// --- Escrita ---
+
+/**
+ * @brief Heap de strings construído durante a escrita do snapshot.
+ *
+ */
+typedef struct {
+    char*  dados;
+    size_t tamanho, capacidade;
+    bool   erro;
+} HeapEscrita;
+
+/**
+ * @brief Acrescenta uma string (com o '\0') ao heap e devolve o seu offset.
+ *
+ * @param h
+ * @param s
+ * @return uint32_t
+ */
+static uint32_t heapAdicionar(HeapEscrita* h, const char* s) {
+    size_t n = strlen(s) + 1;
+    if (h->tamanho + n > UINT32_MAX) {
+        h->erro = true;
+        return 0;
+    }
+    if (h->tamanho + n > h->capacidade) {
+        size_t nova = h->capacidade ? h->capacidade * 2 : 1 << 16;
+        while (nova < h->tamanho + n) nova *= 2;
+        char* tmp = memoria_realocar(MEMORIA_EXPORTACAO, h->dados, nova);
+        if (!tmp) {
+            h->erro = true;
+            return 0;
+        }
+        h->dados = tmp;
+        h->capacidade = nova;
+    }
+    uint32_t offset = (uint32_t)h->tamanho;
+    memcpy(h->dados + h->tamanho, s, n);
+    h->tamanho += n;
+    return offset;
+}
+
+/**
+ * @brief Avança o ficheiro com zeros até um múltiplo de 8 bytes e devolve a posição.
+ *
+ * @param fp
+ * @return uint64_t
+ */
+static uint64_t alinharFicheiro(FILE* fp) {
+    long pos = ftell(fp);
+    while (pos % 8 != 0) {
+        fputc(0, fp);
+        pos++;
+    }
+    return (uint64_t)pos;
+}
+
+/**
+ * @brief Grava toda a base de dados carregada num snapshot binário.
+ * O ficheiro é escrito primeiro com um nome temporário e só depois renomeado,
+ * para que uma gravação interrompida nunca deixe um snapshot inválido no lugar.
+ * O cabeçalho guarda até onde passagem.txt foi lido (e o seu tamanho e mtime),
+ * para que as linhas acrescentadas depois sejam lidas ao carregar o snapshot.
+ *
+ * @param fontePassagens Ficheiro de onde vieram as passagens
+ * @param offsetPassagens Bytes desse ficheiro refletidos na lista
+ * @return true se o snapshot foi gravado
+ */
+bool gravarSnapshot(const char* nomeFicheiro, NodeDono* listaDonos, NodeCarro* listaCarros, NodeSensor* listaSensores,
+                    NodeDistancia* listaDistancias, NodePassagem* listaPassagens,
+                    const char* fontePassagens, size_t offsetPassagens) {
+    char temporario[512];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", nomeFicheiro);
+    FILE* fp = fopen(temporario, "wb");
+    if (!fp) {
+        fprintf(stderr, "Erro ao criar o ficheiro %s\n", temporario);
+        return false;
+    }
+
+    double t0 = segundosAgora();
+    HeapEscrita heap = {0};
+    SnapshotSeccao seccoes[6] = {0};
+    SnapshotCabecalho cab = {0};
+    memcpy(cab.magia, SNAPSHOT_MAGIA, sizeof(cab.magia));
+    cab.versao = SNAPSHOT_VERSAO;
+    cab.numSeccoes = 6;
+    cab.offsetPassagens = offsetPassagens;
+    struct stat st;
+    if (stat(fontePassagens, &st) == 0) {
+        cab.tamanhoPassagens = (uint64_t)st.st_size;
+        cab.mtimePassagens = (int64_t)st.st_mtime;
+    }
+
+    // O cabeçalho e a tabela de secções são reescritos no fim, já com os offsets
+    fwrite(&cab, sizeof(cab), 1, fp);
+    fwrite(seccoes, sizeof(seccoes), 1, fp);
+
+    // --- Donos ---
+    seccoes[0].tipo = SNAP_DONOS;
+    seccoes[0].tamanhoRegisto = sizeof(SnapDono);
+    seccoes[0].offset = alinharFicheiro(fp);
+    for (NodeDono* p = listaDonos; p; p = p->next) {
+        char codigoPostal[DONO_MAX_CODIGOPOSTAL];
+        formatarCodigoPostal(p->dono.codigoPostal, codigoPostal, sizeof(codigoPostal));
+        SnapDono r = { p->dono.numeroContribuinte,
+                       heapAdicionar(&heap, nomeDono(&p->dono)),
+                       heapAdicionar(&heap, codigoPostal) };
+        fwrite(&r, sizeof(r), 1, fp);
+        seccoes[0].numRegistos++;
+    }
+
+    // --- Carros ---
+    seccoes[1].tipo = SNAP_CARROS;
+    seccoes[1].tamanhoRegisto = sizeof(SnapCarro);
+    seccoes[1].offset = alinharFicheiro(fp);
+    for (NodeCarro* p = listaCarros; p; p = p->next) {
+        SnapCarro r = { heapAdicionar(&heap, p->carro.matricula),
+                        heapAdicionar(&heap, marcaCarro(&p->carro)),
+                        heapAdicionar(&heap, modeloCarro(&p->carro)),
+                        p->carro.ano, p->carro.donoContribuinte, p->carro.idVeiculo };
+        fwrite(&r, sizeof(r), 1, fp);
+        seccoes[1].numRegistos++;
+    }
+
+    // --- Sensores ---
+    seccoes[2].tipo = SNAP_SENSORES;
+    seccoes[2].tamanhoRegisto = sizeof(SnapSensor);
+    seccoes[2].offset = alinharFicheiro(fp);
+    for (NodeSensor* p = listaSensores; p; p = p->next) {
+        char lat[GEO_MAX_TEXTO], lon[GEO_MAX_TEXTO];
+        SnapSensor r = { p->sensor.idSensor,
+                         heapAdicionar(&heap, p->sensor.designacao),
+                         heapAdicionar(&heap, textoCoordenada(p->sensor.latitudeTexto, p->sensor.latitude, true, lat, sizeof(lat))),
+                         heapAdicionar(&heap, textoCoordenada(p->sensor.longitudeTexto, p->sensor.longitude, false, lon, sizeof(lon))) };
+        fwrite(&r, sizeof(r), 1, fp);
+        seccoes[2].numRegistos++;
+    }
+
+    // --- Distâncias ---
+    seccoes[3].tipo = SNAP_DISTANCIAS;
+    seccoes[3].tamanhoRegisto = sizeof(SnapDistancia);
+    seccoes[3].offset = alinharFicheiro(fp);
+    for (NodeDistancia* p = listaDistancias; p; p = p->next) {
+        SnapDistancia r = { p->distancia.idSensor1, p->distancia.idSensor2, p->distancia.distancia };
+        fwrite(&r, sizeof(r), 1, fp);
+        seccoes[3].numRegistos++;
+    }
+
+    // --- Passagens ---
+    seccoes[4].tipo = SNAP_PASSAGENS;
+    seccoes[4].tamanhoRegisto = sizeof(SnapPassagem);
+    seccoes[4].offset = alinharFicheiro(fp);
+    for (NodePassagem* p = listaPassagens; p; p = passagem_seguinte(p)) {
+        SnapPassagem r = { p->passagem.ts, p->passagem.idSensor, p->passagem.idVeiculo,
+                           p->passagem.tipoRegisto, heapAdicionar(&heap, p->passagem.dataHora) };
+        fwrite(&r, sizeof(r), 1, fp);
+        seccoes[4].numRegistos++;
+    }
+
+    // --- Heap de strings ---
+    seccoes[5].tipo = SNAP_STRINGS;
+    seccoes[5].tamanhoRegisto = 1;
+    seccoes[5].offset = alinharFicheiro(fp);
+    seccoes[5].numRegistos = heap.tamanho;
+    if (heap.tamanho) fwrite(heap.dados, 1, heap.tamanho, fp);
+
+    for (int i = 0; i < 5; i++)
+        seccoes[i].bytes = seccoes[i].numRegistos * seccoes[i].tamanhoRegisto;
+    seccoes[5].bytes = heap.tamanho;
+    cab.tamanhoTotal = (uint64_t)ftell(fp);
+
+    rewind(fp);
+    fwrite(&cab, sizeof(cab), 1, fp);
+    fwrite(seccoes, sizeof(seccoes), 1, fp);
+
+    bool ok = !heap.erro && !ferror(fp);
+    memoria_libertar(heap.dados);
+    if (fclose(fp) != 0) ok = false;
+
+    if (!ok) {
+        fprintf(stderr, "Erro ao gravar o snapshot %s (disco cheio ou heap de strings > 4 GB).\n", nomeFicheiro);
+        remove(temporario);
+        return false;
+    }
+    remove(nomeFicheiro); // rename() em Windows não substitui ficheiros existentes
+    if (rename(temporario, nomeFicheiro) != 0) {
+        fprintf(stderr, "Erro ao mover %s para %s\n", temporario, nomeFicheiro);
+        return false;
+    }
+    printf("Snapshot %s gravado (%llu bytes) em %.3f s.\n",
+           nomeFicheiro, (unsigned long long)cab.tamanhoTotal, segundosAgora() - t0);
+    return true;
+}
+
+// --- Leitura ---
+
+/**
+ * @brief Localiza e valida uma secção do snapshot mapeado.
+ *
+ * @return const void* Início dos registos ou NULL se a secção não existir / for inválida
+ */
+static const void* obterSeccao(const char* dados, size_t tamanho, const SnapshotSeccao* seccoes, uint32_t numSeccoes,
+                               SnapshotTipoSeccao tipo, uint32_t tamanhoRegisto, uint64_t* numRegistos) {
+    for (uint32_t i = 0; i < numSeccoes; i++) {
+        const SnapshotSeccao* s = &seccoes[i];
+        if (s->tipo != (uint32_t)tipo) continue;
+        if (s->tamanhoRegisto != tamanhoRegisto ||
+            s->numRegistos > UINT64_MAX / tamanhoRegisto ||
+            s->bytes != s->numRegistos * tamanhoRegisto ||
+            s->offset > tamanho || s->bytes > tamanho - s->offset ||
+            s->offset % 8 != 0) {
+            return NULL;
+        }
+        *numRegistos = s->numRegistos;
+        return dados + s->offset;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Copia uma string do heap do snapshot para um campo de tamanho fixo.
+ *
+ * @return bool false se o offset estiver fora do heap
+ */
+static bool copiarString(char* destino, size_t tamanhoDestino, const char* heap, uint64_t tamanhoHeap, uint32_t offset) {
+    if (offset >= tamanhoHeap) return false;
+    strncpy(destino, heap + offset, tamanhoDestino - 1);
+    destino[tamanhoDestino - 1] = '\0';
+    return true;
+}
+
+/**
+ * @brief Código no dicionário de uma string do heap, truncada a tamanhoMax - 1 bytes.
+ *
+ * @param d
+ * @param tamanhoMax
+ * @param heap
+ * @param tamanhoHeap
+ * @param offset
+ * @param codigo Recebe o código
+ * @return bool false se o offset for inválido ou faltar memória
+ */
+static bool codigoString(Dicionario* d, size_t tamanhoMax, const char* heap, uint64_t tamanhoHeap, uint32_t offset, int* codigo) {
+    if (offset >= tamanhoHeap) return false;
+    size_t limite = tamanhoHeap - offset < tamanhoMax - 1 ? (size_t)(tamanhoHeap - offset) : tamanhoMax - 1;
+    *codigo = dicionario_codigo(d, heap + offset, strnlen(heap + offset, limite));
+    return *codigo >= 0;
+}
+
+/**
+ * @brief Intervalo de registos de passagens convertido por uma thread.
+ *
+ */
+typedef struct {
+    const SnapPassagem* registos;
+    NodePassagem*       nos;
+    size_t              ini, fim, total;
+    const char*         heap;
+    uint64_t            tamanhoHeap;
+    bool                erro;
+} FatiaSnapshot;
+
+/**
+ * @brief Converte os registos [ini, fim) em nós já ligados entre si.
+ *
+ * @param arg FatiaSnapshot*
+ * @return void*
+ */
+static void* converterPassagensSnapshot(void* arg) {
+    FatiaSnapshot* f = arg;
+    for (size_t i = f->ini; i < f->fim; i++) {
+        const SnapPassagem* r = &f->registos[i];
+        NodePassagem* no = &f->nos[i];
+        no->passagem.ts          = r->ts;
+        no->passagem.idSensor    = r->idSensor;
+        no->passagem.idVeiculo   = r->idVeiculo;
+        no->passagem.tipoRegisto = r->tipoRegisto;
+        if (!copiarString(no->passagem.dataHora, sizeof(no->passagem.dataHora), f->heap, f->tamanhoHeap, r->dataHora))
+            f->erro = true;
+        no->next = (i + 1 < f->total) ? &f->nos[i + 1] : NULL;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Carrega toda a base de dados a partir de um snapshot binário.
+ * O ficheiro é mapeado em memória; os registos de tamanho fixo são convertidos
+ * diretamente em nós, sem qualquer parsing de texto. As listas ficam pela mesma
+ * ordem em que estavam quando o snapshot foi gravado.
+ *
+ * @return true se o snapshot foi carregado; em caso de erro as listas ficam vazias
+ */
+bool carregarSnapshot(const char* nomeFicheiro, NodeDono** listaDonos, NodeCarro** listaCarros, NodeSensor** listaSensores,
+                      NodeDistancia** listaDistancias, NodePassagem** listaPassagens) {
+    *listaDonos = NULL;
+    *listaCarros = NULL;
+    *listaSensores = NULL;
+    *listaDistancias = NULL;
+    *listaPassagens = NULL;
+
+    double t0 = segundosAgora();
+    size_t tamanho;
+    const char* dados = mapearFicheiro(nomeFicheiro, &tamanho);
+    if (!dados) return false;
+
+    const SnapshotCabecalho* cab = (const SnapshotCabecalho*)dados;
+    if (tamanho < sizeof(*cab) || memcmp(cab->magia, SNAPSHOT_MAGIA, sizeof(cab->magia)) != 0 ||
+        cab->versao != SNAPSHOT_VERSAO || cab->tamanhoTotal != tamanho ||
+        cab->numSeccoes > (tamanho - sizeof(*cab)) / sizeof(SnapshotSeccao)) {
+        fprintf(stderr, "Snapshot %s invalido ou de outra versao; a usar os ficheiros de texto.\n", nomeFicheiro);
+        desmapearFicheiro(dados, tamanho);
+        return false;
+    }
+    const SnapshotSeccao* seccoes = (const SnapshotSeccao*)(dados + sizeof(*cab));
+
+    uint64_t nDonos, nCarros, nSensores, nDistancias, nPassagens, tamanhoHeap;
+    const SnapDono*      rDonos      = obterSeccao(dados, tamanho, seccoes, cab->numSeccoes, SNAP_DONOS, sizeof(SnapDono), &nDonos);
+    const SnapCarro*     rCarros     = obterSeccao(dados, tamanho, seccoes, cab->numSeccoes, SNAP_CARROS, sizeof(SnapCarro), &nCarros);
+    const SnapSensor*    rSensores   = obterSeccao(dados, tamanho, seccoes, cab->numSeccoes, SNAP_SENSORES, sizeof(SnapSensor), &nSensores);
+    const SnapDistancia* rDistancias = obterSeccao(dados, tamanho, seccoes, cab->numSeccoes, SNAP_DISTANCIAS, sizeof(SnapDistancia), &nDistancias);
+    const SnapPassagem*  rPassagens  = obterSeccao(dados, tamanho, seccoes, cab->numSeccoes, SNAP_PASSAGENS, sizeof(SnapPassagem), &nPassagens);
+    const char*          heap        = obterSeccao(dados, tamanho, seccoes, cab->numSeccoes, SNAP_STRINGS, 1, &tamanhoHeap);
+
+    // Todas as secções têm de existir e o heap tem de terminar em '\0' (todas as strings ficam terminadas)
+    if (!rDonos || !rCarros || !rSensores || !rDistancias || !rPassagens || !heap ||
+        (tamanhoHeap > 0 && heap[tamanhoHeap - 1] != '\0')) {
+        fprintf(stderr, "Snapshot %s corrompido; a usar os ficheiros de texto.\n", nomeFicheiro);
+        desmapearFicheiro(dados, tamanho);
+        return false;
+    }
+
+    bool ok = true;
+
+    // --- Donos (as listas são reconstruídas pela ordem do snapshot) ---
+    NodeDono* caudaDono = NULL;
+    for (uint64_t i = 0; i < nDonos && ok; i++) {
+        NodeDono* no = arena_alloc(&arenaDonos, sizeof(NodeDono));
+        if (!no) { ok = false; break; }
+        no->dono.numeroContribuinte = rDonos[i].numeroContribuinte;
+        ok = rDonos[i].nome < tamanhoHeap && rDonos[i].codigoPostal < tamanhoHeap &&
+             strings_adicionar(&heapNomesDonos, heap + rDonos[i].nome,
+                               strnlen(heap + rDonos[i].nome, tamanhoHeap - rDonos[i].nome), &no->dono.nome);
+        if (ok) {
+            const char* cp = heap + rDonos[i].codigoPostal;
+            no->dono.codigoPostal = empacotarCodigoPostal(cp, strnlen(cp, tamanhoHeap - rDonos[i].codigoPostal));
+        }
+        no->next = NULL;
+        if (caudaDono) caudaDono->next = no; else *listaDonos = no;
+        caudaDono = no;
+    }
+
+    // --- Carros ---
+    NodeCarro* caudaCarro = NULL;
+    for (uint64_t i = 0; i < nCarros && ok; i++) {
+        NodeCarro* no = arena_alloc(&arenaCarros, sizeof(NodeCarro));
+        if (!no) { ok = false; break; }
+        ok = copiarString(no->carro.matricula, sizeof(no->carro.matricula), heap, tamanhoHeap, rCarros[i].matricula) &&
+             codigoString(&dicionarioMarcas, CARRO_MAX_MARCA, heap, tamanhoHeap, rCarros[i].marca, &no->carro.codigoMarca) &&
+             codigoString(&dicionarioModelos, CARRO_MAX_MODELO, heap, tamanhoHeap, rCarros[i].modelo, &no->carro.codigoModelo);
+        no->carro.ano = rCarros[i].ano;
+        no->carro.donoContribuinte = rCarros[i].donoContribuinte;
+        no->carro.idVeiculo = rCarros[i].idVeiculo;
+        no->next = NULL;
+        if (caudaCarro) caudaCarro->next = no; else *listaCarros = no;
+        caudaCarro = no;
+    }
+
+    if (ok) indiceDonos_construir(&indiceDonos, *listaDonos);
+    if (ok) indiceNomes_construir(&indiceNomes, *listaDonos);
+    if (ok) indiceCarros_construir(&indiceCarros, *listaCarros);
+    if (ok) indiceMatriculas_construir(&indiceMatriculas, *listaCarros);
+
+    // --- Sensores ---
+    NodeSensor* caudaSensor = NULL;
+    for (uint64_t i = 0; i < nSensores && ok; i++) {
+        NodeSensor* no = arena_alloc(&arenaSensores, sizeof(NodeSensor));
+        if (!no) { ok = false; break; }
+        no->sensor.idSensor = rSensores[i].idSensor;
+        ok = copiarString(no->sensor.designacao, sizeof(no->sensor.designacao), heap, tamanhoHeap, rSensores[i].designacao) &&
+             rSensores[i].latitude < tamanhoHeap && rSensores[i].longitude < tamanhoHeap &&
+             definirCoordenadasSensor(&no->sensor, &arenaSensores,
+                                      heap + rSensores[i].latitude, strnlen(heap + rSensores[i].latitude, tamanhoHeap - rSensores[i].latitude),
+                                      heap + rSensores[i].longitude, strnlen(heap + rSensores[i].longitude, tamanhoHeap - rSensores[i].longitude));
+        no->next = NULL;
+        if (caudaSensor) caudaSensor->next = no; else *listaSensores = no;
+        caudaSensor = no;
+    }
+
+    // --- Distâncias ---
+    NodeDistancia* caudaDistancia = NULL;
+    for (uint64_t i = 0; i < nDistancias && ok; i++) {
+        NodeDistancia* no = arena_alloc(&arenaDistancias, sizeof(NodeDistancia));
+        if (!no) { ok = false; break; }
+        no->distancia.idSensor1 = rDistancias[i].idSensor1;
+        no->distancia.idSensor2 = rDistancias[i].idSensor2;
+        no->distancia.distancia = rDistancias[i].distancia;
+        no->next = NULL;
+        if (caudaDistancia) caudaDistancia->next = no; else *listaDistancias = no;
+        caudaDistancia = no;
+    }
+
+    if (ok) matrizDistancias_construir(&matrizDistancias, *listaDistancias);
+
+    // --- Passagens: um único bloco, convertido em paralelo ---
+    NodePassagem* passagensSnapshot = NULL;
+    if (ok && nPassagens > 0) {
+        passagensSnapshot = arena_alloc(&arenaPassagens, nPassagens * sizeof(NodePassagem));
+        if (!passagensSnapshot) ok = false;
+    }
+    if (ok && nPassagens > 0) {
+        size_t nThreads = 1;
+#ifndef _WIN32
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cores > 1) nThreads = cores > PASSAGENS_MAX_THREADS ? PASSAGENS_MAX_THREADS : (size_t)cores;
+        if (nThreads > nPassagens) nThreads = nPassagens;
+#endif
+        FatiaSnapshot fatias[PASSAGENS_MAX_THREADS];
+        for (size_t i = 0; i < nThreads; i++) {
+            fatias[i] = (FatiaSnapshot){ rPassagens, passagensSnapshot, nPassagens / nThreads * i,
+                                         i == nThreads - 1 ? nPassagens : nPassagens / nThreads * (i + 1),
+                                         nPassagens, heap, tamanhoHeap, false };
+        }
+#ifndef _WIN32
+        pthread_t threads[PASSAGENS_MAX_THREADS];
+        size_t lancadas = 1;
+        for (; lancadas < nThreads; lancadas++) {
+            if (pthread_create(&threads[lancadas], NULL, converterPassagensSnapshot, &fatias[lancadas]) != 0)
+                break;
+        }
+        converterPassagensSnapshot(&fatias[0]);
+        for (size_t i = 1; i < lancadas; i++)
+            pthread_join(threads[i], NULL);
+        for (size_t i = lancadas; i < nThreads; i++)
+            converterPassagensSnapshot(&fatias[i]);
+#else
+        for (size_t i = 0; i < nThreads; i++)
+            converterPassagensSnapshot(&fatias[i]);
+#endif
+        for (size_t i = 0; i < nThreads; i++)
+            if (fatias[i].erro) ok = false;
+        *listaPassagens = passagensSnapshot;
+    }
+
+    desmapearFicheiro(dados, tamanho);
+
+    if (!ok) {
+        fprintf(stderr, "Erro ao carregar o snapshot %s; a usar os ficheiros de texto.\n", nomeFicheiro);
+        libertarListaDonos(listaDonos);
+        libertarListaCarros(listaCarros);
+        libertarListaSensores(listaSensores);
+        libertarListaDistancias(listaDistancias);
+        libertarListaPassagens(listaPassagens);
+        return false;
+    }
+
+    printf("Snapshot %s carregado em %.3f s: %llu donos, %llu carros, %llu sensores, %llu distancias, %llu passagens.\n",
+           nomeFicheiro, segundosAgora() - t0,
+           (unsigned long long)nDonos, (unsigned long long)nCarros, (unsigned long long)nSensores,
+           (unsigned long long)nDistancias, (unsigned long long)nPassagens);
+    return true;
+}
+
+/**
+ * @brief Verifica se o snapshot existe e é mais recente do que os ficheiros de
+ * texto. passagem.txt é comparado com o tamanho e mtime guardados no cabeçalho:
+ * se só cresceu (e não está comprimido), o snapshot continua válido e as linhas
+ * novas são lidas a partir de *offsetPassagens.
+ *
+ * @param nomeFicheiro Snapshot
+ * @param fontes Ficheiros de texto de onde os dados seriam lidos (indexados por FonteDados)
+ * @param numFontes
+ * @param offsetPassagens Recebe os bytes de passagem.txt já refletidos no snapshot
+ * @return bool
+ */
+bool snapshotAtualizado(const char* nomeFicheiro, const char* const fontes[], int numFontes, size_t* offsetPassagens) {
+    struct stat stSnap, stFonte;
+    if (stat(nomeFicheiro, &stSnap) != 0) return false;
+
+    SnapshotCabecalho cab;
+    FILE* fp = fopen(nomeFicheiro, "rb");
+    if (!fp) return false;
+    bool lido = fread(&cab, sizeof(cab), 1, fp) == 1;
+    fclose(fp);
+    if (!lido || memcmp(cab.magia, SNAPSHOT_MAGIA, sizeof(cab.magia)) != 0 || cab.versao != SNAPSHOT_VERSAO)
+        return false;
+
+    for (int i = 0; i < numFontes; i++) {
+        if (stat(fontes[i], &stFonte) != 0) continue;
+        if (i != FONTE_PASSAGENS) {
+            if (stFonte.st_mtime > stSnap.st_mtime) return false;
+            continue;
+        }
+        bool igual   = (uint64_t)stFonte.st_size == cab.tamanhoPassagens &&
+                       (int64_t)stFonte.st_mtime == cab.mtimePassagens;
+        bool cresceu = !ficheiroComprimido(fontes[i]) && (uint64_t)stFonte.st_size > cab.tamanhoPassagens;
+        if (!igual && !cresceu) return false;
+    }
+    *offsetPassagens = (size_t)cab.offsetPassagens;
+    return true;
+}
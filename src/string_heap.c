@@ -0,0 +1,54 @@
+#include <stdio.h>      // fprintf
+#include <string.h>     // memcpy
+#include "string_heap.h"
+
+HeapStrings heapNomesDonos = HEAP_STRINGS_INIT("Nomes donos", MEMORIA_DADOS);
+
+/**
+ * @brief Acrescenta um texto ao heap.
+ *
+ * @param heap
+ * @param texto Não precisa de ser terminado em '\0'
+ * @param comprimento
+ * @param ref Recebe a referência do texto
+ * @return bool false se faltar memória ou o heap passar de 4 GB
+ */
+bool strings_adicionar(HeapStrings* heap, const char* texto, size_t comprimento, RefString* ref) {
+    size_t necessario = heap->tamanho + comprimento + 1;
+    if (necessario > UINT32_MAX) {
+        fprintf(stderr, "Erro Crítico: heap de %s cheio.\n", heap->nome);
+        return false;
+    }
+    if (necessario > heap->capacidade) {
+        size_t nova = heap->capacidade ? heap->capacidade * 2 : HEAP_STRINGS_CAPACIDADE_INICIAL;
+        while (nova < necessario) nova *= 2;
+        char* dados = memoria_realocar(heap->subsistema, heap->dados, nova);
+        if (!dados) {
+            fprintf(stderr, "Erro Crítico: falta de memória no heap de %s.\n", heap->nome);
+            return false;
+        }
+        memoria_ajustarFolga(heap->subsistema, (long long)(nova - heap->capacidade));
+        heap->dados = dados;
+        heap->capacidade = nova;
+    }
+    ref->offset = (uint32_t)heap->tamanho;
+    ref->comprimento = (uint32_t)comprimento;
+    memcpy(heap->dados + heap->tamanho, texto, comprimento);
+    heap->dados[heap->tamanho + comprimento] = '\0';
+    heap->tamanho = necessario;
+    memoria_ajustarFolga(heap->subsistema, -(long long)(comprimento + 1));
+    return true;
+}
+
+/**
+ * @brief Liberta o heap (as referências deixam de ser válidas).
+ *
+ * @param heap
+ */
+void strings_libertar(HeapStrings* heap) {
+    memoria_libertar(heap->dados);
+    memoria_ajustarFolga(heap->subsistema, -(long long)(heap->capacidade - heap->tamanho));
+    heap->dados = NULL;
+    heap->tamanho = 0;
+    heap->capacidade = 0;
+}
@@ -0,0 +1,257 @@
+#include <stdio.h>      // fprintf
+#include <string.h>     // memcpy, memmove
+#include "time_index.h"
+
+IndiceTemporal indiceTemporal = { 0 };
+
+#define TEMPORAL_PENDENTES_MIN 64   // menor limite de linhas pendentes
+
+/**
+ * @brief Funde as sequências ordenadas [0, meio) e [meio, n) de 'linhas' através de 'tmp'.
+ *
+ * @param linhas
+ * @param meio
+ * @param n
+ * @param col
+ * @param tmp Espaço para n linhas
+ */
+static void fundir(uint32_t* linhas, size_t meio, size_t n, const ColunasPassagens* col, uint32_t* tmp) {
+    size_t a = 0, b = meio, k = 0;
+    while (a < meio && b < n)
+        tmp[k++] = colunas_antes(col, linhas[b], linhas[a]) ? linhas[b++] : linhas[a++];
+    while (a < meio) tmp[k++] = linhas[a++];
+    while (b < n)    tmp[k++] = linhas[b++];
+    memcpy(linhas, tmp, n * sizeof *linhas);
+}
+
+/**
+ * @brief Ordena as linhas (merge sort de baixo para cima, estável).
+ *
+ * @param linhas
+ * @param n
+ * @param col
+ * @param tmp Espaço para n linhas
+ */
+static void ordenarLinhas(uint32_t* linhas, size_t n, const ColunasPassagens* col, uint32_t* tmp) {
+    for (size_t largura = 1; largura < n; largura *= 2) {
+        for (size_t ini = 0; ini + largura < n; ini += 2 * largura) {
+            size_t fim = ini + 2 * largura < n ? ini + 2 * largura : n;
+            if (!colunas_antes(col, linhas[ini + largura], linhas[ini + largura - 1])) continue; // já em ordem
+            fundir(linhas + ini, largura, fim - ini, col, tmp);
+        }
+    }
+}
+
+/**
+ * @brief Esvazia o índice (fica com a capacidade) para refletir outras colunas.
+ *
+ * @param idx
+ * @param col NULL para o deixar inválido (tenta de novo na próxima consulta)
+ */
+static void reiniciar(IndiceTemporal* idx, const ColunasPassagens* col) {
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)(idx->total * sizeof *idx->linhas));
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)(idx->numPendentes * sizeof *idx->pendentes));
+    idx->total        = 0;
+    idx->numPendentes = 0;
+    idx->colunas      = col;
+    idx->geracao      = col ? col->geracao : 0;
+}
+
+/**
+ * @brief Máximo de linhas pendentes: inserir no array custa O(pendentes) e
+ * cada fusão O(total), pelo que o equilíbrio fica perto de √total.
+ *
+ * @param idx
+ * @return size_t
+ */
+static size_t limitePendentes(const IndiceTemporal* idx) {
+    size_t k = TEMPORAL_PENDENTES_MIN;
+    while ((k * 2) * (k * 2) <= idx->total) k *= 2;
+    return k;
+}
+
+/**
+ * @brief Funde no índice os pendentes e as linhas das colunas a partir de
+ * 'primeiraNova': são copiadas para o fim, ordenadas (normalmente já chegam
+ * por ordem de ts) e fundidas com as existentes.
+ *
+ * @param idx
+ * @param col
+ * @param primeiraNova
+ * @return bool false se faltar memória (o índice fica vazio; usar a lista)
+ */
+static bool consolidar(IndiceTemporal* idx, const ColunasPassagens* col, size_t primeiraNova) {
+    size_t anteriores = idx->total;
+    size_t total = anteriores + idx->numPendentes + (col->total - primeiraNova);
+    if (total > idx->capacidade) {
+        size_t nova = idx->capacidade ? idx->capacidade : COLUNAS_CAPACIDADE_INICIAL;
+        while (nova < total) nova *= 2;
+        uint32_t* linhas = memoria_realocar(MEMORIA_INDICES, idx->linhas, nova * sizeof *linhas);
+        if (!linhas) {
+            fprintf(stderr, "Erro Crítico: falta de memória no índice temporal.\n");
+            reiniciar(idx, NULL);
+            return false;
+        }
+        memoria_ajustarFolga(MEMORIA_INDICES, (long long)((nova - idx->capacidade) * sizeof *linhas));
+        idx->linhas = linhas;
+        idx->capacidade = nova;
+    }
+
+    if (idx->numPendentes) memcpy(idx->linhas + anteriores, idx->pendentes, idx->numPendentes * sizeof *idx->linhas);
+    size_t k = anteriores + idx->numPendentes;
+    bool ordenadas = true;
+    for (size_t i = primeiraNova; i < col->total; i++, k++) {
+        idx->linhas[k] = (uint32_t)i;
+        if (k > anteriores && ordenadas && !colunas_antes(col, idx->linhas[k - 1], (uint32_t)i)) ordenadas = false;
+    }
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)((total - anteriores) * sizeof *idx->linhas));
+    memoria_ajustarFolga(MEMORIA_INDICES, (long long)(idx->numPendentes * sizeof *idx->pendentes));
+    idx->numPendentes = 0;
+    idx->total = total;
+    if (ordenadas && (anteriores == 0 || !colunas_antes(col, idx->linhas[anteriores], idx->linhas[anteriores - 1])))
+        return true;
+
+    uint32_t* tmp = memoria_alocar(MEMORIA_INDICES, total * sizeof *tmp);
+    if (!tmp) {
+        fprintf(stderr, "Erro Crítico: falta de memória no índice temporal.\n");
+        reiniciar(idx, NULL);
+        return false;
+    }
+    if (!ordenadas) ordenarLinhas(idx->linhas + anteriores, total - anteriores, col, tmp);
+    if (anteriores > 0)
+        fundir(idx->linhas, anteriores, total, col, tmp);
+    memoria_libertar(tmp);
+    return true;
+}
+
+/**
+ * @brief Põe uma linha nos pendentes, mantendo-os ordenados.
+ *
+ * @param idx
+ * @param col
+ * @param linha
+ * @return bool false se faltar memória
+ */
+static bool inserirPendente(IndiceTemporal* idx, const ColunasPassagens* col, uint32_t linha) {
+    if (idx->numPendentes == idx->capacidadePendentes) {
+        size_t nova = idx->capacidadePendentes ? idx->capacidadePendentes * 2 : TEMPORAL_PENDENTES_MIN;
+        uint32_t* pendentes = memoria_realocar(MEMORIA_INDICES, idx->pendentes, nova * sizeof *pendentes);
+        if (!pendentes) return false;
+        memoria_ajustarFolga(MEMORIA_INDICES, (long long)((nova - idx->capacidadePendentes) * sizeof *pendentes));
+        idx->pendentes = pendentes;
+        idx->capacidadePendentes = nova;
+    }
+    size_t lo = 0, hi = idx->numPendentes;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        if (colunas_antes(col, idx->pendentes[meio], linha)) lo = meio + 1; else hi = meio;
+    }
+    memmove(idx->pendentes + lo + 1, idx->pendentes + lo, (idx->numPendentes - lo) * sizeof *idx->pendentes);
+    idx->pendentes[lo] = linha;
+    idx->numPendentes++;
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)sizeof *idx->pendentes);
+    return true;
+}
+
+/**
+ * @brief Atualiza o índice para refletir as colunas (que já têm de estar
+ * sincronizadas). Só reconstrói se as colunas foram reconstruídas.
+ *
+ * @param idx
+ * @param col
+ * @return bool false se faltar memória (o índice fica vazio; usar a lista)
+ */
+bool indiceTemporal_sincronizar(IndiceTemporal* idx, const ColunasPassagens* col) {
+    if (idx->colunas != col || idx->geracao != col->geracao || col->total < idx->total + idx->numPendentes)
+        reiniciar(idx, col);
+    size_t coberto = idx->total + idx->numPendentes;
+    if (coberto == col->total) return true;
+    if (col->total > UINT32_MAX) return false;
+
+    size_t limite = limitePendentes(idx);
+    if (idx->total == 0 || idx->numPendentes + (col->total - coberto) > limite)
+        return consolidar(idx, col, coberto);
+    for (size_t i = coberto; i < col->total; i++) {
+        if (!inserirPendente(idx, col, (uint32_t)i)) {
+            fprintf(stderr, "Erro Crítico: falta de memória no índice temporal.\n");
+            reiniciar(idx, NULL);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Fatia [primeira, ultima) de um array de linhas ordenado com as passagens de [inicioMs, fimMs].
+ *
+ * @param linhas
+ * @param n
+ * @param col
+ * @param inicioMs
+ * @param fimMs
+ * @param primeira
+ * @param ultima
+ */
+static void intervaloLinhas(const uint32_t* linhas, size_t n, const ColunasPassagens* col,
+                            long long inicioMs, long long fimMs, size_t* primeira, size_t* ultima) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {   // primeira linha com ts >= inicioMs
+        size_t meio = lo + (hi - lo) / 2;
+        if (col->ts[linhas[meio]] < inicioMs) lo = meio + 1; else hi = meio;
+    }
+    *primeira = lo;
+    hi = n;
+    while (lo < hi) {   // primeira linha com ts > fimMs
+        size_t meio = lo + (hi - lo) / 2;
+        if (col->ts[linhas[meio]] <= fimMs) lo = meio + 1; else hi = meio;
+    }
+    *ultima = lo;
+}
+
+/**
+ * @brief Fatia [primeira, ultima) do índice com as passagens de [inicioMs, fimMs]
+ * (sem os pendentes, ver indiceTemporal_pendentes()).
+ *
+ * @param idx Sincronizado com col
+ * @param col
+ * @param inicioMs
+ * @param fimMs
+ * @param primeira
+ * @param ultima
+ */
+void indiceTemporal_intervalo(const IndiceTemporal* idx, const ColunasPassagens* col,
+                              long long inicioMs, long long fimMs, size_t* primeira, size_t* ultima) {
+    intervaloLinhas(idx->linhas, idx->total, col, inicioMs, fimMs, primeira, ultima);
+}
+
+/**
+ * @brief Linhas pendentes com as passagens de [inicioMs, fimMs], por ordem.
+ *
+ * @param idx Sincronizado com col
+ * @param col
+ * @param inicioMs
+ * @param fimMs
+ * @param linhas Recebe o início da fatia
+ * @return size_t Número de linhas
+ */
+size_t indiceTemporal_pendentes(const IndiceTemporal* idx, const ColunasPassagens* col,
+                                long long inicioMs, long long fimMs, const uint32_t** linhas) {
+    size_t primeira, ultima;
+    intervaloLinhas(idx->pendentes, idx->numPendentes, col, inicioMs, fimMs, &primeira, &ultima);
+    *linhas = idx->pendentes + primeira;
+    return ultima - primeira;
+}
+
+/**
+ * @brief Liberta o índice (as colunas não são tocadas).
+ *
+ * @param idx
+ */
+void indiceTemporal_libertar(IndiceTemporal* idx) {
+    memoria_ajustarFolga(MEMORIA_INDICES, -(long long)((idx->capacidade - idx->total) * sizeof *idx->linhas));
+    memoria_ajustarFolga(MEMORIA_INDICES,
+                         -(long long)((idx->capacidadePendentes - idx->numPendentes) * sizeof *idx->pendentes));
+    memoria_libertar(idx->linhas);
+    memoria_libertar(idx->pendentes);
+    *idx = (IndiceTemporal){ 0 };
+}
@@ -0,0 +1,190 @@
+#include <string.h>     // memcpy
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "tokenizer.h"
+
+/**
+ * @brief Máscara com um bit por byte de [p, p+64) que seja '\t' ou '\n'.
+ * Só os bytes antes de 'fim' são considerados.
+ *
+ * @param p
+ * @param fim
+ * @return uint64_t
+ */
+static uint64_t mascaraDelimitadores(const char* p, const char* fim) {
+    if (fim - p >= 64) {
+#if defined(__AVX2__)
+        const __m256i tab = _mm256_set1_epi8('\t'), nl = _mm256_set1_epi8('\n');
+        __m256i a = _mm256_loadu_si256((const __m256i*)p);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(p + 32));
+        uint32_t ma = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(a, tab), _mm256_cmpeq_epi8(a, nl)));
+        uint32_t mb = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(b, tab), _mm256_cmpeq_epi8(b, nl)));
+        return (uint64_t)ma | ((uint64_t)mb << 32);
+#elif defined(__SSE2__)
+        const __m128i tab = _mm_set1_epi8('\t'), nl = _mm_set1_epi8('\n');
+        uint64_t m = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+            uint32_t bits = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, nl)));
+            m |= (uint64_t)bits << (16 * i);
+        }
+        return m;
+#endif
+    }
+    // Fim do buffer (ou sem SIMD): classificação byte a byte
+    uint64_t m = 0;
+    size_t n = (size_t)(fim - p) < 64 ? (size_t)(fim - p) : 64;
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == '\t' || p[i] == '\n') m |= (uint64_t)1 << i;
+    }
+    return m;
+}
+
+/**
+ * @brief Prepara o tokenizador para percorrer [ini, fim).
+ *
+ * @param t
+ * @param ini
+ * @param fim
+ */
+void tokenizador_init(Tokenizador* t, const char* ini, const char* fim) {
+    t->pos     = ini;
+    t->fim     = fim;
+    t->base    = ini;
+    t->mascara = ini < fim ? mascaraDelimitadores(ini, fim) : 0;
+}
+
+/**
+ * @brief Posição do próximo '\t' ou '\n' (ou 'fim', se não houver mais).
+ *
+ * @param t
+ * @return const char*
+ */
+static inline const char* proximoDelimitador(Tokenizador* t) {
+    while (t->mascara == 0) {
+        t->base += 64;
+        if (t->base >= t->fim) return t->fim;
+        t->mascara = mascaraDelimitadores(t->base, t->fim);
+    }
+    const char* d = t->base + __builtin_ctzll(t->mascara);
+    t->mascara &= t->mascara - 1;
+    return d;
+}
+
+/**
+ * @brief Divide a próxima linha em campos. Tal como o strtok, os campos vazios
+ * são ignorados; ao último campo da linha é retirado o '\r' final.
+ * Campos a mais do que maxCampos são ignorados (o resto da linha é saltado).
+ *
+ * @param t
+ * @param campos Recebe os campos da linha
+ * @param maxCampos
+ * @return int Número de campos preenchidos, ou -1 se não houver mais linhas
+ */
+int tokenizador_linha(Tokenizador* t, Campo* campos, int maxCampos) {
+    if (t->pos >= t->fim) return -1;
+    int n = 0;
+    for (;;) {
+        const char* ini = t->pos;
+        const char* d = proximoDelimitador(t);
+        bool fimLinha = d >= t->fim || *d == '\n';
+        const char* f = d;
+        if (fimLinha) {
+            while (f > ini && f[-1] == '\r') f--;
+        }
+        if (f > ini && n < maxCampos) {
+            campos[n].ini = ini;
+            campos[n].fim = f;
+            n++;
+        }
+        t->pos = d + 1;
+        if (fimLinha) return n;
+    }
+}
+
+/**
+ * @brief Converte um campo num inteiro, com a semântica do atoi
+ * (espaços iniciais, sinal opcional, para no primeiro não-dígito).
+ *
+ * @param c
+ * @return int
+ */
+int campoInteiro(Campo c) {
+    const char* p = c.ini;
+    while (p < c.fim && (*p == ' ' || *p == '\r')) p++;
+    int sinal = 1;
+    if (p < c.fim && (*p == '-' || *p == '+')) {
+        if (*p == '-') sinal = -1;
+        p++;
+    }
+    int valor = 0;
+    while (p < c.fim && *p >= '0' && *p <= '9') {
+        valor = valor * 10 + (*p - '0');
+        p++;
+    }
+    return sinal * valor;
+}
+
+/**
+ * @brief Converte um campo decimal (ex.: "12.5", "-3", "1.5e2") num double, como o atof.
+ * A mantissa é acumulada como inteiro e dividida por uma potência de 10 exata,
+ * pelo que o resultado é o mesmo do strtod para os valores dos ficheiros.
+ *
+ * @param c
+ * @return double
+ */
+double campoDecimal(Campo c) {
+    static const double potencias10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* p = c.ini;
+    while (p < c.fim && (*p == ' ' || *p == '\r')) p++;
+    bool negativo = false;
+    if (p < c.fim && (*p == '-' || *p == '+')) {
+        negativo = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int expoente = 0, digitos = 0;
+    for (; p < c.fim && *p >= '0' && *p <= '9'; p++, digitos++) {
+        if (mantissa < UINT64_C(100000000000000000)) mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        else expoente++;
+    }
+    if (p < c.fim && *p == '.') {
+        for (p++; p < c.fim && *p >= '0' && *p <= '9'; p++, digitos++) {
+            if (mantissa < UINT64_C(100000000000000000)) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                expoente--;
+            }
+        }
+    }
+    if (digitos > 0 && p < c.fim && (*p == 'e' || *p == 'E')) {
+        Campo e = { p + 1, c.fim };
+        expoente += campoInteiro(e);
+    }
+
+    double valor = (double)mantissa;
+    while (expoente < -22) { valor /= 1e22; expoente += 22; }
+    while (expoente > 22)  { valor *= 1e22; expoente -= 22; }
+    valor = expoente < 0 ? valor / potencias10[-expoente] : valor * potencias10[expoente];
+    return negativo ? -valor : valor;
+}
+
+/**
+ * @brief Copia um campo para uma string de tamanho fixo, truncando como o
+ * strncpy(destino, campo, tamanho - 1) usado até aqui.
+ *
+ * @param destino
+ * @param tamanho
+ * @param c
+ */
+void campoCopiar(char* destino, size_t tamanho, Campo c) {
+    size_t n = (size_t)(c.fim - c.ini);
+    if (n > tamanho - 1) n = tamanho - 1;
+    memcpy(destino, c.ini, n);
+    destino[n] = '\0';
+}
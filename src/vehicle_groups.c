@@ -0,0 +1,377 @@
+#include <stdio.h>      // printf, fprintf
+#include <string.h>     // memcpy, memmove
+#include "vehicle_groups.h"
+
+GruposVeiculo gruposPassagens = GRUPOS_VEICULO_INIT(MEMORIA_INDICES);
+
+/**
+ * @brief De onde vêm as passagens a agrupar: uma lista (do primeiro ao último
+ * nó, fixados na primeira passagem, porque o seguimento pode acrescentar nós
+ * entretanto) ou uma vista.
+ *
+ */
+typedef struct {
+    const NodePassagem* primeiro;
+    const NodePassagem* ultimo;
+    const NodePassagem* no;
+    const NodePassagem* visto;      // último nó devolvido
+    VistaPassagens*     vista;
+} OrigemGrupos;
+
+static void origem_reiniciar(OrigemGrupos* o) {
+    if (o->vista) vista_reiniciar(o->vista);
+    else          o->no = o->primeiro;
+}
+
+static const Passagem* origem_seguinte(OrigemGrupos* o) {
+    if (o->vista) return vista_seguinte(o->vista);
+    const NodePassagem* n = o->no;
+    if (!n) return NULL;
+    o->visto = n;
+    o->no = n == o->ultimo ? NULL : passagem_seguinte(n);
+    return &n->passagem;
+}
+
+/**
+ * @brief Garante espaço para 'n' passagens.
+ *
+ * @param g
+ * @param n
+ * @return bool false se faltar memória
+ */
+static bool reservar(GruposVeiculo* g, size_t n) {
+    if (n <= g->capacidade) return true;
+    size_t nova = g->capacidade ? g->capacidade : GRUPOS_CAPACIDADE_MIN;
+    while (nova < n) nova *= 2;
+    const Passagem** passagens = memoria_realocar(g->subsistema, g->passagens, nova * sizeof *passagens);
+    if (!passagens) return false;
+    memoria_ajustarFolga(g->subsistema, (long long)((nova - g->capacidade) * sizeof *passagens));
+    g->passagens = passagens;
+    g->capacidade = nova;
+    return true;
+}
+
+/**
+ * @brief Ordena uma fatia por ts (merge sort de baixo para cima, estável).
+ *
+ * @param a
+ * @param n
+ * @param tmp Espaço para n ponteiros
+ */
+static void ordenarFatia(const Passagem** a, size_t n, const Passagem** tmp) {
+    for (size_t largura = 1; largura < n; largura *= 2) {
+        for (size_t ini = 0; ini + largura < n; ini += 2 * largura) {
+            size_t meio = ini + largura;
+            size_t fim  = ini + 2 * largura < n ? ini + 2 * largura : n;
+            if (a[meio - 1]->ts <= a[meio]->ts) continue; // já em ordem
+            size_t i = ini, j = meio, k = 0;
+            while (i < meio && j < fim) tmp[k++] = a[j]->ts < a[i]->ts ? a[j++] : a[i++];
+            while (i < meio) tmp[k++] = a[i++];
+            while (j < fim)  tmp[k++] = a[j++];
+            memcpy(a + ini, tmp, k * sizeof *a);
+        }
+    }
+}
+
+/**
+ * @brief Constrói o índice do zero: conta as passagens de cada veículo, coloca-as
+ * pela ordem de origem e ordena por ts as fatias que não estão ordenadas.
+ *
+ * @param g
+ * @param o
+ * @return bool false se não houver passagens, os ids estiverem demasiado espalhados ou faltar memória
+ */
+static bool construir(GruposVeiculo* g, OrigemGrupos* o) {
+    grupos_libertar(g);
+
+    int32_t idMin = 0, idMax = 0;
+    size_t n = 0;
+    origem_reiniciar(o);
+    for (const Passagem* p; (p = origem_seguinte(o)) != NULL; n++) {
+        if (n == 0 || p->idVeiculo < idMin) idMin = p->idVeiculo;
+        if (n == 0 || p->idVeiculo > idMax) idMax = p->idVeiculo;
+    }
+    o->ultimo = o->visto;
+    if (n == 0 || n > UINT32_MAX) return false;
+    if ((int64_t)idMax - idMin + 1 > GRUPOS_MAX_VEICULOS) {
+        fprintf(stderr, "Aviso: ids de veiculos demasiado espalhados para o indice por veiculo.\n");
+        return false;
+    }
+
+    size_t numVeiculos = (size_t)((int64_t)idMax - idMin + 1);
+    uint32_t* inicio = memoria_alocarZeros(g->subsistema, numVeiculos + 1, sizeof *inicio);
+    uint32_t* cursor = memoria_alocar(g->subsistema, numVeiculos * sizeof *cursor);
+    if (!inicio || !cursor || !reservar(g, n)) {
+        fprintf(stderr, "Erro Crítico: falta de memória no indice por veiculo.\n");
+        memoria_libertar(inicio);
+        memoria_libertar(cursor);
+        return false;
+    }
+
+    origem_reiniciar(o);
+    for (const Passagem* p; (p = origem_seguinte(o)) != NULL; )
+        inicio[p->idVeiculo - idMin + 1]++;
+    for (size_t v = 0; v < numVeiculos; v++) {
+        inicio[v + 1] += inicio[v];
+        cursor[v] = inicio[v];
+    }
+    origem_reiniciar(o);
+    for (const Passagem* p; (p = origem_seguinte(o)) != NULL; )
+        g->passagens[cursor[p->idVeiculo - idMin]++] = p;
+
+    // A maior fatia dá o tamanho do espaço temporário do merge sort
+    size_t maior = 0;
+    for (size_t v = 0; v < numVeiculos; v++)
+        if (inicio[v + 1] - inicio[v] > maior) maior = inicio[v + 1] - inicio[v];
+    const Passagem** tmp = (const Passagem**)cursor;
+    if (maior * sizeof *tmp > numVeiculos * sizeof *cursor) {
+        memoria_libertar(cursor);
+        tmp = memoria_alocar(g->subsistema, maior * sizeof *tmp);
+        if (!tmp) {
+            fprintf(stderr, "Erro Crítico: falta de memória no indice por veiculo.\n");
+            memoria_libertar(inicio);
+            return false;
+        }
+    }
+    for (size_t v = 0; v < numVeiculos; v++)
+        ordenarFatia(g->passagens + inicio[v], inicio[v + 1] - inicio[v], tmp);
+    memoria_libertar((void*)tmp);
+
+    g->idMin = idMin;
+    g->numVeiculos = numVeiculos;
+    g->inicio = inicio;
+    g->total = n;
+    memoria_ajustarFolga(g->subsistema, -(long long)(n * sizeof *g->passagens));
+    return true;
+}
+
+/**
+ * @brief Constrói o índice a partir da lista inteira.
+ *
+ * @param g
+ * @param lista
+ * @return bool
+ */
+static bool construirLista(GruposVeiculo* g, const NodePassagem* lista) {
+    OrigemGrupos o = { lista, NULL, NULL, NULL, NULL };
+    if (!construir(g, &o)) return false;
+    g->cabeca = lista;
+    g->cauda  = o.ultimo;
+    return true;
+}
+
+/**
+ * @brief Máximo de passagens pendentes: inserir no array custa O(pendentes) e
+ * cada fusão O(total), pelo que o equilíbrio fica perto de √total.
+ *
+ * @param g
+ * @return size_t
+ */
+static size_t limitePendentes(const GruposVeiculo* g) {
+    size_t k = GRUPOS_PENDENTES_MIN;
+    while ((k * 2) * (k * 2) <= g->total) k *= 2;
+    return k;
+}
+
+/**
+ * @brief Funde as passagens pendentes nas fatias dos seus veículos, de trás
+ * para a frente: cada passagem do array principal é deslocada uma só vez, de
+ * tantas posições quantas as pendentes dos veículos anteriores.
+ *
+ * @param g
+ * @return bool false se faltar memória (os pendentes ficam por fundir)
+ */
+bool grupos_consolidar(GruposVeiculo* g) {
+    size_t k = g->numPendentes;
+    if (k == 0) return true;
+    if (g->total + k > UINT32_MAX || !reservar(g, g->total + k)) return false;
+
+    const PendenteGrupo* pend = g->pendentes;
+    const Passagem** a = g->passagens;
+    size_t fim = g->total;          // passagens [0, fim) ainda por deslocar
+    size_t i = k;
+    while (i > 0) {
+        uint32_t v = pend[i - 1].v;
+        size_t fimFatia = g->inicio[v + 1];
+        memmove(a + fimFatia + i, a + fimFatia, (fim - fimFatia) * sizeof *a);
+        size_t base = g->inicio[v], j = fimFatia, destino = fimFatia + i;
+        for (; i > 0 && pend[i - 1].v == v; i--) {
+            const PendenteGrupo* q = &pend[i - 1];
+            while (j > base && (a[j - 1]->ts > q->passagem->ts || (a[j - 1]->ts == q->passagem->ts && q->antes)))
+                a[--destino] = a[--j];
+            a[--destino] = q->passagem;
+        }
+        fim = j;
+    }
+
+    for (size_t v = pend[0].v + 1, j = 0; v <= g->numVeiculos; v++) {
+        while (j < k && pend[j].v < v) j++;
+        g->inicio[v] += (uint32_t)j;
+    }
+    g->total += k;
+    g->numPendentes = 0;
+    memoria_ajustarFolga(g->subsistema, -(long long)(k * sizeof *g->passagens));
+    memoria_ajustarFolga(g->subsistema, (long long)(k * sizeof *g->pendentes));
+    return true;
+}
+
+/**
+ * @brief Acrescenta uma passagem aos pendentes, mantendo a ordem por (veículo,
+ * ts); se o array estiver cheio, funde-o primeiro.
+ *
+ * @param g
+ * @param p
+ * @param antesDosIguais true para uma passagem posta à cabeça da lista (fica antes das que têm o mesmo ts)
+ * @return bool false se o veículo estiver fora do intervalo ou faltar memória
+ */
+static bool inserir(GruposVeiculo* g, const Passagem* p, bool antesDosIguais) {
+    int64_t d = (int64_t)p->idVeiculo - g->idMin;
+    if (d < 0 || (size_t)d >= g->numVeiculos) return false;
+    if (g->numPendentes >= limitePendentes(g) && !grupos_consolidar(g)) return false;
+
+    if (g->numPendentes == g->capacidadePendentes) {
+        size_t nova = g->capacidadePendentes ? g->capacidadePendentes * 2 : GRUPOS_PENDENTES_MIN;
+        PendenteGrupo* pendentes = memoria_realocar(g->subsistema, g->pendentes, nova * sizeof *pendentes);
+        if (!pendentes) return false;
+        memoria_ajustarFolga(g->subsistema, (long long)((nova - g->capacidadePendentes) * sizeof *pendentes));
+        g->pendentes = pendentes;
+        g->capacidadePendentes = nova;
+    }
+
+    uint32_t v = (uint32_t)d;
+    size_t lo = 0, hi = g->numPendentes;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        const PendenteGrupo* q = &g->pendentes[meio];
+        if (q->v < v || (q->v == v && (q->passagem->ts < p->ts || (!antesDosIguais && q->passagem->ts == p->ts))))
+            lo = meio + 1;
+        else
+            hi = meio;
+    }
+    memmove(g->pendentes + lo + 1, g->pendentes + lo, (g->numPendentes - lo) * sizeof *g->pendentes);
+    g->pendentes[lo] = (PendenteGrupo){ p, v, antesDosIguais };
+    g->numPendentes++;
+    memoria_ajustarFolga(g->subsistema, -(long long)sizeof *g->pendentes);
+    return true;
+}
+
+/**
+ * @brief Atualiza o índice para refletir a lista: põe nos pendentes a passagem
+ * registada à cabeça e as acrescentadas no fim desde a última sincronização,
+ * ou reconstrói tudo se a lista mudou de outra forma (ou se chegaram mais
+ * passagens novas do que o limite de pendentes). Antes de ler fatias é
+ * preciso grupos_consolidar().
+ *
+ * @param g
+ * @param lista
+ * @return bool false se não foi possível construir o índice (ou a lista está vazia)
+ */
+bool grupos_sincronizar(GruposVeiculo* g, const NodePassagem* lista) {
+    if (!lista) {
+        grupos_libertar(g);
+        return false;
+    }
+    if (g->cabeca == NULL || (lista != g->cabeca && lista->next != g->cabeca))
+        return construirLista(g, lista);
+
+    if (lista != g->cabeca) {
+        if (!inserir(g, &lista->passagem, true)) return construirLista(g, lista);
+        g->cabeca = lista;
+    }
+
+    // O next da cauda pode estar a ser escrito pela thread de seguimento
+    const NodePassagem* primeiro = passagem_seguinte(g->cauda);
+    if (!primeiro) return true;
+    size_t limite = limitePendentes(g), novas = 0;
+    const NodePassagem* ultimo = primeiro;
+    for (const NodePassagem* p = primeiro; p && novas <= limite; p = passagem_seguinte(p)) {
+        ultimo = p;
+        novas++;
+    }
+    if (novas > limite) return construirLista(g, lista);
+
+    for (const NodePassagem* p = primeiro; ; p = p->next) {
+        if (!inserir(g, &p->passagem, false)) return construirLista(g, lista);
+        g->cauda = p;
+        if (p == ultimo) break;
+    }
+    return true;
+}
+
+/**
+ * @brief Constrói um índice temporário com as passagens de uma vista.
+ *
+ * @param g Normalmente com GRUPOS_VEICULO_INIT(MEMORIA_CONSULTAS)
+ * @param vista
+ * @return bool false se a vista estiver vazia ou faltar memória
+ */
+bool grupos_construirVista(GruposVeiculo* g, VistaPassagens* vista) {
+    OrigemGrupos o = { NULL, NULL, NULL, NULL, vista };
+    bool ok = construir(g, &o);
+    vista_reiniciar(vista);
+    return ok;
+}
+
+/**
+ * @brief Passagens do veículo v com ts em [inicioMs, fimMs], por ordem de ts.
+ * Não vê as passagens pendentes (ver grupos_consolidar()).
+ *
+ * @param g
+ * @param v Posição do veículo (0 .. numVeiculos-1)
+ * @param inicioMs
+ * @param fimMs
+ * @param fatia
+ * @return size_t Número de passagens (0 se não houver)
+ */
+size_t grupos_fatia(const GruposVeiculo* g, size_t v, long long inicioMs, long long fimMs,
+                    const Passagem* const** fatia) {
+    size_t lo = g->inicio[v], hi = g->inicio[v + 1];
+    while (lo < hi) {   // primeira com ts >= inicioMs
+        size_t meio = lo + (hi - lo) / 2;
+        if (g->passagens[meio]->ts < inicioMs) lo = meio + 1; else hi = meio;
+    }
+    size_t primeira = lo;
+    hi = g->inicio[v + 1];
+    while (lo < hi) {   // primeira com ts > fimMs
+        size_t meio = lo + (hi - lo) / 2;
+        if (g->passagens[meio]->ts <= fimMs) lo = meio + 1; else hi = meio;
+    }
+    *fatia = g->passagens + primeira;
+    return lo - primeira;
+}
+
+/**
+ * @brief Posição do grupo de um veículo.
+ *
+ * @param g
+ * @param idVeiculo
+ * @param v
+ * @return bool false se o veículo estiver fora do intervalo do índice
+ */
+bool grupos_posicao(const GruposVeiculo* g, int idVeiculo, size_t* v) {
+    int64_t d = (int64_t)idVeiculo - g->idMin;
+    if (d < 0 || (size_t)d >= g->numVeiculos) return false;
+    *v = (size_t)d;
+    return true;
+}
+
+/**
+ * @brief Liberta o índice (as passagens não são tocadas).
+ *
+ * @param g
+ */
+void grupos_libertar(GruposVeiculo* g) {
+    memoria_ajustarFolga(g->subsistema, -(long long)((g->capacidade - g->total) * sizeof *g->passagens));
+    memoria_ajustarFolga(g->subsistema, -(long long)((g->capacidadePendentes - g->numPendentes) * sizeof *g->pendentes));
+    memoria_libertar(g->inicio);
+    memoria_libertar((void*)g->passagens);
+    memoria_libertar(g->pendentes);
+    *g = (GruposVeiculo)GRUPOS_VEICULO_INIT(g->subsistema);
+}
+
+void grupos_imprimirEstatisticas(const GruposVeiculo* g) {
+    printf("Grupos por veiculo: %zu passagens (+%zu pendentes), ids %d..%d (%zu bytes)\n",
+           g->total, g->numPendentes, g->idMin, g->numVeiculos ? grupos_idVeiculo(g, g->numVeiculos - 1) : g->idMin,
+           (g->numVeiculos + (g->inicio ? 1 : 0)) * sizeof *g->inicio + g->capacidade * sizeof *g->passagens
+           + g->capacidadePendentes * sizeof *g->pendentes);
+}
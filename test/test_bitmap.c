@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include "bitmap.h"
+#include "teste.h"
+
+#define UNIVERSO (4 << 16)   // quatro contentores
+
+static bool emA[UNIVERSO], emB[UNIVERSO];
+
+/**
+ * @brief Acrescenta ~'quantos' valores aleatórios do contentor 'chave' a um
+ * bitmap e ao conjunto de referência.
+ *
+ * @param b
+ * @param ref
+ * @param chave
+ * @param quantos
+ * @return bool
+ */
+static bool preencher(Bitmap* b, bool* ref, uint32_t chave, int quantos) {
+    for (int i = 0; i < quantos; i++) {
+        uint32_t v = (chave << 16) | (uint32_t)(rand() & 0xFFFF);
+        ref[v] = true;
+        if (!bitmap_adicionar(b, v)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Compara um bitmap com a referência em todo o universo.
+ *
+ * @param b
+ * @param ref
+ * @return bool
+ */
+static bool igualAReferencia(const Bitmap* b, const bool* ref) {
+    uint64_t cardinalidade = 0;
+    for (uint32_t v = 0; v < UNIVERSO; v++) {
+        if (bitmap_contem(b, v) != ref[v]) return false;
+        cardinalidade += ref[v];
+    }
+    return bitmap_cardinalidade(b) == cardinalidade;
+}
+
+/**
+ * @brief Interseção e união com todas as combinações de contentores:
+ * array/array, array/mapa, mapa/mapa e contentores só num dos lados.
+ *
+ */
+static void testarOperacoes(void) {
+    Bitmap a = BITMAP_INIT(MEMORIA_INDICES), b = BITMAP_INIT(MEMORIA_INDICES);
+    srand(2024);
+    bool ok = preencher(&a, emA, 0, 100)                           // array   / array
+           && preencher(&b, emB, 0, 150)
+           && preencher(&a, emA, 1, 20000)                         // mapa    / array
+           && preencher(&b, emB, 1, 1000)
+           && preencher(&a, emA, 2, 30000)                         // mapa    / mapa
+           && preencher(&b, emB, 2, 30000)
+           && preencher(&a, emA, 3, 50);                           // só em a
+    VERIFICAR(ok);
+    for (uint32_t v = 0; v < 8000; v++) {                          // mapa com interseção pequena
+        emB[(3u << 16) | (v * 8)] = true;
+        ok = ok && bitmap_adicionar(&b, (3u << 16) | (v * 8));
+    }
+    VERIFICAR(ok);
+    VERIFICAR(igualAReferencia(&a, emA));
+    VERIFICAR(igualAReferencia(&b, emB));
+
+    static bool esperado[UNIVERSO];
+    Bitmap inter = BITMAP_INIT(MEMORIA_CONSULTAS);
+    VERIFICAR(bitmap_intersetar(&a, &b, &inter));
+    for (uint32_t v = 0; v < UNIVERSO; v++) esperado[v] = emA[v] && emB[v];
+    VERIFICAR(igualAReferencia(&inter, esperado));
+
+    Bitmap uniao = BITMAP_INIT(MEMORIA_CONSULTAS);
+    VERIFICAR(bitmap_unir(&a, &b, &uniao));
+    for (uint32_t v = 0; v < UNIVERSO; v++) esperado[v] = emA[v] || emB[v];
+    VERIFICAR(igualAReferencia(&uniao, esperado));
+
+    // Comutatividade
+    Bitmap inter2 = BITMAP_INIT(MEMORIA_CONSULTAS), uniao2 = BITMAP_INIT(MEMORIA_CONSULTAS);
+    VERIFICAR(bitmap_intersetar(&b, &a, &inter2) && bitmap_unir(&b, &a, &uniao2));
+    VERIFICAR(bitmap_cardinalidade(&inter2) == bitmap_cardinalidade(&inter));
+    VERIFICAR(bitmap_cardinalidade(&uniao2) == bitmap_cardinalidade(&uniao));
+
+    bitmap_libertar(&a);
+    bitmap_libertar(&b);
+    bitmap_libertar(&inter);
+    bitmap_libertar(&uniao);
+    bitmap_libertar(&inter2);
+    bitmap_libertar(&uniao2);
+}
+
+/**
+ * @brief Conjuntos vazios e valores nos extremos.
+ *
+ */
+static void testarExtremos(void) {
+    Bitmap vazio = BITMAP_INIT(MEMORIA_INDICES), b = BITMAP_INIT(MEMORIA_INDICES);
+    VERIFICAR(bitmap_adicionar(&b, 0) && bitmap_adicionar(&b, UINT32_MAX) && bitmap_adicionar(&b, UINT32_MAX));
+    VERIFICAR(bitmap_cardinalidade(&b) == 2);
+    VERIFICAR(bitmap_contem(&b, UINT32_MAX) && !bitmap_contem(&b, UINT32_MAX - 1));
+
+    Bitmap inter = BITMAP_INIT(MEMORIA_CONSULTAS), uniao = BITMAP_INIT(MEMORIA_CONSULTAS);
+    VERIFICAR(bitmap_intersetar(&b, &vazio, &inter));
+    VERIFICAR(bitmap_cardinalidade(&inter) == 0 && !bitmap_contem(&inter, 0));
+    VERIFICAR(bitmap_unir(&vazio, &b, &uniao));
+    VERIFICAR(bitmap_cardinalidade(&uniao) == 2 && bitmap_contem(&uniao, 0) && bitmap_contem(&uniao, UINT32_MAX));
+
+    bitmap_libertar(&b);
+    bitmap_libertar(&inter);
+    bitmap_libertar(&uniao);
+}
+
+int main(void) {
+    testarOperacoes();
+    testarExtremos();
+    TERMINAR_TESTES();
+}
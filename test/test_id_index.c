@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include "id_index.h"
+#include "teste.h"
+
+/**
+ * @brief Mais de 2^24 chaves (NIFs de 9 dígitos espalhados): a tabela passa de
+ * 2^24 posições e todas as chaves têm de continuar a ser encontradas, com a
+ * posição certa na lista.
+ *
+ */
+static void testarMuitasChaves(void) {
+    IndiceIds idx = INDICE_IDS_INIT("Teste");
+    static char nos[2];
+    int n = (1 << 24) + 4096;
+    bool ok = true;
+    for (int k = 0; ok && k < n; k++)
+        ok = indiceIds_inserirCabeca(&idx, 100000000 + k * 53, &nos[k & 1], k ? &nos[(k - 1) & 1] : NULL);
+    VERIFICAR(ok);
+    VERIFICAR(idx.total == (size_t)n);
+    VERIFICAR(idx.numPosicoes > ((size_t)1 << 24));
+
+    int erradas = 0;
+    for (int k = 0; k < n; k++)
+        if (indiceIds_posicao(&idx, 100000000 + k * 53) != n - 1 - k) erradas++;
+    VERIFICAR(erradas == 0);
+    VERIFICAR(indiceIds_procurar(&idx, 100000000 + n * 53) == NULL);
+    VERIFICAR(indiceIds_posicao(&idx, 7) == -1);
+
+    // Posições iniciais na metade de cima da tabela (a dispersão usa os bits todos)
+    size_t naMetadeDeCima = 0;
+    for (size_t i = idx.numPosicoes / 2; i < idx.numPosicoes; i++)
+        if (idx.tabela[i].valor) naMetadeDeCima++;
+    VERIFICAR(naMetadeDeCima > idx.total / 4);
+    indiceIds_libertar(&idx);
+}
+
+/**
+ * @brief Construção a partir de uma lista de donos com NIFs repetidos: fica o
+ * primeiro nó, tal como na pesquisa linear.
+ *
+ */
+static void testarConstrucaoDonos(void) {
+    NodeDono nos[4] = { 0 };
+    int nifs[4] = { 123456789, 987654321, 123456789, 555555555 };
+    for (int i = 0; i < 4; i++) {
+        nos[i].dono.numeroContribuinte = nifs[i];
+        nos[i].next = i < 3 ? &nos[i + 1] : NULL;
+    }
+    IndiceIds idx = INDICE_IDS_INIT("Donos");
+    VERIFICAR(indiceDonos_construir(&idx, nos));
+    VERIFICAR(indiceIds_valido(&idx, nos));
+    VERIFICAR(indiceIds_procurar(&idx, 123456789) == &nos[0]);
+    VERIFICAR(indiceIds_posicao(&idx, 555555555) == 3);
+    VERIFICAR(idx.total == 3);
+    indiceIds_libertar(&idx);
+}
+
+int main(void) {
+    testarConstrucaoDonos();
+    testarMuitasChaves();
+    TERMINAR_TESTES();
+}
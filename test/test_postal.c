@@ -0,0 +1,70 @@
+#include <stdbool.h>
+#include <string.h>
+#include "postal.h"
+#include "teste.h"
+
+/**
+ * @brief Empacota e volta a formatar, comparando com o texto original.
+ *
+ * @param texto
+ * @return bool
+ */
+static bool idaEVolta(const char* texto) {
+    char formatado[16];
+    uint32_t codigo = empacotarCodigoPostal(texto, strlen(texto));
+    formatarCodigoPostal(codigo, formatado, sizeof formatado);
+    return codigo != CODIGO_POSTAL_INVALIDO && strcmp(formatado, texto) == 0;
+}
+
+/**
+ * @brief Os zeros à esquerda e o número de dígitos de cada parte mantêm-se.
+ *
+ */
+static void testarIdaEVolta(void) {
+    VERIFICAR(idaEVolta("4000-012"));
+    VERIFICAR(idaEVolta("4000-12"));
+    VERIFICAR(idaEVolta("4000"));
+    VERIFICAR(idaEVolta("0001-001"));
+    VERIFICAR(idaEVolta("99999-999"));
+    VERIFICAR(idaEVolta("1-0"));
+    VERIFICAR(empacotarCodigoPostal("4000-012", 8) != empacotarCodigoPostal("4000-12", 7));
+    VERIFICAR(empacotarCodigoPostal("4000-012", 8) != empacotarCodigoPostal("04000-012", 9));
+    VERIFICAR(empacotarCodigoPostal("4000-012xyz", 8) == empacotarCodigoPostal("4000-012", 8));
+
+    char formatado[4];
+    formatarCodigoPostal(empacotarCodigoPostal("4000-012", 8), formatado, sizeof formatado);
+    VERIFICAR(strcmp(formatado, "400") == 0);   // truncado como o snprintf
+}
+
+/**
+ * @brief Textos inválidos dão CODIGO_POSTAL_INVALIDO (formatado como "").
+ *
+ */
+static void testarInvalidos(void) {
+    const char* invalidos[] = { "", "-123", "4000-", "40a0-123", "123456-1", "4000-1234", "4000-12-3", "4000 123" };
+    for (size_t i = 0; i < sizeof invalidos / sizeof invalidos[0]; i++)
+        VERIFICAR(empacotarCodigoPostal(invalidos[i], strlen(invalidos[i])) == CODIGO_POSTAL_INVALIDO);
+
+    char formatado[16] = "x";
+    formatarCodigoPostal(CODIGO_POSTAL_INVALIDO, formatado, sizeof formatado);
+    VERIFICAR(formatado[0] == '\0');
+}
+
+/**
+ * @brief Distrito: prefixo sem os três últimos dígitos.
+ *
+ */
+static void testarDistrito(void) {
+    VERIFICAR(distritoCodigoPostal(empacotarCodigoPostal("4000-123", 8)) == 4);
+    VERIFICAR(distritoCodigoPostal(empacotarCodigoPostal("1750", 4)) == 1);
+    VERIFICAR(distritoCodigoPostal(empacotarCodigoPostal("0999-001", 8)) == 0);
+    VERIFICAR(distritoCodigoPostal(empacotarCodigoPostal("12345-001", 9)) == 12);
+    VERIFICAR(distritoCodigoPostal(CODIGO_POSTAL_INVALIDO) == -1);
+}
+
+int main(void) {
+    testarIdaEVolta();
+    testarInvalidos();
+    testarDistrito();
+    TERMINAR_TESTES();
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "data.h"
+#include "operations.h"
+#include "segment.h"
+#include "teste.h"
+
+#define FICHEIRO_TESTE  "teste_segmento.seg"
+#define FICHEIRO_CORTADO "teste_segmento_cortado.seg"
+#define NUM_PASSAGENS   12000
+
+static Passagem esperadas[NUM_PASSAGENS];   // por ordem de ts (e da lista nos empates)
+
+/**
+ * @brief Lista em arenaPassagens com ids espalhados por todo o intervalo de
+ * int (muitos bits por linha), diferenças de ts de 0 ms (empates) a vários
+ * dias (varints de vários bytes) e uma passagem sem ts válido no meio.
+ *
+ * @return NodePassagem*
+ */
+static NodePassagem* criarLista(void) {
+    NodePassagem *cabeca = NULL, *cauda = NULL;
+    long long ts = 1284327345135LL;
+    srand(77);
+    for (int i = 0; i <= NUM_PASSAGENS; i++) {
+        NodePassagem* no = arena_alloc(&arenaPassagens, sizeof(NodePassagem));
+        if (!no) return NULL;
+        if (i == NUM_PASSAGENS / 3) {
+            no->passagem = (Passagem){ 1, 1, "", 0, -1 };   // fica sempre na lista
+        } else {
+            int salto = rand() % 100;
+            ts += salto < 10 ? 0 : salto < 98 ? rand() % 5000 : (long long)rand() * 4;
+            no->passagem = (Passagem){ rand() % 100000, rand(), "", rand() & 1, ts };
+            esperadas[i - (i > NUM_PASSAGENS / 3)] = no->passagem;
+        }
+        no->next = NULL;
+        if (cauda) cauda->next = no;
+        else       cabeca = no;
+        cauda = no;
+    }
+    return cabeca;
+}
+
+/**
+ * @brief Compara as linhas de [primeira, ultima) das esperadas com as de segmento_filtrar().
+ *
+ * @param seg
+ * @param primeira
+ * @param ultima
+ * @return bool
+ */
+static bool filtrarIgual(const SegmentoPassagens* seg, size_t primeira, size_t ultima) {
+    Arena arena = ARENA_INIT("Teste", ARENA_BLOCO_PADRAO, MEMORIA_CONSULTAS);
+    NodePassagem *cabeca = NULL, *cauda = NULL;
+    bool ok = segmento_filtrar(seg, esperadas[primeira].ts, esperadas[ultima - 1].ts, SEGMENTO_SO_PERIODO,
+                               &arena, &cabeca, &cauda);
+    // Os empates nas pontas também entram
+    while (ok && primeira > 0 && esperadas[primeira - 1].ts == esperadas[primeira].ts) primeira--;
+    while (ok && ultima < NUM_PASSAGENS && esperadas[ultima].ts == esperadas[ultima - 1].ts &&
+           esperadas[ultima].ts <= (long long)seg->cabecalho->corte)
+        ultima++;
+
+    size_t i = primeira;
+    for (const NodePassagem* p = cabeca; ok && p; p = p->next, i++) {
+        const Passagem* a = &p->passagem;
+        const Passagem* e = &esperadas[i];
+        ok = i < ultima && a->ts == e->ts && a->idVeiculo == e->idVeiculo && a->idSensor == e->idSensor &&
+             a->tipoRegisto == e->tipoRegisto && parseTimestampMs(a->dataHora) == a->ts;
+    }
+    arena_libertar(&arena);
+    return ok && i == ultima;
+}
+
+/**
+ * @brief Conta as passagens de uma lista.
+ *
+ * @param lista
+ * @return size_t
+ */
+static size_t contar(const NodePassagem* lista) {
+    size_t n = 0;
+    for (; lista; lista = lista->next) n++;
+    return n;
+}
+
+/**
+ * @brief Dois arquivos seguidos (o segundo acrescenta blocos ao primeiro): o
+ * que sai de segmento_filtrar() tem de ser o que entrou, para o segmento todo
+ * e para um período no meio.
+ *
+ */
+static void testarArquivo(void) {
+    remove(FICHEIRO_TESTE);
+    NodePassagem* lista = criarLista();
+    VERIFICAR(lista != NULL);
+
+    size_t corte1 = 5000, corte2 = 9000;
+    while (esperadas[corte1].ts == esperadas[corte1 - 1].ts) corte1++;
+    while (esperadas[corte2].ts == esperadas[corte2 - 1].ts) corte2++;
+
+    VERIFICAR(arquivarPassagens(FICHEIRO_TESTE, &lista, esperadas[corte1 - 1].ts) == corte1);
+    VERIFICAR(segmentoPassagens.cabecalho && segmentoPassagens.cabecalho->numLinhas == corte1);
+    VERIFICAR(contar(lista) == NUM_PASSAGENS + 1 - corte1);
+    VERIFICAR(filtrarIgual(&segmentoPassagens, 0, corte1));
+    uint64_t blocos = segmentoPassagens.cabecalho->numBlocos;
+    uint64_t tamanho = segmentoPassagens.cabecalho->tamanhoTotal;
+
+    VERIFICAR(arquivarPassagens(FICHEIRO_TESTE, &lista, esperadas[corte2 - 1].ts) == corte2 - corte1);
+    VERIFICAR(segmentoPassagens.cabecalho->numLinhas == corte2);
+    VERIFICAR(segmentoPassagens.cabecalho->numBlocos > blocos);        // blocos acrescentados
+    VERIFICAR(segmentoPassagens.cabecalho->tamanhoTotal > tamanho);
+    VERIFICAR(contar(lista) == NUM_PASSAGENS + 1 - corte2);
+    VERIFICAR(filtrarIgual(&segmentoPassagens, 0, corte2));
+    VERIFICAR(filtrarIgual(&segmentoPassagens, 1234, 7777));
+    VERIFICAR(filtrarIgual(&segmentoPassagens, corte1 - 10, corte1 + 10));
+
+    // A passagem sem ts e as posteriores ao corte ficam na lista, pela mesma ordem
+    size_t i = corte2, semTs = 0;
+    bool ordem = true;
+    for (const NodePassagem* p = lista; p; p = p->next) {
+        if (p->passagem.ts < 0) { semTs++; continue; }
+        ordem = ordem && p->passagem.ts == esperadas[i++].ts;
+    }
+    VERIFICAR(ordem && semTs == 1);
+
+    // Um arquivo sem passagens novas não mexe no segmento
+    VERIFICAR(arquivarPassagens(FICHEIRO_TESTE, &lista, esperadas[corte2 - 1].ts) == 0);
+    VERIFICAR(segmentoPassagens.cabecalho->numLinhas == corte2);
+}
+
+/**
+ * @brief O segmento gravado volta a abrir; truncado é rejeitado.
+ *
+ */
+static void testarReabrir(void) {
+    SegmentoPassagens seg = { 0 };
+    VERIFICAR(segmento_abrir(&seg, FICHEIRO_TESTE));
+    VERIFICAR(seg.cabecalho && seg.cabecalho->numLinhas == segmentoPassagens.cabecalho->numLinhas);
+    VERIFICAR(seg.cabecalho && filtrarIgual(&seg, 0, (size_t)seg.cabecalho->numLinhas));
+    size_t tamanho = seg.tamanho;
+    const unsigned char* dados = seg.dados;
+
+    FILE* fp = fopen(FICHEIRO_CORTADO, "wb");
+    VERIFICAR(fp && dados && fwrite(dados, 1, tamanho / 2, fp) == tamanho / 2);
+    if (fp) fclose(fp);
+    segmento_fechar(&seg);
+
+    SegmentoPassagens cortado = { 0 };
+    VERIFICAR(!segmento_abrir(&cortado, FICHEIRO_CORTADO));
+    VERIFICAR(cortado.dados == NULL && cortado.cabecalho == NULL);
+    VERIFICAR(!segmento_abrir(&cortado, "nao_existe.seg"));
+    segmento_fechar(&cortado);
+}
+
+int main(void) {
+    testarArquivo();
+    testarReabrir();
+
+    segmento_fechar(&segmentoPassagens);
+    arena_libertar(&arenaPassagens);
+    remove(FICHEIRO_TESTE);
+    remove(FICHEIRO_CORTADO);
+    TERMINAR_TESTES();
+}
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <string.h>
+#include "data.h"
+#include "dictionary.h"
+#include "operations.h"
+#include "read_files.h"
+#include "snapshot.h"
+#include "teste.h"
+
+#define FICHEIRO_TESTE "teste_snapshot.snap"
+#define MAX_REGISTOS   16
+
+static const char* const fontes[NUM_FONTES] = {
+    [FONTE_DONOS]      = "test/donos_test.txt",
+    [FONTE_CARROS]     = "test/carros_test.txt",
+    [FONTE_SENSORES]   = "test/sensores_test.txt",
+    [FONTE_DISTANCIAS] = "test/dist_test.txt",
+    [FONTE_PASSAGENS]  = "test/pass_test.txt",
+};
+
+/**
+ * @brief Cópia dos dados carregados dos ficheiros de texto, com os textos
+ * resolvidos (os códigos dos dicionários e os heaps mudam ao recarregar).
+ *
+ */
+typedef struct {
+    Dono      donos[MAX_REGISTOS];
+    char      nomes[MAX_REGISTOS][64];
+    size_t    numDonos;
+    Carro     carros[MAX_REGISTOS];
+    char      marcas[MAX_REGISTOS][32];
+    char      modelos[MAX_REGISTOS][32];
+    size_t    numCarros;
+    Sensor    sensores[MAX_REGISTOS];
+    size_t    numSensores;
+    Distancia distancias[MAX_REGISTOS];
+    size_t    numDistancias;
+    Passagem  passagens[MAX_REGISTOS];
+    size_t    numPassagens;
+} Copia;
+
+static NodeDono*      donos;
+static NodeCarro*     carros;
+static NodeSensor*    sensores;
+static NodeDistancia* distancias;
+static NodePassagem*  passagens;
+
+/**
+ * @brief Copia as listas atuais (no máximo MAX_REGISTOS de cada).
+ *
+ * @param c
+ */
+static void copiarListas(Copia* c) {
+    memset(c, 0, sizeof *c);
+    for (NodeDono* p = donos; p && c->numDonos < MAX_REGISTOS; p = p->next, c->numDonos++) {
+        c->donos[c->numDonos] = p->dono;
+        snprintf(c->nomes[c->numDonos], sizeof c->nomes[0], "%s", nomeDono(&p->dono));
+    }
+    for (NodeCarro* p = carros; p && c->numCarros < MAX_REGISTOS; p = p->next, c->numCarros++) {
+        c->carros[c->numCarros] = p->carro;
+        snprintf(c->marcas[c->numCarros], sizeof c->marcas[0], "%s", marcaCarro(&p->carro));
+        snprintf(c->modelos[c->numCarros], sizeof c->modelos[0], "%s", modeloCarro(&p->carro));
+    }
+    for (NodeSensor* p = sensores; p && c->numSensores < MAX_REGISTOS; p = p->next)
+        c->sensores[c->numSensores++] = p->sensor;
+    for (NodeDistancia* p = distancias; p && c->numDistancias < MAX_REGISTOS; p = p->next)
+        c->distancias[c->numDistancias++] = p->distancia;
+    for (NodePassagem* p = passagens; p && c->numPassagens < MAX_REGISTOS; p = p->next)
+        c->passagens[c->numPassagens++] = p->passagem;
+}
+
+/**
+ * @brief Coordenadas iguais a menos do arredondamento do texto.
+ *
+ * @param a
+ * @param b
+ * @return bool
+ */
+static bool quaseIgual(double a, double b) {
+    return (a != a && b != b) || (a - b < 1e-6 && b - a < 1e-6);   // NAN se o texto não foi reconhecido
+}
+
+/**
+ * @brief Compara duas cópias campo a campo.
+ *
+ * @param a
+ * @param b
+ * @return bool
+ */
+static bool copiasIguais(const Copia* a, const Copia* b) {
+    if (a->numDonos != b->numDonos || a->numCarros != b->numCarros || a->numSensores != b->numSensores ||
+        a->numDistancias != b->numDistancias || a->numPassagens != b->numPassagens)
+        return false;
+    for (size_t i = 0; i < a->numDonos; i++)
+        if (a->donos[i].numeroContribuinte != b->donos[i].numeroContribuinte ||
+            a->donos[i].codigoPostal != b->donos[i].codigoPostal || strcmp(a->nomes[i], b->nomes[i]) != 0)
+            return false;
+    for (size_t i = 0; i < a->numCarros; i++) {
+        const Carro *x = &a->carros[i], *y = &b->carros[i];
+        if (strcmp(x->matricula, y->matricula) != 0 || x->ano != y->ano || x->donoContribuinte != y->donoContribuinte ||
+            x->idVeiculo != y->idVeiculo || strcmp(a->marcas[i], b->marcas[i]) != 0 ||
+            strcmp(a->modelos[i], b->modelos[i]) != 0)
+            return false;
+    }
+    for (size_t i = 0; i < a->numSensores; i++) {
+        const Sensor *x = &a->sensores[i], *y = &b->sensores[i];
+        if (x->idSensor != y->idSensor || strcmp(x->designacao, y->designacao) != 0 ||
+            !quaseIgual(x->latitude, y->latitude) || !quaseIgual(x->longitude, y->longitude))
+            return false;
+    }
+    for (size_t i = 0; i < a->numDistancias; i++) {
+        const Distancia *x = &a->distancias[i], *y = &b->distancias[i];
+        if (x->idSensor1 != y->idSensor1 || x->idSensor2 != y->idSensor2 || x->distancia != y->distancia)
+            return false;
+    }
+    for (size_t i = 0; i < a->numPassagens; i++) {
+        const Passagem *x = &a->passagens[i], *y = &b->passagens[i];
+        if (x->idSensor != y->idSensor || x->idVeiculo != y->idVeiculo || x->tipoRegisto != y->tipoRegisto ||
+            x->ts != y->ts || strcmp(x->dataHora, y->dataHora) != 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Liberta as listas (e as arenas respetivas).
+ *
+ */
+static void libertarListas(void) {
+    libertarListaDonos(&donos);
+    libertarListaCarros(&carros);
+    libertarListaSensores(&sensores);
+    libertarListaDistancias(&distancias);
+    libertarListaPassagens(&passagens);
+}
+
+/**
+ * @brief Indica se as listas estão todas vazias.
+ *
+ * @return bool
+ */
+static bool listasVazias(void) {
+    return !donos && !carros && !sensores && !distancias && !passagens;
+}
+
+/**
+ * @brief Copia os primeiros 'bytes' de um ficheiro para outro, com o byte
+ * 'posicao' trocado por 'valor' (se posicao < bytes).
+ *
+ * @param origem
+ * @param destino
+ * @param bytes
+ * @param posicao
+ * @param valor
+ * @return bool
+ */
+static bool copiarAlterado(const char* origem, const char* destino, long bytes, long posicao, int valor) {
+    static char buffer[1 << 16];
+    FILE* in = fopen(origem, "rb");
+    if (!in) return false;
+    size_t lidos = fread(buffer, 1, sizeof buffer, in);
+    fclose(in);
+    if ((long)lidos < bytes) return false;
+    if (posicao < bytes) buffer[posicao] = (char)valor;
+    FILE* out = fopen(destino, "wb");
+    if (!out) return false;
+    bool ok = fwrite(buffer, 1, (size_t)bytes, out) == (size_t)bytes;
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * @brief Grava o snapshot dos ficheiros de teste e volta a carregá-lo: as
+ * listas têm de ficar iguais, pela mesma ordem.
+ *
+ */
+static void testarGravarECarregar(void) {
+    size_t offset = carregarBaseDados(fontes, &donos, &carros, &sensores, &distancias, &passagens);
+    VERIFICAR(offset > 0);
+
+    // dist_test.txt está vazio: duas distâncias à mão para a secção não ficar vazia
+    for (int i = 0; i < 2; i++) {
+        NodeDistancia* no = arena_alloc(&arenaDistancias, sizeof(NodeDistancia));
+        VERIFICAR(no != NULL);
+        if (!no) return;
+        no->distancia = (Distancia){ 1 + i, 2 + i, 12.5f * (float)(i + 1) };
+        no->next = distancias;
+        distancias = no;
+    }
+
+    static Copia antes, depois;
+    copiarListas(&antes);
+    VERIFICAR(antes.numDonos == 5 && antes.numCarros == 5 && antes.numSensores == 5 && antes.numPassagens == 6);
+
+    VERIFICAR(gravarSnapshot(FICHEIRO_TESTE, donos, carros, sensores, distancias, passagens,
+                             fontes[FONTE_PASSAGENS], offset));
+    libertarListas();
+
+    size_t offsetLido = 0;
+    VERIFICAR(snapshotAtualizado(FICHEIRO_TESTE, fontes, NUM_FONTES, &offsetLido));
+    VERIFICAR(offsetLido == offset);
+    VERIFICAR(carregarSnapshot(FICHEIRO_TESTE, &donos, &carros, &sensores, &distancias, &passagens));
+    copiarListas(&depois);
+    VERIFICAR(copiasIguais(&antes, &depois));
+    libertarListas();
+}
+
+/**
+ * @brief Snapshots truncados, com outra magia ou outra versão são rejeitados
+ * e as listas ficam vazias.
+ *
+ */
+static void testarValidacao(void) {
+    const char* alterado = FICHEIRO_TESTE ".alterado";
+    FILE* fp = fopen(FICHEIRO_TESTE, "rb");
+    long tamanho = -1;
+    if (fp) {
+        fseek(fp, 0, SEEK_END);
+        tamanho = ftell(fp);
+        fclose(fp);
+    }
+    VERIFICAR(tamanho > (long)sizeof(SnapshotCabecalho));
+    if (tamanho <= (long)sizeof(SnapshotCabecalho)) return;
+
+    size_t offset;
+    VERIFICAR(copiarAlterado(FICHEIRO_TESTE, alterado, tamanho - 1, tamanho, 0));          // truncado
+    VERIFICAR(!carregarSnapshot(alterado, &donos, &carros, &sensores, &distancias, &passagens));
+    VERIFICAR(listasVazias());
+
+    VERIFICAR(copiarAlterado(FICHEIRO_TESTE, alterado, tamanho, 0, 'X'));                  // magia
+    VERIFICAR(!carregarSnapshot(alterado, &donos, &carros, &sensores, &distancias, &passagens));
+    VERIFICAR(listasVazias());
+    VERIFICAR(!snapshotAtualizado(alterado, fontes, NUM_FONTES, &offset));
+
+    VERIFICAR(copiarAlterado(FICHEIRO_TESTE, alterado, tamanho, 8, SNAPSHOT_VERSAO + 1));  // versão
+    VERIFICAR(!carregarSnapshot(alterado, &donos, &carros, &sensores, &distancias, &passagens));
+    VERIFICAR(listasVazias());
+    VERIFICAR(!snapshotAtualizado(alterado, fontes, NUM_FONTES, &offset));
+
+    VERIFICAR(copiarAlterado(FICHEIRO_TESTE, alterado, sizeof(SnapshotCabecalho) / 2, tamanho, 0));
+    VERIFICAR(!carregarSnapshot(alterado, &donos, &carros, &sensores, &distancias, &passagens));
+    VERIFICAR(listasVazias());
+
+    VERIFICAR(!carregarSnapshot("nao_existe.snap", &donos, &carros, &sensores, &distancias, &passagens));
+    VERIFICAR(listasVazias());
+    remove(alterado);
+}
+
+int main(void) {
+    testarGravarECarregar();
+    testarValidacao();
+    remove(FICHEIRO_TESTE);
+    TERMINAR_TESTES();
+}
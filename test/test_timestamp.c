@@ -0,0 +1,57 @@
+#include <time.h>
+#include "operations.h"
+#include "teste.h"
+
+#define TS_12_09_2010_21_35_45 1284327345000LL   // 12-09-2010 21:35:45 UTC, em ms
+
+/**
+ * @brief Caminho rápido: separador '_' ou espaço, com e sem milissegundos
+ * (1 a 3 dígitos, escalados).
+ *
+ */
+static void testarFormatoFixo(void) {
+    VERIFICAR(parseTimestampMs("12-09-2010_21:35:45.135") == TS_12_09_2010_21_35_45 + 135);
+    VERIFICAR(parseTimestampMs("12-09-2010 21:35:45.135") == TS_12_09_2010_21_35_45 + 135);
+    VERIFICAR(parseTimestampMs("12-09-2010_21:35:45") == TS_12_09_2010_21_35_45);
+    VERIFICAR(parseTimestampMs("12-09-2010 21:35:45") == TS_12_09_2010_21_35_45);
+    VERIFICAR(parseTimestampMs("12-09-2010_21:35:45.5") == TS_12_09_2010_21_35_45 + 500);
+    VERIFICAR(parseTimestampMs("12-09-2010_21:35:45.05") == TS_12_09_2010_21_35_45 + 50);
+    VERIFICAR(parseTimestampMs("12-09-2010_21:35:45.") == TS_12_09_2010_21_35_45);
+    VERIFICAR(parseTimestampMs("01-01-1970_00:00:00.000") == 0);
+    VERIFICAR(parseTimestampMs("29-02-2024_23:59:59.999") == 1709251199000LL + 999);
+    VERIFICAR(parseTimestamp("12-09-2010 21:35:45.999") == (time_t)(TS_12_09_2010_21_35_45 / 1000));
+}
+
+/**
+ * @brief A memoização da data não pode trocar dias diferentes com a mesma hora.
+ *
+ */
+static void testarCacheDatas(void) {
+    for (int i = 0; i < 3; i++) {
+        VERIFICAR(parseTimestampMs("12-09-2010_21:35:45") == TS_12_09_2010_21_35_45);
+        VERIFICAR(parseTimestampMs("13-09-2010_21:35:45") == TS_12_09_2010_21_35_45 + 86400000LL);
+        VERIFICAR(parseTimestampMs("12-10-2010 21:35:45") == TS_12_09_2010_21_35_45 + 30 * 86400000LL);
+    }
+}
+
+/**
+ * @brief Caminho lento (strptime) e datas inválidas.
+ *
+ */
+static void testarOutrosFormatos(void) {
+    VERIFICAR(parseTimestampMs("1-9-2010 8:05:00") == 1283328300000LL);
+    VERIFICAR(parseTimestampMs("1-9-2010_8:05:00") == 1283328300000LL);
+    VERIFICAR(parseTimestampMs("32-01-2024 00:00:00") == -1);
+    VERIFICAR(parseTimestampMs("12-13-2010_21:35:45") == -1);
+    VERIFICAR(parseTimestampMs("12-09-2010_24:00:00") == -1);
+    VERIFICAR(parseTimestampMs("12/09/2010 21:35:45") == -1);
+    VERIFICAR(parseTimestampMs("") == -1);
+    VERIFICAR(parseTimestamp("abc") == (time_t)-1);
+}
+
+int main(void) {
+    testarFormatoFixo();
+    testarCacheDatas();
+    testarOutrosFormatos();
+    TERMINAR_TESTES();
+}
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tokenizer.h"
+#include "teste.h"
+
+#define MAX_CAMPOS 6
+
+/**
+ * @brief Referência byte a byte: os campos de uma linha de [p, fim), com as
+ * mesmas regras do tokenizador (campos vazios ignorados, '\r' final retirado
+ * do último campo, campos a mais ignorados).
+ *
+ * @param p Início da linha (avança para a seguinte)
+ * @param fim
+ * @param campos
+ * @return int
+ */
+static int linhaReferencia(const char** p, const char* fim, Campo* campos) {
+    int n = 0;
+    const char* ini = *p;
+    for (const char* c = *p;; c++) {
+        bool fimLinha = c >= fim || *c == '\n';
+        if (fimLinha || *c == '\t') {
+            const char* f = c;
+            if (fimLinha)
+                while (f > ini && f[-1] == '\r') f--;
+            if (f > ini && n < MAX_CAMPOS) {
+                campos[n].ini = ini;
+                campos[n].fim = f;
+                n++;
+            }
+            ini = c + 1;
+            if (fimLinha) {
+                *p = c + 1;
+                return n;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compara o tokenizador com a referência num buffer inteiro.
+ *
+ * @param ini
+ * @param fim
+ * @return bool
+ */
+static bool igualAReferencia(const char* ini, const char* fim) {
+    Tokenizador t;
+    tokenizador_init(&t, ini, fim);
+    const char* p = ini;
+    Campo campos[MAX_CAMPOS], esperados[MAX_CAMPOS];
+    while (p < fim) {
+        int n = tokenizador_linha(&t, campos, MAX_CAMPOS);
+        if (n != linhaReferencia(&p, fim, esperados)) return false;
+        for (int i = 0; i < n; i++)
+            if (campos[i].ini != esperados[i].ini || campos[i].fim != esperados[i].fim) return false;
+    }
+    return tokenizador_linha(&t, campos, MAX_CAMPOS) == -1;
+}
+
+/**
+ * @brief Buffers aleatórios com muitos delimitadores, de vários tamanhos e
+ * alinhamentos: os blocos de 64 bytes passam pelo caminho vetorial e o resto
+ * pelo escalar, e ambos têm de dar o mesmo que a referência.
+ *
+ */
+static void testarBuffersAleatorios(void) {
+    static const char alfabeto[] = "ab1-\t\t\n\r ";
+    static char buffer[1024 + 64];
+    srand(12345);
+    int diferentes = 0;
+    for (int iteracao = 0; iteracao < 4000; iteracao++) {
+        size_t desvio = (size_t)(rand() % 64);
+        size_t tamanho = (size_t)(rand() % 1024);
+        for (size_t i = 0; i < tamanho; i++)
+            buffer[desvio + i] = alfabeto[rand() % (int)(sizeof alfabeto - 1)];
+        if (!igualAReferencia(buffer + desvio, buffer + desvio + tamanho)) diferentes++;
+    }
+    VERIFICAR(diferentes == 0);
+}
+
+/**
+ * @brief Linhas de passagem.txt que atravessam blocos de 64 bytes.
+ *
+ */
+static void testarLinhasPassagens(void) {
+    char texto[4096] = "";
+    size_t tamanho = 0;
+    for (int i = 0; i < 60; i++)
+        tamanho += (size_t)snprintf(texto + tamanho, sizeof texto - tamanho,
+                                    "%d\t%d\t12-09-2010_21:35:%02d.135\t%d%s\n", i, 1000 + i, i % 60, i & 1,
+                                    i % 7 == 0 ? "\r" : "");
+    VERIFICAR(igualAReferencia(texto, texto + tamanho));
+
+    Tokenizador t;
+    Campo campos[MAX_CAMPOS];
+    tokenizador_init(&t, texto, texto + tamanho);
+    int linhas = 0, erradas = 0;
+    int n;
+    while ((n = tokenizador_linha(&t, campos, MAX_CAMPOS)) >= 0) {
+        char dataHora[32];
+        campoCopiar(dataHora, sizeof dataHora, campos[2]);
+        if (n != 4 || campoInteiro(campos[0]) != linhas || campoInteiro(campos[1]) != 1000 + linhas ||
+            strlen(dataHora) != 23 || campoInteiro(campos[3]) != (linhas & 1))
+            erradas++;
+        linhas++;
+    }
+    VERIFICAR(linhas == 60);
+    VERIFICAR(erradas == 0);
+}
+
+/**
+ * @brief Conversões dos campos.
+ *
+ */
+static void testarConversoes(void) {
+    const char texto[] = "-42\t 17\t3.25\t-0.5e1\t40.123456789\n";
+    Tokenizador t;
+    Campo campos[MAX_CAMPOS];
+    tokenizador_init(&t, texto, texto + sizeof texto - 1);
+    VERIFICAR(tokenizador_linha(&t, campos, MAX_CAMPOS) == 5);
+    VERIFICAR(campoInteiro(campos[0]) == -42);
+    VERIFICAR(campoInteiro(campos[1]) == 17);
+    VERIFICAR(campoDecimal(campos[2]) == 3.25);
+    VERIFICAR(campoDecimal(campos[4]) > 40.1234567 && campoDecimal(campos[4]) < 40.1234568);
+
+    char copia[4];
+    campoCopiar(copia, sizeof copia, campos[2]);
+    VERIFICAR(strcmp(copia, "3.2") == 0);
+    VERIFICAR(tokenizador_linha(&t, campos, MAX_CAMPOS) == -1);
+}
+
+int main(void) {
+    testarBuffersAleatorios();
+    testarLinhasPassagens();
+    testarConversoes();
+    TERMINAR_TESTES();
+}
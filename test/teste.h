@@ -0,0 +1,28 @@
+#ifndef TESTE_H
+#define TESTE_H
+
+#include <stdio.h>
+
+/**
+ * @brief Verificações mínimas para os testes em test/: cada VERIFICAR que falha
+ * é contado e mostrado com o ficheiro e a linha; o main() termina com
+ * TERMINAR_TESTES(), que devolve 1 se alguma falhou.
+ *
+ */
+static int testesFalhados = 0;
+static int testesFeitos   = 0;
+
+#define VERIFICAR(condicao) do {                                              \
+        testesFeitos++;                                                       \
+        if (!(condicao)) {                                                    \
+            testesFalhados++;                                                 \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condicao); \
+        }                                                                     \
+    } while (0)
+
+#define TERMINAR_TESTES() do {                                                \
+        printf("%s: %d verificacoes, %d falhadas\n", __FILE__, testesFeitos, testesFalhados); \
+        return testesFalhados ? 1 : 0;                                        \
+    } while (0)
+
+#endif // TESTE_H